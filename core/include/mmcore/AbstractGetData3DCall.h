@@ -140,6 +140,23 @@ namespace core {
             this->frameID = frameID;
         }
 
+        /**
+         * Requests the data of frame 'frameID' on a worker thread, e.g. to
+         * load frame N + 1 while frame N is rendered. The call must not be
+         * used until the returned future is ready, so the data of the
+         * current frame has to be consumed (e.g. uploaded) and unlocked
+         * before. Modules not using this keep calling synchronously.
+         *
+         * @param frameID The requested frame.
+         * @param force   Flag whether or not to force the frame data.
+         *
+         * @return The return value of 'GetData'.
+         */
+        inline std::future<bool> RequestFrameAsync(unsigned int frameID, bool force = false) {
+            this->SetFrameID(frameID, force);
+            return this->InvokeAsync(0);
+        }
+
         /**
          * Assignment operator.
          * Makes a deep copy of all members. While for data these are only
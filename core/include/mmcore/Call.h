@@ -12,6 +12,8 @@
 #endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
 
 #include "mmcore/api/MegaMolCore.std.h"
+#include <atomic>
+#include <future>
 
 
 namespace megamol {
@@ -23,6 +25,9 @@ namespace core {
     namespace factories {
         class CallDescription;
     }
+    namespace profiler {
+        class Tracer;
+    }
 
 
     /**
@@ -40,6 +45,9 @@ namespace core {
         /** The caller slot registeres itself in the call */
         friend class CallerSlot;
 
+        /** The tracer stores the id of the call names */
+        friend class profiler::Tracer;
+
         /** Ctor. */
         Call(void);
 
@@ -47,7 +55,8 @@ namespace core {
         virtual ~Call(void);
 
         /**
-         * Calls function 'func'.
+         * Calls function 'func'. Waits while another thread executes a
+         * callback of the callee module, see CallScheduler.
          *
          * @param func The function to be called.
          *
@@ -55,6 +64,17 @@ namespace core {
          */
         bool operator()(unsigned int func = 0);
 
+        /**
+         * Calls function 'func' on a worker thread of the CallScheduler.
+         * The call must neither be used nor deleted until the returned
+         * future is ready.
+         *
+         * @param func The function to be called.
+         *
+         * @return The return value of the function.
+         */
+        std::future<bool> InvokeAsync(unsigned int func = 0);
+
         /**
          * Answers the callee slot this call is connected to.
          *
@@ -83,6 +103,17 @@ namespace core {
 
     private:
 
+        /**
+         * The id of the call in the tracer, 0 if never traced. Copies of
+         * a call are traced under their own id, keeping calls copyable.
+         */
+        struct TraceID {
+            TraceID(void) : id(0) {}
+            TraceID(const TraceID&) : id(0) {}
+            TraceID& operator=(const TraceID&) { return *this; }
+            std::atomic<unsigned int> id;
+        };
+
         /** The callee connected by this call */
         CalleeSlot *callee;
 
@@ -94,6 +125,9 @@ namespace core {
         /** The function id mapping */
         unsigned int *funcMap;
 
+        /** The id of the call in the tracer */
+        mutable TraceID traceID;
+
     };
 
 
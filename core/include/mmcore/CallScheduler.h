@@ -0,0 +1,155 @@
+/*
+ * CallScheduler.h
+ *
+ * Copyright (C) 2020 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MEGAMOLCORE_CALLSCHEDULER_H_INCLUDED
+#define MEGAMOLCORE_CALLSCHEDULER_H_INCLUDED
+#pragma once
+
+#include "mmcore/api/MegaMolCore.std.h"
+#include <condition_variable>
+#include <future>
+#include <list>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace megamol {
+namespace core {
+
+    /** forward declaration */
+    class Call;
+
+    /**
+     * Worker pool executing call invocations requested with
+     * Call::InvokeAsync.
+     *
+     * Invocations of calls into different modules run in parallel, while
+     * invocations into the same module are executed one after another in
+     * the order they were requested. Synchronous invocations with
+     * Call::operator() take part in this, too: they wait while another
+     * thread executes a callback of their callee module, so a module never
+     * has to handle two of its callbacks concurrently once calls are
+     * requested asynchronously. A thread may reenter a module it is
+     * already executing.
+     *
+     * Invocations requested from a worker thread are executed immediately
+     * on that thread, as waiting for them could otherwise block all
+     * workers.
+     *
+     * The owner of the modules (the CoreInstance) has to call Shutdown
+     * before the modules and the libraries of their plugins are released.
+     */
+    class MEGAMOLCORE_API CallScheduler {
+    public:
+
+        /**
+         * Answer the only instance of this class
+         *
+         * @return The only instance of this class
+         */
+        static CallScheduler& Instance(void);
+
+        /**
+         * Sets the number of worker threads. Only effective before the
+         * first invocation is scheduled.
+         *
+         * @param count The number of worker threads, at least one.
+         */
+        void SetThreadCount(unsigned int count);
+
+        /**
+         * Schedules the invocation of function 'func' of 'call'.
+         *
+         * @param call The call to invoke, which must neither be used nor
+         *             deleted until the returned future is ready.
+         * @param func The function to invoke.
+         *
+         * @return The result of the invocation.
+         */
+        std::future<bool> Submit(Call& call, unsigned int func);
+
+        /**
+         * Waits until no other thread executes a callback of 'module' and
+         * marks it as being executed by the calling thread. Every call of
+         * Enter must be matched by a call of Leave on the same thread.
+         *
+         * @param module The module to enter, 'nullptr' is ignored.
+         */
+        void Enter(const void *module);
+
+        /**
+         * Ends one execution of a callback of 'module' by the calling
+         * thread started with Enter.
+         *
+         * @param module The module to leave, 'nullptr' is ignored.
+         */
+        void Leave(const void *module);
+
+        /**
+         * Executes the pending invocations and stops the worker threads.
+         * Workers are started again by the next invocation requested.
+         * Must not be called from a worker thread.
+         */
+        void Shutdown(void);
+
+    private:
+
+        /** A requested invocation */
+        struct Task {
+            Call *call;
+            unsigned int func;
+            const void *module;
+            std::promise<bool> result;
+        };
+
+        /** The thread executing callbacks of a module */
+        struct Owner {
+            std::thread::id thread;
+            unsigned int depth;
+        };
+
+        /** Hidden ctor */
+        CallScheduler(void);
+
+        /**
+         * Hidden dtor. Does not wait for workers still running, as it is
+         * called while the core library is unloaded; see Shutdown.
+         */
+        ~CallScheduler(void);
+
+        /** The worker thread loop */
+        void work(void);
+
+        /** Guards all members */
+        std::mutex lock;
+
+        /** Signals new tasks, modules left and shutdown */
+        std::condition_variable wake;
+
+        /** The requested invocations in request order */
+        std::list<Task> queue;
+
+        /** The modules currently executing a callback and their threads */
+        std::map<const void*, Owner> busy;
+
+        /** The worker threads, started with the first task */
+        std::vector<std::thread> workers;
+
+        /** The number of worker threads */
+        unsigned int threadCount;
+
+        /** Tells the workers to finish */
+        bool stop;
+
+    };
+
+} /* end namespace core */
+} /* end namespace megamol */
+
+#endif /* MEGAMOLCORE_CALLSCHEDULER_H_INCLUDED */
@@ -52,15 +52,18 @@
 #include "vislib/sys/Lockable.h"
 #include "vislib/sys/Log.h"
 
+#include <exception>
 #include <functional>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 namespace megamol {
 namespace core {
 
 /* forward declaration */
 class AbstractService;
+class CalleeSlot;
 
 namespace utility {
 
@@ -663,6 +666,24 @@ public:
     Call* InstantiateCall(
         const vislib::StringA fromPath, const vislib::StringA toPath, factories::CallDescription::ptr desc);
 
+    /**
+     * Instantiates the modules and then the calls of a graph in one pass.
+     * All requests are validated before the graph is changed and all names
+     * are resolved against an index of the module graph built once. All
+     * modules are first created on the calling thread in request order,
+     * except those whose class answers 'IsCreateThreadSafe', which are
+     * created afterwards on up to "GraphCreateThreads" threads (default 1,
+     * 0 uses all cores). Invalid requests are logged and skipped, and the
+     * time of each phase is logged.
+     *
+     * @param modules The modules to instantiate (full names)
+     * @param calls   The calls to instantiate (full slot names)
+     *
+     * @return 'true' if all modules and calls have been instantiated
+     */
+    bool InstantiateGraph(const std::vector<InstanceDescription::ModuleInstanceRequest>& modules,
+        const std::vector<InstanceDescription::CallInstanceRequest>& calls);
+
     /**
      * Instantiates a module
      *
@@ -1072,9 +1093,64 @@ private:
     /**
      * Loads the plugin 'filename'
      *
-     * @param filename The plugin to load
+     * @param filename  The plugin to load
+     * @param lib       The library of the plugin if it already has been
+     *                  opened, or nullptr.
+     * @param openError The error opening the library, if any.
+     */
+    void loadPlugin(const vislib::TString& filename,
+        std::shared_ptr<vislib::sys::DynamicLinkLibrary> lib = nullptr,
+        std::exception_ptr openError = nullptr);
+
+    /**
+     * Loads the plugins 'files' as configured: either all of them, opening
+     * the libraries on several threads ("PluginLoadThreads"), or, with
+     * "PluginLoading" set to "lazy" and a valid "PluginManifest", only when
+     * one of their classes is looked up for the first time.
+     *
+     * @param files The plugins to load
+     */
+    void loadPlugins(const vislib::SingleLinkedList<vislib::TString>& files);
+
+    /**
+     * Loads the deferred plugin providing 'classname', or all deferred
+     * plugins if the manifest does not know the class.
+     *
+     * @param classname The module or call class looked up
      */
-    void loadPlugin(const vislib::TString& filename);
+    void loadProvidingPlugin(const char* classname);
+
+    /**
+     * Implements InstantiateGraph. The caller must hold the graph update
+     * lock and the module graph lock.
+     *
+     * @param modules    The modules to instantiate (full names)
+     * @param calls      The calls to instantiate (full slot names)
+     * @param outModules Receives the module of each request or nullptr, if
+     *                   not nullptr
+     * @param outCalls   Receives the call of each request or nullptr, if not
+     *                   nullptr
+     *
+     * @return 'true' if all modules and calls have been instantiated
+     */
+    bool instantiateGraph(const std::vector<InstanceDescription::ModuleInstanceRequest>& modules,
+        const std::vector<InstanceDescription::CallInstanceRequest>& calls, std::vector<Module::ptr_type>* outModules,
+        std::vector<Call*>* outCalls);
+
+    /**
+     * Connects two resolved slots with a new call.
+     *
+     * @param fromSlot The caller slot
+     * @param toSlot   The callee slot
+     * @param desc     The call description
+     * @param fromPath The full name of 'fromSlot' for messages
+     * @param toPath   The full name of 'toSlot' for messages
+     *
+     * @return The new call, the equal call already connecting the slots, or
+     *         'NULL' in case of an error
+     */
+    Call* connectCall(CallerSlot* fromSlot, CalleeSlot* toSlot, factories::CallDescription::ptr desc,
+        const vislib::StringA& fromPath, const vislib::StringA& toPath);
 
     /**
      * Compares two maps storing the association between
@@ -1278,6 +1354,12 @@ private:
     /** The manager of loaded plugins */
     utility::plugins::PluginManager* plugins;
 
+    /** The plugins not loaded yet in lazy plugin loading */
+    std::vector<vislib::TString> deferredPlugins;
+
+    /** The plugin manifest file, if configured */
+    vislib::TString pluginManifest;
+
     /** The manager of registered services */
     utility::ServiceManager* services;
 
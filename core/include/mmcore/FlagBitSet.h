@@ -0,0 +1,139 @@
+/*
+ * FlagBitSet.h
+ *
+ * Copyright (C) 2020 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MEGAMOL_FLAGBITSET_H_INCLUDED
+#define MEGAMOL_FLAGBITSET_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#    pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "mmcore/api/MegaMolCore.std.h"
+
+
+namespace megamol {
+namespace core {
+
+/**
+ * Bit-packed view of one predicate over a flag array, i.e. one bit per item
+ * telling whether (flags[i] & testMask) == passMask. With testMask ==
+ * passMask == FlagStorage::SELECTED this is the selection, for instance.
+ *
+ * The set can be rebuilt from scratch or updated for an index interval,
+ * which is what consumers of FlagRangeLog use to follow changes.
+ */
+class MEGAMOLCORE_API FlagBitSet {
+public:
+    /**
+     * Ctor.
+     *
+     * @param testMask The flag bits to be tested.
+     * @param passMask The value the tested bits must have.
+     */
+    FlagBitSet(const uint32_t testMask = 0, const uint32_t passMask = 0);
+
+    /** Dtor. */
+    ~FlagBitSet(void);
+
+    /**
+     * Rebuild the set from 'cnt' flags.
+     *
+     * @param flags The flags.
+     * @param cnt   The number of flags.
+     */
+    void Assign(const uint32_t *flags, const size_t cnt);
+
+    /**
+     * Answer the number of items passing the predicate.
+     *
+     * @return The number of set bits.
+     */
+    inline size_t Count(void) const {
+        return this->count;
+    }
+
+    /**
+     * Call 'func' with the index of each item passing the predicate in
+     * ascending order. Words without any set bit are skipped as a whole.
+     *
+     * @param func The functor receiving the indices.
+     */
+    template<class F> void ForEachSet(F&& func) const {
+        for (size_t w = 0; w < this->words.size(); ++w) {
+            uint64_t word = this->words[w];
+            while (word != 0) {
+                func(w * 64 + lowestBit(word));
+                word &= word - 1;
+            }
+        }
+    }
+
+    /**
+     * Answer whether the predicate uses the given masks.
+     */
+    inline bool HasMasks(const uint32_t testMask, const uint32_t passMask) const {
+        return (this->testMask == testMask) && (this->passMask == passMask);
+    }
+
+    /**
+     * Answer the number of items in the set.
+     *
+     * @return The number of items.
+     */
+    inline size_t Size(void) const {
+        return this->size;
+    }
+
+    /**
+     * Answer whether item 'idx' passes the predicate.
+     *
+     * @param idx The index of the item.
+     *
+     * @return 'true' if the bit is set, 'false' otherwise.
+     */
+    inline bool Test(const size_t idx) const {
+        return ((this->words[idx / 64] >> (idx % 64)) & 1) != 0;
+    }
+
+    /**
+     * Re-evaluate the items [begin, end) from 'flags', which holds the
+     * flags of all Size() items.
+     *
+     * @param flags The flags of all items.
+     * @param begin The first item to be re-evaluated.
+     * @param end   One past the last item to be re-evaluated.
+     *
+     * @return 'true' if any bit has changed, 'false' otherwise.
+     */
+    bool Update(const uint32_t *flags, size_t begin, size_t end);
+
+private:
+    /** Answer the index of the lowest set bit of 'word' (which is not 0). */
+    static unsigned int lowestBit(uint64_t word);
+
+    /** The number of set bits. */
+    size_t count;
+
+    /** The mask the flags must have under 'testMask' to pass. */
+    uint32_t passMask;
+
+    /** The number of items. */
+    size_t size;
+
+    /** The flag bits being tested. */
+    uint32_t testMask;
+
+    /** The bits, 64 items per word. */
+    std::vector<uint64_t> words;
+};
+
+} // namespace core
+} /* end namespace megamol */
+
+#endif /* MEGAMOL_FLAGBITSET_H_INCLUDED */
@@ -11,6 +11,13 @@
 #    pragma once
 #endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
 
+#include "mmcore/FlagRangeLog.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
 namespace megamol {
 namespace core {
 
@@ -18,14 +25,71 @@ class FlagCollection_GL {
 public:
     std::shared_ptr<glowl::BufferObject> flags;
 
+    /** The intervals modified by the recent versions, maintained by FlagStorage_GL */
+    FlagRangeLog ranges;
+
+    /** The binding point of the change bounds in bitflags.btf (::bitflags::changes) */
+    static const GLuint CHANGES_BINDING = 7;
+
+    /**
+     * Records that the flags [begin, end) have been modified. Writers should call this
+     * before handing out a new version, otherwise all flags count as modified.
+     */
+    void markDirty(size_t begin, size_t end) { dirty.emplace_back(begin, end); }
+
+    /**
+     * Binds the bounds of the flags changed by compute shaders (bitflag_trackChange) to
+     * CHANGES_BINDING. The bounds accumulate until markChanged() collects them.
+     */
+    void bindChanges(void) {
+        if (!changes) {
+            changes = std::make_shared<glowl::BufferObject>(
+                GL_SHADER_STORAGE_BUFFER, std::vector<uint32_t>{UINT32_MAX, 0}, GL_DYNAMIC_COPY);
+        }
+        changes->bind(CHANGES_BINDING);
+    }
+
+    /**
+     * Records the bounds of the flags changed by compute shaders via markDirty and resets
+     * them. Writers call this before handing out a new version; if nothing changed, the
+     * version is recorded with an empty interval.
+     */
+    void markChanged(void) {
+        if (!changes) return;
+        uint32_t bounds[2];
+        glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+        changes->bind();
+        glGetBufferSubData(changes->getTarget(), 0, sizeof(bounds), bounds);
+        markDirty((std::min)(bounds[0], bounds[1]), bounds[1]);
+        changes->rebuffer(std::vector<uint32_t>{UINT32_MAX, 0});
+    }
+
+    /**
+     * Commits the intervals recorded via markDirty as 'version'. Only used by FlagStorage_GL.
+     */
+    void commitDirty(FlagRangeLog::VersionType version) {
+        if (dirty.empty()) {
+            dirty.emplace_back(0, flags->getByteSize() / sizeof(uint32_t));
+        }
+        ranges.Commit(version, std::move(dirty));
+        dirty.clear();
+    }
+
     void validateFlagCount(uint32_t num) {
         if (flags->getByteSize() / sizeof(uint32_t) < num) {
+            markDirty(flags->getByteSize() / sizeof(uint32_t), num);
             std::vector<uint32_t> temp_data(num, FlagStorage::ENABLED);
             std::shared_ptr<glowl::BufferObject> temp_buffer = std::make_shared<glowl::BufferObject>(GL_SHADER_STORAGE_BUFFER, temp_data, GL_DYNAMIC_DRAW);
             glowl::BufferObject::copy(flags.get(), temp_buffer.get(), 0, 0, flags->getByteSize());
             flags = temp_buffer;
         }
     }
+
+private:
+    std::vector<FlagRangeLog::Range> dirty;
+
+    /** The first changed and one past the last changed flag, see bindChanges() */
+    std::shared_ptr<glowl::BufferObject> changes;
 };
 
 } // namespace core
@@ -0,0 +1,120 @@
+/*
+ * FlagRangeLog.h
+ *
+ * Copyright (C) 2020 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MEGAMOL_FLAGRANGELOG_H_INCLUDED
+#define MEGAMOL_FLAGRANGELOG_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#    pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+#include "mmcore/api/MegaMolCore.std.h"
+
+
+namespace megamol {
+namespace core {
+
+/**
+ * Records which index intervals of a flag storage were modified by which
+ * version, so consumers can apply only the changes since the version they
+ * have last seen instead of rescanning all flags.
+ *
+ * Only the most recent versions are retained. Not synchronised, access is
+ * expected to be serialised by the owning storage.
+ */
+class MEGAMOLCORE_API FlagRangeLog {
+public:
+    /** Half-open index interval [first, second). */
+    typedef std::pair<size_t, size_t> Range;
+
+    /** Version type, matching FlagStorage::FlagVersionType. */
+    typedef uint32_t VersionType;
+
+    /**
+     * Sorts 'ranges' and merges overlapping and adjacent intervals.
+     *
+     * @param ranges The ranges to be coalesced in place.
+     */
+    static void Coalesce(std::vector<Range>& ranges);
+
+    /**
+     * Ctor.
+     *
+     * @param maxVersions The number of versions to be retained.
+     */
+    FlagRangeLog(const size_t maxVersions = 64);
+
+    /** Dtor. */
+    ~FlagRangeLog(void);
+
+    /**
+     * Forget all recorded versions. Afterwards, Collect() fails for all
+     * versions before 'version'.
+     *
+     * @param version The version the flags are at now.
+     */
+    void Clear(const VersionType version);
+
+    /**
+     * Answer the union of all intervals modified after 'since'.
+     *
+     * @param since     The last version the caller has seen.
+     * @param outRanges Receives the coalesced intervals.
+     *
+     * @return 'true' on success, 'false' if the log does not reach back to
+     *         'since' any more, in which case the caller must assume that
+     *         all flags have changed. This also happens if the caller
+     *         claims to have seen a version newer than Version().
+     */
+    bool Collect(const VersionType since, std::vector<Range>& outRanges) const;
+
+    /**
+     * Record that 'version' modified 'ranges'.
+     *
+     * @param version The new version, which must be larger than all
+     *                versions recorded before.
+     * @param ranges  The modified intervals.
+     */
+    void Commit(const VersionType version, std::vector<Range> ranges);
+
+    /**
+     * Answer the most recently committed version.
+     *
+     * @return The current version.
+     */
+    inline VersionType Version(void) const {
+        return this->version;
+    }
+
+private:
+    /** The intervals modified by one version. */
+    struct Entry {
+        VersionType version;
+        std::vector<Range> ranges;
+    };
+
+    /** The retained versions, oldest first. */
+    std::deque<Entry> entries;
+
+    /** The newest version which is not covered by 'entries' any more. */
+    VersionType horizon;
+
+    /** The number of versions to be retained. */
+    size_t maxVersions;
+
+    /** The most recently committed version. */
+    VersionType version;
+};
+
+} // namespace core
+} /* end namespace megamol */
+
+#endif /* MEGAMOL_FLAGRANGELOG_H_INCLUDED */
@@ -224,6 +224,21 @@ protected:
     int Flush(lua_State* L);
     int CurrentScriptPath(lua_State* L);
 
+    /**
+     * mmStartTrace([int spansPerThread]): discard the recorded call spans
+     * and start tracing all calls.
+     */
+    int StartTrace(lua_State* L);
+
+    /** mmStopTrace(): stop tracing, keeping the recorded spans. */
+    int StopTrace(lua_State* L);
+
+    /** mmWriteTrace(string fileName): write the spans as Chrome trace JSON. */
+    int WriteTrace(lua_State* L);
+
+    /** mmTraceSummary(): answer the recorded time per module. */
+    int TraceSummary(lua_State* L);
+
 private:
 
     /** answer whether LuaState is instanced for configuration */
@@ -90,6 +90,23 @@ namespace core {
             return true;
         }
 
+        /**
+         * Answer whether the ctor and 'create' of this module can run
+         * concurrently with those of other modules. Overwrite if they
+         * neither touch shared state nor the graphics context and do not set
+         * parameter values, so batched graph instantiation may create the
+         * module on a worker thread. This holds for most modules whose ctor
+         * only makes their slots available and whose 'create' does no more
+         * than return 'true'.
+         *
+         * This default implementation returns 'false'
+         *
+         * @return Whether or not the module can be created on any thread.
+         */
+        static bool IsCreateThreadSafe(void) {
+            return false;
+        }
+
         /**
          * Ctor.
          *
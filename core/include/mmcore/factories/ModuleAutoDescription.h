@@ -69,6 +69,16 @@ namespace factories {
             return C::IsAvailable();
         }
 
+        /**
+         * Answers whether modules of this class can be created concurrently
+         * with other modules.
+         *
+         * @return 'true' if the module can be created on any thread.
+         */
+        virtual bool IsCreateThreadSafe(void) const {
+            return C::IsCreateThreadSafe();
+        }
+
         /**
          * Answers whether this description is describing the class of
          * 'module'.
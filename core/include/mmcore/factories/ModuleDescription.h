@@ -71,6 +71,18 @@ namespace factories {
          */
         virtual bool IsAvailable(void) const;
 
+        /**
+         * Answers whether modules of this class can be constructed and
+         * created concurrently with other modules, i.e. whether neither
+         * their ctor nor their 'create' touch any shared state, the graphics
+         * context or parameter values.
+         *
+         * This default implementation returns 'false'.
+         *
+         * @return 'true' if the module can be created on any thread.
+         */
+        virtual bool IsCreateThreadSafe(void) const;
+
         /**
          * Answers whether this description is describing the class of
          * 'module'.
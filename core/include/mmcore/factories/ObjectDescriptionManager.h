@@ -14,6 +14,10 @@
 #include <vector>
 #include <memory>
 #include <algorithm>
+#include <cctype>
+#include <functional>
+#include <string>
+#include <unordered_map>
 #include "vislib/AlreadyExistsException.h"
 #include "vislib/IllegalParamException.h"
 #include "vislib/macro_utils.h"
@@ -27,6 +31,9 @@ namespace factories {
     /**
      * Singelton class template for managing object descriptions.
      * Template parameter T is a class derived from 'ObjectDescription'.
+     *
+     * Descriptions are indexed by their lower-case class name, so Find is a
+     * hash lookup instead of a scan over all registered descriptions.
      */
     template<class T> class ObjectDescriptionManager {
     public:
@@ -36,6 +43,7 @@ namespace factories {
         typedef ::std::vector<description_ptr_type> description_list_type;
         typedef typename description_list_type::iterator description_iterator_type;
         typedef typename description_list_type::const_iterator description_const_iterator_type;
+        typedef ::std::function<void(const char *)> miss_handler_type;
 
         /** ctor */
         ObjectDescriptionManager(void);
@@ -45,6 +53,9 @@ namespace factories {
 
         /**
          * Searches for an object description object with the given name.
+         * If the name is not registered and a miss handler is set, the
+         * handler is given the chance to register it before the search is
+         * repeated once.
          *
          * @param classname The class name to search for.
          *
@@ -53,6 +64,15 @@ namespace factories {
          */
         virtual description_ptr_type Find(const char *classname) const;
 
+        /**
+         * Sets the function called by Find for class names that are not
+         * registered. The handler may register the missing description, e.g.
+         * by loading the plugin providing it. It is not called recursively.
+         *
+         * @param handler The handler or an empty function to remove it.
+         */
+        void SetMissHandler(miss_handler_type handler);
+
         /**
          * Gets an iterator over the registered descriptions.
          *
@@ -124,10 +144,42 @@ namespace factories {
         /* deleted assigmnet operator */
         ObjectDescriptionManager& operator=(const ObjectDescriptionManager& rhs) = delete;
 
+        /**
+         * Answer the key of 'classname' in the index.
+         *
+         * @param classname The class name.
+         *
+         * @return The lower-case class name.
+         */
+        static ::std::string indexKey(const char *classname);
+
+        /**
+         * Searches the registered descriptions only.
+         *
+         * @param classname The class name to search for.
+         *
+         * @return The found object description object or NULL.
+         */
+        description_ptr_type findRegistered(const char *classname) const;
+
+        /** Rebuilds the index after descriptions have been removed. */
+        void rebuildIndex(void);
+
         /** The registered object descriptions */
         VISLIB_MSVC_SUPPRESS_WARNING(4251)
         description_list_type descriptions;
 
+        /** The position in 'descriptions' for each lower-case class name */
+        VISLIB_MSVC_SUPPRESS_WARNING(4251)
+        ::std::unordered_map<::std::string, size_t> index;
+
+        /** The function called for unknown class names */
+        VISLIB_MSVC_SUPPRESS_WARNING(4251)
+        miss_handler_type missHandler;
+
+        /** Whether the miss handler is currently running */
+        mutable bool inMissHandler;
+
     };
 
 
@@ -136,7 +188,7 @@ namespace factories {
      */
     template<class T>
     ObjectDescriptionManager<T>::ObjectDescriptionManager(void)
-            : descriptions() {
+            : descriptions(), index(), missHandler(), inMissHandler(false) {
         // intentionally empty
     }
 
@@ -147,23 +199,38 @@ namespace factories {
     template<class T>
     ObjectDescriptionManager<T>::~ObjectDescriptionManager(void) {
         this->descriptions.clear();
+        this->index.clear();
     }
 
 
     /*
-     * ObjectDescriptionManager<T>::Register
+     * ObjectDescriptionManager<T>::Find
      */
     template<class T> 
     typename ObjectDescriptionManager<T>::description_ptr_type
     ObjectDescriptionManager<T>::Find(const char *classname) const {
-        vislib::StringA nameA(classname);
-        auto d_end = this->descriptions.cend();
-        for (auto d_i = this->descriptions.cbegin(); d_i != d_end; ++d_i) {
-            if (nameA.Equals((*d_i)->ClassName(), false)) {
-                return *d_i;
+        description_ptr_type d = this->findRegistered(classname);
+        if (!d && this->missHandler && !this->inMissHandler && (classname != nullptr)) {
+            this->inMissHandler = true;
+            try {
+                this->missHandler(classname);
+            } catch (...) {
+                this->inMissHandler = false;
+                throw;
             }
+            this->inMissHandler = false;
+            d = this->findRegistered(classname);
         }
-        return nullptr;
+        return d;
+    }
+
+
+    /*
+     * ObjectDescriptionManager<T>::SetMissHandler
+     */
+    template<class T>
+    void ObjectDescriptionManager<T>::SetMissHandler(miss_handler_type handler) {
+        this->missHandler = handler;
     }
 
 
@@ -213,9 +280,11 @@ namespace factories {
     template<class T>
     void ObjectDescriptionManager<T>::Register(description_ptr_type objDesc) {
         if (!objDesc) throw vislib::IllegalParamException("objDesc", __FILE__, __LINE__);
-        if (this->Find(objDesc->ClassName()) != nullptr) {
+        const ::std::string key = indexKey(objDesc->ClassName());
+        if (this->index.find(key) != this->index.end()) {
             throw vislib::AlreadyExistsException("objDesc", __FILE__, __LINE__);
         }
+        this->index[key] = this->descriptions.size();
         this->descriptions.push_back(objDesc);
     }
 
@@ -232,6 +301,7 @@ namespace factories {
                 return nameA.Equals(d->ClassName(), false);
             }),
             this->descriptions.end());
+        this->rebuildIndex();
     }
 
 
@@ -249,7 +319,45 @@ namespace factories {
      */
     template<class T>
     void ObjectDescriptionManager<T>::Shutdown(void) {
+        this->missHandler = nullptr;
         this->descriptions.clear();
+        this->index.clear();
+    }
+
+
+    /*
+     * ObjectDescriptionManager<T>::indexKey
+     */
+    template<class T>
+    ::std::string ObjectDescriptionManager<T>::indexKey(const char *classname) {
+        ::std::string key((classname != nullptr) ? classname : "");
+        for (char& c : key) {
+            c = static_cast<char>(::std::tolower(static_cast<unsigned char>(c)));
+        }
+        return key;
+    }
+
+
+    /*
+     * ObjectDescriptionManager<T>::findRegistered
+     */
+    template<class T>
+    typename ObjectDescriptionManager<T>::description_ptr_type
+    ObjectDescriptionManager<T>::findRegistered(const char *classname) const {
+        auto i = this->index.find(indexKey(classname));
+        return (i != this->index.end()) ? this->descriptions[i->second] : nullptr;
+    }
+
+
+    /*
+     * ObjectDescriptionManager<T>::rebuildIndex
+     */
+    template<class T>
+    void ObjectDescriptionManager<T>::rebuildIndex(void) {
+        this->index.clear();
+        for (size_t i = 0; i < this->descriptions.size(); ++i) {
+            this->index[indexKey(this->descriptions[i]->ClassName())] = i;
+        }
     }
 
 
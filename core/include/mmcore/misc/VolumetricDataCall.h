@@ -118,6 +118,17 @@ namespace misc {
             return this->FrameCount();
         }
 
+        /**
+         * Gets the number of levels of the resolution pyramid that the data
+         * source can deliver. Level 0 is the full resolution, every further
+         * level halves the resolution in each dimension.
+         *
+         * @return The number of available levels, which is at least 1.
+         */
+        inline unsigned int GetAvailableLevels(void) const {
+            return this->availableLevels;
+        }
+
         /**
          * Gets the number of components per grid point.
          *
@@ -165,6 +176,29 @@ namespace misc {
 			}
 		}
 
+        /**
+         * Gets the level of the resolution pyramid the data returned by the
+         * last call to GetData are from.
+         *
+         * @return The level of the data.
+         */
+        inline unsigned int GetDataLevel(void) const {
+            return this->dataLevel;
+        }
+
+        /**
+         * Gets the position of the first returned voxel in the grid of
+         * GetDataLevel(). This is zero unless the data source honoured a
+         * request for a region of interest.
+         *
+         * @param axis The axis to retrieve the offset for.
+         *
+         * @return The offset of the data in voxels.
+         *
+         * @throws vislib::OutOfRangeException If 'axis' is not within [0, 3[.
+         */
+        size_t GetDataOffset(const int axis) const;
+
         /**
          * Gets the total number of frames in the data set.
          *
@@ -197,6 +231,35 @@ namespace misc {
             return this->metadata;
         }
 
+        /**
+         * Gets the level of the resolution pyramid requested by the caller.
+         *
+         * @return The requested level, 0 being the full resolution.
+         */
+        inline unsigned int GetRequestedLevel(void) const {
+            return this->requestedLevel;
+        }
+
+        /**
+         * Gets the first voxel of the requested region of interest in full
+         * resolution voxel coordinates.
+         *
+         * @return Pointer to the three coordinates of the first voxel.
+         */
+        inline const size_t *GetRequestedRegionMin(void) const {
+            return this->requestedRegion;
+        }
+
+        /**
+         * Gets the end (exclusive) of the requested region of interest in
+         * full resolution voxel coordinates.
+         *
+         * @return Pointer to the three coordinates behind the last voxel.
+         */
+        inline const size_t *GetRequestedRegionMax(void) const {
+            return this->requestedRegion + 3;
+        }
+
         /**
          * Gets the resolution in the specified dimension.
          *
@@ -254,6 +317,71 @@ namespace misc {
         const float GetAbsoluteVoxelValue(
             const uint32_t x, const uint32_t y, const uint32_t z, const uint32_t c = 0) const;
 
+        /**
+         * Converts the slices [firstSlice, firstSlice + cntSlices[ of
+         * channel c into a dense array of floats.
+         *
+         * The scalar type is only resolved once for the whole slab, which
+         * makes this considerably faster than converting voxel by voxel.
+         *
+         * @param firstSlice The first z-slice to be converted.
+         * @param cntSlices  The number of z-slices to be converted.
+         * @param dst        Receives Resolution[0] * Resolution[1] *
+         *                   cntSlices values.
+         * @param c          The channel to be converted.
+         * @param relative   If true, the values are mapped from
+         *                   [min, max] to [0, 1].
+         *
+         * @return true on success, false if the data cannot be converted.
+         */
+        bool ConvertSlab(const size_t firstSlice, const size_t cntSlices, float *dst,
+            const uint32_t c = 0, const bool relative = false) const;
+
+        /**
+         * Gathers the values of channel c at the given linear voxel
+         * indices, ie (z * Resolution[1] + y) * Resolution[0] + x.
+         *
+         * @param indices  The linear indices of the voxels.
+         * @param cnt      The number of voxels to be gathered.
+         * @param dst      Receives 'cnt' values.
+         * @param c        The channel to be read.
+         * @param relative If true, the values are mapped from [min, max]
+         *                 to [0, 1].
+         *
+         * @return true on success, false if the data cannot be read.
+         */
+        bool GatherVoxelValues(const uint64_t *indices, const size_t cnt, float *dst,
+            const uint32_t c = 0, const bool relative = false) const;
+
+        /**
+         * Samples channel c at a batch of positions using trilinear
+         * interpolation.
+         *
+         * The positions are given in voxel coordinates, ie voxel (x, y, z)
+         * is located at (x, y, z), and are clamped to the grid.
+         *
+         * @param positions 'cnt' consecutive (x, y, z) triples.
+         * @param cnt       The number of positions to be sampled.
+         * @param dst       Receives 'cnt' values.
+         * @param c         The channel to be sampled.
+         * @param relative  If true, the values are mapped from [min, max]
+         *                  to [0, 1].
+         *
+         * @return true on success, false if the data cannot be sampled.
+         */
+        bool SampleTrilinear(const float *positions, const size_t cnt, float *dst,
+            const uint32_t c = 0, const bool relative = false) const;
+
+        /**
+         * Answer whether the caller restricted the request to a region of
+         * interest.
+         *
+         * @return true if a region of interest was requested.
+         */
+        inline bool HasRequestedRegion(void) const {
+            return this->hasRequestedRegion;
+        }
+
         /**
          * Answer whether the given axis is uniform or has
          * this->GetResolution(axis) entries in the slice distance area.
@@ -264,6 +392,24 @@ namespace misc {
          */
         bool IsUniform(const int axis) const;
 
+        /**
+         * Clears a region of interest set via SetRequestedRegion, ie the
+         * whole grid is requested again.
+         */
+        inline void ResetRequestedRegion(void) {
+            this->hasRequestedRegion = false;
+        }
+
+        /**
+         * Sets the number of levels of the resolution pyramid the data
+         * source provides.
+         *
+         * @param levels The number of levels, which is at least 1.
+         */
+        inline void SetAvailableLevels(const unsigned int levels) {
+            this->availableLevels = (levels > 0) ? levels : 1;
+        }
+
         /**
          * Sets the data pointer.
          *
@@ -289,6 +435,40 @@ namespace misc {
 			this->vram_volume_name = texture_name;
 		}
 
+        /**
+         * Informs the caller about the part of the grid the data set via
+         * SetData are from. The metadata set by the data source must
+         * describe this part, ie its resolution, origin and slice distances.
+         *
+         * @param level  The level of the resolution pyramid.
+         * @param offset The position of the first voxel in the grid of
+         *               'level' or nullptr if the data start at the origin.
+         */
+        void SetDataRegion(const unsigned int level, const size_t *offset);
+
+        /**
+         * Requests the data to be delivered from the given level of the
+         * resolution pyramid. Data sources that do not provide a pyramid
+         * ignore the request and deliver the full resolution, which can be
+         * checked via GetDataLevel().
+         *
+         * @param level The requested level, 0 being the full resolution.
+         */
+        inline void SetRequestedLevel(const unsigned int level) {
+            this->requestedLevel = level;
+        }
+
+        /**
+         * Restricts the data request to the voxels in [min, max[, given in
+         * full resolution voxel coordinates. Data sources may deliver more
+         * than requested (eg whole bricks or the whole grid); the metadata
+         * after GetData and GetDataOffset() describe what was delivered.
+         *
+         * @param min The first voxel of the region.
+         * @param max The end (exclusive) of the region.
+         */
+        void SetRequestedRegion(const size_t *min, const size_t *max);
+
         /**
          * Update the metadata.
          *
@@ -314,6 +494,21 @@ namespace misc {
         /** The functions that are provided by the call. */
         static const char *FUNCTIONS[6];
 
+        /**
+         * Checks whether the data can be accessed in bulk and computes the
+         * mapping of the values of channel 'c'.
+         *
+         * @param caller   The name of the calling method for error messages.
+         * @param c        The channel to be accessed.
+         * @param relative Requests values relative to [min, max].
+         * @param outScale Receives the factor to be applied to the values.
+         * @param outBias  Receives the offset to be added to the values.
+         *
+         * @return true if the data can be accessed, false otherwise.
+         */
+        bool prepareBulkAccess(const char *caller, const uint32_t c,
+            const bool relative, float& outScale, float& outBias) const;
+
         /** The pointer to the raw data. The call does not own this memory! */
         void *data;
 
@@ -323,6 +518,24 @@ namespace misc {
         /** Pointer to the metadata descriptor of the data set. */
         const Metadata *metadata;
 
+        /** The number of levels of the resolution pyramid of the source. */
+        unsigned int availableLevels;
+
+        /** The level of the resolution pyramid the data are from. */
+        unsigned int dataLevel;
+
+        /** The offset of the data in the grid of 'dataLevel'. */
+        size_t dataOffset[3];
+
+        /** Answers whether 'requestedRegion' is valid. */
+        bool hasRequestedRegion;
+
+        /** The requested level of the resolution pyramid. */
+        unsigned int requestedLevel;
+
+        /** The requested region of interest as min and max (exclusive). */
+        size_t requestedRegion[6];
+
     };
 
     /** Call Descriptor.  */
@@ -0,0 +1,221 @@
+/*
+ * profiler/Tracer.h
+ *
+ * Copyright (C) 2020 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MEGAMOLCORE_PROFILER_TRACER_H_INCLUDED
+#define MEGAMOLCORE_PROFILER_TRACER_H_INCLUDED
+#pragma once
+
+#include "mmcore/api/MegaMolCore.std.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace megamol {
+namespace core {
+
+    /** forward declaration */
+    class Call;
+
+namespace profiler {
+
+    /**
+     * Records the nested invocations of all calls of the module graph as
+     * spans (caller slot, callee module, callback, frame, thread) for
+     * export as Chrome trace / Perfetto JSON and as a per-module summary.
+     *
+     * Every thread records into its own fixed-size buffer without locking;
+     * the tracer lock is only taken when a thread records its first span
+     * after a start, when a call is traced for the first time, and for
+     * starting and exporting. While tracing is stopped, a call only tests
+     * one atomic flag. Spans beyond the buffer capacity are dropped and
+     * counted.
+     */
+    class MEGAMOLCORE_API Tracer {
+    public:
+
+        /** The default number of spans per thread */
+        static const size_t DEFAULT_CAPACITY = 1 << 16;
+
+        /**
+         * Records the span of one call invocation from construction to
+         * destruction.
+         */
+        class MEGAMOLCORE_API Span {
+        public:
+
+            /**
+             * Begins the span.
+             *
+             * @param call     The invoked call.
+             * @param callback The index of the callback in the callee slot.
+             */
+            Span(const Call& call, unsigned int callback);
+
+            /** Ends the span */
+            ~Span(void);
+
+        private:
+
+            /** The invoked call */
+            const Call& call;
+
+            /** The index of the callback in the callee slot */
+            unsigned int callback;
+
+            /** The frame at the begin of the span */
+            unsigned int frame;
+
+            /** The begin of the span */
+            std::chrono::steady_clock::time_point start;
+
+        };
+
+        /**
+         * Answer the only instance of this class
+         *
+         * @return The only instance of this class
+         */
+        static Tracer& Instance(void);
+
+        /**
+         * Answer whether spans are recorded
+         *
+         * @return 'true' while tracing
+         */
+        static inline bool IsEnabled(void) {
+            return enabled.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * Advances the frame number stored with the spans. Called once per
+         * rendered frame.
+         */
+        static inline void NextFrame(void) {
+            frame.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * Discards all recorded spans and starts recording.
+         *
+         * @param capacity The number of spans per thread.
+         */
+        void Start(size_t capacity = DEFAULT_CAPACITY);
+
+        /**
+         * Stops recording. The recorded spans are kept for export.
+         */
+        void Stop(void);
+
+        /**
+         * Writes the recorded spans in the Chrome trace event format, which
+         * can be opened in chrome://tracing and Perfetto.
+         *
+         * @param path The output file.
+         *
+         * @return 'true' on success, 'false' if the file cannot be written.
+         */
+        bool WriteTrace(const std::string& path);
+
+        /**
+         * Answers the recorded time per callee module: number of spans,
+         * inclusive and exclusive (self) time, and longest span, sorted by
+         * self time.
+         *
+         * @return The summary as text table.
+         */
+        std::string Summary(void);
+
+    private:
+
+        /** The names of a traced call */
+        struct CallNames {
+            std::string caller;
+            std::string callee;
+            std::string callClass;
+            std::vector<std::string> callbacks;
+        };
+
+        /** One recorded span */
+        struct Event {
+            uint32_t call;
+            uint32_t callback;
+            uint32_t frame;
+            uint32_t depth;
+            int64_t start;
+            int64_t duration;
+            int64_t self;
+        };
+
+        /** The span buffer of one thread, only written by that thread */
+        struct ThreadBuffer {
+            std::unique_ptr<Event[]> events;
+            size_t capacity;
+            std::atomic<size_t> count;
+            std::atomic<size_t> dropped;
+            std::atomic<uint64_t> generation;
+            uint32_t id;
+            uint32_t depth;
+            int64_t childTime[64];
+        };
+
+        /** Hidden ctor */
+        Tracer(void);
+
+        /** Hidden dtor */
+        ~Tracer(void);
+
+        /**
+         * Answers the buffer of the calling thread for the current
+         * recording, registering or resetting it if necessary.
+         */
+        ThreadBuffer& threadBuffer(void);
+
+        /**
+         * Answers the id of the names of 'call', registering them on first
+         * use.
+         */
+        uint32_t callID(const Call& call);
+
+        /** Answers 'time' in microseconds since the time base */
+        int64_t micros(std::chrono::steady_clock::time_point time) const;
+
+        /** Whether spans are recorded */
+        static std::atomic<bool> enabled;
+
+        /** The current frame number */
+        static std::atomic<unsigned int> frame;
+
+        /** Guards the buffer list, the call names and the recording state */
+        std::mutex lock;
+
+        /** The buffers of all threads that ever recorded a span */
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+        /** The names of all traced calls, indexed by call id - 1 */
+        std::vector<CallNames> calls;
+
+        /** Counts the recordings, stale thread buffers are reset */
+        std::atomic<uint64_t> generation;
+
+        /** The number of spans per thread of the current recording */
+        size_t capacity;
+
+        /** The begin of the current recording in nanoseconds of the steady clock */
+        std::atomic<int64_t> timeBase;
+
+    };
+
+} /* end namespace profiler */
+} /* end namespace core */
+} /* end namespace megamol */
+
+#endif /* MEGAMOLCORE_PROFILER_TRACER_H_INCLUDED */
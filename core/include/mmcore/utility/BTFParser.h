@@ -14,6 +14,7 @@
 #include "mmcore/api/MegaMolCore.std.h"
 #include "mmcore/utility/xml/ConditionalParser.h"
 #include "mmcore/utility/xml/XmlReader.h"
+#include "vislib/Array.h"
 #include "vislib/Map.h"
 #include "vislib/SingleLinkedList.h"
 #include "vislib/SmartPtr.h"
@@ -428,6 +429,26 @@ namespace utility {
         void SetRootElement(const vislib::SmartPtr<BTFElement>& root,
             const vislib::SmartPtr<BTFElement>& masterroot);
 
+        /**
+         * Answer the root-namespace names of the btf files included while
+         * parsing.
+         *
+         * @return The included btf names.
+         */
+        inline const vislib::Array<vislib::StringA>& IncludedBTFs(void) const {
+            return this->includes;
+        }
+
+        /**
+         * Answer the paths of the files read for "file" snippets while
+         * parsing.
+         *
+         * @return The snippet file paths.
+         */
+        inline const vislib::Array<vislib::StringA>& SnippetFiles(void) const {
+            return this->snippetFiles;
+        }
+
     protected:
 
         /**
@@ -532,6 +553,12 @@ namespace utility {
 
         /** The stack of parsing elements */
         vislib::Stack<vislib::SmartPtr<BTFElement> > stack;
+
+        /** The included btf names */
+        vislib::Array<vislib::StringA> includes;
+
+        /** The files read for "file" snippets */
+        vislib::Array<vislib::StringA> snippetFiles;
 #ifdef _WIN32
 #pragma warning (default: 4251)
 #endif /* _WIN32 */
@@ -0,0 +1,188 @@
+/*
+ * CacheFile.h
+ *
+ * Copyright (C) 2020 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MEGAMOLCORE_CACHEFILE_H_INCLUDED
+#define MEGAMOLCORE_CACHEFILE_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include "mmcore/api/MegaMolCore.std.h"
+#include "vislib/String.h"
+#include "vislib/types.h"
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+namespace megamol {
+namespace core {
+namespace utility {
+
+    /**
+     * Utility class for the binary cache files of precomputed results.
+     *
+     * A cache file starts with an 8-byte magic number, a version and a key
+     * describing everything the content depends on, and it ends with a
+     * marker, so a file written only partially is never accepted. Values
+     * are stored in the native byte order, as cache files are not meant to
+     * be shared between machines.
+     */
+    class MEGAMOLCORE_API CacheFile {
+    public:
+
+        /** The length of the magic number */
+        static const SIZE_T MAGIC_LENGTH = 8;
+
+        /**
+         * Answer a key identifying the content of a file by its name, size
+         * and modification time.
+         *
+         * @param path The file.
+         *
+         * @return The key, or the name only if the file does not exist.
+         */
+        static std::string FileKey(const vislib::TString& path);
+
+        /**
+         * Answer the size and modification time of a file.
+         *
+         * @param path  The file.
+         * @param size  Receives the size in bytes.
+         * @param mtime Receives the modification time.
+         *
+         * @return 'true' on success, 'false' if the file does not exist.
+         */
+        static bool FileStamp(const vislib::StringW& path, UINT64& size, INT64& mtime);
+
+        /**
+         * Reads and checks the header of a cache file.
+         *
+         * @param in      The stream to read from.
+         * @param magic   The expected magic number.
+         * @param version The expected version.
+         * @param key     The expected key.
+         *
+         * @return 'true' if the header matches, 'false' otherwise.
+         */
+        static bool ReadHeader(std::istream& in, const char (&magic)[MAGIC_LENGTH], UINT32 version,
+            const std::string& key);
+
+        /**
+         * Writes the header of a cache file.
+         *
+         * @param out     The stream to write to.
+         * @param magic   The magic number.
+         * @param version The version.
+         * @param key     The key.
+         */
+        static void WriteHeader(std::ostream& out, const char (&magic)[MAGIC_LENGTH], UINT32 version,
+            const std::string& key);
+
+        /**
+         * Reads and checks the end marker of a cache file.
+         *
+         * @param in The stream to read from.
+         *
+         * @return 'true' if the marker is present, 'false' otherwise.
+         */
+        static bool ReadEnd(std::istream& in);
+
+        /**
+         * Writes the end marker of a cache file.
+         *
+         * @param out The stream to write to.
+         */
+        static void WriteEnd(std::ostream& out);
+
+        /**
+         * Reads a value.
+         *
+         * @param in The stream to read from.
+         * @param v  Receives the value.
+         *
+         * @return 'true' on success, 'false' otherwise.
+         */
+        template<class T> static inline bool Read(std::istream& in, T& v) {
+            return static_cast<bool>(in.read(reinterpret_cast<char*>(&v), sizeof(T)));
+        }
+
+        /**
+         * Writes a value.
+         *
+         * @param out The stream to write to.
+         * @param v   The value.
+         */
+        template<class T> static inline void Write(std::ostream& out, const T& v) {
+            out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+        }
+
+        /**
+         * Reads an array of values preceded by its length.
+         *
+         * @param in The stream to read from.
+         * @param v  Receives the values.
+         *
+         * @return 'true' on success, 'false' otherwise.
+         */
+        template<class T> static inline bool ReadArray(std::istream& in, std::vector<T>& v) {
+            UINT32 cnt;
+            if (!Read(in, cnt)) return false;
+            v.resize(cnt);
+            return (cnt == 0) || static_cast<bool>(in.read(reinterpret_cast<char*>(v.data()), cnt * sizeof(T)));
+        }
+
+        /**
+         * Writes an array of values preceded by its length.
+         *
+         * @param out The stream to write to.
+         * @param v   The values.
+         */
+        template<class T> static inline void WriteArray(std::ostream& out, const std::vector<T>& v) {
+            Write(out, static_cast<UINT32>(v.size()));
+            if (!v.empty()) out.write(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T));
+        }
+
+        /**
+         * Reads a string preceded by its length.
+         *
+         * @param in  The stream to read from.
+         * @param str Receives the string.
+         *
+         * @return 'true' on success, 'false' otherwise.
+         */
+        static bool ReadString(std::istream& in, std::string& str);
+
+        /**
+         * Writes a string preceded by its length.
+         *
+         * @param out The stream to write to.
+         * @param str The string.
+         */
+        static void WriteString(std::ostream& out, const std::string& str);
+
+    private:
+
+        /**
+         * Forbidden ctor
+         */
+        CacheFile(void);
+
+        /**
+         * Forbidden dtor
+         */
+        ~CacheFile(void);
+
+    };
+
+
+} /* end namespace utility */
+} /* end namespace core */
+} /* end namespace megamol */
+
+#endif /* MEGAMOLCORE_CACHEFILE_H_INCLUDED */
@@ -10,6 +10,8 @@
 //#include "CommandFunctionPtr.h"
 #include <map>
 #include <atomic>
+#include <future>
+#include <vector>
 
 namespace megamol {
 namespace core {
@@ -41,11 +43,26 @@ namespace utility {
 
     private:
 
+        /** Poll timeout in milliseconds, bounds the reaction time to disabling the service */
+        static const long pollTimeout;
+
         void serve();
-        void servePair();
+        void servePair(std::promise<int> port);
         std::string makeAnswer(const std::string& req);
         std::string makePairAnswer(const std::string& req) const;
-        std::atomic<int> lastPairPort;
+
+        /**
+         * Answers all requests of one (possibly multipart) message.
+         *
+         * A single-part message is one Lua script and is answered with one
+         * result part. A multipart message is a batch of
+         * (correlation id, script) pairs which is answered by a multipart
+         * message of (correlation id, result) pairs in the same order.
+         *
+         * @param socket The pair socket to answer on
+         * @param parts  The parts of the received message
+         */
+        void answerPairMessage(zmq::socket_t& socket, std::vector<zmq::message_t>& parts) const;
 
         //ModuleGraphAccess mgAccess;
         ZMQContextUser::ptr context;
@@ -17,12 +17,18 @@
 #include "vislib/Array.h"
 #include "vislib/graphics/gl/ShaderSource.h"
 #include "vislib/String.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
 
 
 namespace megamol {
 namespace core {
 namespace utility {
 
+    /* forward declaration */
+    class BTFCache;
+
 
     /**
      * Factory class for shader sources.
@@ -30,6 +36,10 @@ namespace utility {
      * Shaders and shader snippets are adressed by names with namespaces,
      * similar to slots in the view graph. The first namespace identifies the
      * btf file name and must not be omitted in the function calls.
+     *
+     * If the configuration value "BTFCacheDir" is set, parsed btf trees are
+     * stored there and reused as long as the btf and snippet files are
+     * unchanged.
      */
     class MEGAMOLCORE_API ShaderSourceFactory {
     public:
@@ -206,6 +216,21 @@ namespace utility {
         vislib::SmartPtr<vislib::graphics::gl::ShaderSource::Snippet>
         makeSnippet(BTFParser::BTFSnippet *s, UINT32 flags);
 
+        /**
+         * Loads the btf file 'filename' into 'fileroot', from the cache if
+         * possible.
+         *
+         * @param name     The root-namespace name of the btf.
+         * @param filename The btf file.
+         * @param fileroot The namespace receiving the btf elements, which
+         *                 already is a child of 'root'.
+         *
+         * @return 'true' on success, 'false' on failure (an error message
+         *         will be logged).
+         */
+        bool loadBTFTree(const vislib::StringA& name, const vislib::StringW& filename,
+            vislib::SmartPtr<BTFParser::BTFElement> fileroot);
+
         /** The configuration */
         Configuration& config;
 
@@ -217,10 +242,25 @@ namespace utility {
 #endif /* _WIN32 */
         /** The stable ordered list of fileIds */
         vislib::Array<vislib::StringA> fileIds;
+
+        /** The cache of parsed btf trees, created on first use */
+        std::unique_ptr<BTFCache> cache;
+
+        /** The elements already looked up by their full name */
+        std::unordered_map<std::string, vislib::SmartPtr<BTFParser::BTFElement> > elements;
 #ifdef _WIN32
 #pragma warning (default: 4251)
 #endif /* _WIN32 */
 
+        /** The time spent in nested LoadBTF calls of the current one */
+        double nestedMillis;
+
+        /** The number of btf files read from the cache */
+        unsigned int cacheHits;
+
+        /** The parsing time saved by the cache in milliseconds */
+        double savedMillis;
+
     };
 
 } /* end namespace utility */
@@ -26,13 +26,18 @@ int main(int argc, char* argv[]) {
     int hammerFactor = 1;
     bool keepOpen = false;
     bool singleSend = false;
+    int benchIterations = 0;
+    int benchBatch = 16;
 
     cxxopts::Options options("remoteconsole.exe", "MegaMol Remote Lua Console Client");
     options.add_options()("open", "open host", cxxopts::value<std::string>())(
         "source", "source file", cxxopts::value<std::string>())(
         "exec", "execute script", cxxopts::value<std::string>())("keep-open", "keep open")(
         "hammer", "multi-connect, works only with exec or source. replaces %%i%% with index", cxxopts::value<int>())(
-            "single", "send whole file or script in one go")("help", "print help");
+            "single", "send whole file or script in one go")(
+        "bench", "measure latency of exec script over n round trips and pipelined batches", cxxopts::value<int>())(
+        "batch", "number of requests per pipelined batch for bench (default 16)", cxxopts::value<int>())(
+        "help", "print help");
 
     try {
 
@@ -53,6 +58,8 @@ int main(int argc, char* argv[]) {
         if (parseRes.count("keep-open")) keepOpen = parseRes["keep-open"].as<bool>();
         if (parseRes.count("hammer")) hammerFactor = parseRes["hammer"].as<int>();
         if (parseRes.count("single")) singleSend = parseRes["single"].as<bool>();
+        if (parseRes.count("bench")) benchIterations = parseRes["bench"].as<int>();
+        if (parseRes.count("batch")) benchBatch = parseRes["batch"].as<int>();
         
         if (!parseRes.count("exec") && !parseRes.count("source")) {
             hammerFactor = 1;
@@ -105,7 +112,10 @@ int main(int argc, char* argv[]) {
         }
 
 
-        if (!file.empty()) {
+        if (benchIterations > 0) {
+            benchmarkLatency(connections[0], script.empty() ? std::string("return 0") : script, benchIterations,
+                benchBatch);
+        } else if (!file.empty()) {
             for (int i = 0; i < hammerFactor; ++i) {
                 runScript(connections[i], file, singleSend, i);
             }
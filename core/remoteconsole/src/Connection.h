@@ -36,19 +36,43 @@ public:
         //std::cout << "sent " << sent << "bytes";
         zmq::message_t reply;
 
-        size_t counter = 0;
-        bool have_something = false;
-        while (!(have_something = socket.recv(&reply, ZMQ_DONTWAIT)) && counter < 100) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            ++counter;
-        }
-        if (have_something) {
+        if (waitForReply() && socket.recv(&reply, ZMQ_DONTWAIT)) {
             return std::string(reinterpret_cast<char*>(reply.data()), reply.size());
         } else {
             return "reply timeout, probably MegaMol was closed. Please reconnect.";
         }
     }
 
+    /**
+     * Sends a batch of commands as one multipart message of
+     * (correlation id, command) pairs without waiting for the answer.
+     */
+    void sendBatch(const std::vector<std::pair<std::string, std::string>>& cmds) {
+        for (size_t i = 0; i < cmds.size(); ++i) {
+            const bool last = (i + 1 == cmds.size());
+            socket.send(cmds[i].first.data(), cmds[i].first.length(), ZMQ_SNDMORE);
+            socket.send(cmds[i].second.data(), cmds[i].second.length(), last ? 0 : ZMQ_SNDMORE);
+        }
+    }
+
+    /**
+     * Receives the answer to one batch sent by sendBatch as
+     * (correlation id, result) pairs. Returns false on timeout.
+     */
+    bool receiveBatch(std::vector<std::pair<std::string, std::string>>& results) {
+        results.clear();
+        if (!waitForReply()) return false;
+        zmq::message_t id, reply;
+        do {
+            if (!socket.recv(&id)) return false;
+            if (!id.more()) return false; // not a batch answer
+            if (!socket.recv(&reply)) return false;
+            results.emplace_back(std::string(reinterpret_cast<char*>(id.data()), id.size()),
+                std::string(reinterpret_cast<char*>(reply.data()), reply.size()));
+        } while (reply.more());
+        return true;
+    }
+
     inline bool Connect(const std::string &host) {
         if (!activeHost.empty()) return false;
         //socket.setsockopt(ZMQ_SNDHWM, 0);
@@ -62,6 +86,13 @@ public:
     }
 
 private:
+    /** Blocks until an answer is available, for at most one second */
+    bool waitForReply() {
+        zmq::pollitem_t items[] = {{static_cast<void*>(socket), 0, ZMQ_POLLIN, 0}};
+        zmq::poll(items, 1, 1000);
+        return (items[0].revents & ZMQ_POLLIN) != 0;
+    }
+
     zmq::socket_t& socket;
     std::string activeHost;
 };
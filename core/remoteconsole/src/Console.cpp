@@ -5,6 +5,8 @@
 #include <fstream>
 #include <sstream>
 #include <thread>
+#include <algorithm>
+#include <chrono>
 
 void printGreeting() {
     std::cout << std::endl
@@ -150,3 +152,66 @@ void interactiveConsole(Connection &conn) {
 
 
 }
+
+
+void benchmarkLatency(Connection& conn, const std::string& command, const int iterations, const int batchSize) {
+    using std::cout;
+    using std::endl;
+    using clock = std::chrono::high_resolution_clock;
+    using ms = std::chrono::duration<double, std::milli>;
+
+    if (!conn.Connected()) {
+        cout << "Socket not connected" << endl
+            << endl;
+        return;
+    }
+    if (iterations <= 0) return;
+
+    cout << "Benchmarking " << iterations << " x \"" << command << "\"" << endl;
+
+    // one request at a time, waiting for every answer
+    std::vector<double> latencies;
+    latencies.reserve(iterations);
+    const auto seqStart = clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        const auto start = clock::now();
+        conn.sendCommand(command);
+        latencies.push_back(ms(clock::now() - start).count());
+    }
+    const double seqTotal = ms(clock::now() - seqStart).count();
+    std::sort(latencies.begin(), latencies.end());
+    cout << "Sequential: total " << seqTotal << " ms, " << (iterations * 1000.0 / seqTotal) << " req/s" << endl
+        << "\tlatency min " << latencies.front() << " ms, median " << latencies[latencies.size() / 2]
+        << " ms, p99 " << latencies[(latencies.size() * 99) / 100] << " ms, max " << latencies.back() << " ms"
+        << endl;
+
+    // pipelined batches, all sent before the first answer is read
+    const int batch = std::max(1, batchSize);
+    const int numBatches = (iterations + batch - 1) / batch;
+    std::vector<std::pair<std::string, std::string>> cmds, results;
+    int sent = 0, answered = 0, mismatched = 0;
+    const auto pipeStart = clock::now();
+    for (int b = 0; b < numBatches; ++b) {
+        cmds.clear();
+        for (int i = 0; i < batch && sent < iterations; ++i, ++sent) {
+            cmds.emplace_back(std::to_string(sent), command);
+        }
+        conn.sendBatch(cmds);
+    }
+    for (int b = 0; b < numBatches; ++b) {
+        if (!conn.receiveBatch(results)) {
+            cout << "reply timeout, probably MegaMol was closed. Please reconnect." << endl;
+            break;
+        }
+        for (auto& r : results) {
+            if (r.first != std::to_string(answered)) ++mismatched;
+            ++answered;
+        }
+    }
+    const double pipeTotal = ms(clock::now() - pipeStart).count();
+    cout << "Pipelined (batch size " << batch << "): total " << pipeTotal << " ms, "
+        << (answered * 1000.0 / pipeTotal) << " req/s, " << answered << "/" << iterations << " answered";
+    if (mismatched > 0) cout << ", " << mismatched << " out of order";
+    cout << endl
+        << endl;
+}
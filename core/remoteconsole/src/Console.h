@@ -6,3 +6,4 @@ void printHelp();
 bool execCommand(Connection& conn, const std::string& command, int index = -1);
 void runScript(Connection& conn, const std::string& scriptfile, const bool singleSend = false, int index = -1);
 void interactiveConsole(Connection &conn);
+void benchmarkLatency(Connection& conn, const std::string& command, int iterations, int batchSize);
@@ -8,8 +8,10 @@
 #include "stdafx.h"
 #include "mmcore/RigRendering.h"
 #include "mmcore/Call.h"
+#include "mmcore/CallScheduler.h"
 #include "mmcore/CalleeSlot.h"
 #include "mmcore/CallerSlot.h"
+#include "mmcore/profiler/Tracer.h"
 #ifdef RIG_RENDERCALLS_WITH_DEBUGGROUPS
 #    include "mmcore/view/Renderer2DModule.h"
 #    include "mmcore/view/Renderer3DModule.h"
@@ -19,10 +21,28 @@
 
 using namespace megamol::core;
 
+
+namespace {
+
+    /** Marks the callee module of a call as executing on this thread while in scope */
+    class ModuleGuard {
+    public:
+        ModuleGuard(const void *module) : module(module) {
+            CallScheduler::Instance().Enter(this->module);
+        }
+        ~ModuleGuard(void) {
+            CallScheduler::Instance().Leave(this->module);
+        }
+    private:
+        const void *module;
+    };
+
+}
+
 /*
  * Call::Call
  */
-Call::Call(void) : callee(nullptr), caller(nullptr), className(nullptr), funcMap(nullptr) {
+Call::Call(void) : callee(nullptr), caller(nullptr), className(nullptr), funcMap(nullptr), traceID() {
     // intentionally empty
 }
 
@@ -50,6 +70,8 @@ Call::~Call(void) {
 bool Call::operator()(unsigned int func) {
     bool res = false;
     if (this->callee != nullptr) {
+        // wait while the callee runs on another thread, e.g. an asynchronous invocation
+        ModuleGuard guard(this->callee->Owner());
 #ifdef RIG_RENDERCALLS_WITH_DEBUGGROUPS
         auto f = this->callee->GetCallbackFuncName(func);
         auto p3 = dynamic_cast<core::view::Renderer3DModule*>(callee->Parent().get());
@@ -69,7 +91,12 @@ bool Call::operator()(unsigned int func) {
             // vislib::sys::Log::DefaultLog.WriteInfo("called %s::%s", p2->ClassName(), f);
         }
 #endif
-        res = this->callee->InCall(this->funcMap[func], *this);
+        if (profiler::Tracer::IsEnabled()) {
+            profiler::Tracer::Span span(*this, this->funcMap[func]);
+            res = this->callee->InCall(this->funcMap[func], *this);
+        } else {
+            res = this->callee->InCall(this->funcMap[func], *this);
+        }
 #ifdef RIG_RENDERCALLS_WITH_DEBUGGROUPS
         if (p2 || p3) glPopDebugGroup();
 #endif
@@ -78,3 +105,11 @@ bool Call::operator()(unsigned int func) {
     //    res ? "true" : "false", this->callee == nullptr ? "no callee" : "from callee");
     return res;
 }
+
+
+/*
+ * Call::InvokeAsync
+ */
+std::future<bool> Call::InvokeAsync(unsigned int func) {
+    return CallScheduler::Instance().Submit(*this, func);
+}
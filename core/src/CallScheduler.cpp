@@ -0,0 +1,193 @@
+/*
+ * CallScheduler.cpp
+ *
+ * Copyright (C) 2020 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#include "stdafx.h"
+#include "mmcore/CallScheduler.h"
+#include "mmcore/Call.h"
+#include "mmcore/CalleeSlot.h"
+#include "vislib/sys/Log.h"
+#include <algorithm>
+
+using namespace megamol::core;
+
+
+namespace {
+
+    /** Whether the calling thread is a worker of the scheduler */
+    thread_local bool isWorker = false;
+
+}
+
+
+/*
+ * CallScheduler::Instance
+ */
+CallScheduler& CallScheduler::Instance(void) {
+    static CallScheduler scheduler;
+    return scheduler;
+}
+
+
+/*
+ * CallScheduler::SetThreadCount
+ */
+void CallScheduler::SetThreadCount(unsigned int count) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    if (!this->workers.empty()) {
+        vislib::sys::Log::DefaultLog.WriteWarn("Call scheduler already running with %u threads",
+            static_cast<unsigned int>(this->workers.size()));
+        return;
+    }
+    this->threadCount = (std::max)(1u, count);
+}
+
+
+/*
+ * CallScheduler::Submit
+ */
+std::future<bool> CallScheduler::Submit(Call& call, unsigned int func) {
+    auto runNow = [&call, func]() {
+        std::promise<bool> result;
+        try {
+            result.set_value(call(func));
+        } catch (...) {
+            result.set_exception(std::current_exception());
+        }
+        return result.get_future();
+    };
+    if (isWorker) return runNow();
+
+    const void *module = (call.PeekCalleeSlot() != nullptr) ? call.PeekCalleeSlot()->Owner() : nullptr;
+    std::unique_lock<std::mutex> guard(this->lock);
+    if (this->stop) {
+        // shutting down, the workers may already be gone
+        guard.unlock();
+        return runNow();
+    }
+    if (this->workers.empty()) {
+        for (unsigned int i = 0; i < this->threadCount; ++i) {
+            this->workers.emplace_back(&CallScheduler::work, this);
+        }
+        vislib::sys::Log::DefaultLog.WriteInfo("Call scheduler started %u threads", this->threadCount);
+    }
+    this->queue.emplace_back();
+    Task& task = this->queue.back();
+    task.call = &call;
+    task.func = func;
+    task.module = module;
+    std::future<bool> result = task.result.get_future();
+    this->wake.notify_all();
+    return result;
+}
+
+
+/*
+ * CallScheduler::Enter
+ */
+void CallScheduler::Enter(const void *module) {
+    if (module == nullptr) return;
+    const std::thread::id self = std::this_thread::get_id();
+    std::unique_lock<std::mutex> guard(this->lock);
+    this->wake.wait(guard, [this, module, self]() {
+        auto owner = this->busy.find(module);
+        return (owner == this->busy.end()) || (owner->second.thread == self);
+    });
+    Owner& owner = this->busy[module];
+    owner.thread = self;
+    ++owner.depth;
+}
+
+
+/*
+ * CallScheduler::Leave
+ */
+void CallScheduler::Leave(const void *module) {
+    if (module == nullptr) return;
+    std::lock_guard<std::mutex> guard(this->lock);
+    auto owner = this->busy.find(module);
+    if ((owner != this->busy.end()) && (--owner->second.depth == 0)) {
+        this->busy.erase(owner);
+        this->wake.notify_all();
+    }
+}
+
+
+/*
+ * CallScheduler::Shutdown
+ */
+void CallScheduler::Shutdown(void) {
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+        if (this->workers.empty() || this->stop) return;
+        this->stop = true;
+    }
+    this->wake.notify_all();
+    // only the workers and Submit touch 'workers', and Submit does not while stopping
+    for (auto& w : this->workers) {
+        w.join();
+    }
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->workers.clear();
+    this->stop = false;
+}
+
+
+/*
+ * CallScheduler::CallScheduler
+ */
+CallScheduler::CallScheduler(void) : lock(), wake(), queue(), busy(), workers(), threadCount(1), stop(false) {
+    unsigned int hw = std::thread::hardware_concurrency();
+    this->threadCount = (hw > 1) ? hw - 1 : 1;
+}
+
+
+/*
+ * CallScheduler::~CallScheduler
+ */
+CallScheduler::~CallScheduler(void) {
+    // joining threads while the library is unloaded may deadlock, Shutdown must have been called before
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->stop = true;
+    this->wake.notify_all();
+    for (auto& w : this->workers) {
+        w.detach();
+    }
+}
+
+
+/*
+ * CallScheduler::work
+ */
+void CallScheduler::work(void) {
+    isWorker = true;
+    std::unique_lock<std::mutex> guard(this->lock);
+    while (true) {
+        // the oldest task of a module which is not busy, pending tasks are executed before stopping
+        auto task = this->queue.end();
+        this->wake.wait(guard, [this, &task]() {
+            task = std::find_if(this->queue.begin(), this->queue.end(),
+                [this](const Task& t) { return this->busy.count(t.module) == 0; });
+            return (this->stop && this->queue.empty()) || (task != this->queue.end());
+        });
+        if (task == this->queue.end()) return; // stop
+
+        // claim the module before unlocking, so no other thread can enter it in between
+        Task t = std::move(*task);
+        this->queue.erase(task);
+        if (t.module != nullptr) this->busy[t.module] = Owner{std::this_thread::get_id(), 1};
+        guard.unlock();
+
+        try {
+            t.result.set_value((*t.call)(t.func));
+        } catch (...) {
+            t.result.set_exception(std::current_exception());
+        }
+
+        this->Leave(t.module);
+        guard.lock();
+    }
+}
@@ -21,6 +21,7 @@
 #include "mmcore/Call.h"
 #include "mmcore/CalleeSlot.h"
 #include "mmcore/CallerSlot.h"
+#include "mmcore/CallScheduler.h"
 #include "mmcore/CoreInstance.h"
 #include "mmcore/Module.h"
 #include "mmcore/cluster/ClusterController.h"
@@ -76,7 +77,10 @@
 #include "vislib/sys/Path.h"
 #include "vislib/sys/sysfunctions.h"
 
+#include <atomic>
+#include <chrono>
 #include <sstream>
+#include <thread>
 
 #include "mmcore/utility/LuaHostService.h"
 
@@ -149,6 +153,8 @@ megamol::core::CoreInstance::CoreInstance(void)
     , timeOffset(0.0)
     , paramUpdateListeners()
     , plugins(nullptr)
+    , deferredPlugins()
+    , pluginManifest()
     , all_call_descriptions()
     , all_module_descriptions()
     , parameterHash(1) {
@@ -241,6 +247,9 @@ megamol::core::CoreInstance::~CoreInstance(void) {
     delete this->services;
     this->services = nullptr;
 
+    // the call workers run code of the modules' plugins, so they have to stop before those are unloaded
+    CallScheduler::Instance().Shutdown();
+
     // we need to manually clean up all data structures in the right order!
     // first view- and job-descriptions
     this->builtinViewDescs.Shutdown();
@@ -378,10 +387,7 @@ void megamol::core::CoreInstance::Initialise(void) {
     // printf("\tEcho-Target: %d\n", (long)(vislib::sys::Log::DefaultLog.GetEchoOutTarget()));
     vislib::SingleLinkedList<vislib::TString> plugins_paths;
     this->config.ListPluginsToLoad(plugins_paths);
-    vislib::SingleLinkedList<vislib::TString>::Iterator iter = plugins_paths.GetIterator();
-    while (iter.HasNext()) {
-        this->loadPlugin(iter.Next());
-    }
+    this->loadPlugins(plugins_paths);
     // printf("Log: %d:\n", (long)(&vislib::sys::Log::DefaultLog));
     // printf("\tAutoflush: %s\n", vislib::sys::Log::DefaultLog.IsAutoFlushEnabled() ? "enabled" : "disabled");
     // printf("\tLevel: %u\n", vislib::sys::Log::DefaultLog.GetLevel());
@@ -414,6 +420,24 @@ void megamol::core::CoreInstance::Initialise(void) {
         profiler::Manager::Instance().SetMode(profiler::Manager::PROFILE_NONE);
     }
 
+    // set up the worker pool of asynchronous call invocations
+    if (this->config.IsConfigValueSet("CallWorkerThreads")) {
+        try {
+            // parsed as signed, so a negative value is not wrapped into billions of threads
+            const int maxCount = 256;
+            const int count =
+                vislib::CharTraitsW::ParseInt(this->config.ConfigValue("CallWorkerThreads").PeekBuffer());
+            if ((count < 1) || (count > maxCount)) {
+                vislib::sys::Log::DefaultLog.WriteWarn(
+                    "Configuration value \"CallWorkerThreads\" (%d) clamped to [1, %d]", count, maxCount);
+            }
+            CallScheduler::Instance().SetThreadCount(
+                static_cast<unsigned int>((std::max)(1, (std::min)(count, maxCount))));
+        } catch (...) {
+            vislib::sys::Log::DefaultLog.WriteWarn("Unable to parse configuration value \"CallWorkerThreads\"");
+        }
+    }
+
 
     //////////////////////////////////////////////////////////////////////
     // register builtin descriptions
@@ -1123,7 +1147,8 @@ void megamol::core::CoreInstance::PerformGraphUpdates() {
 
     this->shortenFlushIdxList(this->pendingModuleInstRequests.Count(), this->moduleInstRequestsFlushIndices);
 
-    // make modules
+    // collect modules
+    std::vector<core::InstanceDescription::ModuleInstanceRequest> moduleBatch;
     while (this->pendingModuleInstRequests.Count() > 0) {
         // flush mechanism
         if (this->checkForFlushEvent(counter, this->moduleInstRequestsFlushIndices)) {
@@ -1131,23 +1156,18 @@ void megamol::core::CoreInstance::PerformGraphUpdates() {
             break;
         }
 
-        auto mir = this->pendingModuleInstRequests.First();
+        moduleBatch.push_back(this->pendingModuleInstRequests.First());
         this->pendingModuleInstRequests.RemoveFirst();
 
         ++counter;
-
-        if (this->instantiateModule(mir.First(), mir.Second()) == nullptr) {
-            vislib::sys::Log::DefaultLog.WriteError("cannot instantiate module \"%s\""
-                                                    " of class \"%s\".",
-                mir.First().PeekBuffer(), mir.Second()->ClassName());
-        }
     }
 
     counter = 0;
 
     this->shortenFlushIdxList(this->pendingCallInstRequests.Count(), this->callInstRequestsFlushIndices);
 
-    // make calls
+    // collect calls
+    std::vector<core::InstanceDescription::CallInstanceRequest> callBatch;
     while (this->pendingCallInstRequests.Count() > 0) {
         // flush mechanism
         if (this->checkForFlushEvent(counter, this->callInstRequestsFlushIndices)) {
@@ -1155,15 +1175,29 @@ void megamol::core::CoreInstance::PerformGraphUpdates() {
             break;
         }
 
-        auto cir = this->pendingCallInstRequests.First();
+        callBatch.push_back(this->pendingCallInstRequests.First());
         this->pendingCallInstRequests.RemoveFirst();
 
         ++counter;
+    }
 
-        if (this->InstantiateCall(cir.From(), cir.To(), cir.Description()) == nullptr) {
+    // make modules and calls
+    std::vector<Module::ptr_type> madeModules;
+    std::vector<Call*> madeCalls;
+    this->instantiateGraph(moduleBatch, callBatch, &madeModules, &madeCalls);
+    for (size_t i = 0; i < moduleBatch.size(); ++i) {
+        if ((madeModules[i] == nullptr) && (moduleBatch[i].Second() != nullptr)) {
+            vislib::sys::Log::DefaultLog.WriteError("cannot instantiate module \"%s\""
+                                                    " of class \"%s\".",
+                moduleBatch[i].First().PeekBuffer(), moduleBatch[i].Second()->ClassName());
+        }
+    }
+    for (size_t i = 0; i < callBatch.size(); ++i) {
+        if ((madeCalls[i] == nullptr) && (callBatch[i].Description() != nullptr)) {
             vislib::sys::Log::DefaultLog.WriteError("cannot instantiate \"%s\" call"
                                                     " from \"%s\" to \"%s\".",
-                cir.Description()->ClassName(), cir.From().PeekBuffer(), cir.To().PeekBuffer());
+                callBatch[i].Description()->ClassName(), callBatch[i].From().PeekBuffer(),
+                callBatch[i].To().PeekBuffer());
         }
     }
 
@@ -1484,6 +1518,7 @@ megamol::core::ViewInstance::ptr_type megamol::core::CoreInstance::InstantiatePe
     }
 
     // instantiate modules
+    std::vector<InstanceDescription::ModuleInstanceRequest> moduleBatch;
     for (unsigned int idx = 0; idx < request.Description()->ModuleCount(); idx++) {
         const ViewDescription::ModuleInstanceRequest& mir = request.Description()->Module(idx);
         factories::ModuleDescription::ptr desc = mir.Second();
@@ -1499,20 +1534,23 @@ megamol::core::ViewInstance::ptr_type megamol::core::CoreInstance::InstantiatePe
             continue;
         }
 
-        Module::ptr_type mod = this->instantiateModule(fullName, desc);
-        if (!mod) {
-            hasErrors = true;
-            continue;
+        moduleBatch.push_back(InstanceDescription::ModuleInstanceRequest(fullName, desc));
+    }
 
-        } else {
-            view::AbstractView* av = dynamic_cast<view::AbstractView*>(mod.get());
-            if (av != NULL) {
-                // view module instantiated.
-                if (fullName.Equals(viewFullPath)) {
-                    view = av;
-                } else if (fallbackView == NULL) {
-                    fallbackView = av;
-                }
+    std::vector<Module::ptr_type> madeModules;
+    std::vector<Call*> madeCalls;
+    if (!this->instantiateGraph(moduleBatch, std::vector<InstanceDescription::CallInstanceRequest>(), &madeModules,
+            &madeCalls)) {
+        hasErrors = true;
+    }
+    for (size_t idx = 0; idx < moduleBatch.size(); idx++) {
+        view::AbstractView* av = dynamic_cast<view::AbstractView*>(madeModules[idx].get());
+        if (av != NULL) {
+            // view module instantiated.
+            if (moduleBatch[idx].First().Equals(viewFullPath)) {
+                view = av;
+            } else if (fallbackView == NULL) {
+                fallbackView = av;
             }
         }
     }
@@ -1528,6 +1566,7 @@ megamol::core::ViewInstance::ptr_type megamol::core::CoreInstance::InstantiatePe
     }
 
     // instantiate calls
+    std::vector<InstanceDescription::CallInstanceRequest> callBatch;
     for (unsigned int idx = 0; idx < request.Description()->CallCount(); idx++) {
         const ViewDescription::CallInstanceRequest& cir = request.Description()->Call(idx);
         factories::CallDescription::ptr desc = cir.Description();
@@ -1544,12 +1583,20 @@ megamol::core::ViewInstance::ptr_type megamol::core::CoreInstance::InstantiatePe
             continue;
         }
 
-        Call* call = this->InstantiateCall(fromFullName, toFullName, desc);
-        if (call == NULL) {
-            hasErrors = true;
-        } else if (profiler::Manager::Instance().GetMode() != profiler::Manager::PROFILE_NONE) {
-            if (cir.DoProfiling() || (profiler::Manager::Instance().GetMode() == profiler::Manager::PROFILE_ALL))
-                profiler::Manager::Instance().Select(fromFullName);
+        callBatch.push_back(
+            InstanceDescription::CallInstanceRequest(fromFullName, toFullName, desc, cir.DoProfiling()));
+    }
+
+    if (!this->instantiateGraph(std::vector<InstanceDescription::ModuleInstanceRequest>(), callBatch, &madeModules,
+            &madeCalls)) {
+        hasErrors = true;
+    }
+    if (profiler::Manager::Instance().GetMode() != profiler::Manager::PROFILE_NONE) {
+        for (size_t idx = 0; idx < callBatch.size(); idx++) {
+            if ((madeCalls[idx] != NULL) && (callBatch[idx].DoProfiling() ||
+                    (profiler::Manager::Instance().GetMode() == profiler::Manager::PROFILE_ALL))) {
+                profiler::Manager::Instance().Select(callBatch[idx].From());
+            }
         }
     }
 
@@ -3215,6 +3262,17 @@ megamol::core::Call* megamol::core::CoreInstance::InstantiateCall(
         return NULL;
     }
 
+    return this->connectCall(fromSlot, toSlot, desc, fromPath, toPath);
+}
+
+
+/*
+ * megamol::core::CoreInstance::connectCall
+ */
+megamol::core::Call* megamol::core::CoreInstance::connectCall(CallerSlot* fromSlot, CalleeSlot* toSlot,
+    factories::CallDescription::ptr desc, const vislib::StringA& fromPath, const vislib::StringA& toPath) {
+    using vislib::sys::Log;
+
     if (!fromSlot->IsCallCompatible(desc)) {
         Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR,
             "Unable to instantiate call: source slot \"%s\" not compatible with call \"%s\"", fromPath.PeekBuffer(),
@@ -3278,6 +3336,351 @@ megamol::core::Call* megamol::core::CoreInstance::InstantiateCall(
 }
 
 
+/*
+ * megamol::core::CoreInstance::InstantiateGraph
+ */
+bool megamol::core::CoreInstance::InstantiateGraph(
+    const std::vector<InstanceDescription::ModuleInstanceRequest>& modules,
+    const std::vector<InstanceDescription::CallInstanceRequest>& calls) {
+    vislib::sys::AutoLock u(this->graphUpdateLock);
+    vislib::sys::AutoLock m(this->namespaceRoot->ModuleGraphLock());
+    return this->instantiateGraph(modules, calls, nullptr, nullptr);
+}
+
+
+namespace {
+
+/**
+ * Answer the canonical full name "::a::b" of 'path', or an empty string if
+ * it does not name anything below the root.
+ */
+std::string graphKey(const vislib::Array<vislib::StringA>& path) {
+    std::string key;
+    for (SIZE_T i = 0; i < path.Count(); ++i) {
+        key += "::";
+        key += path[i].PeekBuffer();
+    }
+    return key;
+}
+
+/**
+ * Adds all modules below 'container' to 'index', keyed by their full name.
+ */
+void indexModules(megamol::core::AbstractNamedObjectContainer& container, const std::string& prefix,
+    std::unordered_map<std::string, megamol::core::Module::ptr_type>& index) {
+    using namespace megamol::core;
+    const auto end = container.ChildList_End();
+    for (auto it = container.ChildList_Begin(); it != end; ++it) {
+        const std::string name = prefix + "::" + (*it)->Name().PeekBuffer();
+        Module::ptr_type mod = Module::dynamic_pointer_cast(*it);
+        if (mod) {
+            index[name] = mod;
+            continue;
+        }
+        AbstractNamedObjectContainer::ptr_type c = std::dynamic_pointer_cast<AbstractNamedObjectContainer>(*it);
+        if (c) {
+            indexModules(*c, name, index);
+        }
+    }
+}
+
+} /* end namespace */
+
+
+/*
+ * megamol::core::CoreInstance::instantiateGraph
+ */
+bool megamol::core::CoreInstance::instantiateGraph(
+    const std::vector<InstanceDescription::ModuleInstanceRequest>& modules,
+    const std::vector<InstanceDescription::CallInstanceRequest>& calls, std::vector<Module::ptr_type>* outModules,
+    std::vector<Call*>* outCalls) {
+    using vislib::sys::Log;
+    typedef std::chrono::high_resolution_clock clock_type;
+    auto millisSince = [](const clock_type::time_point& t) {
+        return std::chrono::duration<double, std::milli>(clock_type::now() - t).count();
+    };
+
+    /** A module to be created */
+    struct PendingModule {
+        size_t request;
+        vislib::Array<vislib::StringA> dirs;
+        vislib::StringA name;
+        std::string key;
+        ModuleNamespace::ptr_type ns;
+        Module::ptr_type mod;
+        bool created;
+    };
+
+    /** A call to be connected */
+    struct PendingCall {
+        size_t request;
+        std::string fromModule;
+        vislib::StringA fromSlot;
+        std::string toModule;
+        vislib::StringA toSlot;
+    };
+
+    const auto startTime = clock_type::now();
+    bool allOk = true;
+    if (outModules != nullptr) outModules->assign(modules.size(), Module::ptr_type(nullptr));
+    if (outCalls != nullptr) outCalls->assign(calls.size(), nullptr);
+
+    // validation: everything is checked before the graph is touched
+    std::unordered_map<std::string, Module::ptr_type> index;
+    indexModules(*this->namespaceRoot, "", index);
+
+    std::vector<PendingModule> pending;
+    pending.reserve(modules.size());
+    std::unordered_map<std::string, size_t> batch;
+    for (size_t i = 0; i < modules.size(); ++i) {
+        const vislib::StringA& path = modules[i].First();
+        factories::ModuleDescription::ptr desc = modules[i].Second();
+        if ((desc == nullptr) || !path.StartsWith("::")) {
+            Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR,
+                "Unable to make module \"%s\": invalid name or module class", path.PeekBuffer());
+            allOk = false;
+            continue;
+        }
+        if (!desc->IsAvailable()) {
+            Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR,
+                "Unable to make module \"%s\" (%s): Module type is installed but not available.", desc->ClassName(),
+                path.PeekBuffer());
+            allOk = false;
+            continue;
+        }
+
+        PendingModule pm;
+        pm.request = i;
+        pm.dirs = vislib::StringTokeniserA::Split(path, "::", true);
+        if (pm.dirs.IsEmpty()) {
+            Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Unable to make module \"%s\": empty name", path.PeekBuffer());
+            allOk = false;
+            continue;
+        }
+        pm.key = graphKey(pm.dirs);
+        pm.name = pm.dirs.Last();
+        pm.dirs.RemoveLast();
+        pm.created = false;
+
+        auto present = index.find(pm.key);
+        if (present != index.end()) {
+            if (desc->IsDescribing(present->second.get())) {
+                Log::DefaultLog.WriteMsg(
+                    Log::LEVEL_WARN, "Unable to make module \"%s\": module already present", path.PeekBuffer());
+                if (outModules != nullptr) (*outModules)[i] = present->second;
+            } else {
+                Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR,
+                    "Unable to make module \"%s\" (%s): name conflict with other namespace object.",
+                    desc->ClassName(), path.PeekBuffer());
+                allOk = false;
+            }
+            continue;
+        }
+        if (!batch.emplace(pm.key, pending.size()).second) {
+            Log::DefaultLog.WriteMsg(
+                Log::LEVEL_WARN, "Unable to make module \"%s\": requested more than once", path.PeekBuffer());
+            continue;
+        }
+        pending.push_back(pm);
+    }
+
+    std::vector<PendingCall> pendingCalls;
+    pendingCalls.reserve(calls.size());
+    for (size_t i = 0; i < calls.size(); ++i) {
+        const InstanceDescription::CallInstanceRequest& cir = calls[i];
+        vislib::Array<vislib::StringA> from = vislib::StringTokeniserA::Split(cir.From(), "::", true);
+        vislib::Array<vislib::StringA> to = vislib::StringTokeniserA::Split(cir.To(), "::", true);
+        if ((cir.Description() == nullptr) || (from.Count() < 2) || (to.Count() < 2)) {
+            Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR,
+                "Unable to instantiate call \"%s\"->\"%s\": invalid slot names or call class", cir.From().PeekBuffer(),
+                cir.To().PeekBuffer());
+            allOk = false;
+            continue;
+        }
+        PendingCall pc;
+        pc.request = i;
+        pc.fromSlot = from.Last();
+        from.RemoveLast();
+        pc.fromModule = graphKey(from);
+        pc.toSlot = to.Last();
+        to.RemoveLast();
+        pc.toModule = graphKey(to);
+
+        const bool hasFrom = (index.find(pc.fromModule) != index.end()) || (batch.find(pc.fromModule) != batch.end());
+        const bool hasTo = (index.find(pc.toModule) != index.end()) || (batch.find(pc.toModule) != batch.end());
+        if (!hasFrom || !hasTo) {
+            Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Unable to instantiate call: can not find %s module \"%s\"",
+                hasFrom ? "target" : "source", hasFrom ? cir.To().PeekBuffer() : cir.From().PeekBuffer());
+            allOk = false;
+            continue;
+        }
+        pendingCalls.push_back(pc);
+    }
+
+    // namespaces are created in request order, each path only looked up once
+    std::unordered_map<std::string, ModuleNamespace::ptr_type> namespaces;
+    for (PendingModule& pm : pending) {
+        std::string nsKey;
+        bool blocked = false;
+        for (SIZE_T d = 0; (d < pm.dirs.Count()) && !blocked; ++d) {
+            nsKey += "::";
+            nsKey += pm.dirs[d].PeekBuffer();
+            blocked = (batch.find(nsKey) != batch.end()) || (index.find(nsKey) != index.end());
+        }
+        auto known = namespaces.find(nsKey);
+        if (blocked) {
+            // a module of the batch or the graph has the name of a namespace
+            pm.ns.reset();
+        } else if (known != namespaces.end()) {
+            pm.ns = known->second;
+        } else {
+            pm.ns = ModuleNamespace::dynamic_pointer_cast(this->namespaceRoot->FindNamespace(pm.dirs, true));
+            namespaces[nsKey] = pm.ns;
+        }
+    }
+    const double validateMillis = millisSince(startTime);
+
+    // creation: all modules not declaring a thread-safe create are created on
+    // this thread in request order first; only then are the remaining ones
+    // distributed over the worker threads, so no module ever runs its create
+    // concurrently with one that has not opted in.
+    const auto createStart = clock_type::now();
+    auto create = [this, &modules](PendingModule& pm) {
+        if (!pm.ns) return;
+        pm.mod = Module::ptr_type(modules[pm.request].Second()->CreateModule(pm.name));
+        if (!pm.mod) return;
+        std::shared_ptr<RootModuleNamespace> tmpRoot = std::make_shared<RootModuleNamespace>();
+        tmpRoot->SetCoreInstance(*this);
+        tmpRoot->AddChild(pm.mod);
+        pm.created = pm.mod->Create();
+        tmpRoot->RemoveChild(pm.mod);
+    };
+
+    std::vector<size_t> concurrent, sequential;
+    for (size_t i = 0; i < pending.size(); ++i) {
+        if (modules[pending[i].request].Second()->IsCreateThreadSafe()) {
+            concurrent.push_back(i);
+        } else {
+            sequential.push_back(i);
+        }
+    }
+    // single-threaded unless configured otherwise, as module creation was
+    // never meant to run concurrently and each module must opt in
+    int threads = 1;
+    if (this->config.IsConfigValueSet("GraphCreateThreads")) {
+        try {
+            threads = vislib::CharTraitsW::ParseInt(this->config.ConfigValue("GraphCreateThreads").PeekBuffer());
+        } catch (...) {
+        }
+    }
+    if (threads <= 0) {
+        threads = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    threads = (std::max)(1, (std::min)(threads, static_cast<int>(concurrent.size())));
+
+    std::atomic<size_t> next(0);
+    auto createConcurrent = [&]() {
+        for (size_t i = next++; i < concurrent.size(); i = next++) {
+            create(pending[concurrent[i]]);
+        }
+    };
+    for (size_t i : sequential) {
+        create(pending[i]);
+    }
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; ++t) {
+        workers.emplace_back(createConcurrent);
+    }
+    createConcurrent();
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    // the created modules are added to the graph in request order
+    for (PendingModule& pm : pending) {
+        const char* className = modules[pm.request].Second()->ClassName();
+        const vislib::StringA& path = modules[pm.request].First();
+        if (!pm.ns) {
+            Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR,
+                "Unable to make module \"%s\" (%s): name conflict with other namespace object.", className,
+                path.PeekBuffer());
+            allOk = false;
+        } else if (!pm.mod) {
+            Log::DefaultLog.WriteMsg(
+                Log::LEVEL_ERROR, "Unable to construct module \"%s\" (%s)", className, path.PeekBuffer());
+            allOk = false;
+        } else if (!pm.created) {
+            Log::DefaultLog.WriteMsg(
+                Log::LEVEL_ERROR, "Unable to create module \"%s\" (%s)", className, path.PeekBuffer());
+            pm.mod.reset();
+            allOk = false;
+        } else {
+            Log::DefaultLog.WriteMsg(Log::LEVEL_INFO + 350, "Created module \"%s\" (%s)", className, path.PeekBuffer());
+            pm.ns->AddChild(pm.mod);
+            index[pm.key] = pm.mod;
+#if defined(DEBUG) || defined(_DEBUG)
+            debugDumpSlots(pm.mod.get());
+#endif /* DEBUG || _DEBUG */
+            if (outModules != nullptr) (*outModules)[pm.request] = pm.mod;
+        }
+    }
+    const double createMillis = millisSince(createStart);
+
+    // connection: all calls are resolved through the index
+    const auto connectStart = clock_type::now();
+    unsigned int connected = 0;
+    for (const PendingCall& pc : pendingCalls) {
+        const InstanceDescription::CallInstanceRequest& cir = calls[pc.request];
+        auto fromMod = index.find(pc.fromModule);
+        auto toMod = index.find(pc.toModule);
+        if ((fromMod == index.end()) || (toMod == index.end())) {
+            // the module failed to be created, which has been reported.
+            allOk = false;
+            continue;
+        }
+
+        CallerSlot* fromSlot = dynamic_cast<CallerSlot*>(fromMod->second->FindSlot(pc.fromSlot));
+        if (fromSlot == NULL) {
+            Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Unable to instantiate call: can not find source slot \"%s\"",
+                cir.From().PeekBuffer());
+            allOk = false;
+            continue;
+        }
+        CalleeSlot* toSlot = dynamic_cast<CalleeSlot*>(toMod->second->FindSlot(pc.toSlot));
+        if (toSlot == NULL) {
+            Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Unable to instantiate call: can not find target slot \"%s\"",
+                cir.To().PeekBuffer());
+            allOk = false;
+            continue;
+        }
+
+        Call* call = this->connectCall(fromSlot, toSlot, cir.Description(), cir.From(), cir.To());
+        if (call == NULL) {
+            allOk = false;
+            continue;
+        }
+        ++connected;
+        if (outCalls != nullptr) (*outCalls)[pc.request] = call;
+    }
+    const double connectMillis = millisSince(connectStart);
+
+    if (!modules.empty() || !calls.empty()) {
+        unsigned int created = 0;
+        for (const PendingModule& pm : pending) {
+            if (pm.created) ++created;
+        }
+        Log::DefaultLog.WriteMsg(Log::LEVEL_INFO,
+            "Instantiated %u of %u modules (%u on %u threads) and %u of %u calls in %.1f ms "
+            "(validate %.1f ms, create %.1f ms, connect %.1f ms)",
+            created, static_cast<unsigned int>(modules.size()), static_cast<unsigned int>(concurrent.size()),
+            static_cast<unsigned int>(threads), connected, static_cast<unsigned int>(calls.size()),
+            millisSince(startTime), validateMillis, createMillis, connectMillis);
+    }
+
+    return allOk;
+}
+
+
 /*
  * megamol::core::CoreInstance::enumParameters
  */
@@ -3454,7 +3857,8 @@ void megamol::core::CoreInstance::applyConfigParams(
 /*
  * megamol::core::CoreInstance::loadPlugin
  */
-void megamol::core::CoreInstance::loadPlugin(const vislib::TString& filename) {
+void megamol::core::CoreInstance::loadPlugin(const vislib::TString& filename,
+    std::shared_ptr<vislib::sys::DynamicLinkLibrary> lib, std::exception_ptr openError) {
 
     // select log level for plugin loading errors
     unsigned int loadFailedLevel = vislib::sys::Log::LEVEL_ERROR;
@@ -3476,10 +3880,14 @@ void megamol::core::CoreInstance::loadPlugin(const vislib::TString& filename) {
     }
 
     try {
+        if (openError) {
+            std::rethrow_exception(openError);
+        }
 
         utility::plugins::PluginManager::collection_type new_plugins =
-            this->plugins->LoadPlugin(filename.PeekBuffer(), *this);
+            this->plugins->LoadPlugin(filename.PeekBuffer(), *this, lib);
 
+        const auto registerStart = std::chrono::high_resolution_clock::now();
         for (auto new_plugin : new_plugins) {
             this->log.WriteMsg(vislib::sys::Log::LEVEL_INFO,
                 "Plugin \"%s\" (%s) loaded: %d Modules, %d Calls registered\n", new_plugin->GetAssemblyName().c_str(),
@@ -3501,6 +3909,9 @@ void megamol::core::CoreInstance::loadPlugin(const vislib::TString& filename) {
                 }
             }
         }
+        this->plugins->AddLoadTime(filename.PeekBuffer(), utility::plugins::PluginManager::LoadPhase::REGISTER,
+            std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - registerStart)
+                .count());
 
     } catch (const vislib::Exception& vex) {
         this->log.WriteMsg(loadFailedLevel, "Unable to load Plugin \"%s\": %s (%s, &d)",
@@ -3512,6 +3923,139 @@ void megamol::core::CoreInstance::loadPlugin(const vislib::TString& filename) {
 }
 
 
+/*
+ * megamol::core::CoreInstance::loadPlugins
+ */
+void megamol::core::CoreInstance::loadPlugins(const vislib::SingleLinkedList<vislib::TString>& files) {
+    typedef utility::plugins::PluginManager::filename_type filename_type;
+    const auto startTime = std::chrono::high_resolution_clock::now();
+
+    std::vector<vislib::TString> todo;
+    std::vector<filename_type> names;
+    vislib::ConstIterator<vislib::SingleLinkedList<vislib::TString>::Iterator> iter = files.GetConstIterator();
+    while (iter.HasNext()) {
+        todo.push_back(iter.Next());
+        names.push_back(todo.back().PeekBuffer());
+    }
+
+    if (this->config.IsConfigValueSet("PluginManifest")) {
+        this->pluginManifest = vislib::TString(this->config.ConfigValue("PluginManifest"));
+    }
+    bool lazy = false;
+    if (this->config.IsConfigValueSet("PluginLoading")) {
+        lazy = this->config.ConfigValue("PluginLoading").Equals(L"lazy", false);
+    }
+
+    if (lazy) {
+        if (this->pluginManifest.IsEmpty()) {
+            this->log.WriteWarn("Lazy plugin loading requires \"PluginManifest\" to be set. Loading all plugins.");
+        } else if (!this->plugins->ReadManifest(this->pluginManifest.PeekBuffer(), names)) {
+            this->log.WriteInfo("Plugin manifest \"%s\" is missing or outdated. Loading all plugins.",
+                vislib::StringA(this->pluginManifest).PeekBuffer());
+        } else {
+            // classes are looked up through the description managers, which
+            // now pull in the providing plugin on the first miss.
+            this->deferredPlugins = todo;
+            this->all_module_descriptions.SetMissHandler([this](const char* name) { this->loadProvidingPlugin(name); });
+            this->all_call_descriptions.SetMissHandler([this](const char* name) { this->loadProvidingPlugin(name); });
+            this->log.WriteInfo("Deferring %u plugins until their classes are used.",
+                static_cast<unsigned int>(todo.size()));
+            return;
+        }
+    }
+
+    // opening the libraries, which includes their static initialisation, is
+    // independent for each plugin. Everything touching the core instance
+    // happens afterwards in the configured order. The static initialisers
+    // may still touch core singletons like the default log, and dlopen and
+    // the Windows loader lock serialise most of the work anyway, so
+    // concurrent opening is opt-in.
+    unsigned int threads = 1;
+    if (this->config.IsConfigValueSet("PluginLoadThreads")) {
+        try {
+            threads = static_cast<unsigned int>(
+                vislib::CharTraitsW::ParseInt(this->config.ConfigValue("PluginLoadThreads").PeekBuffer()));
+        } catch (...) {
+        }
+    }
+    threads = (std::max)(1u, (std::min)(threads, static_cast<unsigned int>(todo.size())));
+
+    std::vector<std::shared_ptr<vislib::sys::DynamicLinkLibrary>> libs(todo.size());
+    std::vector<std::exception_ptr> errors(todo.size());
+    std::vector<double> openMillis(todo.size(), 0.0);
+    std::atomic<size_t> next(0);
+    auto open = [&]() {
+        for (size_t i = next++; i < todo.size(); i = next++) {
+            const auto openStart = std::chrono::high_resolution_clock::now();
+            try {
+                libs[i] = utility::plugins::PluginManager::OpenLibrary(names[i]);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+            openMillis[i] =
+                std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - openStart).count();
+        }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned int t = 1; t < threads; ++t) {
+        workers.emplace_back(open);
+    }
+    open();
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    for (size_t i = 0; i < todo.size(); ++i) {
+        this->plugins->AddLoadTime(names[i], utility::plugins::PluginManager::LoadPhase::OPEN, openMillis[i]);
+        this->loadPlugin(todo[i], libs[i], errors[i]);
+    }
+
+    const double wallMillis =
+        std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+    this->log.WriteInfo("Loaded %u plugin files on %u threads.", static_cast<unsigned int>(todo.size()), threads);
+    this->plugins->WriteLoadReport(this->log, wallMillis);
+
+    if (!this->pluginManifest.IsEmpty() && !this->plugins->WriteManifest(this->pluginManifest.PeekBuffer())) {
+        this->log.WriteWarn(
+            "Unable to write plugin manifest \"%s\"", vislib::StringA(this->pluginManifest).PeekBuffer());
+    }
+}
+
+
+/*
+ * megamol::core::CoreInstance::loadProvidingPlugin
+ */
+void megamol::core::CoreInstance::loadProvidingPlugin(const char* classname) {
+    if (this->deferredPlugins.empty()) return;
+
+    const auto provider = this->plugins->FindProvider(classname);
+    if (!provider.empty() && !this->plugins->IsLoaded(provider)) {
+        const vislib::TString file(provider.c_str());
+        this->log.WriteInfo("Loading plugin \"%s\" for class \"%s\"", vislib::StringA(file).PeekBuffer(), classname);
+        this->loadPlugin(file);
+        this->deferredPlugins.erase(
+            std::remove(this->deferredPlugins.begin(), this->deferredPlugins.end(), file), this->deferredPlugins.end());
+        return;
+    }
+
+    // the class is unknown or not where the manifest claims it is. Only
+    // loading everything answers that for sure, and the manifest is
+    // rewritten to be accurate next time.
+    this->log.WriteWarn("Plugin manifest does not resolve class \"%s\". Loading all remaining plugins.", classname);
+    std::vector<vislib::TString> remaining;
+    remaining.swap(this->deferredPlugins);
+    for (auto& file : remaining) {
+        if (!this->plugins->IsLoaded(file.PeekBuffer())) {
+            this->loadPlugin(file);
+        }
+    }
+    if (!this->plugins->WriteManifest(this->pluginManifest.PeekBuffer())) {
+        this->log.WriteWarn(
+            "Unable to write plugin manifest \"%s\"", vislib::StringA(this->pluginManifest).PeekBuffer());
+    }
+}
+
+
 /*
  * megamol::core::CoreInstance::mapCompare
  */
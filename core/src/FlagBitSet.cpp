@@ -0,0 +1,62 @@
+#include "stdafx.h"
+#include "mmcore/FlagBitSet.h"
+
+#include <algorithm>
+#include <bitset>
+
+using namespace megamol;
+using namespace megamol::core;
+
+
+FlagBitSet::FlagBitSet(const uint32_t testMask, const uint32_t passMask)
+    : count(0), passMask(passMask), size(0), testMask(testMask), words() {}
+
+
+FlagBitSet::~FlagBitSet(void) {}
+
+
+void FlagBitSet::Assign(const uint32_t *flags, const size_t cnt) {
+    this->size = cnt;
+    this->count = 0;
+    this->words.assign((cnt + 63) / 64, 0);
+    this->Update(flags, 0, cnt);
+}
+
+
+bool FlagBitSet::Update(const uint32_t *flags, size_t begin, size_t end) {
+    end = (std::min)(end, this->size);
+    if (begin >= end) return false;
+
+    bool changed = false;
+    const size_t firstWord = begin / 64;
+    const size_t lastWord = (end - 1) / 64;
+    for (size_t w = firstWord; w <= lastWord; ++w) {
+        const size_t lo = (std::max)(begin, w * 64);
+        const size_t hi = (std::min)(end, w * 64 + 64);
+
+        uint64_t bits = 0, mask = 0;
+        for (size_t i = lo; i < hi; ++i) {
+            const uint64_t bit = uint64_t(1) << (i % 64);
+            mask |= bit;
+            if ((flags[i] & this->testMask) == this->passMask) {
+                bits |= bit;
+            }
+        }
+
+        const uint64_t old = this->words[w];
+        const uint64_t updated = (old & ~mask) | bits;
+        if (updated != old) {
+            this->count -= std::bitset<64>(old & mask).count();
+            this->count += std::bitset<64>(bits).count();
+            this->words[w] = updated;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+
+unsigned int FlagBitSet::lowestBit(uint64_t word) {
+    // the bits below the lowest set one are exactly its index.
+    return static_cast<unsigned int>(std::bitset<64>((word & (~word + 1)) - 1).count());
+}
@@ -18,7 +18,7 @@ const unsigned int FlagCall::CallUnmapFlags = 1;
 /*
  *	IntSelectionCall:IntSelectionCall
  */
-FlagCall::FlagCall(void) : flags() {}
+FlagCall::FlagCall(void) : flags(), version(0) {}
 
 /*
  *	IntSelectionCall::~IntSelectionCall
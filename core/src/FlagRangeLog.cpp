@@ -0,0 +1,69 @@
+#include "stdafx.h"
+#include "mmcore/FlagRangeLog.h"
+
+#include <algorithm>
+
+using namespace megamol;
+using namespace megamol::core;
+
+
+void FlagRangeLog::Coalesce(std::vector<Range>& ranges) {
+    ranges.erase(std::remove_if(ranges.begin(), ranges.end(), [](const Range& r) { return r.first >= r.second; }),
+        ranges.end());
+    if (ranges.empty()) return;
+
+    std::sort(ranges.begin(), ranges.end());
+    size_t last = 0;
+    for (size_t i = 1; i < ranges.size(); ++i) {
+        if (ranges[i].first <= ranges[last].second) {
+            ranges[last].second = (std::max)(ranges[last].second, ranges[i].second);
+        } else {
+            ranges[++last] = ranges[i];
+        }
+    }
+    ranges.resize(last + 1);
+}
+
+
+FlagRangeLog::FlagRangeLog(const size_t maxVersions)
+    : entries(), horizon(0), maxVersions((maxVersions > 0) ? maxVersions : 1), version(0) {}
+
+
+FlagRangeLog::~FlagRangeLog(void) {}
+
+
+void FlagRangeLog::Clear(const VersionType version) {
+    this->entries.clear();
+    this->horizon = version;
+    this->version = version;
+}
+
+
+bool FlagRangeLog::Collect(const VersionType since, std::vector<Range>& outRanges) const {
+    outRanges.clear();
+    if (since < this->horizon || since > this->version) return false;
+
+    for (auto it = this->entries.rbegin(); it != this->entries.rend() && it->version > since; ++it) {
+        outRanges.insert(outRanges.end(), it->ranges.begin(), it->ranges.end());
+    }
+    Coalesce(outRanges);
+    return true;
+}
+
+
+void FlagRangeLog::Commit(const VersionType version, std::vector<Range> ranges) {
+    if (version <= this->version) {
+        // someone restarted counting, nothing older can be trusted.
+        this->Clear(version);
+        return;
+    }
+
+    Coalesce(ranges);
+    this->entries.push_back(Entry{version, std::move(ranges)});
+    this->version = version;
+
+    while (this->entries.size() > this->maxVersions) {
+        this->horizon = this->entries.front().version;
+        this->entries.pop_front();
+    }
+}
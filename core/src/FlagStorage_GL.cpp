@@ -53,8 +53,15 @@ bool FlagStorage_GL::writeDataCallback(core::Call& caller) {
     if (fc == nullptr) return false;
 
     if (fc->version() > this->version) {
-        this->theData = fc->getData();
+        auto data = fc->getData();
+        if (data == nullptr) return false;
+        if (data != this->theData) {
+            // keep the history when a writer hands in a different collection.
+            data->ranges = std::move(this->theData->ranges);
+        }
+        this->theData = data;
         this->version = fc->version();
+        this->theData->commitDirty(this->version);
     }
     return true;
 }
@@ -22,6 +22,7 @@
 #include "mmcore/CallerSlot.h"
 #include "mmcore/CoreInstance.h"
 #include "mmcore/LuaState.h"
+#include "mmcore/profiler/Tracer.h"
 #include "mmcore/utility/Configuration.h"
 #include "vislib/UTF8Encoder.h"
 #include "vislib/sys/AutoLock.h"
@@ -92,6 +93,10 @@ bool iequals(const std::string& one, const std::string& other) {
 #define MMC_LUA_MMFLUSH "mmFlush"
 #define MMC_LUA_MMCURRENTSCRIPTPATH "mmCurrentScriptPath"
 #define MMC_LUA_MMLISTPARAMETERS "mmListParameters"
+#define MMC_LUA_MMSTARTTRACE "mmStartTrace"
+#define MMC_LUA_MMSTOPTRACE "mmStopTrace"
+#define MMC_LUA_MMWRITETRACE "mmWriteTrace"
+#define MMC_LUA_MMTRACESUMMARY "mmTraceSummary"
 
 
 bool megamol::core::LuaState::checkConfiguring(const std::string where) {
@@ -178,6 +183,11 @@ void megamol::core::LuaState::commonInit() {
 
     theLua.RegisterCallback<LuaState, &LuaState::Flush>(MMC_LUA_MMFLUSH, "()\n\tInserts a flush event into graph manipulation queues.");
     theLua.RegisterCallback<LuaState, &LuaState::CurrentScriptPath>(MMC_LUA_MMCURRENTSCRIPTPATH, "()\n\tReturns the path of the currently running script, if possible. Empty string otherwise.");
+
+    theLua.RegisterCallback<LuaState, &LuaState::StartTrace>(MMC_LUA_MMSTARTTRACE, "([int spansPerThread])\n\tDiscards the recorded call spans and starts tracing all calls.");
+    theLua.RegisterCallback<LuaState, &LuaState::StopTrace>(MMC_LUA_MMSTOPTRACE, "()\n\tStops tracing, keeping the recorded call spans.");
+    theLua.RegisterCallback<LuaState, &LuaState::WriteTrace>(MMC_LUA_MMWRITETRACE, "(string fileName)\n\tWrites the recorded call spans as Chrome trace / Perfetto JSON.");
+    theLua.RegisterCallback<LuaState, &LuaState::TraceSummary>(MMC_LUA_MMTRACESUMMARY, "()\n\tReturns the recorded time per module as text table.");
 }
 
 
@@ -1253,3 +1263,34 @@ int megamol::core::LuaState::CurrentScriptPath(struct lua_State* L) {
     lua_pushstring(L, this->currentScriptPath.c_str());
     return 1;
 }
+
+int megamol::core::LuaState::StartTrace(lua_State* L) {
+    auto capacity = luaL_optinteger(L, 1, megamol::core::profiler::Tracer::DEFAULT_CAPACITY);
+    if (capacity <= 0) {
+        lua_pushstring(L, MMC_LUA_MMSTARTTRACE ": the number of spans per thread must be positive");
+        lua_error(L);
+        return 0;
+    }
+    megamol::core::profiler::Tracer::Instance().Start(static_cast<size_t>(capacity));
+    return 0;
+}
+
+int megamol::core::LuaState::StopTrace(lua_State* L) {
+    megamol::core::profiler::Tracer::Instance().Stop();
+    return 0;
+}
+
+int megamol::core::LuaState::WriteTrace(lua_State* L) {
+    auto fileName = luaL_checkstring(L, 1);
+    if (!megamol::core::profiler::Tracer::Instance().WriteTrace(fileName)) {
+        std::string err = MMC_LUA_MMWRITETRACE ": could not write \"" + std::string(fileName) + "\"";
+        lua_pushstring(L, err.c_str());
+        lua_error(L);
+    }
+    return 0;
+}
+
+int megamol::core::LuaState::TraceSummary(lua_State* L) {
+    lua_pushstring(L, megamol::core::profiler::Tracer::Instance().Summary().c_str());
+    return 1;
+}
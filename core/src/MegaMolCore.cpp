@@ -30,6 +30,7 @@
 #include "mmcore/factories/ModuleDescriptionManager.h"
 #include "mmcore/factories/CallDescriptionManager.h"
 #include "mmcore/CallerSlot.h"
+#include "mmcore/profiler/Tracer.h"
 
 #include "vislib/assert.h"
 #include "vislib/sys/CriticalSection.h"
@@ -655,6 +656,7 @@ MEGAMOLCORE_API void MEGAMOLCORE_CALL mmcRenderView(void *hView,
             context->Time = view->View()->DefaultTime(it);
             context->InstanceTime = it; 
 
+            megamol::core::profiler::Tracer::NextFrame();
             view->View()->Render(*context);
             context->ContinuousRedraw = true; // TODO: Implement the real thing
         }
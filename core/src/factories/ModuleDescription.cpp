@@ -47,6 +47,14 @@ bool factories::ModuleDescription::IsAvailable(void) const {
 }
 
 
+/*
+ * factories::ModuleDescription::IsCreateThreadSafe
+ */
+bool factories::ModuleDescription::IsCreateThreadSafe(void) const {
+    return false;
+}
+
+
 /*
  * factories::ModuleDescription::IsLoaderWithAutoDetection
  */
@@ -8,6 +8,9 @@
 #include "stdafx.h"
 #include "mmcore/misc/VolumetricDataCall.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <utility>
 
 #include "vislib/OutOfRangeException.h"
@@ -15,6 +18,251 @@
 
 #define STATIC_ARRAY_COUNT(ary) (sizeof(ary) / sizeof(*(ary)))
 
+#if (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+#define MEGAMOLCORE_VOLUMETRICDATACALL_SSE2
+#include <emmintrin.h>
+#endif
+
+
+namespace {
+
+    /**
+     * Invokes 'f' with a value of the C++ type matching the given scalar
+     * description, which allows for resolving the type only once per bulk
+     * operation rather than once per voxel.
+     */
+    template<class F>
+    bool dispatchScalarType(const megamol::core::misc::ScalarType_t type,
+            const size_t length, F&& f) {
+        using namespace megamol::core::misc;
+        switch (type) {
+            case SIGNED_INTEGER:
+                switch (length) {
+                    case 1: f(int8_t()); return true;
+                    case 2: f(int16_t()); return true;
+                    case 4: f(int32_t()); return true;
+                    case 8: f(int64_t()); return true;
+                }
+                break;
+
+            case UNSIGNED_INTEGER:
+                switch (length) {
+                    case 1: f(uint8_t()); return true;
+                    case 2: f(uint16_t()); return true;
+                    case 4: f(uint32_t()); return true;
+                    case 8: f(uint64_t()); return true;
+                }
+                break;
+
+            case FLOATING_POINT:
+                switch (length) {
+                    case 4: f(float()); return true;
+                    case 8: f(double()); return true;
+                }
+                break;
+
+            default:
+                break;
+        }
+        return false;
+    }
+
+
+    /**
+     * Converts as many of the 'cnt' contiguous values as possible using
+     * SIMD instructions and answers how many have been converted. The
+     * generic version does not have a fast path.
+     */
+    template<class T>
+    inline size_t convertContiguous(const T *src, const size_t cnt,
+            const float scale, const float bias, float *dst) {
+        return 0;
+    }
+
+#ifdef MEGAMOLCORE_VOLUMETRICDATACALL_SSE2
+    /** Scales and biases four converted values and stores them. */
+    inline void storeScaled(float *dst, const __m128 v, const __m128 scale,
+            const __m128 bias) {
+        ::_mm_storeu_ps(dst, ::_mm_add_ps(::_mm_mul_ps(v, scale), bias));
+    }
+
+    /** Converts four signed 32-bit integers and stores them. */
+    inline void storeScaled(float *dst, const __m128i v, const __m128 scale,
+            const __m128 bias) {
+        storeScaled(dst, ::_mm_cvtepi32_ps(v), scale, bias);
+    }
+
+    template<>
+    inline size_t convertContiguous<float>(const float *src, const size_t cnt,
+            const float scale, const float bias, float *dst) {
+        const auto s = ::_mm_set1_ps(scale);
+        const auto b = ::_mm_set1_ps(bias);
+        size_t i = 0;
+        for (; i + 4 <= cnt; i += 4) {
+            storeScaled(dst + i, ::_mm_loadu_ps(src + i), s, b);
+        }
+        return i;
+    }
+
+    template<>
+    inline size_t convertContiguous<int32_t>(const int32_t *src,
+            const size_t cnt, const float scale, const float bias,
+            float *dst) {
+        const auto s = ::_mm_set1_ps(scale);
+        const auto b = ::_mm_set1_ps(bias);
+        size_t i = 0;
+        for (; i + 4 <= cnt; i += 4) {
+            auto v = ::_mm_loadu_si128(reinterpret_cast<const __m128i *>(
+                src + i));
+            storeScaled(dst + i, v, s, b);
+        }
+        return i;
+    }
+
+    template<>
+    inline size_t convertContiguous<uint16_t>(const uint16_t *src,
+            const size_t cnt, const float scale, const float bias,
+            float *dst) {
+        const auto s = ::_mm_set1_ps(scale);
+        const auto b = ::_mm_set1_ps(bias);
+        const auto z = ::_mm_setzero_si128();
+        size_t i = 0;
+        for (; i + 8 <= cnt; i += 8) {
+            auto v = ::_mm_loadu_si128(reinterpret_cast<const __m128i *>(
+                src + i));
+            storeScaled(dst + i, ::_mm_unpacklo_epi16(v, z), s, b);
+            storeScaled(dst + i + 4, ::_mm_unpackhi_epi16(v, z), s, b);
+        }
+        return i;
+    }
+
+    template<>
+    inline size_t convertContiguous<int16_t>(const int16_t *src,
+            const size_t cnt, const float scale, const float bias,
+            float *dst) {
+        const auto s = ::_mm_set1_ps(scale);
+        const auto b = ::_mm_set1_ps(bias);
+        size_t i = 0;
+        for (; i + 8 <= cnt; i += 8) {
+            auto v = ::_mm_loadu_si128(reinterpret_cast<const __m128i *>(
+                src + i));
+            // Sign-extend by moving each value to the upper half.
+            storeScaled(dst + i, ::_mm_srai_epi32(
+                ::_mm_unpacklo_epi16(v, v), 16), s, b);
+            storeScaled(dst + i + 4, ::_mm_srai_epi32(
+                ::_mm_unpackhi_epi16(v, v), 16), s, b);
+        }
+        return i;
+    }
+
+    template<>
+    inline size_t convertContiguous<uint8_t>(const uint8_t *src,
+            const size_t cnt, const float scale, const float bias,
+            float *dst) {
+        const auto s = ::_mm_set1_ps(scale);
+        const auto b = ::_mm_set1_ps(bias);
+        const auto z = ::_mm_setzero_si128();
+        size_t i = 0;
+        for (; i + 16 <= cnt; i += 16) {
+            auto v = ::_mm_loadu_si128(reinterpret_cast<const __m128i *>(
+                src + i));
+            auto lo = ::_mm_unpacklo_epi8(v, z);
+            auto hi = ::_mm_unpackhi_epi8(v, z);
+            storeScaled(dst + i, ::_mm_unpacklo_epi16(lo, z), s, b);
+            storeScaled(dst + i + 4, ::_mm_unpackhi_epi16(lo, z), s, b);
+            storeScaled(dst + i + 8, ::_mm_unpacklo_epi16(hi, z), s, b);
+            storeScaled(dst + i + 12, ::_mm_unpackhi_epi16(hi, z), s, b);
+        }
+        return i;
+    }
+#endif /* MEGAMOLCORE_VOLUMETRICDATACALL_SSE2 */
+
+
+    /**
+     * Converts 'cnt' values which are 'stride' scalars apart.
+     */
+    template<class T>
+    void convertValues(const T *src, const size_t cnt, const size_t stride,
+            const float scale, const float bias, float *dst) {
+        size_t i = 0;
+        if (stride == 1) {
+            i = convertContiguous(src, cnt, scale, bias, dst);
+        }
+        for (; i < cnt; ++i) {
+            dst[i] = static_cast<float>(src[i * stride]) * scale + bias;
+        }
+    }
+
+
+    /**
+     * Gathers the values at the given linear voxel indices.
+     */
+    template<class T>
+    void gatherValues(const T *src, const uint64_t *indices, const size_t cnt,
+            const size_t stride, const float scale, const float bias,
+            float *dst) {
+        for (size_t i = 0; i < cnt; ++i) {
+            dst[i] = static_cast<float>(src[indices[i] * stride]) * scale
+                + bias;
+        }
+    }
+
+
+    /**
+     * Samples the grid at the given voxel coordinates using trilinear
+     * interpolation.
+     */
+    template<class T>
+    void sampleValues(const T *src, const size_t *resolution,
+            const float *positions, const size_t cnt, const size_t stride,
+            const float scale, const float bias, float *dst) {
+        const int64_t maxX = static_cast<int64_t>(resolution[0]) - 1;
+        const int64_t maxY = static_cast<int64_t>(resolution[1]) - 1;
+        const int64_t maxZ = static_cast<int64_t>(resolution[2]) - 1;
+        const int64_t sx = static_cast<int64_t>(stride);
+        const int64_t sy = sx * static_cast<int64_t>(resolution[0]);
+        const int64_t sz = sy * static_cast<int64_t>(resolution[1]);
+
+        for (size_t i = 0; i < cnt; ++i) {
+            const auto *p = positions + 3 * i;
+            const float x = (std::min)((std::max)(p[0], 0.0f),
+                static_cast<float>(maxX));
+            const float y = (std::min)((std::max)(p[1], 0.0f),
+                static_cast<float>(maxY));
+            const float z = (std::min)((std::max)(p[2], 0.0f),
+                static_cast<float>(maxZ));
+
+            const int64_t x0 = static_cast<int64_t>(x);
+            const int64_t y0 = static_cast<int64_t>(y);
+            const int64_t z0 = static_cast<int64_t>(z);
+            const float fx = x - x0;
+            const float fy = y - y0;
+            const float fz = z - z0;
+            const int64_t dx = (x0 < maxX) ? sx : 0;
+            const int64_t dy = (y0 < maxY) ? sy : 0;
+            const int64_t dz = (z0 < maxZ) ? sz : 0;
+
+            const T *v = src + x0 * sx + y0 * sy + z0 * sz;
+            const float c00 = static_cast<float>(v[0])
+                + fx * (static_cast<float>(v[dx]) - static_cast<float>(v[0]));
+            const float c10 = static_cast<float>(v[dy])
+                + fx * (static_cast<float>(v[dy + dx])
+                - static_cast<float>(v[dy]));
+            const float c01 = static_cast<float>(v[dz])
+                + fx * (static_cast<float>(v[dz + dx])
+                - static_cast<float>(v[dz]));
+            const float c11 = static_cast<float>(v[dz + dy])
+                + fx * (static_cast<float>(v[dz + dy + dx])
+                - static_cast<float>(v[dz + dy]));
+            const float c0 = c00 + fy * (c10 - c00);
+            const float c1 = c01 + fy * (c11 - c01);
+
+            dst[i] = (c0 + fz * (c1 - c0)) * scale + bias;
+        }
+    }
+
+} /* end namespace */
+
 
 /*
  * megamol::pcl::CallPcd::FunctionCount
@@ -78,7 +326,10 @@ const unsigned int megamol::core::misc::VolumetricDataCall::IDX_TRY_GET_DATA
  * megamol::core::misc::VolumetricDataCall::VolumetricDataCall
  */
 megamol::core::misc::VolumetricDataCall::VolumetricDataCall(void)
-        : data(nullptr), metadata(nullptr), vram_volume_name(0) {
+        : data(nullptr), metadata(nullptr), vram_volume_name(0), availableLevels(1), dataLevel(0),
+        hasRequestedRegion(false), requestedLevel(0) {
+    ::memset(this->dataOffset, 0, sizeof(this->dataOffset));
+    ::memset(this->requestedRegion, 0, sizeof(this->requestedRegion));
 }
 
 
@@ -86,7 +337,10 @@ megamol::core::misc::VolumetricDataCall::VolumetricDataCall(void)
  * megamol::core::misc::VolumetricDataCall::VolumetricDataCall
  */
 megamol::core::misc::VolumetricDataCall::VolumetricDataCall(
-        const VolumetricDataCall& rhs) : data(nullptr), metadata(nullptr), vram_volume_name(0) {
+        const VolumetricDataCall& rhs) : data(nullptr), metadata(nullptr), vram_volume_name(0), availableLevels(1),
+        dataLevel(0), hasRequestedRegion(false), requestedLevel(0) {
+    ::memset(this->dataOffset, 0, sizeof(this->dataOffset));
+    ::memset(this->requestedRegion, 0, sizeof(this->requestedRegion));
     *this = rhs;
 }
 
@@ -106,6 +360,18 @@ size_t megamol::core::misc::VolumetricDataCall::GetComponents(void) const {
 }
 
 
+/*
+ * megamol::core::misc::VolumetricDataCall::GetDataOffset
+ */
+size_t megamol::core::misc::VolumetricDataCall::GetDataOffset(
+        const int axis) const {
+    if ((axis < 0) || (axis > 2)) {
+        throw vislib::OutOfRangeException(axis, 0, 2, __FILE__, __LINE__);
+    }
+    return this->dataOffset[axis];
+}
+
+
 /*
  * megamol::core::misc::VolumetricDataCall::GetFrames
  */
@@ -199,7 +465,7 @@ const float megamol::core::misc::VolumetricDataCall::GetRelativeVoxelValue(const
     } else {
         uint64_t idx =
             (z * this->metadata->Resolution[1] + y) * this->metadata->Resolution[0] + x;
-        idx *= this->metadata->Components;
+        idx = idx * this->metadata->Components + c;
         switch (this->metadata->ScalarType) {
         case UNKNOWN:
         case BITS:
@@ -250,7 +516,7 @@ const float megamol::core::misc::VolumetricDataCall::GetAbsoluteVoxelValue(
     } else {
         uint64_t idx =
             z * this->metadata->Resolution[0] * this->metadata->Resolution[1] + y * this->metadata->Resolution[0] + x;
-        idx *= this->metadata->Components;
+        idx = idx * this->metadata->Components + c;
         switch (this->metadata->ScalarType) {
         case UNKNOWN:
         case BITS:
@@ -277,6 +543,60 @@ const float megamol::core::misc::VolumetricDataCall::GetAbsoluteVoxelValue(
     return theVal;
 }
 
+/*
+ * megamol::core::misc::VolumetricDataCall::ConvertSlab
+ */
+bool megamol::core::misc::VolumetricDataCall::ConvertSlab(
+        const size_t firstSlice, const size_t cntSlices, float *dst,
+        const uint32_t c, const bool relative) const {
+    float scale, bias;
+    if (!this->prepareBulkAccess("ConvertSlab", c, relative, scale, bias)) {
+        return false;
+    }
+
+    const auto& md = *this->metadata;
+    if (firstSlice + cntSlices > md.Resolution[2]) {
+        vislib::sys::Log::DefaultLog.WriteError("ConvertSlab: slices "
+            "[%zu, %zu[ are out of range.", firstSlice,
+            firstSlice + cntSlices);
+        return false;
+    }
+
+    const size_t sliceSize = md.Resolution[0] * md.Resolution[1];
+    const size_t first = firstSlice * sliceSize * md.Components + c;
+    const size_t cnt = cntSlices * sliceSize;
+
+    return ::dispatchScalarType(md.ScalarType, md.ScalarLength,
+            [&](auto tag) {
+        typedef decltype(tag) T;
+        ::convertValues(static_cast<const T *>(this->data) + first, cnt,
+            md.Components, scale, bias, dst);
+    });
+}
+
+
+/*
+ * megamol::core::misc::VolumetricDataCall::GatherVoxelValues
+ */
+bool megamol::core::misc::VolumetricDataCall::GatherVoxelValues(
+        const uint64_t *indices, const size_t cnt, float *dst,
+        const uint32_t c, const bool relative) const {
+    float scale, bias;
+    if (!this->prepareBulkAccess("GatherVoxelValues", c, relative, scale,
+            bias)) {
+        return false;
+    }
+
+    const auto& md = *this->metadata;
+    return ::dispatchScalarType(md.ScalarType, md.ScalarLength,
+            [&](auto tag) {
+        typedef decltype(tag) T;
+        ::gatherValues(static_cast<const T *>(this->data) + c, indices, cnt,
+            md.Components, scale, bias, dst);
+    });
+}
+
+
 /*
  * megamol::core::misc::VolumetricDataCall::IsUniform
  */
@@ -288,6 +608,53 @@ bool megamol::core::misc::VolumetricDataCall::IsUniform(const int axis) const {
 }
 
 
+/*
+ * megamol::core::misc::VolumetricDataCall::SampleTrilinear
+ */
+bool megamol::core::misc::VolumetricDataCall::SampleTrilinear(
+        const float *positions, const size_t cnt, float *dst,
+        const uint32_t c, const bool relative) const {
+    float scale, bias;
+    if (!this->prepareBulkAccess("SampleTrilinear", c, relative, scale,
+            bias)) {
+        return false;
+    }
+
+    const auto& md = *this->metadata;
+    return ::dispatchScalarType(md.ScalarType, md.ScalarLength,
+            [&](auto tag) {
+        typedef decltype(tag) T;
+        ::sampleValues(static_cast<const T *>(this->data) + c, md.Resolution,
+            positions, cnt, md.Components, scale, bias, dst);
+    });
+}
+
+
+/*
+ * megamol::core::misc::VolumetricDataCall::SetDataRegion
+ */
+void megamol::core::misc::VolumetricDataCall::SetDataRegion(
+        const unsigned int level, const size_t *offset) {
+    this->dataLevel = level;
+    if (offset != nullptr) {
+        ::memcpy(this->dataOffset, offset, sizeof(this->dataOffset));
+    } else {
+        ::memset(this->dataOffset, 0, sizeof(this->dataOffset));
+    }
+}
+
+
+/*
+ * megamol::core::misc::VolumetricDataCall::SetRequestedRegion
+ */
+void megamol::core::misc::VolumetricDataCall::SetRequestedRegion(
+        const size_t *min, const size_t *max) {
+    ::memcpy(this->requestedRegion, min, 3 * sizeof(size_t));
+    ::memcpy(this->requestedRegion + 3, max, 3 * sizeof(size_t));
+    this->hasRequestedRegion = true;
+}
+
+
 /*
  * megamol::core::misc::VolumetricDataCall::SetMetadata
  */
@@ -306,11 +673,58 @@ megamol::core::misc::VolumetricDataCall::operator =(const VolumetricDataCall& rh
         Base::operator =(rhs);
         this->data = rhs.data;
         this->metadata = rhs.metadata;
+        this->availableLevels = rhs.availableLevels;
+        this->dataLevel = rhs.dataLevel;
+        ::memcpy(this->dataOffset, rhs.dataOffset, sizeof(this->dataOffset));
+        this->hasRequestedRegion = rhs.hasRequestedRegion;
+        this->requestedLevel = rhs.requestedLevel;
+        ::memcpy(this->requestedRegion, rhs.requestedRegion, sizeof(this->requestedRegion));
     }
     return *this;
 }
 
 
+/*
+ * megamol::core::misc::VolumetricDataCall::prepareBulkAccess
+ */
+bool megamol::core::misc::VolumetricDataCall::prepareBulkAccess(
+        const char *caller, const uint32_t c, const bool relative,
+        float& outScale, float& outBias) const {
+    if ((this->metadata == nullptr) || (this->data == nullptr)) {
+        vislib::sys::Log::DefaultLog.WriteError("%s: no data available.",
+            caller);
+        return false;
+    }
+    if ((this->metadata->GridType != GridType::CARTESIAN)
+            && (this->metadata->GridType != GridType::RECTILINEAR)) {
+        vislib::sys::Log::DefaultLog.WriteError("%s: unsupported grid!",
+            caller);
+        return false;
+    }
+    if (c >= this->metadata->Components) {
+        vislib::sys::Log::DefaultLog.WriteError("%s: channel %u does not "
+            "exist.", caller, c);
+        return false;
+    }
+
+    outScale = 1.0f;
+    outBias = 0.0f;
+    if (relative) {
+        const auto min = static_cast<float>(this->metadata->MinValues[c]);
+        const auto range = static_cast<float>(this->metadata->MaxValues[c])
+            - min;
+        if (range != 0.0f) {
+            outScale = 1.0f / range;
+            outBias = -min * outScale;
+        } else {
+            outScale = 0.0f;
+        }
+    }
+
+    return true;
+}
+
+
 /*
  * megamol::core::misc::VolumetricDataCall::FUNCTIONS
  */
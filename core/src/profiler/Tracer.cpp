@@ -0,0 +1,325 @@
+/*
+ * profiler/Tracer.cpp
+ *
+ * Copyright (C) 2020 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+#include "stdafx.h"
+#include "mmcore/profiler/Tracer.h"
+#include "mmcore/Call.h"
+#include "mmcore/CalleeSlot.h"
+#include "mmcore/CallerSlot.h"
+#include "vislib/sys/Log.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+using namespace megamol;
+using namespace megamol::core;
+
+
+namespace {
+
+    /** The buffer of the calling thread, owned by the tracer */
+    thread_local void *currentBuffer = nullptr;
+
+    /**
+     * Writes 'str' as JSON string literal.
+     */
+    void writeJSONString(std::ostream& out, const std::string& str) {
+        out << '"';
+        for (char c : str) {
+            switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out << "\\u00" << std::hex << std::setw(2) << std::setfill('0')
+                        << static_cast<int>(c) << std::dec << std::setfill(' ');
+                } else {
+                    out << c;
+                }
+            }
+        }
+        out << '"';
+    }
+
+}
+
+
+/*
+ * profiler::Tracer::enabled
+ */
+std::atomic<bool> profiler::Tracer::enabled(false);
+
+
+/*
+ * profiler::Tracer::frame
+ */
+std::atomic<unsigned int> profiler::Tracer::frame(0);
+
+
+/*
+ * profiler::Tracer::Span::Span
+ */
+profiler::Tracer::Span::Span(const Call& call, unsigned int callback)
+        : call(call), callback(callback), frame(Tracer::frame.load(std::memory_order_relaxed)) {
+    ThreadBuffer& buf = Tracer::Instance().threadBuffer();
+    if (buf.depth < 64) buf.childTime[buf.depth] = 0;
+    ++buf.depth;
+    this->start = std::chrono::steady_clock::now();
+}
+
+
+/*
+ * profiler::Tracer::Span::~Span
+ */
+profiler::Tracer::Span::~Span(void) {
+    auto end = std::chrono::steady_clock::now();
+    Tracer& tracer = Tracer::Instance();
+    ThreadBuffer& buf = tracer.threadBuffer();
+    if (buf.depth == 0) return; // the recording was restarted meanwhile
+    --buf.depth;
+
+    Event e;
+    e.callback = this->callback;
+    e.frame = this->frame;
+    e.depth = buf.depth;
+    e.start = tracer.micros(this->start);
+    e.duration = tracer.micros(end) - e.start;
+    e.self = e.duration - ((buf.depth < 64) ? buf.childTime[buf.depth] : 0);
+    if ((buf.depth > 0) && (buf.depth <= 64)) buf.childTime[buf.depth - 1] += e.duration;
+
+    size_t n = buf.count.load(std::memory_order_relaxed);
+    if (n < buf.capacity) {
+        e.call = tracer.callID(this->call);
+        buf.events[n] = e;
+        buf.count.store(n + 1, std::memory_order_release);
+    } else {
+        buf.dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+
+/*
+ * profiler::Tracer::Instance
+ */
+profiler::Tracer& profiler::Tracer::Instance(void) {
+    static Tracer tracer;
+    return tracer;
+}
+
+
+/*
+ * profiler::Tracer::Start
+ */
+void profiler::Tracer::Start(size_t capacity) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->capacity = std::max<size_t>(capacity, 1);
+    this->timeBase.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+    this->generation.fetch_add(1);
+    enabled.store(true);
+    vislib::sys::Log::DefaultLog.WriteInfo("Tracing started (%u spans per thread)",
+        static_cast<unsigned int>(this->capacity));
+}
+
+
+/*
+ * profiler::Tracer::Stop
+ */
+void profiler::Tracer::Stop(void) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    enabled.store(false);
+    vislib::sys::Log::DefaultLog.WriteInfo("Tracing stopped");
+}
+
+
+/*
+ * profiler::Tracer::WriteTrace
+ */
+bool profiler::Tracer::WriteTrace(const std::string& path) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        vislib::sys::Log::DefaultLog.WriteError("Unable to write trace file \"%s\"", path.c_str());
+        return false;
+    }
+
+    const uint64_t gen = this->generation.load();
+    size_t written = 0, dropped = 0;
+    bool first = true;
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (const auto& buf : this->buffers) {
+        if (buf->generation.load(std::memory_order_acquire) != gen) continue;
+        const size_t n = buf->count.load(std::memory_order_acquire);
+        dropped += buf->dropped.load(std::memory_order_relaxed);
+
+        out << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buf->id
+            << ",\"args\":{\"name\":\"thread " << buf->id << "\"}}";
+        first = false;
+        for (size_t i = 0; i < n; ++i) {
+            const Event& e = buf->events[i];
+            const CallNames& names = this->calls[e.call - 1];
+            const std::string& cb = (e.callback < names.callbacks.size()) ? names.callbacks[e.callback] : "";
+            out << ",\n{\"name\":";
+            writeJSONString(out, names.callee + "::" + cb);
+            out << ",\"cat\":";
+            writeJSONString(out, names.callClass);
+            out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buf->id << ",\"ts\":" << e.start << ",\"dur\":" << e.duration
+                << ",\"args\":{\"caller\":";
+            writeJSONString(out, names.caller);
+            out << ",\"frame\":" << e.frame << ",\"self\":" << e.self << "}}";
+        }
+        written += n;
+    }
+    out << "\n]}\n";
+    out.close();
+
+    if (!out) {
+        vislib::sys::Log::DefaultLog.WriteError("Unable to write trace file \"%s\"", path.c_str());
+        return false;
+    }
+    vislib::sys::Log::DefaultLog.WriteInfo("Wrote %u spans to trace file \"%s\" (%u dropped)",
+        static_cast<unsigned int>(written), path.c_str(), static_cast<unsigned int>(dropped));
+    return true;
+}
+
+
+/*
+ * profiler::Tracer::Summary
+ */
+std::string profiler::Tracer::Summary(void) {
+    struct Row {
+        size_t count = 0;
+        int64_t total = 0;
+        int64_t self = 0;
+        int64_t longest = 0;
+    };
+
+    std::lock_guard<std::mutex> guard(this->lock);
+    const uint64_t gen = this->generation.load();
+    std::map<std::string, Row> modules;
+    size_t dropped = 0;
+    for (const auto& buf : this->buffers) {
+        if (buf->generation.load(std::memory_order_acquire) != gen) continue;
+        const size_t n = buf->count.load(std::memory_order_acquire);
+        dropped += buf->dropped.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < n; ++i) {
+            const Event& e = buf->events[i];
+            Row& row = modules[this->calls[e.call - 1].callee];
+            ++row.count;
+            row.total += e.duration;
+            row.self += e.self;
+            row.longest = std::max(row.longest, e.duration);
+        }
+    }
+
+    std::vector<std::pair<std::string, Row>> sorted(modules.begin(), modules.end());
+    std::sort(sorted.begin(), sorted.end(), [](const std::pair<std::string, Row>& a,
+        const std::pair<std::string, Row>& b) { return a.second.self > b.second.self; });
+
+    std::stringstream out;
+    out << std::fixed << std::setprecision(3);
+    out << std::setw(10) << "calls" << std::setw(14) << "total [ms]" << std::setw(14) << "self [ms]"
+        << std::setw(14) << "max [ms]" << "  module\n";
+    for (const auto& m : sorted) {
+        out << std::setw(10) << m.second.count << std::setw(14) << m.second.total * 0.001 << std::setw(14)
+            << m.second.self * 0.001 << std::setw(14) << m.second.longest * 0.001 << "  " << m.first << "\n";
+    }
+    if (dropped > 0) {
+        out << dropped << " spans dropped, the per-thread buffers were full\n";
+    }
+    return out.str();
+}
+
+
+/*
+ * profiler::Tracer::Tracer
+ */
+profiler::Tracer::Tracer(void) : lock(), buffers(), calls(), generation(0), capacity(DEFAULT_CAPACITY),
+        timeBase(0) {
+    // intentionally empty
+}
+
+
+/*
+ * profiler::Tracer::~Tracer
+ */
+profiler::Tracer::~Tracer(void) {
+    enabled.store(false);
+}
+
+
+/*
+ * profiler::Tracer::threadBuffer
+ */
+profiler::Tracer::ThreadBuffer& profiler::Tracer::threadBuffer(void) {
+    ThreadBuffer *buf = static_cast<ThreadBuffer*>(currentBuffer);
+    const uint64_t gen = this->generation.load(std::memory_order_relaxed);
+    if ((buf != nullptr) && (buf->generation.load(std::memory_order_relaxed) == gen)) {
+        return *buf;
+    }
+
+    std::lock_guard<std::mutex> guard(this->lock);
+    if (buf == nullptr) {
+        this->buffers.emplace_back(new ThreadBuffer());
+        buf = this->buffers.back().get();
+        buf->capacity = 0;
+        buf->generation.store(0);
+        buf->id = static_cast<uint32_t>(this->buffers.size());
+        currentBuffer = buf;
+    }
+    if (buf->capacity != this->capacity) {
+        buf->events.reset(new Event[this->capacity]);
+        buf->capacity = this->capacity;
+    }
+    buf->count.store(0);
+    buf->dropped.store(0);
+    buf->depth = 0;
+    buf->generation.store(this->generation.load(), std::memory_order_release);
+    return *buf;
+}
+
+
+/*
+ * profiler::Tracer::callID
+ */
+uint32_t profiler::Tracer::callID(const Call& call) {
+    uint32_t id = call.traceID.id.load(std::memory_order_acquire);
+    if (id != 0) return id;
+
+    std::lock_guard<std::mutex> guard(this->lock);
+    id = call.traceID.id.load();
+    if (id != 0) return id;
+
+    CallNames names;
+    if (call.PeekCallerSlot() != nullptr) names.caller = call.PeekCallerSlot()->FullName().PeekBuffer();
+    const CalleeSlot *callee = call.PeekCalleeSlot();
+    if (callee != nullptr) {
+        names.callee = (callee->Parent() != nullptr) ? callee->Parent()->FullName().PeekBuffer()
+            : callee->FullName().PeekBuffer();
+        for (SIZE_T i = 0; i < callee->GetCallbackCount(); ++i) {
+            names.callbacks.push_back(callee->GetCallbackFuncName(i));
+        }
+    }
+    if (call.ClassName() != nullptr) names.callClass = call.ClassName();
+    this->calls.push_back(std::move(names));
+
+    id = static_cast<uint32_t>(this->calls.size());
+    call.traceID.id.store(id, std::memory_order_release);
+    return id;
+}
+
+
+/*
+ * profiler::Tracer::micros
+ */
+int64_t profiler::Tracer::micros(std::chrono::steady_clock::time_point time) const {
+    return (std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count()
+        - this->timeBase.load(std::memory_order_relaxed)) / 1000;
+}
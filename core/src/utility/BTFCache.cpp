@@ -0,0 +1,352 @@
+/*
+ * BTFCache.cpp
+ *
+ * Copyright (C) 2020 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#include "stdafx.h"
+#include "utility/BTFCache.h"
+#include "mmcore/utility/CacheFile.h"
+#include "vislib/StringTokeniser.h"
+#include "vislib/sys/Path.h"
+#include "vislib/sys/SystemInformation.h"
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace megamol::core;
+using megamol::core::utility::CacheFile;
+
+
+namespace {
+
+    typedef utility::BTFParser::BTFElement BTFElement;
+    typedef utility::BTFParser::BTFNamespace BTFNamespace;
+    typedef utility::BTFParser::BTFShader BTFShader;
+    typedef utility::BTFParser::BTFSnippet BTFSnippet;
+
+    /** The magic number and version of cache files */
+    const char CACHE_MAGIC[CacheFile::MAGIC_LENGTH] = {'M', 'M', 'B', 'T', 'F', 'C', '\0', '\0'};
+    const UINT32 CACHE_VERSION = 1;
+
+    /** Element tags */
+    enum ElementTag : unsigned char {
+        TAG_NULL = 'X',
+        TAG_NAMESPACE = 'N',
+        TAG_SHADER = 'S',
+        TAG_SNIPPET = 'T',
+        TAG_REFERENCE = 'R'
+    };
+
+    /** The full names of all elements which can be referenced */
+    typedef std::map<const BTFElement*, std::string> path_map;
+
+    /**
+     * Answer the conditions a btf file can test, which must not differ
+     * between writing and reading a cache file.
+     */
+    std::string buildKey(void) {
+        std::string key(vislib::sys::SystemInformation::ComputerNameA().PeekBuffer());
+        key += "|" + std::to_string(vislib::sys::SystemInformation::SelfWordSize());
+#if defined(DEBUG) || defined(_DEBUG)
+        key += "|debug";
+#endif /* DEBUG || _DEBUG */
+        return key;
+    }
+
+    /** Reads a length-prefixed string into a vislib string */
+    bool readString(std::istream& in, vislib::StringA& str) {
+        std::string buf;
+        if (!CacheFile::ReadString(in, buf)) return false;
+        str = buf.c_str();
+        return true;
+    }
+
+    /**
+     * Assigns full names to all namespace-level elements and to the named
+     * snippets defined inline in shaders.
+     */
+    void collectPaths(const BTFNamespace& ns, const std::string& prefix, path_map& paths,
+            std::vector<std::pair<const BTFShader*, std::string> >& shaders) {
+        vislib::ConstIterator<vislib::SingleLinkedList<vislib::SmartPtr<BTFElement> >::Iterator>
+            i = ns.Children().GetConstIterator();
+        while (i.HasNext()) {
+            const vislib::SmartPtr<BTFElement>& c = i.Next();
+            if (c.IsNull() || (paths.find(c.operator->()) != paths.end())) continue;
+            const std::string path = prefix.empty()
+                ? std::string(c->Name().PeekBuffer())
+                : prefix + "::" + c->Name().PeekBuffer();
+            paths[c.operator->()] = path;
+            const BTFShader* sh = dynamic_cast<const BTFShader*>(c.operator->());
+            const BTFNamespace* n = dynamic_cast<const BTFNamespace*>(c.operator->());
+            if (sh != nullptr) {
+                shaders.push_back(std::make_pair(sh, path));
+            } else if (n != nullptr) {
+                collectPaths(*n, path, paths, shaders);
+            }
+        }
+    }
+
+    void writeChildren(std::ostream& out, const BTFNamespace& parent, const std::string& parentPath,
+        const path_map& paths, bool inShader);
+
+    void writeElement(std::ostream& out, const vislib::SmartPtr<BTFElement>& e, const std::string& parentPath,
+            const path_map& paths, bool inShader) {
+        if (e.IsNull()) {
+            CacheFile::Write(out, static_cast<unsigned char>(TAG_NULL));
+            return;
+        }
+        const std::string ownPath = parentPath + "::" + e->Name().PeekBuffer();
+        auto p = paths.find(e.operator->());
+        if (inShader && (p != paths.end()) && (p->second != ownPath)) {
+            // defined elsewhere, so only the full name is stored.
+            CacheFile::Write(out, static_cast<unsigned char>(TAG_REFERENCE));
+            CacheFile::WriteString(out, p->second.c_str());
+            return;
+        }
+
+        const BTFShader* sh = dynamic_cast<const BTFShader*>(e.operator->());
+        const BTFNamespace* ns = dynamic_cast<const BTFNamespace*>(e.operator->());
+        const BTFSnippet* sn = dynamic_cast<const BTFSnippet*>(e.operator->());
+        if (sh != nullptr) {
+            CacheFile::Write(out, static_cast<unsigned char>(TAG_SHADER));
+            CacheFile::WriteString(out, e->Name().PeekBuffer());
+            CacheFile::Write(out, static_cast<UINT32>(sh->NameIDs().Count()));
+            auto ids = sh->NameIDs().GetConstIterator();
+            while (ids.HasNext()) {
+                auto& id = ids.Next();
+                CacheFile::WriteString(out, id.Key().PeekBuffer());
+                CacheFile::Write(out, static_cast<UINT32>(id.Value()));
+            }
+            writeChildren(out, *sh, ownPath, paths, true);
+        } else if (ns != nullptr) {
+            CacheFile::Write(out, static_cast<unsigned char>(TAG_NAMESPACE));
+            CacheFile::WriteString(out, e->Name().PeekBuffer());
+            writeChildren(out, *ns, ownPath, paths, false);
+        } else if (sn != nullptr) {
+            CacheFile::Write(out, static_cast<unsigned char>(TAG_SNIPPET));
+            CacheFile::WriteString(out, e->Name().PeekBuffer());
+            CacheFile::Write(out, static_cast<UINT32>(sn->Type()));
+            CacheFile::WriteString(out, sn->Content().PeekBuffer());
+            CacheFile::WriteString(out, sn->File().PeekBuffer());
+            CacheFile::Write(out, static_cast<UINT64>(sn->Line()));
+        } else {
+            CacheFile::Write(out, static_cast<unsigned char>(TAG_NULL));
+        }
+    }
+
+    void writeChildren(std::ostream& out, const BTFNamespace& parent, const std::string& parentPath,
+            const path_map& paths, bool inShader) {
+        CacheFile::Write(out, static_cast<UINT32>(parent.Children().Count()));
+        vislib::ConstIterator<vislib::SingleLinkedList<vislib::SmartPtr<BTFElement> >::Iterator>
+            i = parent.Children().GetConstIterator();
+        while (i.HasNext()) {
+            writeElement(out, i.Next(), parentPath, paths, inShader);
+        }
+    }
+
+    /**
+     * Finds an element by its full name.
+     */
+    vislib::SmartPtr<BTFElement> resolve(const BTFNamespace& masterRoot, const vislib::StringA& path) {
+        vislib::Array<vislib::StringA> namepath = vislib::StringTokeniserA::Split(path, "::");
+        vislib::SmartPtr<BTFElement> e;
+        for (SIZE_T i = 0; i < namepath.Count(); i++) {
+            const BTFNamespace* n = (i == 0) ? &masterRoot : e.DynamicCast<BTFNamespace>();
+            if (n == nullptr) return NULL;
+            e = n->FindChild(namepath[i]);
+            if (e.IsNull()) return NULL;
+        }
+        return e;
+    }
+
+    bool readChildren(std::istream& in, BTFNamespace& parent, const BTFNamespace& masterRoot) {
+        UINT32 cnt;
+        if (!CacheFile::Read(in, cnt)) return false;
+        for (UINT32 c = 0; c < cnt; ++c) {
+            unsigned char tag;
+            if (!CacheFile::Read(in, tag)) return false;
+            vislib::StringA name;
+
+            if (tag == TAG_NULL) {
+                parent.Children().Append(vislib::SmartPtr<BTFElement>());
+
+            } else if (tag == TAG_REFERENCE) {
+                if (!readString(in, name)) return false;
+                vislib::SmartPtr<BTFElement> e = resolve(masterRoot, name);
+                if (e.IsNull()) return false;
+                parent.Children().Append(e);
+
+            } else if (tag == TAG_NAMESPACE) {
+                if (!readString(in, name)) return false;
+                vislib::SmartPtr<BTFElement> e = new BTFNamespace(name);
+                parent.Children().Append(e);
+                if (!readChildren(in, *e.DynamicCast<BTFNamespace>(), masterRoot)) return false;
+
+            } else if (tag == TAG_SHADER) {
+                UINT32 idCnt;
+                if (!readString(in, name) || !CacheFile::Read(in, idCnt)) return false;
+                vislib::SmartPtr<BTFElement> e = new BTFShader(name);
+                BTFShader* sh = e.DynamicCast<BTFShader>();
+                for (UINT32 i = 0; i < idCnt; ++i) {
+                    vislib::StringA key;
+                    UINT32 value;
+                    if (!readString(in, key) || !CacheFile::Read(in, value)) return false;
+                    sh->NameIDs()[key] = value;
+                }
+                parent.Children().Append(e);
+                if (!readChildren(in, *sh, masterRoot)) return false;
+
+            } else if (tag == TAG_SNIPPET) {
+                UINT32 type;
+                vislib::StringA content, file;
+                UINT64 line;
+                if (!readString(in, name) || !CacheFile::Read(in, type) || !readString(in, content)
+                    || !readString(in, file) || !CacheFile::Read(in, line)) {
+                    return false;
+                }
+                BTFSnippet* s = new BTFSnippet(name);
+                s->SetType(static_cast<BTFSnippet::SnippetType>(type));
+                s->SetContent(content);
+                s->SetFile(file);
+                s->SetLine(static_cast<SIZE_T>(line));
+                parent.Children().Append(vislib::SmartPtr<BTFElement>(s));
+
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+} /* end namespace */
+
+
+/*
+ * utility::BTFCache::BTFCache
+ */
+utility::BTFCache::BTFCache(const vislib::StringW& directory) : directory(directory) {
+    // intentionally empty
+}
+
+
+/*
+ * utility::BTFCache::~BTFCache
+ */
+utility::BTFCache::~BTFCache(void) {
+    // intentionally empty
+}
+
+
+/*
+ * utility::BTFCache::Read
+ */
+bool utility::BTFCache::Read(const vislib::StringA& name, const vislib::StringW& btfFile,
+        const BTFParser::BTFNamespace& masterRoot, BTFParser::BTFNamespace& fileRoot,
+        const include_loader_type& loadInclude, double& parseMillis) const {
+    if (!this->IsEnabled()) return false;
+
+    std::ifstream in(vislib::StringA(this->cacheFile(name)).PeekBuffer(), std::ios::binary);
+    if (!in) return false;
+
+    if (!CacheFile::ReadHeader(in, CACHE_MAGIC, CACHE_VERSION, buildKey()) || !CacheFile::Read(in, parseMillis)) {
+        return false;
+    }
+
+    // the btf file itself comes first, followed by the snippet files.
+    UINT32 sourceCnt;
+    if (!CacheFile::Read(in, sourceCnt)) return false;
+    for (UINT32 i = 0; i < sourceCnt; ++i) {
+        vislib::StringA path;
+        UINT64 size, currentSize;
+        INT64 mtime, currentMtime;
+        if (!readString(in, path) || !CacheFile::Read(in, size) || !CacheFile::Read(in, mtime)) return false;
+        if ((i == 0) && !vislib::sys::Path::Compare(vislib::StringW(path), btfFile)) return false;
+        if (!CacheFile::FileStamp(vislib::StringW(path), currentSize, currentMtime)) return false;
+        if ((size != currentSize) || (mtime != currentMtime)) return false;
+    }
+
+    UINT32 includeCnt;
+    if (!CacheFile::Read(in, includeCnt)) return false;
+    for (UINT32 i = 0; i < includeCnt; ++i) {
+        vislib::StringA include;
+        if (!readString(in, include) || !loadInclude(include)) return false;
+    }
+
+    return readChildren(in, fileRoot, masterRoot) && CacheFile::ReadEnd(in);
+}
+
+
+/*
+ * utility::BTFCache::Write
+ */
+bool utility::BTFCache::Write(const vislib::StringA& name, const vislib::StringW& btfFile,
+        const BTFParser::BTFNamespace& masterRoot, const BTFParser::BTFNamespace& fileRoot,
+        const vislib::Array<vislib::StringA>& includes, const vislib::Array<vislib::StringA>& snippetFiles,
+        double parseMillis) const {
+    if (!this->IsEnabled()) return false;
+
+    vislib::Array<vislib::StringW> sources;
+    sources.Append(btfFile);
+    for (SIZE_T i = 0; i < snippetFiles.Count(); ++i) {
+        sources.Append(vislib::StringW(snippetFiles[i]));
+    }
+
+    const vislib::StringA cachePath(this->cacheFile(name));
+    std::ofstream out(cachePath.PeekBuffer(), std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+
+    CacheFile::WriteHeader(out, CACHE_MAGIC, CACHE_VERSION, buildKey());
+    CacheFile::Write(out, parseMillis);
+
+    CacheFile::Write(out, static_cast<UINT32>(sources.Count()));
+    for (SIZE_T i = 0; i < sources.Count(); ++i) {
+        UINT64 size;
+        INT64 mtime;
+        if (!CacheFile::FileStamp(sources[i], size, mtime)) {
+            // e.g. a missing snippet file, which is reported by the parser.
+            out.close();
+            vislib::sys::File::Delete(cachePath);
+            return false;
+        }
+        CacheFile::WriteString(out, vislib::StringA(sources[i]).PeekBuffer());
+        CacheFile::Write(out, size);
+        CacheFile::Write(out, mtime);
+    }
+
+    CacheFile::Write(out, static_cast<UINT32>(includes.Count()));
+    for (SIZE_T i = 0; i < includes.Count(); ++i) {
+        CacheFile::WriteString(out, includes[i].PeekBuffer());
+    }
+
+    path_map paths;
+    std::vector<std::pair<const BTFShader*, std::string> > shaders;
+    collectPaths(masterRoot, "", paths, shaders);
+    for (auto& s : shaders) {
+        vislib::ConstIterator<vislib::SingleLinkedList<vislib::SmartPtr<BTFElement> >::Iterator>
+            i = s.first->Children().GetConstIterator();
+        while (i.HasNext()) {
+            const vislib::SmartPtr<BTFElement>& c = i.Next();
+            if (c.IsNull() || c->Name().IsEmpty() || (paths.find(c.operator->()) != paths.end())) continue;
+            if (dynamic_cast<const BTFSnippet*>(c.operator->()) != nullptr) {
+                paths[c.operator->()] = s.second + "::" + c->Name().PeekBuffer();
+            }
+        }
+    }
+
+    writeChildren(out, fileRoot, name.PeekBuffer(), paths, false);
+    CacheFile::WriteEnd(out);
+    return static_cast<bool>(out);
+}
+
+
+/*
+ * utility::BTFCache::cacheFile
+ */
+vislib::StringW utility::BTFCache::cacheFile(const vislib::StringA& name) const {
+    vislib::StringW file = vislib::sys::Path::Concatenate(this->directory, vislib::StringW(name));
+    file.Append(L".btfc");
+    return file;
+}
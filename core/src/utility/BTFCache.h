@@ -0,0 +1,114 @@
+/*
+ * BTFCache.h
+ *
+ * Copyright (C) 2020 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+#ifndef MEGAMOLCORE_BTFCACHE_H_INCLUDED
+#define MEGAMOLCORE_BTFCACHE_H_INCLUDED
+#pragma once
+
+#include "mmcore/utility/BTFParser.h"
+#include "vislib/Array.h"
+#include "vislib/String.h"
+#include <functional>
+
+
+namespace megamol {
+namespace core {
+namespace utility {
+
+    /**
+     * Binary cache of parsed btf trees, one file per btf root namespace.
+     *
+     * A cache file is only used if it was written by the same cache version
+     * for the same machine and build configuration (the conditions a btf can
+     * test), and if the btf file and all files read for "file" snippets
+     * still have the recorded size and modification time. Elements shared
+     * with other btf trees, i.e. referenced snippets and shaders, are stored
+     * by their full name and resolved against the already loaded trees.
+     */
+    class BTFCache {
+    public:
+
+        /** The function loading an included btf by its root-namespace name */
+        typedef std::function<bool(const vislib::StringA&)> include_loader_type;
+
+        /**
+         * Ctor.
+         *
+         * @param directory The directory holding the cache files, or an
+         *                  empty string to disable the cache.
+         */
+        BTFCache(const vislib::StringW& directory);
+
+        /** Dtor. */
+        ~BTFCache(void);
+
+        /**
+         * Answer whether a cache directory is set.
+         *
+         * @return 'true' if the cache is used.
+         */
+        inline bool IsEnabled(void) const {
+            return !this->directory.IsEmpty();
+        }
+
+        /**
+         * Reads the cached tree of 'name' into 'fileRoot', which must already
+         * be a child of 'masterRoot' and must not have any children.
+         *
+         * @param name        The root-namespace name of the btf.
+         * @param btfFile     The btf file the cache must match.
+         * @param masterRoot  The namespace holding all loaded btf trees.
+         * @param fileRoot    Receives the cached elements.
+         * @param loadInclude Loads the btf files included by 'name'.
+         * @param parseMillis Receives the time parsing the btf file took
+         *                    when the cache was written.
+         *
+         * @return 'true' on success, 'false' if there is no valid cache file.
+         *         'fileRoot' may have been partially filled in that case.
+         */
+        bool Read(const vislib::StringA& name, const vislib::StringW& btfFile,
+            const BTFParser::BTFNamespace& masterRoot, BTFParser::BTFNamespace& fileRoot,
+            const include_loader_type& loadInclude, double& parseMillis) const;
+
+        /**
+         * Writes the tree of 'fileRoot' to the cache.
+         *
+         * @param name         The root-namespace name of the btf.
+         * @param btfFile      The parsed btf file.
+         * @param masterRoot   The namespace holding all loaded btf trees.
+         * @param fileRoot     The parsed tree.
+         * @param includes     The btf names included while parsing.
+         * @param snippetFiles The files read for "file" snippets.
+         * @param parseMillis  The time parsing took.
+         *
+         * @return 'true' on success, 'false' otherwise.
+         */
+        bool Write(const vislib::StringA& name, const vislib::StringW& btfFile,
+            const BTFParser::BTFNamespace& masterRoot, const BTFParser::BTFNamespace& fileRoot,
+            const vislib::Array<vislib::StringA>& includes, const vislib::Array<vislib::StringA>& snippetFiles,
+            double parseMillis) const;
+
+    private:
+
+        /**
+         * Answer the cache file of 'name'.
+         *
+         * @param name The root-namespace name of the btf.
+         *
+         * @return The cache file path.
+         */
+        vislib::StringW cacheFile(const vislib::StringA& name) const;
+
+        /** The cache directory */
+        vislib::StringW directory;
+
+    };
+
+} /* end namespace utility */
+} /* end namespace core */
+} /* end namespace megamol */
+
+#endif /* MEGAMOLCORE_BTFCACHE_H_INCLUDED */
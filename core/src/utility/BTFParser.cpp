@@ -33,7 +33,7 @@ unsigned int utility::BTFParser::XMLSTATE_CONTENT = XmlReader::STATE_USER + 50;
  */
 utility::BTFParser::BTFParser(ShaderSourceFactory& factory)
     : utility::xml::ConditionalParser(), factory(factory), root(),
-    stack() {
+    stack(), includes(), snippetFiles() {
     // intentionally empty
 }
 
@@ -60,6 +60,8 @@ void utility::BTFParser::SetRootElement(
 
     this->stack.Clear();
     this->stack.Push(masterroot);
+    this->includes.Clear();
+    this->snippetFiles.Clear();
 }
 
 
@@ -229,6 +231,7 @@ bool utility::BTFParser::StartTag(unsigned int num, unsigned int level,
                 this->FatalError(msg);
                 return true;
             }
+            this->includes.Append(vislib::StringA(filename));
         } else {
             this->Warning("\"include\" tag without \"file\" attribute ignored.");
         }
@@ -520,6 +523,7 @@ bool utility::BTFParser::EndTag(unsigned int num, unsigned int level,
                 if (!this->Reader().GetPath().IsEmpty()) {
                     auto path = this->Reader().GetPath();
                     std::ifstream infile(path + "/" + str);
+                    this->snippetFiles.Append(path + "/" + str);
                     if (infile.is_open()) {
                         std::stringstream cont;
                         cont << infile.rdbuf();
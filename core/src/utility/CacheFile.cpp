@@ -0,0 +1,133 @@
+/*
+ * CacheFile.cpp
+ *
+ * Copyright (C) 2020 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#include "stdafx.h"
+#include "mmcore/utility/CacheFile.h"
+#include <cstring>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+using namespace megamol::core;
+
+
+namespace {
+
+    /** Marks the end of a complete cache file */
+    const UINT32 CACHE_END = 0x454e4421;
+
+}
+
+
+/*
+ * utility::CacheFile::FileKey
+ */
+std::string utility::CacheFile::FileKey(const vislib::TString& path) {
+    std::string key(vislib::StringA(path).PeekBuffer());
+    UINT64 size;
+    INT64 mtime;
+    if (!FileStamp(vislib::StringW(path), size, mtime)) return key;
+    return key + "|" + std::to_string(size) + "|" + std::to_string(mtime);
+}
+
+
+/*
+ * utility::CacheFile::FileStamp
+ */
+bool utility::CacheFile::FileStamp(const vislib::StringW& path, UINT64& size, INT64& mtime) {
+#ifdef _WIN32
+    struct _stat64 st;
+    if (::_wstat64(path.PeekBuffer(), &st) != 0) return false;
+#else /* _WIN32 */
+    struct stat st;
+    if (::stat(vislib::StringA(path).PeekBuffer(), &st) != 0) return false;
+#endif /* _WIN32 */
+    size = static_cast<UINT64>(st.st_size);
+    mtime = static_cast<INT64>(st.st_mtime);
+    return true;
+}
+
+
+/*
+ * utility::CacheFile::ReadHeader
+ */
+bool utility::CacheFile::ReadHeader(std::istream& in, const char (&magic)[MAGIC_LENGTH], UINT32 version,
+        const std::string& key) {
+    char fileMagic[MAGIC_LENGTH];
+    UINT32 fileVersion, keyLen;
+    if (!in.read(fileMagic, MAGIC_LENGTH) || (::memcmp(fileMagic, magic, MAGIC_LENGTH) != 0)
+        || !Read(in, fileVersion) || (fileVersion != version)) {
+        return false;
+    }
+    // compare the length first, so a corrupt file cannot request a huge key
+    if (!Read(in, keyLen) || (keyLen != key.size())) return false;
+    std::string fileKey(keyLen, '\0');
+    return ((keyLen == 0) || in.read(&fileKey[0], keyLen)) && (fileKey == key);
+}
+
+
+/*
+ * utility::CacheFile::WriteHeader
+ */
+void utility::CacheFile::WriteHeader(std::ostream& out, const char (&magic)[MAGIC_LENGTH], UINT32 version,
+        const std::string& key) {
+    out.write(magic, MAGIC_LENGTH);
+    Write(out, version);
+    WriteString(out, key);
+}
+
+
+/*
+ * utility::CacheFile::ReadEnd
+ */
+bool utility::CacheFile::ReadEnd(std::istream& in) {
+    UINT32 end;
+    return Read(in, end) && (end == CACHE_END);
+}
+
+
+/*
+ * utility::CacheFile::WriteEnd
+ */
+void utility::CacheFile::WriteEnd(std::ostream& out) {
+    Write(out, CACHE_END);
+}
+
+
+/*
+ * utility::CacheFile::ReadString
+ */
+bool utility::CacheFile::ReadString(std::istream& in, std::string& str) {
+    UINT32 len;
+    if (!Read(in, len)) return false;
+    str.assign(len, '\0');
+    return (len == 0) || static_cast<bool>(in.read(&str[0], len));
+}
+
+
+/*
+ * utility::CacheFile::WriteString
+ */
+void utility::CacheFile::WriteString(std::ostream& out, const std::string& str) {
+    Write(out, static_cast<UINT32>(str.size()));
+    out.write(str.data(), str.size());
+}
+
+
+/*
+ * utility::CacheFile::CacheFile
+ */
+utility::CacheFile::CacheFile(void) {
+    // intentionally empty
+}
+
+
+/*
+ * utility::CacheFile::~CacheFile
+ */
+utility::CacheFile::~CacheFile(void) {
+    // intentionally empty
+}
@@ -11,6 +11,8 @@ using megamol::core::AbstractNamedObjectContainer;
 
 unsigned int megamol::core::utility::LuaHostService::ID = 0;
 
+const long megamol::core::utility::LuaHostService::pollTimeout = 100;
+
 megamol::core::utility::LuaHostService::LuaHostService(core::CoreInstance& core)
     : AbstractService(core), serverThread(), serverRunning(false), address("tcp://*:33333") {
     // Intentionally empty
@@ -142,13 +144,15 @@ void megamol::core::utility::LuaHostService::serve() {
 
         Log::DefaultLog.WriteInfo("LRH Server socket opened on \"%s\"", address.c_str());
 
+        zmq::pollitem_t items[] = {{static_cast<void*>(socket), 0, ZMQ_POLLIN, 0}};
         while (serverRunning) {
-            zmq::message_t request;
-            while (serverRunning && !socket.recv(&request, ZMQ_DONTWAIT)) {
-                // no messages available ATM
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            }
+            // block until a request arrives, but wake up regularly to check for shutdown
+            zmq::poll(items, 1, pollTimeout);
             if (!serverRunning) break;
+            if ((items[0].revents & ZMQ_POLLIN) == 0) continue;
+
+            zmq::message_t request;
+            if (!socket.recv(&request, ZMQ_DONTWAIT)) continue;
 
             std::string request_str(reinterpret_cast<char*>(request.data()), request.size());
             std::string reply = makeAnswer(request_str);
@@ -169,40 +173,46 @@ void megamol::core::utility::LuaHostService::serve() {
     Log::DefaultLog.WriteInfo("LRH Server socket closed");
 }
 
-void core::utility::LuaHostService::servePair() {
+void core::utility::LuaHostService::servePair(std::promise<int> port) {
     using vislib::sys::Log;
 
     auto socket = zmq::socket_t(*context, zmq::socket_type::pair);
-    socket.bind("tcp://*:0");
-    size_t len = 1024;
-    char* opts = new char[len];
-    socket.getsockopt(ZMQ_LAST_ENDPOINT, opts, &len);
-    std::string endp(opts);
-    delete[] opts;
-    const auto portPos = endp.find_last_of(":");
-    const auto portStr = endp.substr(portPos + 1, -1);
-    this->lastPairPort.store(std::atoi(portStr.c_str()));
+    try {
+        socket.bind("tcp://*:0");
+        size_t len = 1024;
+        char* opts = new char[len];
+        socket.getsockopt(ZMQ_LAST_ENDPOINT, opts, &len);
+        std::string endp(opts);
+        delete[] opts;
+        const auto portPos = endp.find_last_of(":");
+        const auto portStr = endp.substr(portPos + 1, -1);
+        port.set_value(std::atoi(portStr.c_str()));
+    } catch (std::exception& error) {
+        Log::DefaultLog.WriteError("Error on LRH Pair Server: %s", error.what());
+        port.set_value(0);
+        return;
+    }
 
     try {
+        zmq::pollitem_t items[] = {{static_cast<void*>(socket), 0, ZMQ_POLLIN, 0}};
+        std::vector<zmq::message_t> parts;
         while (serverRunning) {
-            zmq::message_t request;
             if (!socket.connected()) break;
-            while (serverRunning && !socket.recv(&request, ZMQ_DONTWAIT)) {
-                // no messages available ATM
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            }
+            zmq::poll(items, 1, pollTimeout);
             if (!serverRunning) break;
-
-            std::string request_str(reinterpret_cast<char*>(request.data()), request.size());
-            std::string reply = makePairAnswer(request_str);
-            const auto num_sent = socket.send(reply.data(), reply.size());
-#ifdef LRH_ANNOYING_DETAILS
-            if (num_sent == reply.size()) {
-                vislib::sys::Log::DefaultLog.WriteInfo("LRH: sending looks OK");
-            } else {
-                vislib::sys::Log::DefaultLog.WriteError("LRH: send failed");
+            if ((items[0].revents & ZMQ_POLLIN) == 0) continue;
+
+            // drain everything the client pipelined before polling again
+            while (serverRunning) {
+                parts.clear();
+                parts.emplace_back();
+                if (!socket.recv(&parts.back(), ZMQ_DONTWAIT)) break;
+                while (parts.back().more()) {
+                    parts.emplace_back();
+                    socket.recv(&parts.back());
+                }
+                answerPairMessage(socket, parts);
             }
-#endif
         }
 
     } catch (std::exception& error) {
@@ -219,19 +229,53 @@ void core::utility::LuaHostService::servePair() {
     Log::DefaultLog.WriteInfo("LRH Server socket closed");
 }
 
-std::string megamol::core::utility::LuaHostService::makeAnswer(const std::string& req) {
+void megamol::core::utility::LuaHostService::answerPairMessage(
+    zmq::socket_t& socket, std::vector<zmq::message_t>& parts) const {
+    if (parts.size() == 1) {
+        std::string request_str(reinterpret_cast<char*>(parts[0].data()), parts[0].size());
+        std::string reply = makePairAnswer(request_str);
+        const auto num_sent = socket.send(reply.data(), reply.size());
+#ifdef LRH_ANNOYING_DETAILS
+        if (num_sent == reply.size()) {
+            vislib::sys::Log::DefaultLog.WriteInfo("LRH: sending looks OK");
+        } else {
+            vislib::sys::Log::DefaultLog.WriteError("LRH: send failed");
+        }
+#endif
+        return;
+    }
 
-    if (req.empty()) return std::string("Null Command.");
+    if ((parts.size() % 2) != 0) {
+        vislib::sys::Log::DefaultLog.WriteError("LRH: batch request with %u parts is not a list of (id, script) pairs",
+            static_cast<unsigned int>(parts.size()));
+        const std::string reply("Error: batch requests must consist of (id, script) pairs");
+        socket.send(reply.data(), reply.size());
+        return;
+    }
 
-    int port;
-    this->lastPairPort.store(0);
+#ifdef LRH_ANNOYING_DETAILS
+    vislib::sys::Log::DefaultLog.WriteInfo(
+        "LRH: got batch of %u requests", static_cast<unsigned int>(parts.size() / 2));
+#endif
+    for (size_t i = 0; i < parts.size(); i += 2) {
+        std::string request_str(reinterpret_cast<char*>(parts[i + 1].data()), parts[i + 1].size());
+        std::string reply = makePairAnswer(request_str);
+        const bool last = (i + 2 == parts.size());
+        // echo the correlation id in front of the result
+        socket.send(parts[i], ZMQ_SNDMORE);
+        socket.send(reply.data(), reply.size(), last ? 0 : ZMQ_SNDMORE);
+    }
+}
 
-    this->pairThreads.emplace_back([&]() { this->servePair(); });
+std::string megamol::core::utility::LuaHostService::makeAnswer(const std::string& req) {
 
-    while ((port = this->lastPairPort.load()) == 0 && serverRunning) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-    }
+    if (req.empty()) return std::string("Null Command.");
 
+    std::promise<int> portPromise;
+    auto portFuture = portPromise.get_future();
+    this->pairThreads.emplace_back(
+        [this](std::promise<int> p) { this->servePair(std::move(p)); }, std::move(portPromise));
+    const int port = portFuture.get();
 
     vislib::sys::Log::DefaultLog.WriteInfo("LRH: generated PAIR socket on port %i", port);
     return std::to_string(port);
@@ -9,9 +9,12 @@
 #include "mmcore/utility/ShaderSourceFactory.h"
 #include "mmcore/utility/BTFParser.h"
 #include "mmcore/utility/xml/XmlReader.h"
+#include "utility/BTFCache.h"
 #include "vislib/StringTokeniser.h"
 #include "vislib/sys/Log.h"
 #include "vislib/sys/Path.h"
+#include <algorithm>
+#include <chrono>
 
 using namespace megamol::core;
 
@@ -47,7 +50,8 @@ const UINT32 utility::ShaderSourceFactory::FLAGS_DEFAULT_FLAGS
  * utility::ShaderSourceFactory::ShaderSourceFactory
  */
 utility::ShaderSourceFactory::ShaderSourceFactory(utility::Configuration& config)
-        : config(config), root(), fileIds() {
+        : config(config), root(), fileIds(), cache(), elements(), nestedMillis(0.0),
+        cacheHits(0), savedMillis(0.0) {
     // intentionally empty
 }
 
@@ -56,7 +60,7 @@ utility::ShaderSourceFactory::ShaderSourceFactory(utility::Configuration& config
  * utility::ShaderSourceFactory::~ShaderSourceFactory
  */
 utility::ShaderSourceFactory::~ShaderSourceFactory(void) {
-    // intentionally empty (ATM)
+    // intentionally empty (BTFCache is complete here)
 }
 
 
@@ -75,6 +79,7 @@ bool utility::ShaderSourceFactory::LoadBTF(const vislib::StringA & name, bool fo
         vislib::SmartPtr<utility::BTFParser::BTFElement> ptr = this->root.FindChild(name);
         if (!ptr.IsNull()) {
             this->root.Children().Remove(ptr);
+            this->elements.clear();
         }
     } else {
         if (!this->root.FindChild(name).IsNull()) {
@@ -125,42 +130,21 @@ bool utility::ShaderSourceFactory::LoadBTF(const vislib::StringA & name, bool fo
     }
 #endif /* _WIN32 && (DEBUG || _DEBUG) */
 
-    xml::XmlReader reader;
-    if (!reader.OpenFile(filename)) {
-        Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR,
-            "Unable to load btf \"%s\": cannot open file\n",
-            name.PeekBuffer());
-        return false;
-    }
-
     vislib::SmartPtr<BTFParser::BTFElement> fileroot = new BTFParser::BTFNamespace(name);
     this->root.Children().Add(fileroot);
 
-    BTFParser parser(*this);
-    parser.SetRootElement(fileroot, new ShallowBTFNamespace(this->root));
-
-    if (!parser.Parse(reader)) {
-
-        vislib::SingleLinkedList<vislib::StringA>::Iterator mi = parser.Messages();
-        while (mi.HasNext()) {
-            Log::DefaultLog.WriteMsg(Log::LEVEL_INFO, "Parser: %s",
-                mi.Next().PeekBuffer());
-        }
-
+    // the time of nested loads is accounted for by these loads.
+    const double outerNestedMillis = this->nestedMillis;
+    this->nestedMillis = 0.0;
+    const auto start = std::chrono::steady_clock::now();
+    const bool loaded = this->loadBTFTree(name, filename, fileroot);
+    const double millis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    this->nestedMillis = outerNestedMillis + millis;
+    if (!loaded) {
         this->root.Children().RemoveAll(fileroot);
-        Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR,
-            "Unable to load btf \"%s\": failed to parse\n",
-            name.PeekBuffer());
         return false;
     }
 
-    vislib::SingleLinkedList<vislib::StringA>::Iterator mi = parser.Messages();
-    while (mi.HasNext()) {
-        Log::DefaultLog.WriteMsg(Log::LEVEL_INFO, "Parser: %s",
-            mi.Next().PeekBuffer());
-    }
-    reader.CloseFile();
-
     if (this->fileIds.Find(name) == NULL) {
         this->fileIds.Append(name);
         Log::DefaultLog.WriteMsg(Log::LEVEL_INFO,
@@ -223,6 +207,87 @@ int utility::ShaderSourceFactory::fileNo(const vislib::StringA& name) {
 }
 
 
+/*
+ * utility::ShaderSourceFactory::loadBTFTree
+ */
+bool utility::ShaderSourceFactory::loadBTFTree(const vislib::StringA& name,
+        const vislib::StringW& filename, vislib::SmartPtr<BTFParser::BTFElement> fileroot) {
+    using vislib::sys::Log;
+    if (!this->cache) {
+        // the configuration is complete only after the constructor
+        this->cache.reset(new BTFCache(this->config.IsConfigValueSet("BTFCacheDir")
+            ? this->config.ConfigValue("BTFCacheDir") : vislib::StringW()));
+    }
+    BTFParser::BTFNamespace *fileNS = fileroot.DynamicCast<BTFParser::BTFNamespace>();
+
+    auto start = std::chrono::steady_clock::now();
+    double parseMillis = 0.0;
+    if (this->cache->Read(name, filename, this->root, *fileNS,
+            [this](const vislib::StringA& include) { return this->LoadBTF(include); }, parseMillis)) {
+        const double millis = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count() - this->nestedMillis;
+        this->cacheHits++;
+        this->savedMillis += (std::max)(parseMillis - millis, 0.0);
+        Log::DefaultLog.WriteMsg(Log::LEVEL_INFO + 50,
+            "BTF \"%s\" read from cache in %.2f ms instead of %.2f ms "
+            "(%u btf files, %.2f ms saved in total)\n", name.PeekBuffer(), millis, parseMillis,
+            this->cacheHits, this->savedMillis);
+        return true;
+    }
+    if (this->cache->IsEnabled()) {
+        Log::DefaultLog.WriteMsg(Log::LEVEL_INFO + 50,
+            "BTF \"%s\" not cached or cache outdated\n", name.PeekBuffer());
+        fileNS->Children().Clear();
+        this->nestedMillis = 0.0;
+        start = std::chrono::steady_clock::now();
+    }
+
+    xml::XmlReader reader;
+    if (!reader.OpenFile(filename)) {
+        Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR,
+            "Unable to load btf \"%s\": cannot open file\n",
+            name.PeekBuffer());
+        return false;
+    }
+
+    BTFParser parser(*this);
+    parser.SetRootElement(fileroot, new ShallowBTFNamespace(this->root));
+
+    if (!parser.Parse(reader)) {
+
+        vislib::SingleLinkedList<vislib::StringA>::Iterator mi = parser.Messages();
+        while (mi.HasNext()) {
+            Log::DefaultLog.WriteMsg(Log::LEVEL_INFO, "Parser: %s",
+                mi.Next().PeekBuffer());
+        }
+
+        Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR,
+            "Unable to load btf \"%s\": failed to parse\n",
+            name.PeekBuffer());
+        return false;
+    }
+
+    vislib::SingleLinkedList<vislib::StringA>::Iterator mi = parser.Messages();
+    while (mi.HasNext()) {
+        Log::DefaultLog.WriteMsg(Log::LEVEL_INFO, "Parser: %s",
+            mi.Next().PeekBuffer());
+    }
+    reader.CloseFile();
+
+    if (this->cache->IsEnabled()) {
+        parseMillis = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count() - this->nestedMillis;
+        if (!this->cache->Write(name, filename, this->root, *fileNS,
+                parser.IncludedBTFs(), parser.SnippetFiles(), parseMillis)) {
+            Log::DefaultLog.WriteMsg(Log::LEVEL_WARN,
+                "Unable to write btf \"%s\" to the cache\n", name.PeekBuffer());
+        }
+    }
+
+    return true;
+}
+
+
 /*
  * utility::ShaderSourceFactory::getBTFElement
  */
@@ -240,12 +305,20 @@ utility::ShaderSourceFactory::getBTFElement(const vislib::StringA& name) {
         return NULL;
     }
     if (!this->LoadBTF(namepath[0])) return NULL;
+
+    const std::string key(name.PeekBuffer() + (name.StartsWith("::") ? 2 : 0));
+    auto known = this->elements.find(key);
+    if (known != this->elements.end()) return known->second;
+
     vislib::SmartPtr<BTFParser::BTFElement> e = this->root.FindChild(namepath[0]);
     for (SIZE_T i = 1; i < namepath.Count(); i++) {
         if (e.IsNull()) return NULL;
         if (e.DynamicCast<BTFParser::BTFNamespace>() == NULL) return NULL;
         e = e.DynamicCast<BTFParser::BTFNamespace>()->FindChild(namepath[i]);
     }
+    if (!e.IsNull()) {
+        this->elements[key] = e;
+    }
     return e;
 }
 
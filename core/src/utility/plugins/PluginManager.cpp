@@ -12,10 +12,17 @@
 #include "utility/plugins/Plugin100Instance.h"
 #include "mmcore/utility/plugins/Plugin200Instance.h"
 #include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+#include <sys/types.h>
 #include "vislib/String.h"
 #include "mmcore/versioninfo.h"
 #include "vislib/VersionNumber.h"
 #include "vislib/vislibversion.h"
+#include "vislib/sys/File.h"
 
 using namespace megamol::core;
 using namespace megamol::core::utility::plugins;
@@ -24,7 +31,7 @@ using namespace megamol::core::utility::plugins;
 /*
  * PluginManager::PluginManager
  */
-PluginManager::PluginManager(void) : plugins() {
+PluginManager::PluginManager(void) : plugins(), loadedFiles(), loadTimes(), providers() {
 }
 
 
@@ -49,14 +56,9 @@ PluginManager::~PluginManager(void) {
 
 
 /*
- * PluginManager::LoadPlugin
+ * PluginManager::OpenLibrary
  */
-PluginManager::collection_type PluginManager::LoadPlugin(
-        const std::basic_string<TCHAR>& filename,
-        ::megamol::core::CoreInstance& coreInst) {
-    PluginManager::collection_type rv;
-
-    // load plugin assembly
+std::shared_ptr<vislib::sys::DynamicLinkLibrary> PluginManager::OpenLibrary(const filename_type& filename) {
     std::shared_ptr<vislib::sys::DynamicLinkLibrary> plugin_asm = std::make_shared<vislib::sys::DynamicLinkLibrary>();
     if (!plugin_asm->Load(filename.c_str())) {
         vislib::StringA msg;
@@ -64,6 +66,28 @@ PluginManager::collection_type PluginManager::LoadPlugin(
             plugin_asm->LastLoadErrorMessage().PeekBuffer());
         throw vislib::Exception(msg.PeekBuffer(), __FILE__, __LINE__);
     }
+    return plugin_asm;
+}
+
+
+/*
+ * PluginManager::LoadPlugin
+ */
+PluginManager::collection_type PluginManager::LoadPlugin(
+        const std::basic_string<TCHAR>& filename,
+        ::megamol::core::CoreInstance& coreInst,
+        std::shared_ptr<vislib::sys::DynamicLinkLibrary> lib) {
+    PluginManager::collection_type rv;
+
+    // load plugin assembly
+    std::shared_ptr<vislib::sys::DynamicLinkLibrary> plugin_asm = lib;
+    if (!plugin_asm) {
+        const auto openStart = std::chrono::high_resolution_clock::now();
+        plugin_asm = OpenLibrary(filename);
+        this->AddLoadTime(filename, LoadPhase::OPEN,
+            std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - openStart).count());
+    }
+    const auto instantiateStart = std::chrono::high_resolution_clock::now();
 
     // search for api entry
     int (*mmplgPluginAPIVersion)(void) = function_cast<int (*)()>(plugin_asm->GetProcAddress("mmplgPluginAPIVersion"));
@@ -93,11 +117,149 @@ PluginManager::collection_type PluginManager::LoadPlugin(
     }
 
     for (auto p : rv) this->plugins.push_back(p);
+    this->loadedFiles[filename] = rv;
+    this->AddLoadTime(filename, LoadPhase::INSTANTIATE,
+        std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - instantiateStart).count());
 
     return rv;
 }
 
 
+/*
+ * PluginManager::AddLoadTime
+ */
+void PluginManager::AddLoadTime(const filename_type& filename, LoadPhase phase, double millis) {
+    this->loadTimes[filename].millis[static_cast<int>(phase)] += millis;
+}
+
+
+/*
+ * PluginManager::WriteLoadReport
+ */
+void PluginManager::WriteLoadReport(vislib::sys::Log& log, double wallMillis) const {
+    std::vector<std::pair<double, const filename_type*>> order;
+    double totals[3] = {0.0, 0.0, 0.0};
+    for (auto& t : this->loadTimes) {
+        order.push_back(std::make_pair(t.second.millis[0] + t.second.millis[1] + t.second.millis[2], &t.first));
+        for (int p = 0; p < 3; ++p) totals[p] += t.second.millis[p];
+    }
+    std::sort(order.begin(), order.end(), [](const std::pair<double, const filename_type*>& l,
+        const std::pair<double, const filename_type*>& r) { return l.first > r.first; });
+
+    log.WriteInfo("Plugin startup took %.1f ms for %u plugin files (open %.1f ms, instantiate %.1f ms, "
+        "register %.1f ms summed over all plugins):", wallMillis, static_cast<unsigned int>(order.size()),
+        totals[0], totals[1], totals[2]);
+    for (auto& o : order) {
+        const LoadTimes& t = this->loadTimes.find(*o.second)->second;
+        log.WriteInfo("    %8.1f ms  (open %8.1f, instantiate %8.1f, register %8.1f)  %s", o.first, t.millis[0],
+            t.millis[1], t.millis[2], vislib::StringA(o.second->c_str()).PeekBuffer());
+    }
+}
+
+
+namespace {
+
+    /**
+     * Answer the size and modification time of a plugin file, which identify
+     * its build in the manifest.
+     */
+    std::string fileStamp(const megamol::core::utility::plugins::PluginManager::filename_type& path) {
+#ifdef _WIN32
+        struct _stat64 st;
+        if (::_wstat64(vislib::StringW(path.c_str()).PeekBuffer(), &st) != 0) return std::string();
+#else /* _WIN32 */
+        struct stat st;
+        if (::stat(vislib::StringA(path.c_str()).PeekBuffer(), &st) != 0) return std::string();
+#endif /* _WIN32 */
+        return std::to_string(static_cast<unsigned long long>(st.st_size)) + " "
+            + std::to_string(static_cast<long long>(st.st_mtime));
+    }
+
+} /* end namespace */
+
+
+/*
+ * PluginManager::ReadManifest
+ */
+bool PluginManager::ReadManifest(const filename_type& path, const std::vector<filename_type>& files) {
+    this->providers.clear();
+
+    std::ifstream in(vislib::StringA(path.c_str()).PeekBuffer());
+    std::string line;
+    if (!in || !std::getline(in, line) || (line != "MegaMolPluginManifest 2")) return false;
+
+    std::vector<filename_type> listed;
+    std::map<std::string, filename_type> read;
+    while (std::getline(in, line)) {
+        std::istringstream tokens(line);
+        std::string kind;
+        tokens >> kind;
+        if (kind == "plugin") {
+            // plugin <size> <mtime> <path>, where the path may contain blanks
+            std::string size, mtime, file;
+            tokens >> size >> mtime;
+            std::getline(tokens >> std::ws, file);
+            listed.push_back(filename_type(vislib::TString(file.c_str()).PeekBuffer()));
+            const std::string stamp = fileStamp(listed.back());
+            if (stamp.empty() || (stamp != size + " " + mtime)) return false;
+
+        } else if (((kind == "module") || (kind == "call")) && !listed.empty()) {
+            std::string name;
+            tokens >> name;
+            read[providerKey(name.c_str())] = listed.back();
+        }
+    }
+
+    std::vector<filename_type> expected(files);
+    std::sort(expected.begin(), expected.end());
+    std::sort(listed.begin(), listed.end());
+    if (expected != listed) return false;
+
+    this->providers.swap(read);
+    return true;
+}
+
+
+/*
+ * PluginManager::WriteManifest
+ */
+bool PluginManager::WriteManifest(const filename_type& path) const {
+    std::ofstream out(vislib::StringA(path.c_str()).PeekBuffer(), std::ios::trunc);
+    if (!out) return false;
+
+    out << "MegaMolPluginManifest 2\n";
+    for (auto& f : this->loadedFiles) {
+        out << "plugin " << fileStamp(f.first) << " " << vislib::StringA(f.first.c_str()).PeekBuffer() << "\n";
+        for (auto& p : f.second) {
+            for (auto& md : p->GetModuleDescriptionManager()) out << "module " << md->ClassName() << "\n";
+            for (auto& cd : p->GetCallDescriptionManager()) out << "call " << cd->ClassName() << "\n";
+        }
+    }
+    return static_cast<bool>(out);
+}
+
+
+/*
+ * PluginManager::FindProvider
+ */
+PluginManager::filename_type PluginManager::FindProvider(const char *classname) const {
+    auto i = this->providers.find(providerKey(classname));
+    return (i != this->providers.end()) ? i->second : filename_type();
+}
+
+
+/*
+ * PluginManager::providerKey
+ */
+std::string PluginManager::providerKey(const char *classname) {
+    std::string key((classname != nullptr) ? classname : "");
+    for (char& c : key) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return key;
+}
+
+
 namespace {
     void throw_exception(const char *msg, const char *file, unsigned int line) {
         throw vislib::Exception(msg, file, line);
@@ -12,6 +12,8 @@
 #include <vector>
 #include "vislib/tchar.h"
 #include "vislib/sys/DynamicLinkLibrary.h"
+#include "vislib/sys/Log.h"
+#include <map>
 #include <string>
 
 
@@ -39,6 +41,29 @@ namespace plugins {
         /** Type of list managing loaded plugins */
         typedef std::vector<plugin_ptr_type> collection_type;
 
+        /** Type of plugin file names */
+        typedef std::basic_string<TCHAR> filename_type;
+
+        /** The phases of loading a plugin reported by WriteLoadReport */
+        enum class LoadPhase {
+            OPEN = 0,       //< loading the library, including its static initialisation
+            INSTANTIATE,    //< compatibility check and creation of the plugin instance
+            REGISTER        //< registration of its descriptions at the core instance
+        };
+
+        /**
+         * Loads the library of a plugin file without touching any state, so
+         * several libraries can be opened concurrently. The result can be
+         * passed to LoadPlugin.
+         *
+         * @param filename The path to the plugin file to load
+         *
+         * @return The loaded library
+         *
+         * @throw vislib::Exception in case of an error.
+         */
+        static std::shared_ptr<vislib::sys::DynamicLinkLibrary> OpenLibrary(const filename_type& filename);
+
         /** Ctor. */
         PluginManager(void);
 
@@ -51,6 +76,8 @@ namespace plugins {
          * @param filename The path to the plugin file to load
          * @param coreInst The CoreInstance calling. This must always be the
          *                 same object!
+         * @param lib      The library of 'filename' if it already has been
+         *                 opened by OpenLibrary, or nullptr.
          *
          * @return A collection of pointers to all newly loaded plugins. This
          *         collection at least holds the requested plugin, but might
@@ -59,7 +86,69 @@ namespace plugins {
          * @throw std::exception in case of an error.
          */
         collection_type LoadPlugin(const std::basic_string<TCHAR>& filename,
-            ::megamol::core::CoreInstance& coreInst);
+            ::megamol::core::CoreInstance& coreInst,
+            std::shared_ptr<vislib::sys::DynamicLinkLibrary> lib = nullptr);
+
+        /**
+         * Adds to the time spent in one phase of loading a plugin.
+         *
+         * @param filename The plugin file
+         * @param phase    The phase
+         * @param millis   The time in milliseconds
+         */
+        void AddLoadTime(const filename_type& filename, LoadPhase phase, double millis);
+
+        /**
+         * Writes the time spent per plugin and phase to 'log', slowest plugin
+         * first.
+         *
+         * @param log        The log to write to
+         * @param wallMillis The wall clock time of loading all plugins
+         */
+        void WriteLoadReport(vislib::sys::Log& log, double wallMillis) const;
+
+        /**
+         * Reads a manifest written by WriteManifest. The manifest is only
+         * accepted if it lists exactly 'files' with unchanged sizes and
+         * modification times.
+         *
+         * @param path  The manifest file
+         * @param files The plugin files to be loaded
+         *
+         * @return true if the manifest is valid for 'files'.
+         */
+        bool ReadManifest(const filename_type& path, const std::vector<filename_type>& files);
+
+        /**
+         * Writes which plugin file provides which module and call class for
+         * all loaded plugins, for lazy loading by later runs.
+         *
+         * @param path The manifest file
+         *
+         * @return true on success.
+         */
+        bool WriteManifest(const filename_type& path) const;
+
+        /**
+         * Answer the plugin file providing a module or call class according to
+         * the manifest read last.
+         *
+         * @param classname The module or call class name
+         *
+         * @return The plugin file or an empty string if unknown.
+         */
+        filename_type FindProvider(const char *classname) const;
+
+        /**
+         * Answer whether the plugin file 'filename' has been loaded.
+         *
+         * @param filename The plugin file
+         *
+         * @return true if it has been loaded.
+         */
+        inline bool IsLoaded(const filename_type& filename) const {
+            return this->loadedFiles.find(filename) != this->loadedFiles.end();
+        }
 
         /**
          * Answer the collection of loaded plugins
@@ -95,9 +184,26 @@ namespace plugins {
             CoreInstance& coreInst);
 
 
+        /** The time of each phase per plugin file in milliseconds */
+        struct LoadTimes {
+            double millis[3] = {0.0, 0.0, 0.0};
+        };
+
+        /** Answer the key of a class name in 'providers' */
+        static std::string providerKey(const char *classname);
+
         /** The loaded plugins */
         collection_type plugins;
 
+        /** The plugins loaded from each file */
+        std::map<filename_type, collection_type> loadedFiles;
+
+        /** The load times per plugin file */
+        std::map<filename_type, LoadTimes> loadTimes;
+
+        /** The plugin file providing each lower-case class name, read from the manifest */
+        std::map<std::string, filename_type> providers;
+
     };
 
 } /* end namespace plugins */
@@ -0,0 +1,551 @@
+#include "stdafx.h"
+#include "BarnesHutTSNE.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <random>
+#include <tuple>
+
+using namespace megamol;
+using namespace megamol::infovis;
+
+
+namespace {
+
+/** Iterations with exaggerated input similarities */
+const int STOP_LYING_ITER = 250;
+
+/** Iteration switching from initial to final momentum */
+const int MOMENTUM_SWITCH_ITER = 250;
+
+/** The early exaggeration factor */
+const double EXAGGERATION = 12.0;
+
+/** The learning rate */
+const double ETA = 200.0;
+
+/** The depth of the space-partitioning tree beyond which points are not separated any more */
+const int MAX_TREE_DEPTH = 32;
+
+/** The number of points below which a cell of the space-partitioning tree is not split */
+const size_t MAX_LEAF_SIZE = 4;
+
+/**
+ * Vantage-point tree for the nearest neighbours of the input rows.
+ */
+class VpTree {
+public:
+    VpTree(const double* data, size_t rows, size_t columns, std::mt19937& rng)
+        : data(data), columns(columns), index(rows) {
+        for (size_t i = 0; i < rows; ++i) index[i] = static_cast<uint32_t>(i);
+        this->nodes.reserve(rows);
+        this->build(0, rows, rng);
+    }
+
+    /** Answers the k nearest neighbours of row 'row' except 'row' itself, closest first, with their distances */
+    void Search(size_t row, size_t k, std::vector<uint32_t>& neighbours, std::vector<double>& distances) const {
+        std::priority_queue<std::pair<double, uint32_t>> heap;
+        double tau = std::numeric_limits<double>::max();
+        this->search(0, row, k + 1, heap, tau);
+
+        neighbours.clear();
+        distances.clear();
+        while (!heap.empty()) {
+            if (heap.top().second != row) {
+                neighbours.push_back(heap.top().second);
+                distances.push_back(heap.top().first);
+            }
+            heap.pop();
+        }
+        std::reverse(neighbours.begin(), neighbours.end());
+        std::reverse(distances.begin(), distances.end());
+        if (neighbours.size() > k) {
+            neighbours.resize(k);
+            distances.resize(k);
+        }
+    }
+
+private:
+    struct Node {
+        uint32_t point;
+        double threshold;
+        int64_t left;
+        int64_t right;
+    };
+
+    double distance(size_t a, size_t b) const {
+        double d = 0.0;
+        for (size_t c = 0; c < this->columns; ++c) {
+            const double diff = this->data[a * this->columns + c] - this->data[b * this->columns + c];
+            d += diff * diff;
+        }
+        return std::sqrt(d);
+    }
+
+    int64_t build(size_t lo, size_t hi, std::mt19937& rng) {
+        if (lo >= hi) return -1;
+        const int64_t node = static_cast<int64_t>(this->nodes.size());
+        this->nodes.push_back(Node{0, 0.0, -1, -1});
+
+        std::swap(this->index[lo], this->index[lo + rng() % (hi - lo)]);
+        const uint32_t vantage = this->index[lo];
+        this->nodes[node].point = vantage;
+        if (hi - lo > 1) {
+            const size_t median = (lo + 1 + hi) / 2;
+            std::nth_element(this->index.begin() + lo + 1, this->index.begin() + median, this->index.begin() + hi,
+                [this, vantage](uint32_t a, uint32_t b) { return this->distance(vantage, a) < this->distance(vantage, b); });
+            this->nodes[node].threshold = this->distance(vantage, this->index[median]);
+            const int64_t left = this->build(lo + 1, median, rng);
+            const int64_t right = this->build(median, hi, rng);
+            this->nodes[node].left = left;
+            this->nodes[node].right = right;
+        }
+        return node;
+    }
+
+    void search(int64_t node, size_t row, size_t k, std::priority_queue<std::pair<double, uint32_t>>& heap,
+        double& tau) const {
+        if (node < 0) return;
+        const Node& n = this->nodes[node];
+        const double d = this->distance(n.point, row);
+        if (d < tau) {
+            if (heap.size() == k) heap.pop();
+            heap.push(std::make_pair(d, n.point));
+            if (heap.size() == k) tau = heap.top().first;
+        }
+        if ((n.left < 0) && (n.right < 0)) return;
+        if (d < n.threshold) {
+            if (d - tau <= n.threshold) this->search(n.left, row, k, heap, tau);
+            if (d + tau >= n.threshold) this->search(n.right, row, k, heap, tau);
+        } else {
+            if (d + tau >= n.threshold) this->search(n.right, row, k, heap, tau);
+            if (d - tau <= n.threshold) this->search(n.left, row, k, heap, tau);
+        }
+    }
+
+    const double* data;
+    size_t columns;
+    std::vector<uint32_t> index;
+    std::vector<Node> nodes;
+};
+
+} // namespace
+
+
+/**
+ * Space-partitioning tree (quadtree in 2D, octree in 3D) storing the number
+ * of points and their centre of mass per cell. The root is split first,
+ * the subtrees below are then built concurrently.
+ */
+class megamol::infovis::BarnesHutTSNE::SPTree {
+public:
+    SPTree(const std::vector<double>& y, size_t rows, int dims)
+        : y(y), dims(dims), childCount(size_t(1) << dims), index(rows), subtrees(childCount) {
+        for (size_t i = 0; i < rows; ++i) this->index[i] = static_cast<uint32_t>(i);
+
+        std::vector<double> minCorner(dims, std::numeric_limits<double>::max());
+        std::vector<double> maxCorner(dims, std::numeric_limits<double>::lowest());
+        for (size_t i = 0; i < rows; ++i) {
+            for (int d = 0; d < dims; ++d) {
+                minCorner[d] = (std::min)(minCorner[d], y[i * dims + d]);
+                maxCorner[d] = (std::max)(maxCorner[d], y[i * dims + d]);
+            }
+        }
+        std::vector<double> center(dims), half(dims);
+        for (int d = 0; d < dims; ++d) {
+            center[d] = 0.5 * (minCorner[d] + maxCorner[d]);
+            half[d] = 0.5 * (maxCorner[d] - minCorner[d]) + 1e-5;
+        }
+
+        std::vector<size_t> childBegin;
+        this->partition(0, rows, center.data(), childBegin);
+        const int64_t cnt = static_cast<int64_t>(this->childCount);
+#pragma omp parallel for schedule(dynamic)
+        for (int64_t c = 0; c < cnt; ++c) {
+            if (childBegin[c] == childBegin[c + 1]) continue;
+            std::vector<double> childCenter(dims), childHalf(dims);
+            this->childCell(center.data(), half.data(), static_cast<size_t>(c), childCenter.data(), childHalf.data());
+            this->build(this->subtrees[c], childBegin[c], childBegin[c + 1], childCenter.data(), childHalf.data(), 1);
+        }
+    }
+
+    /**
+     * Adds the unnormalised repulsive force on 'point' to 'neg' and answers
+     * the contribution of 'point' to the normalisation sum.
+     */
+    double ComputeNonEdgeForces(size_t point, double theta, double* neg) const {
+        const double* p = &this->y[point * this->dims];
+        double sumQ = 0.0;
+        std::vector<int64_t> stack;
+        for (const Subtree& s : this->subtrees) {
+            if (s.nodes.empty()) continue;
+            stack.push_back(0);
+            while (!stack.empty()) {
+                const int64_t n = stack.back();
+                stack.pop_back();
+                const Node& node = s.nodes[n];
+                const double* com = &s.com[n * this->dims];
+
+                // the cell is summarised if it is small enough as seen from 'point'
+                double d2 = 0.0;
+                for (int d = 0; d < this->dims; ++d) d2 += (p[d] - com[d]) * (p[d] - com[d]);
+                if ((d2 > 0.0) && (node.width * node.width < theta * theta * d2)) {
+                    this->addForce(p, com, static_cast<double>(node.end - node.begin), neg, sumQ);
+                } else if (node.firstChild < 0) {
+                    for (size_t i = node.begin; i < node.end; ++i) {
+                        if (this->index[i] == point) continue;
+                        this->addForce(p, &this->y[this->index[i] * this->dims], 1.0, neg, sumQ);
+                    }
+                } else {
+                    for (size_t c = 0; c < this->childCount; ++c) {
+                        const int64_t child = s.children[node.firstChild + c];
+                        if (child >= 0) stack.push_back(child);
+                    }
+                }
+            }
+        }
+        return sumQ;
+    }
+
+private:
+    /** A cell of the tree, holding the points index[begin, end), with its half width as in bhtsne */
+    struct Node {
+        size_t begin;
+        size_t end;
+        double width;
+        int64_t firstChild;
+    };
+
+    /** The cells below one child of the root */
+    struct Subtree {
+        std::vector<Node> nodes;
+        std::vector<double> com;
+        std::vector<int64_t> children;
+    };
+
+    void addForce(const double* p, const double* q, double count, double* neg, double& sumQ) const {
+        double d2 = 0.0;
+        for (int d = 0; d < this->dims; ++d) d2 += (p[d] - q[d]) * (p[d] - q[d]);
+        const double qij = 1.0 / (1.0 + d2);
+        const double mult = count * qij;
+        sumQ += mult;
+        for (int d = 0; d < this->dims; ++d) neg[d] += mult * qij * (p[d] - q[d]);
+    }
+
+    int64_t build(Subtree& s, size_t begin, size_t end, const double* center, const double* half, int depth) {
+        const int64_t n = static_cast<int64_t>(s.nodes.size());
+        double width = 0.0;
+        for (int d = 0; d < this->dims; ++d) width = (std::max)(width, half[d]);
+        s.nodes.push_back(Node{begin, end, width, -1});
+        s.com.resize(s.com.size() + this->dims, 0.0);
+        for (size_t i = begin; i < end; ++i) {
+            for (int d = 0; d < this->dims; ++d) s.com[n * this->dims + d] += this->y[this->index[i] * this->dims + d];
+        }
+        for (int d = 0; d < this->dims; ++d) s.com[n * this->dims + d] /= static_cast<double>(end - begin);
+
+        if ((end - begin <= MAX_LEAF_SIZE) || (depth >= MAX_TREE_DEPTH)) return n;
+
+        std::vector<size_t> childBegin;
+        this->partition(begin, end, center, childBegin);
+        const int64_t firstChild = static_cast<int64_t>(s.children.size());
+        s.children.resize(s.children.size() + this->childCount, -1);
+        s.nodes[n].firstChild = firstChild;
+        std::vector<double> childCenter(this->dims), childHalf(this->dims);
+        for (size_t c = 0; c < this->childCount; ++c) {
+            if (childBegin[c] == childBegin[c + 1]) continue;
+            this->childCell(center, half, c, childCenter.data(), childHalf.data());
+            const int64_t child =
+                this->build(s, childBegin[c], childBegin[c + 1], childCenter.data(), childHalf.data(), depth + 1);
+            s.children[firstChild + c] = child;
+        }
+        return n;
+    }
+
+    void childCell(
+        const double* center, const double* half, size_t child, double* childCenter, double* childHalf) const {
+        for (int d = 0; d < this->dims; ++d) {
+            childHalf[d] = 0.5 * half[d];
+            childCenter[d] = center[d] + (((child >> d) & 1) ? childHalf[d] : -childHalf[d]);
+        }
+    }
+
+    /** Sorts index[begin, end) by the child cell around 'center' and answers where each child starts */
+    void partition(size_t begin, size_t end, const double* center, std::vector<size_t>& childBegin) {
+        std::vector<size_t> code(end - begin);
+        std::vector<size_t> counts(this->childCount, 0);
+        for (size_t i = begin; i < end; ++i) {
+            size_t c = 0;
+            for (int d = 0; d < this->dims; ++d) {
+                if (this->y[this->index[i] * this->dims + d] > center[d]) c |= size_t(1) << d;
+            }
+            code[i - begin] = c;
+            ++counts[c];
+        }
+        childBegin.assign(this->childCount + 1, begin);
+        for (size_t c = 0; c < this->childCount; ++c) childBegin[c + 1] = childBegin[c] + counts[c];
+        std::vector<size_t> pos(childBegin.begin(), childBegin.end() - 1);
+        std::vector<uint32_t> sorted(end - begin);
+        for (size_t i = begin; i < end; ++i) sorted[pos[code[i - begin]]++ - begin] = this->index[i];
+        std::copy(sorted.begin(), sorted.end(), this->index.begin() + begin);
+    }
+
+    const std::vector<double>& y;
+    int dims;
+    size_t childCount;
+    std::vector<uint32_t> index;
+    std::vector<Subtree> subtrees;
+};
+
+
+BarnesHutTSNE::BarnesHutTSNE(int outputDims, double perplexity, double theta, int seed)
+    : outputDims(outputDims), perplexity(perplexity), seed(seed), theta(theta) {}
+
+
+bool BarnesHutTSNE::Run(const std::vector<double>& data, size_t rows, size_t columns, int maxIter,
+    int publishInterval, const std::atomic<bool>& cancel, const progress_callback& progress) {
+    if ((rows < 2) || (columns == 0) || (this->outputDims <= 0)) return false;
+
+    // zero mean, scaled into [-1, 1] like bhtsne does
+    std::vector<double> x(data.begin(), data.begin() + rows * columns);
+    double maxAbs = 0.0;
+    for (size_t c = 0; c < columns; ++c) {
+        double mean = 0.0;
+        for (size_t r = 0; r < rows; ++r) mean += x[r * columns + c];
+        mean /= static_cast<double>(rows);
+        for (size_t r = 0; r < rows; ++r) {
+            x[r * columns + c] -= mean;
+            maxAbs = (std::max)(maxAbs, std::abs(x[r * columns + c]));
+        }
+    }
+    if (maxAbs > 0.0) {
+        for (double& v : x) v /= maxAbs;
+    }
+
+    Similarities p;
+    if (!this->computeInputSimilarities(x, rows, columns, cancel, p)) return false;
+    for (double& v : p.value) v *= EXAGGERATION;
+
+    const size_t dims = static_cast<size_t>(this->outputDims);
+    std::mt19937 rng(this->seed < 0 ? static_cast<unsigned int>(
+                                          std::chrono::high_resolution_clock::now().time_since_epoch().count())
+                                    : static_cast<unsigned int>(this->seed));
+    std::normal_distribution<double> gauss(0.0, 1.0);
+    std::vector<double> y(rows * dims);
+    for (double& v : y) v = gauss(rng) * 1e-4;
+    std::vector<double> dy(rows * dims), uy(rows * dims, 0.0), gains(rows * dims, 1.0);
+
+    if (progress) progress(y, 0);
+
+    const int64_t cnt = static_cast<int64_t>(rows * dims);
+    for (int iter = 0; iter < maxIter; ++iter) {
+        if (cancel) return false;
+        if (iter == STOP_LYING_ITER) {
+            for (double& v : p.value) v /= EXAGGERATION;
+        }
+        const double momentum = (iter < MOMENTUM_SWITCH_ITER) ? 0.5 : 0.8;
+
+        this->computeGradient(p, y, rows, dy);
+
+#pragma omp parallel for
+        for (int64_t i = 0; i < cnt; ++i) {
+            gains[i] = ((dy[i] > 0.0) != (uy[i] > 0.0)) ? gains[i] + 0.2 : gains[i] * 0.8;
+            if (gains[i] < 0.01) gains[i] = 0.01;
+            uy[i] = momentum * uy[i] - ETA * gains[i] * dy[i];
+            y[i] += uy[i];
+        }
+
+        for (size_t d = 0; d < dims; ++d) {
+            double mean = 0.0;
+            for (size_t r = 0; r < rows; ++r) mean += y[r * dims + d];
+            mean /= static_cast<double>(rows);
+            for (size_t r = 0; r < rows; ++r) y[r * dims + d] -= mean;
+        }
+
+        if (progress && (publishInterval > 0) && ((iter + 1) % publishInterval == 0) && (iter + 1 < maxIter)) {
+            progress(y, iter + 1);
+        }
+    }
+
+    if (progress) progress(y, maxIter);
+    return true;
+}
+
+
+bool BarnesHutTSNE::computeInputSimilarities(const std::vector<double>& data, size_t rows, size_t columns,
+    const std::atomic<bool>& cancel, Similarities& p) const {
+    // the exact variant (theta = 0) calibrates over all rows like bhtsne does, only the
+    // Barnes-Hut variant restricts the similarities to the 3 * perplexity nearest neighbours
+    const size_t k = (this->theta > 0.0)
+                         ? (std::min)(rows - 1, (std::max)(size_t(1), static_cast<size_t>(3.0 * this->perplexity)))
+                         : rows - 1;
+
+    std::mt19937 rng(static_cast<unsigned int>(this->seed));
+    VpTree tree(data.data(), rows, columns, rng);
+
+    // conditional similarities of the k nearest neighbours, matching the perplexity per row
+    std::vector<uint32_t> neighbours(rows * k);
+    std::vector<double> conditional(rows * k, 0.0);
+    const double targetEntropy = std::log(this->perplexity);
+    const int64_t cnt = static_cast<int64_t>(rows);
+#pragma omp parallel
+    {
+        std::vector<uint32_t> idx;
+        std::vector<double> dist;
+#pragma omp for schedule(dynamic, 64)
+        for (int64_t i = 0; i < cnt; ++i) {
+            if (cancel) continue;
+            tree.Search(static_cast<size_t>(i), k, idx, dist);
+            const size_t found = idx.size();
+            for (double& d : dist) d *= d;
+
+            double* pi = &conditional[i * k];
+            double beta = 1.0;
+            double minBeta = std::numeric_limits<double>::lowest();
+            double maxBeta = std::numeric_limits<double>::max();
+            double sum = 0.0;
+            for (int step = 0; step < 200; ++step) {
+                // distances relative to the nearest neighbour to avoid underflow
+                sum = 0.0;
+                double weighted = 0.0;
+                for (size_t m = 0; m < found; ++m) {
+                    pi[m] = std::exp(-beta * (dist[m] - dist[0]));
+                    sum += pi[m];
+                    weighted += (dist[m] - dist[0]) * pi[m];
+                }
+                const double entropy = std::log(sum) + beta * weighted / sum;
+                const double diff = entropy - targetEntropy;
+                if (std::abs(diff) < 1e-5) break;
+                if (diff > 0.0) {
+                    minBeta = beta;
+                    beta = (maxBeta == std::numeric_limits<double>::max()) ? beta * 2.0 : 0.5 * (beta + maxBeta);
+                } else {
+                    maxBeta = beta;
+                    beta = (minBeta == std::numeric_limits<double>::lowest()) ? beta * 0.5 : 0.5 * (beta + minBeta);
+                }
+            }
+            for (size_t m = 0; m < found; ++m) {
+                pi[m] /= sum;
+                neighbours[i * k + m] = idx[m];
+            }
+            for (size_t m = found; m < k; ++m) neighbours[i * k + m] = static_cast<uint32_t>(i);
+        }
+    }
+    if (cancel) return false;
+
+    if (k == rows - 1) {
+        // dense: symmetrise through a full matrix instead of sorting all pairs
+        std::vector<double> dense(rows * rows, 0.0);
+        for (size_t i = 0; i < rows; ++i) {
+            for (size_t m = 0; m < k; ++m) {
+                const uint32_t j = neighbours[i * k + m];
+                if (j != i) dense[i * rows + j] = conditional[i * k + m];
+            }
+        }
+        neighbours = std::vector<uint32_t>();
+        conditional = std::vector<double>();
+
+        p.rowStart.resize(rows + 1);
+        p.column.resize(rows * (rows - 1));
+        p.value.resize(rows * (rows - 1));
+        double total = 0.0;
+        size_t e = 0;
+        for (size_t i = 0; i < rows; ++i) {
+            p.rowStart[i] = e;
+            for (size_t j = 0; j < rows; ++j) {
+                if (j == i) continue;
+                p.column[e] = static_cast<uint32_t>(j);
+                p.value[e] = dense[i * rows + j] + dense[j * rows + i];
+                total += p.value[e];
+                ++e;
+            }
+        }
+        p.rowStart[rows] = e;
+        for (double& v : p.value) v /= total;
+        return true;
+    }
+
+    // symmetrise as p_ij + p_ji and normalise
+    std::vector<std::tuple<uint32_t, uint32_t, double>> entries;
+    entries.reserve(2 * rows * k);
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t m = 0; m < k; ++m) {
+            const uint32_t j = neighbours[i * k + m];
+            if (j == i) continue;
+            entries.emplace_back(static_cast<uint32_t>(i), j, conditional[i * k + m]);
+            entries.emplace_back(j, static_cast<uint32_t>(i), conditional[i * k + m]);
+        }
+    }
+    std::sort(entries.begin(), entries.end());
+
+    p.rowStart.assign(rows + 1, 0);
+    p.column.clear();
+    p.value.clear();
+    double total = 0.0;
+    for (size_t e = 0; e < entries.size(); ++e) {
+        const uint32_t i = std::get<0>(entries[e]);
+        const uint32_t j = std::get<1>(entries[e]);
+        if ((e > 0) && (std::get<0>(entries[e - 1]) == i) && (std::get<1>(entries[e - 1]) == j)) {
+            p.value.back() += std::get<2>(entries[e]);
+        } else {
+            p.column.push_back(j);
+            p.value.push_back(std::get<2>(entries[e]));
+            ++p.rowStart[i + 1];
+        }
+        total += std::get<2>(entries[e]);
+    }
+    for (size_t i = 0; i < rows; ++i) p.rowStart[i + 1] += p.rowStart[i];
+    for (double& v : p.value) v /= total;
+
+    return true;
+}
+
+
+void BarnesHutTSNE::computeGradient(
+    const Similarities& p, const std::vector<double>& y, size_t rows, std::vector<double>& dy) const {
+    const int dims = this->outputDims;
+    std::vector<double> pos(rows * dims, 0.0), neg(rows * dims, 0.0);
+    const int64_t cnt = static_cast<int64_t>(rows);
+
+    // attractive forces along the sparse input similarities
+#pragma omp parallel for schedule(dynamic, 256)
+    for (int64_t i = 0; i < cnt; ++i) {
+        const double* yi = &y[i * dims];
+        for (size_t e = p.rowStart[i]; e < p.rowStart[i + 1]; ++e) {
+            const double* yj = &y[p.column[e] * dims];
+            double d2 = 0.0;
+            for (int d = 0; d < dims; ++d) d2 += (yi[d] - yj[d]) * (yi[d] - yj[d]);
+            const double mult = p.value[e] / (1.0 + d2);
+            for (int d = 0; d < dims; ++d) pos[i * dims + d] += mult * (yi[d] - yj[d]);
+        }
+    }
+
+    // repulsive forces, approximated by the tree or exact for theta = 0
+    double sumQ = 0.0;
+    if (this->theta > 0.0) {
+        SPTree tree(y, rows, dims);
+#pragma omp parallel for schedule(dynamic, 256) reduction(+ : sumQ)
+        for (int64_t i = 0; i < cnt; ++i) {
+            sumQ += tree.ComputeNonEdgeForces(static_cast<size_t>(i), this->theta, &neg[i * dims]);
+        }
+    } else {
+#pragma omp parallel for schedule(dynamic, 64) reduction(+ : sumQ)
+        for (int64_t i = 0; i < cnt; ++i) {
+            const double* yi = &y[i * dims];
+            for (int64_t j = 0; j < cnt; ++j) {
+                if (j == i) continue;
+                const double* yj = &y[j * dims];
+                double d2 = 0.0;
+                for (int d = 0; d < dims; ++d) d2 += (yi[d] - yj[d]) * (yi[d] - yj[d]);
+                const double q = 1.0 / (1.0 + d2);
+                sumQ += q;
+                for (int d = 0; d < dims; ++d) neg[i * dims + d] += q * q * (yi[d] - yj[d]);
+            }
+        }
+    }
+
+    dy.resize(rows * dims);
+    for (size_t i = 0; i < rows * dims; ++i) dy[i] = pos[i] - neg[i] / sumQ;
+}
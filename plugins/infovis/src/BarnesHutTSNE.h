@@ -0,0 +1,88 @@
+#ifndef MEGAMOL_INFOVIS_BARNESHUTTSNE_H_INCLUDED
+#define MEGAMOL_INFOVIS_BARNESHUTTSNE_H_INCLUDED
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+
+namespace megamol {
+namespace infovis {
+
+/**
+ * Barnes-Hut t-SNE following van der Maaten's bhtsne, with input
+ * similarities, tree build and gradient evaluated on all cores, and
+ * intermediate embeddings handed out while the optimisation is running.
+ */
+class BarnesHutTSNE {
+public:
+    /** Receives an intermediate embedding (rows x outputDims, row-major) after 'iteration' iterations */
+    typedef std::function<void(const std::vector<double>& embedding, int iteration)> progress_callback;
+
+    /**
+     * Constructor
+     *
+     * @param outputDims The number of output dimensions
+     * @param perplexity The perplexity of the input similarities
+     * @param theta      The Barnes-Hut accuracy, 0 computes exact t-SNE with dense input similarities
+     *                   (quadratic in time and memory)
+     * @param seed       The seed of the random initialisation, negative for a time-dependent seed
+     */
+    BarnesHutTSNE(int outputDims, double perplexity, double theta, int seed);
+
+    /**
+     * Computes the embedding of 'data'.
+     *
+     * @param data            The input (rows x columns, row-major)
+     * @param rows            The number of input rows
+     * @param columns         The number of input columns
+     * @param maxIter         The number of iterations
+     * @param publishInterval The number of iterations between calls of 'progress', 0 for the final result only
+     * @param cancel          Stops the optimisation when set
+     * @param progress        Receives the initial, the intermediate and the final embedding
+     *
+     * @return false if cancelled or if there are too few rows for the perplexity
+     */
+    bool Run(const std::vector<double>& data, size_t rows, size_t columns, int maxIter, int publishInterval,
+        const std::atomic<bool>& cancel, const progress_callback& progress);
+
+private:
+    /** Sparse symmetric input similarities in compressed row storage */
+    struct Similarities {
+        std::vector<size_t> rowStart;
+        std::vector<uint32_t> column;
+        std::vector<double> value;
+    };
+
+    /** Space-partitioning tree over the embedding for the repulsive forces */
+    class SPTree;
+
+    /**
+     * Answers the symmetric, normalised input similarities of the 3 * perplexity nearest
+     * neighbours, or of all rows if theta is 0.
+     */
+    bool computeInputSimilarities(const std::vector<double>& data, size_t rows, size_t columns,
+        const std::atomic<bool>& cancel, Similarities& p) const;
+
+    /** Computes the gradient of the embedding 'y' into 'dy' */
+    void computeGradient(const Similarities& p, const std::vector<double>& y, size_t rows, std::vector<double>& dy) const;
+
+    /** The number of output dimensions */
+    int outputDims;
+
+    /** The perplexity of the input similarities */
+    double perplexity;
+
+    /** The random seed */
+    int seed;
+
+    /** The Barnes-Hut accuracy */
+    double theta;
+};
+
+} // namespace infovis
+} // namespace megamol
+
+
+#endif
@@ -2,11 +2,14 @@
 #include "PCAProjection.h"
 
 #include "mmcore/param/BoolParam.h"
+#include "mmcore/param/EnumParam.h"
 #include "mmcore/param/IntParam.h"
 #include "mmstd_datatools/table/TableDataCall.h"
 
 #include <Eigen/Dense>
 #include <Eigen/SVD>
+#include <chrono>
+#include <limits>
 #include <set>
 #include <sstream>
 #include "MDSProjection.h"
@@ -22,6 +25,9 @@ MDSProjection::MDSProjection(void)
     , dataOutSlot("dataOut", "Ouput")
     , dataInSlot("dataIn", "Input")
     , reduceToNSlot("nComponents", "Number of components (dimensions) to keep")
+    , modeSlot("mode", "Exact classical MDS (N x N memory) or landmark MDS for large tables")
+    , landmarksSlot("landmarks", "Number of landmark rows of landmark MDS")
+    , compareSlot("compareExact", "Log accuracy and runtime of landmark MDS against the exact MDS (small tables only)")
     , datahash(0)
     , dataInHash(0)
     , columnInfos() {
@@ -37,6 +43,18 @@ MDSProjection::MDSProjection(void)
 
     reduceToNSlot << new ::megamol::core::param::IntParam(2);
     this->MakeSlotAvailable(&reduceToNSlot);
+
+    auto modes = new ::megamol::core::param::EnumParam(MODE_CLASSIC);
+    modes->SetTypePair(MODE_CLASSIC, "Classic");
+    modes->SetTypePair(MODE_LANDMARK, "Landmark");
+    modeSlot << modes;
+    this->MakeSlotAvailable(&modeSlot);
+
+    landmarksSlot << new ::megamol::core::param::IntParam(200, 2);
+    this->MakeSlotAvailable(&landmarksSlot);
+
+    compareSlot << new ::megamol::core::param::BoolParam(false);
+    this->MakeSlotAvailable(&compareSlot);
 }
 
 MDSProjection::~MDSProjection(void) { this->Release(); }
@@ -106,7 +124,7 @@ bool MDSProjection::getHashCallback(core::Call& c) {
 bool megamol::infovis::MDSProjection::dataProjection(megamol::stdplugin::datatools::table::TableDataCall* inCall) {
     // Test if inData has changed and if slots have changed
     if (this->dataInHash == inCall->DataHash()) {
-        if (!reduceToNSlot.IsDirty()) {
+        if (!reduceToNSlot.IsDirty() && !modeSlot.IsDirty() && !landmarksSlot.IsDirty() && !compareSlot.IsDirty()) {
             return true; // Nothing to do
         }
     }
@@ -130,10 +148,45 @@ bool megamol::infovis::MDSProjection::dataProjection(megamol::stdplugin::datatoo
         }
     }
 
-    // generate dissimilarity Matrix( squared euclidean Distance matrix)
-    Eigen::MatrixXd delta2 = euclideanDissimilarityMatrix(inDataMat).array().pow(2);
-    // compute MDS
-    Eigen::MatrixXd result = classicMds(delta2, outputDimCount);
+    Eigen::MatrixXd result;
+    if (this->modeSlot.Param<core::param::EnumParam>()->Value() == MODE_LANDMARK) {
+        int landmarkCount = this->landmarksSlot.Param<core::param::IntParam>()->Value();
+        if (landmarkCount <= outputDimCount) {
+            vislib::sys::Log::DefaultLog.WriteError(
+                _T("%hs: Landmark MDS needs more landmarks than output dimensions\n"), ClassName());
+            return false;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        result = landmarkMds(inDataMat, outputDimCount, landmarkCount);
+        double landmarkMillis =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        vislib::sys::Log::DefaultLog.WriteInfo(_T("%hs: Landmark MDS of %d rows with %d landmarks took %.1f ms\n"),
+            ClassName(), static_cast<int>(rowsCount), (std::min)(landmarkCount, static_cast<int>(rowsCount)),
+            landmarkMillis);
+
+        if (this->compareSlot.Param<core::param::BoolParam>()->Value()) {
+            if (static_cast<int64_t>(rowsCount) > MAX_COMPARE_ROWS) {
+                vislib::sys::Log::DefaultLog.WriteWarn(
+                    _T("%hs: Exact MDS is only compared for up to %d rows\n"), ClassName(),
+                    static_cast<int>(MAX_COMPARE_ROWS));
+            } else {
+                start = std::chrono::steady_clock::now();
+                Eigen::MatrixXd exact = classicMds(euclideanDissimilarityMatrix(inDataMat).array().pow(2), outputDimCount);
+                double exactMillis =
+                    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                vislib::sys::Log::DefaultLog.WriteInfo(
+                    _T("%hs: Exact MDS took %.1f ms, relative distance error of landmark MDS is %f\n"), ClassName(),
+                    exactMillis, relativeDistanceError(result, exact));
+            }
+        }
+
+    } else {
+        // generate dissimilarity Matrix( squared euclidean Distance matrix)
+        Eigen::MatrixXd delta2 = euclideanDissimilarityMatrix(inDataMat).array().pow(2);
+        // compute MDS
+        result = classicMds(delta2, outputDimCount);
+    }
 
     // generate new columns
     this->columnInfos.clear();
@@ -158,6 +211,9 @@ bool megamol::infovis::MDSProjection::dataProjection(megamol::stdplugin::datatoo
     this->dataInHash = inCall->DataHash();
     this->datahash++;
     reduceToNSlot.ResetDirty();
+    modeSlot.ResetDirty();
+    landmarksSlot.ResetDirty();
+    compareSlot.ResetDirty();
 
     return true;
 }
@@ -216,6 +272,87 @@ Eigen::MatrixXd megamol::infovis::MDSProjection::classicMds(
     return result;
 }
 
+Eigen::MatrixXd megamol::infovis::MDSProjection::landmarkMds(
+    const Eigen::MatrixXd& dataMatrix, int outputDimension, int landmarkCount) {
+    const int64_t rowsCount = dataMatrix.rows();
+    const int k = static_cast<int>((std::min)(static_cast<int64_t>(landmarkCount), rowsCount));
+
+    // squared distances of all rows to the landmarks (N x k)
+    Eigen::MatrixXd delta2;
+    std::vector<int64_t> landmarks = selectLandmarks(dataMatrix, k, delta2);
+
+    // classical MDS of the landmarks
+    Eigen::MatrixXd landmarkDelta2(k, k);
+    for (int i = 0; i < k; i++) {
+        landmarkDelta2.row(i) = delta2.row(landmarks[i]);
+    }
+    Eigen::VectorXd meanDelta2 = landmarkDelta2.colwise().mean().transpose();
+    Eigen::MatrixXd B = landmarkDelta2;
+    B.colwise() -= meanDelta2;
+    B.rowwise() -= meanDelta2.transpose();
+    B.array() += meanDelta2.mean();
+    B *= -0.5;
+    SelfAdjointEigenSolver<MatrixXd> eigSolver(B);
+
+    // pseudo-inverse of the landmark embedding, eigenvalues are ascending
+    MatrixXd lSharp = MatrixXd::Zero(k, outputDimension);
+    for (int i = 0; i < outputDimension && i < k; ++i) {
+        double eigVal = eigSolver.eigenvalues()(k - 1 - i);
+        if (eigVal > std::numeric_limits<double>::epsilon()) {
+            lSharp.col(i) = eigSolver.eigenvectors().col(k - 1 - i) / sqrt(eigVal);
+        }
+    }
+
+    // distance-based triangulation of all rows, including the landmarks
+    delta2.rowwise() -= meanDelta2.transpose();
+    return -0.5 * delta2 * lSharp;
+}
+
+std::vector<int64_t> megamol::infovis::MDSProjection::selectLandmarks(
+    const Eigen::MatrixXd& dataMatrix, int count, Eigen::MatrixXd& squaredDistances) {
+    const int64_t rowsCount = dataMatrix.rows();
+    std::vector<int64_t> landmarks;
+    landmarks.reserve(count);
+    squaredDistances.resize(rowsCount, count);
+    std::vector<double> minDistance(rowsCount, std::numeric_limits<double>::max());
+
+    int64_t next = 0;
+    for (int l = 0; l < count; l++) {
+        landmarks.push_back(next);
+        const Eigen::RowVectorXd landmark = dataMatrix.row(next);
+
+#pragma omp parallel for
+        for (int64_t row = 0; row < rowsCount; row++) {
+            double d = (dataMatrix.row(row) - landmark).squaredNorm();
+            squaredDistances(row, l) = d;
+            minDistance[row] = (std::min)(minDistance[row], d);
+        }
+
+        // the row farthest from all landmarks so far
+        next = std::max_element(minDistance.begin(), minDistance.end()) - minDistance.begin();
+    }
+
+    return landmarks;
+}
+
+double megamol::infovis::MDSProjection::relativeDistanceError(
+    const Eigen::MatrixXd& embedding, const Eigen::MatrixXd& reference) {
+    const int64_t rowsCount = reference.rows();
+    double error = 0.0, norm = 0.0;
+
+#pragma omp parallel for reduction(+ : error, norm) schedule(dynamic)
+    for (int64_t row = 1; row < rowsCount; row++) {
+        for (int64_t col = 0; col < row; col++) {
+            double d = (embedding.row(row) - embedding.row(col)).norm();
+            double ref = (reference.row(row) - reference.row(col)).norm();
+            error += (d - ref) * (d - ref);
+            norm += ref * ref;
+        }
+    }
+
+    return (norm > 0.0) ? sqrt(error / norm) : 0.0;
+}
+
 Eigen::MatrixXd megamol::infovis::MDSProjection::bMatrix(
     Eigen::MatrixXd X, Eigen::MatrixXd W, Eigen::MatrixXd dissimilarityMatrix) {
     assert(X.rows() == W.rows());
@@ -39,6 +39,19 @@ public:
 
     static Eigen::MatrixXd classicMds(Eigen::MatrixXd squaredDissimilarityMatrix, int outputDimension);
 
+    /**
+     * Landmark MDS: classical MDS of 'landmarkCount' rows chosen by max-min
+     * distance, with all other rows placed by distance-based triangulation.
+     * Needs O(N * landmarkCount) memory instead of O(N^2).
+     *
+     * @param dataMatrix      One row per data point.
+     * @param outputDimension The number of output dimensions.
+     * @param landmarkCount   The number of landmarks, more than 'outputDimension'.
+     *
+     * @return The embedding with one row per data point.
+     */
+    static Eigen::MatrixXd landmarkMds(const Eigen::MatrixXd& dataMatrix, int outputDimension, int landmarkCount);
+
     static Eigen::MatrixXd smacofMds(Eigen::MatrixXd squaredDissimilarityMatrix, int outputDimension = 2,
         int countSteps = 100, Eigen::MatrixXd weightsMatrix = Eigen::MatrixXd::Ones(1, 1), double tolerance = 1e-3);
 
@@ -49,6 +62,12 @@ public:
         Eigen::MatrixXd weightsMatrix = Eigen::MatrixXd::Ones(1, 1));
 
 protected:
+    /** The MDS variants */
+    enum Mode { MODE_CLASSIC = 0, MODE_LANDMARK = 1 };
+
+    /** The maximum number of rows to compare landmark against exact MDS for */
+    static const int64_t MAX_COMPARE_ROWS = 2000;
+
     /** Lazy initialization of the module */
     virtual bool create(void);
 
@@ -60,6 +79,24 @@ private:
 
     static Eigen::MatrixXd vMatrix(Eigen::MatrixXd W);
 
+    /**
+     * Chooses 'count' landmarks by max-min distance, starting at row 0.
+     *
+     * @param dataMatrix        One row per data point.
+     * @param count             The number of landmarks.
+     * @param squaredDistances  Receives the squared distances of all rows (N x count).
+     *
+     * @return The row indices of the landmarks.
+     */
+    static std::vector<int64_t> selectLandmarks(
+        const Eigen::MatrixXd& dataMatrix, int count, Eigen::MatrixXd& squaredDistances);
+
+    /**
+     * Answers the RMS difference of all pairwise distances of two
+     * embeddings relative to the RMS distance in 'reference'.
+     */
+    static double relativeDistanceError(const Eigen::MatrixXd& embedding, const Eigen::MatrixXd& reference);
+
     /** Data callback */
     bool getDataCallback(core::Call& c);
 
@@ -76,6 +113,15 @@ private:
     /** Parameter slot for target number of dimensions */
     ::megamol::core::param::ParamSlot reduceToNSlot;
 
+    /** Parameter slot selecting exact or landmark MDS */
+    ::megamol::core::param::ParamSlot modeSlot;
+
+    /** Parameter slot for the number of landmarks */
+    ::megamol::core::param::ParamSlot landmarksSlot;
+
+    /** Parameter slot to compare landmark against exact MDS on small tables */
+    ::megamol::core::param::ParamSlot compareSlot;
+
     /** ID of the current frame */
     // int frameID; //TODO: unknown
 
@@ -2,11 +2,14 @@
 #include "PCAProjection.h"
 
 #include "mmcore/param/BoolParam.h"
+#include "mmcore/param/EnumParam.h"
 #include "mmcore/param/IntParam.h"
 #include "mmstd_datatools/table/TableDataCall.h"
 
 #include <Eigen/Dense>
 #include <Eigen/SVD>
+#include <algorithm>
+#include <chrono>
 #include <sstream>
 
 
@@ -22,6 +25,10 @@ PCAProjection::PCAProjection(void)
     , reduceToNSlot("nComponents", "Number of components (dimensions) to keep")
     , scaleSlot("scale", "Set to scale each column to unit variance")
     , centerSlot("center", "Set to shift the mean centroid to the origin")
+    , modeSlot("mode", "Exact PCA on a copy of the table or streaming PCA over row chunks for large tables")
+    , chunkRowsSlot("chunkRows", "Number of rows processed at once by the streaming mode")
+    , reuseBasisSlot(
+          "reuseBasis", "Set to project new data with the fitted components instead of refitting (streaming)")
     , datahash(0)
     , dataInHash(0)
     , columnInfos() {
@@ -43,6 +50,18 @@ PCAProjection::PCAProjection(void)
 
     scaleSlot << new ::megamol::core::param::BoolParam(false);
     this->MakeSlotAvailable(&scaleSlot);
+
+    auto modes = new ::megamol::core::param::EnumParam(MODE_EXACT);
+    modes->SetTypePair(MODE_EXACT, "Exact");
+    modes->SetTypePair(MODE_STREAMING, "Streaming");
+    modeSlot << modes;
+    this->MakeSlotAvailable(&modeSlot);
+
+    chunkRowsSlot << new ::megamol::core::param::IntParam(8192, 64);
+    this->MakeSlotAvailable(&chunkRowsSlot);
+
+    reuseBasisSlot << new ::megamol::core::param::BoolParam(false);
+    this->MakeSlotAvailable(&reuseBasisSlot);
 }
 
 
@@ -115,7 +134,8 @@ bool megamol::infovis::PCAProjection::project(megamol::stdplugin::datatools::tab
 
     // check if inData has changed and if Slots have changed
     if (this->dataInHash == inCall->DataHash()) {
-        if (!reduceToNSlot.IsDirty() && !scaleSlot.IsDirty() && !centerSlot.IsDirty()) {
+        if (!reduceToNSlot.IsDirty() && !scaleSlot.IsDirty() && !centerSlot.IsDirty() && !modeSlot.IsDirty() &&
+            !chunkRowsSlot.IsDirty()) {
             return true; // Nothing to do
         }
     }
@@ -136,6 +156,54 @@ bool megamol::infovis::PCAProjection::project(megamol::stdplugin::datatools::tab
         return false;
     }
 
+    if (this->modeSlot.Param<core::param::EnumParam>()->Value() == MODE_STREAMING) {
+        if (rowsCount < 2) {
+            vislib::sys::Log::DefaultLog.WriteError(_T("%hs: At least two rows are needed\n"), ClassName());
+            return false;
+        }
+        const size_t chunkRows = this->chunkRowsSlot.Param<core::param::IntParam>()->Value();
+        const bool refit = reduceToNSlot.IsDirty() || scaleSlot.IsDirty() || centerSlot.IsDirty() ||
+                           modeSlot.IsDirty() || !this->reuseBasisSlot.Param<core::param::BoolParam>()->Value() ||
+                           this->streamingPCA.Columns() != columnCount ||
+                           this->streamingPCA.Components() != outputDimCount;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        if (refit) {
+            this->streamingPCA.Fit(inData, rowsCount, columnCount, outputDimCount, center, scale, chunkRows);
+        }
+        auto fitted = std::chrono::high_resolution_clock::now();
+        this->data.resize(rowsCount * outputDimCount);
+        std::vector<float> minimum(outputDimCount), maximum(outputDimCount);
+        this->streamingPCA.Project(inData, rowsCount, chunkRows, this->data.data(), minimum.data(), maximum.data());
+        auto end = std::chrono::high_resolution_clock::now();
+
+        // generate new columns
+        this->columnInfos.clear();
+        this->columnInfos.resize(outputDimCount);
+        for (size_t col = 0; col < outputDimCount; col++) {
+            this->columnInfos[col]
+                .SetName("PC" + std::to_string(col))
+                .SetType(megamol::stdplugin::datatools::table::TableDataCall::ColumnType::QUANTITATIVE)
+                .SetMinimumValue(minimum[col])
+                .SetMaximumValue(maximum[col]);
+        }
+
+        vislib::sys::Log::DefaultLog.WriteInfo(_T("%hs: Streaming PCA of %u rows: fit %.1f ms%hs, projection %.1f ms\n"),
+            ClassName(), static_cast<unsigned int>(rowsCount),
+            std::chrono::duration<double, std::milli>(fitted - start).count(), refit ? "" : " (reused)",
+            std::chrono::duration<double, std::milli>(end - fitted).count());
+
+        this->dataInHash = inCall->DataHash();
+        this->datahash++;
+        reduceToNSlot.ResetDirty();
+        scaleSlot.ResetDirty();
+        centerSlot.ResetDirty();
+        modeSlot.ResetDirty();
+        chunkRowsSlot.ResetDirty();
+
+        return true;
+    }
+
     // Load data in a Matrix
     Eigen::MatrixXd inDataMat = Eigen::MatrixXd(rowsCount, columnCount);
     for (int row = 0; row < rowsCount; row++) {
@@ -248,6 +316,8 @@ bool megamol::infovis::PCAProjection::project(megamol::stdplugin::datatools::tab
     reduceToNSlot.ResetDirty();
     scaleSlot.ResetDirty();
     centerSlot.ResetDirty();
+    modeSlot.ResetDirty();
+    chunkRowsSlot.ResetDirty();
 
     return true;
 }
@@ -7,6 +7,8 @@
 #include "mmcore/param/ParamSlot.h"
 #include "mmstd_datatools/table/TableDataCall.h"
 
+#include "StreamingPCA.h"
+
 
 namespace megamol {
 namespace infovis {
@@ -33,6 +35,9 @@ public:
     virtual ~PCAProjection(void);
 
 protected:
+    /** The PCA variants */
+    enum Mode { MODE_EXACT = 0, MODE_STREAMING = 1 };
+
     /** Lazy initialization of the module */
     virtual bool create(void);
 
@@ -57,6 +62,9 @@ private:
     ::megamol::core::param::ParamSlot reduceToNSlot;
     ::megamol::core::param::ParamSlot scaleSlot;
     ::megamol::core::param::ParamSlot centerSlot;
+    ::megamol::core::param::ParamSlot modeSlot;
+    ::megamol::core::param::ParamSlot chunkRowsSlot;
+    ::megamol::core::param::ParamSlot reuseBasisSlot;
 
     /** ID of the current frame */
     // int frameID; //TODO: unknown
@@ -70,6 +78,9 @@ private:
 
     /** Vector stroing the actual float data */
     std::vector<float> data;
+
+    /** The streaming PCA, whose basis is kept for 'reuseBasis' */
+    StreamingPCA streamingPCA;
 };
 
 } // namespace infovis
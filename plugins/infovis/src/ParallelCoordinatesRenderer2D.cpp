@@ -195,6 +195,7 @@ bool ParallelCoordinatesRenderer2D::enableProgramAndBind(vislib::graphics::gl::G
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, dataBuffer);
     auto flags = this->readFlagsSlot.CallAs<core::FlagCallRead_GL>();
     flags->getData()->flags->bind(1);
+    flags->getData()->bindChanges();
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, minimumsBuffer);
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, maximumsBuffer);
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, axisIndirectionBuffer);
@@ -1031,6 +1032,7 @@ bool ParallelCoordinatesRenderer2D::Render(core::view::CallRender2D& call) {
         auto readFlags = readFlagsSlot.CallAs<core::FlagCallRead_GL>();
         auto writeFlags = writeFlagsSlot.CallAs<core::FlagCallWrite_GL>();
         if (readFlags != nullptr && writeFlags != nullptr) {
+            readFlags->getData()->markChanged();
             writeFlags->setData(readFlags->getData(), this->currentFlagsVersion);
             (*writeFlags)(core::FlagCallWrite_GL::CallGetData);
 #if 0
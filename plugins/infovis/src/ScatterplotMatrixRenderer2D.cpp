@@ -1175,6 +1175,7 @@ void ScatterplotMatrixRenderer2D::updateSelection() {
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PlotSSBOBindingPoint, this->plotSSBO.GetHandle(0));
     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, ValueSSBOBindingPoint, this->valueSSBO.GetHandle(0));
     this->readFlags->getData()->flags->bind(FlagsBindingPoint);
+    this->readFlags->getData()->bindChanges();
 
     GLuint groupCounts[3];
     computeDispatchSizes(this->floatTable->GetRowsCount(), pickWorkgroupSize, maxWorkgroupCount, groupCounts);
@@ -1188,6 +1189,7 @@ void ScatterplotMatrixRenderer2D::updateSelection() {
 
     auto writeFlags = writeFlagStorageSlot.CallAs<core::FlagCallWrite_GL>();
     if (this->readFlags != nullptr && writeFlags != nullptr) {
+        this->readFlags->getData()->markChanged();
         writeFlags->setData(this->readFlags->getData(), this->flagsBufferVersion);
         (*writeFlags)(core::FlagCallWrite_GL::CallGetData);
     }
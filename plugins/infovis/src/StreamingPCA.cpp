@@ -0,0 +1,129 @@
+#include "stdafx.h"
+#include "StreamingPCA.h"
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+#include <vector>
+
+using namespace megamol;
+using namespace megamol::infovis;
+using namespace Eigen;
+
+
+namespace {
+
+/** Column means and centred scatter matrix (lower triangle) of a set of rows */
+struct MomentAccumulator {
+    MomentAccumulator(size_t columns)
+        : count(0.0), mean(VectorXd::Zero(columns)), scatter(MatrixXd::Zero(columns, columns)) {}
+
+    /** Adds the moments of 'other' (Chan et al.) */
+    void Merge(const MomentAccumulator& other) {
+        if (other.count == 0.0) return;
+        const double n = this->count + other.count;
+        const VectorXd delta = other.mean - this->mean;
+        this->scatter += other.scatter;
+        this->scatter.selfadjointView<Lower>().rankUpdate(delta, this->count * other.count / n);
+        this->mean += delta * (other.count / n);
+        this->count = n;
+    }
+
+    double count;
+    VectorXd mean;
+    MatrixXd scatter;
+};
+
+typedef Map<const Matrix<float, Dynamic, Dynamic, RowMajor>> TableChunk;
+
+} // namespace
+
+
+void StreamingPCA::Fit(const float* data, size_t rows, size_t columns, unsigned int components, bool center,
+    bool scale, size_t chunkRows) {
+    // one accumulator per group of consecutive chunks, merged in order afterwards
+    const size_t chunkCount = (rows + chunkRows - 1) / chunkRows;
+    const size_t groupCount =
+        (std::max)(size_t(1), (std::min)(chunkCount, static_cast<size_t>(std::thread::hardware_concurrency())));
+    std::vector<MomentAccumulator> groups(groupCount, MomentAccumulator(columns));
+
+    const int64_t cnt = static_cast<int64_t>(groupCount);
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int64_t g = 0; g < cnt; ++g) {
+        const size_t firstChunk = chunkCount * g / groupCount;
+        const size_t lastChunk = chunkCount * (g + 1) / groupCount;
+        for (size_t chunk = firstChunk; chunk < lastChunk; ++chunk) {
+            const size_t begin = chunk * chunkRows;
+            const size_t chunkSize = (std::min)(chunkRows, rows - begin);
+            MatrixXd x = TableChunk(data + begin * columns, chunkSize, columns).cast<double>();
+
+            MomentAccumulator moments(columns);
+            moments.count = static_cast<double>(chunkSize);
+            moments.mean = x.colwise().mean().transpose();
+            x.rowwise() -= moments.mean.transpose();
+            moments.scatter.selfadjointView<Lower>().rankUpdate(x.transpose());
+            groups[g].Merge(moments);
+        }
+    }
+    MomentAccumulator total(columns);
+    for (auto& group : groups) {
+        total.Merge(group);
+    }
+
+    // second moments about the origin if the data is not centred, like the exact mode
+    VectorXd centre = VectorXd::Zero(columns);
+    if (center) {
+        centre = total.mean;
+    } else {
+        total.scatter.selfadjointView<Lower>().rankUpdate(total.mean, total.count);
+    }
+    MatrixXd covarianceMatrix = total.scatter.selfadjointView<Lower>();
+    covarianceMatrix /= (total.count - 1.0);
+
+    VectorXd invStdDev = VectorXd::Ones(columns);
+    if (scale) {
+        invStdDev = covarianceMatrix.diagonal().cwiseSqrt().cwiseInverse();
+        covarianceMatrix = invStdDev.asDiagonal() * covarianceMatrix * invStdDev.asDiagonal();
+    }
+
+    // eigenvalues in ascending order
+    SelfAdjointEigenSolver<MatrixXd> eigSolver(covarianceMatrix);
+    MatrixXd eigVecBasis = eigSolver.eigenvectors().rowwise().reverse().leftCols(components);
+
+    this->basis = invStdDev.asDiagonal() * eigVecBasis;
+    this->offset = centre.transpose() * this->basis;
+}
+
+
+void StreamingPCA::Project(const float* data, size_t rows, size_t chunkRows, float* result, float* minimum,
+    float* maximum) const {
+    const size_t columns = this->Columns();
+    const size_t components = this->Components();
+    const size_t chunkCount = (rows + chunkRows - 1) / chunkRows;
+
+    std::vector<float> minimas(chunkCount * components), maximas(chunkCount * components);
+    const int64_t cnt = static_cast<int64_t>(chunkCount);
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int64_t chunk = 0; chunk < cnt; ++chunk) {
+        const size_t begin = chunk * chunkRows;
+        const size_t chunkSize = (std::min)(chunkRows, rows - begin);
+        MatrixXd projected = TableChunk(data + begin * columns, chunkSize, columns).cast<double>() * this->basis;
+        projected.rowwise() -= this->offset;
+
+        Map<Matrix<float, Dynamic, Dynamic, RowMajor>>(result + begin * components, chunkSize, components) =
+            projected.cast<float>();
+        for (size_t col = 0; col < components; col++) {
+            minimas[chunk * components + col] = static_cast<float>(projected.col(col).minCoeff());
+            maximas[chunk * components + col] = static_cast<float>(projected.col(col).maxCoeff());
+        }
+    }
+
+    for (size_t col = 0; col < components; col++) {
+        minimum[col] = std::numeric_limits<float>::max();
+        maximum[col] = std::numeric_limits<float>::lowest();
+        for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+            minimum[col] = (std::min)(minimum[col], minimas[chunk * components + col]);
+            maximum[col] = (std::max)(maximum[col], maximas[chunk * components + col]);
+        }
+    }
+}
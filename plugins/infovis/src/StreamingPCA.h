@@ -0,0 +1,65 @@
+#ifndef MEGAMOL_INFOVIS_STREAMINGPCA_H_INCLUDED
+#define MEGAMOL_INFOVIS_STREAMINGPCA_H_INCLUDED
+
+#include <Eigen/Dense>
+
+#include <cstddef>
+
+
+namespace megamol {
+namespace infovis {
+
+/**
+ * Principal component analysis of a float table that is processed in
+ * chunks of rows in parallel, without a double-precision copy of the
+ * whole table. The fitted basis can be reused to project further tables.
+ */
+class StreamingPCA {
+public:
+    /**
+     * Fits the principal components from the covariance matrix, which is
+     * accumulated over row chunks in parallel.
+     *
+     * @param data       The table (rows x columns, row-major).
+     * @param rows       The number of rows, at least two.
+     * @param columns    The number of columns.
+     * @param components The number of components to keep.
+     * @param center     Subtract the column means, otherwise use second moments about the origin.
+     * @param scale      Scale the columns to unit variance.
+     * @param chunkRows  The number of rows per chunk.
+     */
+    void Fit(const float* data, size_t rows, size_t columns, unsigned int components, bool center, bool scale,
+        size_t chunkRows);
+
+    /**
+     * Projects a table with the fitted basis, chunk by chunk in parallel.
+     *
+     * @param data      The table (rows x Columns(), row-major).
+     * @param rows      The number of rows.
+     * @param chunkRows The number of rows per chunk.
+     * @param result    Receives the projection (rows x Components(), row-major).
+     * @param minimum   Receives the minimum of each component.
+     * @param maximum   Receives the maximum of each component.
+     */
+    void Project(const float* data, size_t rows, size_t chunkRows, float* result, float* minimum,
+        float* maximum) const;
+
+    /** Answers the number of input columns of the fitted basis, 0 before the first fit */
+    inline size_t Columns(void) const { return static_cast<size_t>(this->basis.rows()); }
+
+    /** Answers the number of fitted components, 0 before the first fit */
+    inline size_t Components(void) const { return static_cast<size_t>(this->basis.cols()); }
+
+private:
+    /** The components, scaled by the inverse column deviations (columns x components) */
+    Eigen::MatrixXd basis;
+
+    /** The projection of the column offsets (centre) onto 'basis' */
+    Eigen::RowVectorXd offset;
+};
+
+} // namespace infovis
+} // namespace megamol
+
+
+#endif
@@ -1,13 +1,15 @@
 #include "stdafx.h"
 #include "TSNEProjection.h"
+#include "BarnesHutTSNE.h"
 
 #include "mmcore/param/BoolParam.h"
 #include "mmcore/param/FloatParam.h"
 #include "mmcore/param/IntParam.h"
 #include "mmstd_datatools/table/TableDataCall.h"
 
+#include <chrono>
+#include <limits>
 #include <sstream>
-#include <tsne.h>
 
 using namespace megamol;
 using namespace megamol::infovis;
@@ -22,11 +24,17 @@ TSNEProjection::TSNEProjection(void)
           "theta = 0 corresponds to standard, slow t-SNE, while theta = 1 corresponds to very crude approximations")
     , maxIterSlot("maxIter", "Set the maximum Iterations")
     , perplexitySlot("perplexity", "Set the Perplexity")
+    , publishIntervalSlot("publishInterval",
+          "Number of iterations between intermediate results handed to the output, 0 for the final result only")
+    , asyncSlot("async", "Optimise in the background, otherwise block until the final result is available")
     , datahash(0)
     , dataInHash(0)
-    , columnInfos() {
-
-    TSNE* tsne = new TSNE(); // lib load test
+    , columnInfos()
+    , outputColumnCount(0)
+    , cancelWorker(false)
+    , latestIteration(0)
+    , latestVersion(0)
+    , adoptedVersion(0) {
 
     this->dataInSlot.SetCompatibleCall<megamol::stdplugin::datatools::table::TableDataCallDescription>();
     this->MakeSlotAvailable(&this->dataInSlot);
@@ -51,13 +59,19 @@ TSNEProjection::TSNEProjection(void)
 
     thetaSlot << new ::megamol::core::param::FloatParam(0.5);
     this->MakeSlotAvailable(&thetaSlot);
+
+    publishIntervalSlot << new ::megamol::core::param::IntParam(50, 0);
+    this->MakeSlotAvailable(&publishIntervalSlot);
+
+    asyncSlot << new ::megamol::core::param::BoolParam(true);
+    this->MakeSlotAvailable(&asyncSlot);
 }
 
 TSNEProjection::~TSNEProjection(void) { this->Release(); }
 
 bool TSNEProjection::create(void) { return true; }
 
-void TSNEProjection::release(void) {}
+void TSNEProjection::release(void) { this->stopWorker(); }
 
 bool TSNEProjection::getDataCallback(core::Call& c) {
     try {
@@ -74,6 +88,7 @@ bool TSNEProjection::getDataCallback(core::Call& c) {
 
         bool finished = project(inCall);
         if (finished == false) return false;
+        this->adoptResult();
 
         outCall->SetFrameCount(inCall->GetFrameCount());
         outCall->SetDataHash(this->datahash);
@@ -106,6 +121,13 @@ bool TSNEProjection::getHashCallback(core::Call& c) {
 
         inCall->SetFrameID(outCall->GetFrameID());
         if (!(*inCall)(1)) return false;
+        // restart on changed input or parameters right away, otherwise callers only asking for the hash
+        // would never see the change while an optimisation keeps running
+        if ((this->dataInHash != inCall->DataHash()) || this->isDirty()) {
+            if (!(*inCall)(0)) return false;
+            if (!this->project(inCall)) return false;
+        }
+        this->adoptResult();
 
         outCall->SetFrameCount(inCall->GetFrameCount());
         outCall->SetDataHash(this->datahash);
@@ -119,15 +141,14 @@ bool TSNEProjection::getHashCallback(core::Call& c) {
 
 bool megamol::infovis::TSNEProjection::project(megamol::stdplugin::datatools::table::TableDataCall* inCall) {
     // check if inData has changed and if Slots have changed
-    if (this->dataInHash == inCall->DataHash()) {
-        if (!reduceToNSlot.IsDirty() && !maxIterSlot.IsDirty() && !thetaSlot.IsDirty() && !perplexitySlot.IsDirty() &&
-            !randomSeedSlot.IsDirty()) {
-            return true; // Nothing to do
-        }
+    if ((this->dataInHash == inCall->DataHash()) && !this->isDirty()) {
+        return true; // Nothing to do
     }
 
+    // the running optimisation is outdated
+    this->stopWorker();
+
     auto columnCount = inCall->GetColumnsCount();
-    auto column_infos = inCall->GetColumnsInfos();
     auto rowsCount = inCall->GetRowsCount();
     auto inData = inCall->GetData();
 
@@ -136,90 +157,103 @@ bool megamol::infovis::TSNEProjection::project(megamol::stdplugin::datatools::ta
     int randomSeed = this->randomSeedSlot.Param<core::param::IntParam>()->Value();
     double theta = this->thetaSlot.Param<core::param::FloatParam>()->Value();
     double perplexity = this->perplexitySlot.Param<core::param::FloatParam>()->Value();
-
+    int publishInterval = this->publishIntervalSlot.Param<core::param::IntParam>()->Value();
 
     if (outputColumnCount <= 0 || outputColumnCount > columnCount) {
         vislib::sys::Log::DefaultLog.WriteError(_T("%hs: No valid Dimension Count has been given\n"), ClassName());
         return false;
     }
-
-    // Load data in a double Array
-    double* inputData = (double*)malloc(columnCount * rowsCount * sizeof(double));
-    for (int col = 0; col < columnCount; col++) {
-        for (int row = 0; row < rowsCount; row++) {
-            inputData[row * columnCount + col] = inData[row * columnCount + col];
-            // inputData[col*rowsCount + row] = inData[row * columnCount + col];
-        }
-    }
-
-
-    TSNE* tsne = new TSNE();
-
-    double* result = (double*)malloc(rowsCount * outputColumnCount * sizeof(double));
-    // void run(double* X, int N, int D, double* Y, int no_dims, double perplexity, double theta, int rand_seed,
-    // bool skip_random_init, int max_iter = 1000, int stop_lying_iter = 250, int mom_switch_iter = 250);
-    tsne->run(
-        inputData, rowsCount, columnCount, result, outputColumnCount, perplexity, theta, randomSeed, false, maxIter);
-
-    double* maximas = new double[outputColumnCount];
-    double* minimas = new double[outputColumnCount];
-
-    for (int col = 0; col < outputColumnCount; col++) {
-        maximas[col] = result[col];
-        minimas[col] = result[col];
-    }
-
-    for (int col = 0; col < outputColumnCount; col++) {
-        for (int row = 1; row < rowsCount; row++) {
-            double value = result[row * outputColumnCount + col];
-            if (maximas[col] < value) maximas[col] = value;
-            if (minimas[col] > value) minimas[col] = value;
-        }
+    if (rowsCount < 2) {
+        vislib::sys::Log::DefaultLog.WriteError(_T("%hs: At least two rows are needed\n"), ClassName());
+        return false;
     }
 
+    // Load data in a double Array owned by the worker
+    std::vector<double> inputData(inData, inData + columnCount * rowsCount);
 
-    // std::stringstream debug;
-    // debug << std::endl << result << std::endl;
-    // vislib::sys::Log::DefaultLog.WriteInfo(debug.str().c_str());
-
-    // generate new columns
+    // generate new columns, the value ranges follow with each result
     this->columnInfos.clear();
     this->columnInfos.resize(outputColumnCount);
-
     for (int indexX = 0; indexX < outputColumnCount; indexX++) {
         this->columnInfos[indexX]
             .SetName("TSNE" + std::to_string(indexX))
             .SetType(megamol::stdplugin::datatools::table::TableDataCall::ColumnType::QUANTITATIVE)
-            .SetMinimumValue(minimas[indexX])
-            .SetMaximumValue(maximas[indexX]);
+            .SetMinimumValue(0.0f)
+            .SetMaximumValue(0.0f);
     }
-
-    // Result Matrix into Output
-    this->data.clear();
-    this->data.reserve(rowsCount * outputColumnCount);
-
-
-    for (size_t row = 0; row < rowsCount; row++) {
-        for (size_t col = 0; col < outputColumnCount; col++)
-            this->data.push_back(result[row * outputColumnCount + col]);
+    this->data.assign(rowsCount * outputColumnCount, 0.0f);
+    this->outputColumnCount = outputColumnCount;
+    {
+        std::lock_guard<std::mutex> lock(this->resultLock);
+        this->latest.clear();
+        this->adoptedVersion = this->latestVersion;
     }
-
+    this->datahash++;
 
     this->dataInHash = inCall->DataHash();
-    this->datahash++;
     reduceToNSlot.ResetDirty();
     maxIterSlot.ResetDirty();
     randomSeedSlot.ResetDirty();
     thetaSlot.ResetDirty();
     perplexitySlot.ResetDirty();
-
-    free(result);
-    result = NULL;
-    free(inputData);
-    inputData = NULL;
-    delete (tsne);
-    delete[] maximas;
-    delete[] minimas;
+    publishIntervalSlot.ResetDirty();
+
+    this->cancelWorker = false;
+    this->worker = std::thread([this, inputData = std::move(inputData), rowsCount, columnCount, outputColumnCount,
+                                   maxIter, randomSeed, theta, perplexity, publishInterval]() {
+        auto start = std::chrono::high_resolution_clock::now();
+        BarnesHutTSNE tsne(outputColumnCount, perplexity, theta, randomSeed);
+        bool finished = tsne.Run(inputData, rowsCount, columnCount, maxIter, publishInterval, this->cancelWorker,
+            [this](const std::vector<double>& embedding, int iteration) {
+                std::lock_guard<std::mutex> lock(this->resultLock);
+                this->latest = embedding;
+                this->latestIteration = iteration;
+                this->latestVersion++;
+            });
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+        if (finished) {
+            vislib::sys::Log::DefaultLog.WriteInfo(_T("%hs: Embedded %u rows in %.2f s\n"), ClassName(),
+                static_cast<unsigned int>(rowsCount), elapsed.count());
+        } else if (!this->cancelWorker) {
+            vislib::sys::Log::DefaultLog.WriteError(_T("%hs: Failed to compute the embedding\n"), ClassName());
+        }
+    });
+    if (!this->asyncSlot.Param<core::param::BoolParam>()->Value()) {
+        this->worker.join();
+    }
 
     return true;
 }
+
+bool megamol::infovis::TSNEProjection::isDirty(void) {
+    return reduceToNSlot.IsDirty() || maxIterSlot.IsDirty() || thetaSlot.IsDirty() || perplexitySlot.IsDirty() ||
+           randomSeedSlot.IsDirty() || publishIntervalSlot.IsDirty();
+}
+
+void megamol::infovis::TSNEProjection::adoptResult(void) {
+    std::lock_guard<std::mutex> lock(this->resultLock);
+    if (this->latestVersion == this->adoptedVersion || this->latest.empty()) return;
+    if (this->latest.size() != this->data.size()) return;
+
+    std::vector<float> minimas(this->outputColumnCount, std::numeric_limits<float>::max());
+    std::vector<float> maximas(this->outputColumnCount, std::numeric_limits<float>::lowest());
+    for (size_t i = 0; i < this->latest.size(); ++i) {
+        const size_t col = i % this->outputColumnCount;
+        this->data[i] = static_cast<float>(this->latest[i]);
+        if (minimas[col] > this->data[i]) minimas[col] = this->data[i];
+        if (maximas[col] < this->data[i]) maximas[col] = this->data[i];
+    }
+    for (size_t col = 0; col < this->outputColumnCount; col++) {
+        this->columnInfos[col].SetMinimumValue(minimas[col]).SetMaximumValue(maximas[col]);
+    }
+
+    this->adoptedVersion = this->latestVersion;
+    this->datahash++;
+}
+
+void megamol::infovis::TSNEProjection::stopWorker(void) {
+    this->cancelWorker = true;
+    if (this->worker.joinable()) {
+        this->worker.join();
+    }
+}
@@ -7,6 +7,11 @@
 #include "mmcore/param/ParamSlot.h"
 #include "mmstd_datatools/table/TableDataCall.h"
 
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 
 namespace megamol {
 namespace infovis {
@@ -48,6 +53,15 @@ private:
 
     bool project(megamol::stdplugin::datatools::table::TableDataCall* inCall);
 
+    /** Answers whether a parameter of the optimisation has changed since it was started */
+    bool isDirty(void);
+
+    /** Copies the latest embedding published by the worker into the output, if there is a new one */
+    void adoptResult(void);
+
+    /** Cancels the running optimisation and waits for the worker to finish */
+    void stopWorker(void);
+
     /** Data output slot */
     CalleeSlot dataOutSlot;
 
@@ -60,6 +74,8 @@ private:
     ::megamol::core::param::ParamSlot thetaSlot;
     ::megamol::core::param::ParamSlot perplexitySlot;
     ::megamol::core::param::ParamSlot maxIterSlot;
+    ::megamol::core::param::ParamSlot publishIntervalSlot;
+    ::megamol::core::param::ParamSlot asyncSlot;
 
     /** ID of the current frame */
     // int frameID; //TODO: unknown
@@ -73,6 +89,30 @@ private:
 
     /** Vector stroing the actual float data */
     std::vector<float> data;
+
+    /** The number of output columns of the running optimisation */
+    size_t outputColumnCount;
+
+    /** The thread running the optimisation */
+    std::thread worker;
+
+    /** Tells the worker to stop */
+    std::atomic<bool> cancelWorker;
+
+    /** Guards the embedding published by the worker */
+    std::mutex resultLock;
+
+    /** The latest embedding published by the worker */
+    std::vector<double> latest;
+
+    /** The iteration of 'latest' */
+    int latestIteration;
+
+    /** Counts the embeddings published by the worker */
+    size_t latestVersion;
+
+    /** The version of the embedding currently in 'data' */
+    size_t adoptedVersion;
 };
 
 } // namespace infovis
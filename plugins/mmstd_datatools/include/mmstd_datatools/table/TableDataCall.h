@@ -15,6 +15,7 @@
 #include "mmcore/factories/CallAutoDescription.h"
 #include <string>
 #include <type_traits>
+#include <vector>
 #include "vislib/macro_utils.h"
 
 namespace megamol {
@@ -28,6 +29,13 @@ namespace table {
 	 * Tabular data is composed from cells that are subdivided into columns and rows.
 	 * Cells are expected to be stored in a consecutive row-major format 
 	 * (until the shitty API no longer provides unsafe pointer access).
+	 *
+	 * Filters can instead publish a view on the table they received, i.e. a
+	 * selection of rows and/or a projection of columns of the upstream data,
+	 * without copying any cell. Consumers that understand views read cells via
+	 * GetData(col, row) or the Base* accessors. GetData() and GetData(row)
+	 * materialize a dense copy in the call if required, so all other consumers
+	 * keep working unchanged.
 	 */
     class MMSTD_DATATOOLS_API TableDataCall : public core::AbstractGetDataCall {
     public:
@@ -100,14 +108,31 @@ namespace table {
             return columns;
         }
 
+        /**
+         * Answer the dense row-major cells. If the call holds a view, the
+         * cells are copied into storage owned by the call. The copy is kept
+         * as long as the view, the data hash and the frame do not change.
+         *
+         * The copy is made lazily and without synchronisation, so the call
+         * must not be read by several threads at once.
+         */
         inline const float* GetData(void) const {
-            return data;
+            if (IsDense()) {
+                return data;
+            }
+            return materialize();
         }
 
+        /**
+         * Answer the cells of 'row'. This only copies if columns are projected.
+         */
         inline const float* GetData(size_t row) const {
             assert(row >= 0);
             assert(row < rows_count);
-            return data + row * columns_count;
+            if (column_selection == nullptr) {
+                return data + GetBaseRow(row) * base_columns_count;
+            }
+            return materialize() + row * columns_count;
         }
 
         inline float GetData(size_t col, size_t row) const {
@@ -115,14 +140,74 @@ namespace table {
             assert(col < columns_count);
             assert(row >= 0);
             assert(row < rows_count);
-            return data[col + row * columns_count];
+            return data[GetBaseColumn(col) + GetBaseRow(row) * base_columns_count];
         }
 
         inline void Set(size_t col_cnt, size_t row_cnt, const ColumnInfo* info, const float* d) {
+            SetView(col_cnt, d, col_cnt, nullptr, row_cnt, nullptr, info);
+        }
+
+        /**
+         * Sets a view on row-major data without copying it.
+         *
+         * @param base_col_cnt The number of columns per row in 'd'.
+         * @param d            The upstream cells.
+         * @param col_cnt      The number of columns of the view.
+         * @param col_sel      'col_cnt' column indices into 'd', or nullptr for all columns.
+         * @param row_cnt      The number of rows of the view.
+         * @param row_sel      'row_cnt' row indices into 'd', or nullptr for the first 'row_cnt' rows.
+         * @param info         'col_cnt' column infos of the view.
+         */
+        inline void SetView(size_t base_col_cnt, const float* d, size_t col_cnt, const size_t* col_sel, size_t row_cnt,
+            const size_t* row_sel, const ColumnInfo* info) {
+            const bool same = (data == d) && (column_selection == col_sel) && (row_selection == row_sel) &&
+                              (base_columns_count == base_col_cnt) && (columns_count == col_cnt) &&
+                              (rows_count == row_cnt);
+            base_columns_count = base_col_cnt;
             columns_count = col_cnt;
             rows_count = row_cnt;
             columns = info;
             data = d;
+            column_selection = col_sel;
+            row_selection = row_sel;
+            if (!same) {
+                materialized_data = nullptr;
+            }
+        }
+
+        /** Answer whether GetData() can be returned without copying. */
+        inline bool IsDense(void) const {
+            return (row_selection == nullptr) && (column_selection == nullptr || IsIdentityProjection());
+        }
+
+        /** Answer the data the view refers to. */
+        inline const float* GetBaseData(void) const {
+            return data;
+        }
+
+        /** Answer the number of columns per row in GetBaseData(). */
+        inline size_t GetBaseColumnsCount(void) const {
+            return base_columns_count;
+        }
+
+        /** Answer the row of GetBaseData() that 'row' refers to. */
+        inline size_t GetBaseRow(size_t row) const {
+            return (row_selection != nullptr) ? row_selection[row] : row;
+        }
+
+        /** Answer the column of GetBaseData() that 'col' refers to. */
+        inline size_t GetBaseColumn(size_t col) const {
+            return (column_selection != nullptr) ? column_selection[col] : col;
+        }
+
+        /** Answer the selected rows, or nullptr if the view is not restricted to a selection. */
+        inline const size_t* GetRowSelection(void) const {
+            return row_selection;
+        }
+
+        /** Answer the projected columns, or nullptr if the view has all base columns. */
+        inline const size_t* GetColumnSelection(void) const {
+            return column_selection;
         }
         
         inline size_t GetFirstCategoricalColumnIndex() const {
@@ -155,7 +240,7 @@ namespace table {
 			for (int c = 0; c < columns_count; ++c) {
                 const auto& column = columns[c];
                 for (int r = 0; r < rows_count; ++r) {
-                    float cell = data[r * columns_count + c];
+                    float cell = GetData(c, r);
                     assert(cell > column.MaximumValue() && "Value beyond maximum found");
 					assert(cell < column.MinimumValue() && "Value beyond maximum found");
 				}
@@ -163,10 +248,24 @@ namespace table {
 		}
 
     private:
+        /** Answer whether the column projection just lists all base columns in order. */
+        bool IsIdentityProjection(void) const;
+
+        /** Copies the view into 'materialized' unless the copy is still valid. */
+        const float* materialize(void) const;
+
         size_t columns_count;
         size_t rows_count;
         const ColumnInfo *columns;
         const float *data; // data is stored row major order, aka array of structs
+        size_t base_columns_count;
+        const size_t *column_selection;
+        const size_t *row_selection;
+        VISLIB_MSVC_SUPPRESS_WARNING(4251)
+        mutable std::vector<float> materialized;
+        mutable const float *materialized_data;
+        mutable SIZE_T materialized_hash;
+        mutable unsigned int materialized_frame;
         unsigned int frameCount;
         unsigned int frameID;
     };
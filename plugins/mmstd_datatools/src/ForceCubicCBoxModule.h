@@ -40,6 +40,10 @@ namespace datatools {
             return true;
         }
 
+        static bool IsCreateThreadSafe(void) {
+            return true;
+        }
+
         /** Ctor */
         ForceCubicCBoxModule(void);
 
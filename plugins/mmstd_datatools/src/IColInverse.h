@@ -18,6 +18,7 @@ namespace datatools {
         static const char *ClassName(void) { return "IColInverse"; }
         static const char *Description(void) { return "Inverts the ICol value range."; }
         static bool IsAvailable(void) { return true; }
+        static bool IsCreateThreadSafe(void) { return true; }
 
         IColInverse();
         virtual ~IColInverse();
@@ -17,6 +17,7 @@ namespace datatools {
         static const char *ClassName(void) { return "IColRangeFix"; }
         static const char *Description(void) { return "Fixes the ICol min and max values by iterating over all particles"; }
         static bool IsAvailable(void) { return true; }
+        static bool IsCreateThreadSafe(void) { return true; }
 
         IColRangeFix();
         virtual ~IColRangeFix();
@@ -6,11 +6,16 @@
  */
 #include "stdafx.h"
 #include "MPIVolumeAggregator.h"
+#include "VolumeBrickExchange.h"
 #include "mmcore/cluster/mpi/MpiCall.h"
 #include "mmcore/moldyn/MultiParticleDataCall.h"
+#include "mmcore/param/BoolParam.h"
 #include "mmcore/param/EnumParam.h"
+#include "mmcore/param/FloatParam.h"
+#include "mmcore/param/IntParam.h"
 #include "vislib/sys/SystemInformation.h"
 #include <chrono>
+#include <limits>
 
 using namespace megamol;
 using namespace megamol::stdplugin;
@@ -22,7 +27,13 @@ using namespace megamol::stdplugin;
 datatools::MPIVolumeAggregator::MPIVolumeAggregator(void)
     : AbstractVolumeManipulator("outData", "indata")
     , callRequestMpi("requestMpi", "Requests initialisation of MPI and the communicator for the view.")
-    , operatorSlot("operator", "the operator to apply to the volume when aggregating") {
+    , operatorSlot("operator", "the operator to apply to the volume when aggregating")
+    , modeSlot("mode", "how the volume is exchanged: all of it, only the occupied bricks, or only the occupied "
+                       "bricks with each rank keeping a slab of the result")
+    , brickSizeSlot("brickSize", "edge length of the bricks in voxels for the brick-based modes")
+    , backgroundSlot("background", "value of empty voxels, the brick-based modes skip bricks holding only this value "
+                                   "for Max and Min. Sum and Product skip bricks holding only 0 or 1, respectively.")
+    , gatherToRootSlot("gatherToRoot", "collect the slabs on rank 0 after the reduce-scatter, e.g. for rendering") {
 
     this->callRequestMpi.SetCompatibleCall<core::cluster::mpi::MpiCallDescription>();
     this->MakeSlotAvailable(&this->callRequestMpi);
@@ -34,6 +45,22 @@ datatools::MPIVolumeAggregator::MPIVolumeAggregator(void)
     ep->SetTypePair(3, "Product");
     this->operatorSlot << ep;
     this->MakeSlotAvailable(&this->operatorSlot);
+
+    ep = new core::param::EnumParam(0);
+    ep->SetTypePair(0, "Allreduce");
+    ep->SetTypePair(1, "Sparse bricks");
+    ep->SetTypePair(2, "Reduce-scatter slabs");
+    this->modeSlot << ep;
+    this->MakeSlotAvailable(&this->modeSlot);
+
+    this->brickSizeSlot << new core::param::IntParam(32, 1);
+    this->MakeSlotAvailable(&this->brickSizeSlot);
+
+    this->backgroundSlot << new core::param::FloatParam(0.0f);
+    this->MakeSlotAvailable(&this->backgroundSlot);
+
+    this->gatherToRootSlot << new core::param::BoolParam(false);
+    this->MakeSlotAvailable(&this->gatherToRootSlot);
 }
 
 
@@ -74,6 +101,7 @@ bool datatools::MPIVolumeAggregator::manipulateData(
     vislib::sys::Log::DefaultLog.WriteInfo("MPIVolumeAggregator: starting volume aggregation");
     const auto startAllTime = std::chrono::high_resolution_clock::now();
 
+    this->releaseMetadata();
     metadata = inData.GetMetadata()->Clone();
     const auto comp = metadata.Components;
 
@@ -89,14 +117,12 @@ bool datatools::MPIVolumeAggregator::manipulateData(
     }
 
     const size_t numFloats = comp * metadata.Resolution[0] * metadata.Resolution[1] * metadata.Resolution[2];
-    // we need a copy of the data since we must not alter it.
-    std::vector<float> tmpVolume;
-    tmpVolume.resize(numFloats);
-    memcpy(tmpVolume.data(), inData.GetData(), numFloats * sizeof(float));
-    // and a copy to receive the result
-    this->theVolume.resize(numFloats);
 
+    // bricks holding only the background on all ranks are skipped. Max and
+    // Min are idempotent, so any background reduces to itself, while Sum
+    // and Product need their identity.
     MPI_Op op = MPI_SUM;
+    float background = 0.0f;
     const auto opVal = this->operatorSlot.Param<core::param::EnumParam>()->Value();
     if (comp > 1) {
         vislib::sys::Log::DefaultLog.WriteWarn(
@@ -107,36 +133,111 @@ bool datatools::MPIVolumeAggregator::manipulateData(
     switch (opVal) {
     case 0:
         op = MPI_MAX;
+        background = this->backgroundSlot.Param<core::param::FloatParam>()->Value();
         break;
     case 1:
         op = MPI_MIN;
+        background = this->backgroundSlot.Param<core::param::FloatParam>()->Value();
         break;
     case 2:
         op = MPI_SUM;
+        background = 0.0f;
         break;
     case 3:
         op = MPI_PROD;
+        background = 1.0f;
         break;
     default:
         vislib::sys::Log::DefaultLog.WriteError("MPIVolumeAggregator: unknown operation %u. Aborting.", opVal);
         return false;
     }
 
-    vislib::sys::Log::DefaultLog.WriteInfo("MPIVolumeAggregator: starting Allreduce");
+    const auto mode = this->modeSlot.Param<core::param::EnumParam>()->Value();
+    const auto gatherToRoot = this->gatherToRootSlot.Param<core::param::BoolParam>()->Value();
+    const auto brickSize = static_cast<size_t>(this->brickSizeSlot.Param<core::param::IntParam>()->Value());
+    const auto modeName = this->modeSlot.Param<core::param::EnumParam>()->getMap()[mode];
+
+    vislib::sys::Log::DefaultLog.WriteInfo("MPIVolumeAggregator: starting %s", modeName.PeekBuffer());
     const auto startTime = std::chrono::high_resolution_clock::now();
 
-    MPI_Allreduce(tmpVolume.data(), this->theVolume.data(), numFloats, MPI_FLOAT, op, this->comm);
+    // the voxels [firstVoxel, lastVoxel) of theVolume are the part of this rank
+    // for computing the global min/max.
+    size_t firstVoxel = 0, lastVoxel = 0;
+    size_t transferred = numFloats;
+    bool ok = true;
+    if (mode == 0) {
+        // we need a copy of the data since we must not alter it.
+        std::vector<float> tmpVolume;
+        tmpVolume.resize(numFloats);
+        memcpy(tmpVolume.data(), inData.GetData(), numFloats * sizeof(float));
+        // and a copy to receive the result
+        this->theVolume.resize(numFloats);
+
+        MPI_Allreduce(tmpVolume.data(), this->theVolume.data(), numFloats, MPI_FLOAT, op, this->comm);
+
+        const size_t numVoxels = numFloats / comp;
+        const size_t chunkSize = numVoxels / this->mpiSize + 1;
+        firstVoxel = std::min<size_t>(this->mpiRank * chunkSize, numVoxels);
+        lastVoxel = std::min<size_t>((this->mpiRank + 1) * chunkSize, numVoxels);
+
+    } else {
+        // only bricks holding anything but the background on any rank take
+        // part in the reduction, all others are known to reduce to it.
+        VolumeBrickExchange exchange(this->comm, metadata.Resolution, comp, brickSize, op, background);
+        const auto input = static_cast<const float *>(inData.GetData());
+        const auto occupied = exchange.FindOccupiedBricks(input);
+        vislib::sys::Log::DefaultLog.WriteInfo("MPIVolumeAggregator: %zu bricks of %zu^3 voxels are occupied.",
+            occupied, brickSize);
+
+        if (mode == 1) {
+            this->theVolume.resize(numFloats);
+            ok = exchange.Allreduce(input, this->theVolume.data());
+            firstVoxel = exchange.SlabBegin(this->mpiRank) * metadata.Resolution[0] * metadata.Resolution[1];
+            lastVoxel = exchange.SlabEnd(this->mpiRank) * metadata.Resolution[0] * metadata.Resolution[1];
+
+        } else {
+            const size_t slabBegin = exchange.SlabBegin(this->mpiRank);
+            const size_t slabEnd = exchange.SlabEnd(this->mpiRank);
+            this->theVolume.resize(exchange.SlabSize(this->mpiRank));
+            ok = exchange.ReduceScatter(input, this->theVolume.data());
+            firstVoxel = 0;
+            lastVoxel = this->theVolume.size() / comp;
+
+            if (ok && gatherToRoot) {
+                std::vector<float> slab;
+                if (this->mpiRank == 0) {
+                    slab.swap(this->theVolume);
+                    this->theVolume.resize(numFloats);
+                } else {
+                    slab = this->theVolume;
+                }
+                ok = exchange.GatherSlabs(slab.data(), this->theVolume.data(), 0);
+                if (this->mpiRank != 0) {
+                    this->theVolume.swap(slab);
+                }
+            }
+            if (ok && (!gatherToRoot || (this->mpiRank != 0))) {
+                this->cropToSlab(slabBegin, slabEnd);
+            }
+        }
+        transferred = exchange.TransferSize();
+    }
+
+    if (!ok) {
+        vislib::sys::Log::DefaultLog.WriteError(
+            "MPIVolumeAggregator: the volume is too large for %s. Use a smaller volume or the Allreduce mode.",
+            modeName.PeekBuffer());
+        return false;
+    }
 
     const auto endTime = std::chrono::high_resolution_clock::now();
     std::chrono::duration<float, std::milli> diffMillis = endTime - startTime;
 
-    const int chunkSize = (numFloats) / this->mpiSize + 1;
     float min = std::numeric_limits<float>::max();
-    float max = 0.0f;
+    float max = std::numeric_limits<float>::lowest();
     float globalmin = min;
     float globalmax = max;
-    const int end = std::min<int>((this->mpiRank + 1) * chunkSize, numFloats);
-    for (int x = this->mpiRank * chunkSize; x < end; x += comp) {
+    for (size_t x = firstVoxel * comp; x < lastVoxel * comp; x += comp) {
         auto& d = this->theVolume.data()[x];
         if (d < min) {
             min = d;
@@ -152,8 +253,10 @@ bool datatools::MPIVolumeAggregator::manipulateData(
 
     const auto endAllTime = std::chrono::high_resolution_clock::now();
     std::chrono::duration<float, std::milli> diffAllMillis = endAllTime - startAllTime;
-    vislib::sys::Log::DefaultLog.WriteInfo("MPIVolumeAggregator: Allreduce of %u x %u x %u volume took %f ms.",
-        metadata.Resolution[0], metadata.Resolution[1], metadata.Resolution[2], diffMillis.count());
+    vislib::sys::Log::DefaultLog.WriteInfo(
+        "MPIVolumeAggregator: %s of %zu x %zu x %zu volume took %f ms, reducing %zu of %zu floats.",
+        modeName.PeekBuffer(), inData.GetMetadata()->Resolution[0], inData.GetMetadata()->Resolution[1],
+        inData.GetMetadata()->Resolution[2], diffMillis.count(), transferred, numFloats);
     vislib::sys::Log::DefaultLog.WriteInfo("MPIVolumeAggregator: volume aggregation of %u x %u x %u volume took %f ms.",
         metadata.Resolution[0], metadata.Resolution[1], metadata.Resolution[2], diffAllMillis.count());
 
@@ -200,10 +303,51 @@ bool datatools::MPIVolumeAggregator::initMPI() {
     return retval;
 }
 
-void datatools::MPIVolumeAggregator::release() {
+void datatools::MPIVolumeAggregator::release() { this->releaseMetadata(); }
+
+
+/*
+ * datatools::MPIVolumeAggregator::cropToSlab
+ */
+void datatools::MPIVolumeAggregator::cropToSlab(size_t zBegin, size_t zEnd) {
+    const size_t depth = zEnd - zBegin;
+    float* dists = this->metadata.SliceDists[2];
+
+    if (this->metadata.GridType == core::misc::RECTILINEAR) {
+        float offset = 0.0f;
+        for (size_t z = 0; z < zBegin; ++z) {
+            offset += dists[z];
+        }
+        float extent = 0.0f;
+        auto* slabDists = new float[(std::max)(depth, static_cast<size_t>(2)) - 1];
+        for (size_t z = 0; z + 1 < depth; ++z) {
+            slabDists[z] = dists[zBegin + z];
+            extent += slabDists[z];
+        }
+        delete[] dists;
+        this->metadata.SliceDists[2] = slabDists;
+        this->metadata.Origin[2] += offset;
+        this->metadata.Extents[2] = extent;
+    } else {
+        this->metadata.Origin[2] += zBegin * dists[0];
+        this->metadata.Extents[2] = (depth > 0) ? (depth - 1) * dists[0] : 0.0f;
+    }
+    this->metadata.Resolution[2] = depth;
+}
+
+
+/*
+ * datatools::MPIVolumeAggregator::releaseMetadata
+ */
+void datatools::MPIVolumeAggregator::releaseMetadata(void) {
     delete[] this->metadata.MinValues;
     delete[] this->metadata.MaxValues;
     delete[] this->metadata.SliceDists[0];
     delete[] this->metadata.SliceDists[1];
     delete[] this->metadata.SliceDists[2];
+    this->metadata.MinValues = nullptr;
+    this->metadata.MaxValues = nullptr;
+    this->metadata.SliceDists[0] = nullptr;
+    this->metadata.SliceDists[1] = nullptr;
+    this->metadata.SliceDists[2] = nullptr;
 }
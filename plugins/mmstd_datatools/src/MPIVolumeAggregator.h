@@ -27,6 +27,11 @@ namespace datatools {
      * This should be used for gathering large in situ SUBSAMPLED (ParticleThinner) data sets:
      * Everything is collected at once and MPI cannot push that much data
      * at once.
+     *
+     * Besides the plain Allreduce of the whole volume, the module can reduce
+     * only the bricks that are occupied on any rank, either leaving the
+     * full result on every rank or scattering it such that each rank keeps
+     * a slab along z, which can optionally be gathered on rank 0.
      */
     class MPIVolumeAggregator : public AbstractVolumeManipulator {
     public:
@@ -76,6 +81,15 @@ namespace datatools {
 
     private:
 
+        /**
+         * Restrict the metadata to the z layers [zBegin, zEnd) the rank keeps
+         * after a reduce-scatter.
+         */
+        void cropToSlab(size_t zBegin, size_t zEnd);
+
+        /** Free the arrays of the cloned metadata. */
+        void releaseMetadata(void);
+
 #ifdef WITH_MPI
         /** The communicator that the view uses. */
         MPI_Comm comm = MPI_COMM_NULL;
@@ -86,6 +100,18 @@ namespace datatools {
 
         core::param::ParamSlot operatorSlot;
 
+        /** The exchange scheme: Allreduce, sparse bricks or reduce-scatter slabs. */
+        core::param::ParamSlot modeSlot;
+
+        /** The edge length of the bricks in voxels. */
+        core::param::ParamSlot brickSizeSlot;
+
+        /** The value of empty voxels, which the brick-based modes skip for Max and Min. */
+        core::param::ParamSlot backgroundSlot;
+
+        /** Whether the slabs are gathered on rank 0 in reduce-scatter mode. */
+        core::param::ParamSlot gatherToRootSlot;
+
         core::misc::VolumetricDataCall::Metadata metadata;
 
         int mpiRank = 0;
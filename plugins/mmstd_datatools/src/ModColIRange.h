@@ -21,6 +21,7 @@ namespace datatools {
         static const char *ClassName(void) { return "ModIColRange"; }
         static const char *Description(void) { return "Mapps IColRange values periodically into the specified range."; }
         static bool IsAvailable(void) { return true; }
+        static bool IsCreateThreadSafe(void) { return true; }
 
         ModColIRange();
         virtual ~ModColIRange();
@@ -33,6 +33,8 @@ public:
     /** Module is always available */
     static bool IsAvailable(void) { return true; }
 
+    static bool IsCreateThreadSafe(void) { return true; }
+
     /** Ctor */
     OverrideParticleBBox(void);
 
@@ -41,6 +41,10 @@ namespace datatools {
             return true;
         }
 
+        static bool IsCreateThreadSafe(void) {
+            return true;
+        }
+
         /** Ctor */
         ParticleColorChannelSelect(void);
 
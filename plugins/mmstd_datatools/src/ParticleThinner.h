@@ -42,6 +42,10 @@ namespace datatools {
             return true;
         }
 
+        static bool IsCreateThreadSafe(void) {
+            return true;
+        }
+
         /** Ctor */
         ParticleThinner(void);
 
@@ -9,6 +9,7 @@
 #include "mmcore/param/EnumParam.h"
 #include "mmcore/param/FloatParam.h"
 #include "mmcore/param/BoolParam.h"
+#include "mmcore/param/IntParam.h"
 #include <algorithm>
 #include <chrono>
 #include <omp.h>
@@ -26,6 +27,7 @@ datatools::ParticleVisibilityFromVolume::ParticleVisibilityFromVolume(void)
     , valueSlot("ref", "the value for the operator")
     , epsilonSlot("epsilon", "the tolerance for equality")
     , absoluteSlot("absolute", "use absolute values instead of relative")
+    , levelSlot("level", "the level of the volume's resolution pyramid to sample (if the source has one)")
     //, cyclXSlot("cyclX", "Considers cyclic boundary conditions in X direction")
     //, cyclYSlot("cyclY", "Considers cyclic boundary conditions in Y direction")
     //, cyclZSlot("cyclZ", "Considers cyclic boundary conditions in Z direction")
@@ -39,6 +41,8 @@ datatools::ParticleVisibilityFromVolume::ParticleVisibilityFromVolume(void)
     this->MakeSlotAvailable(&this->epsilonSlot);
     this->absoluteSlot.SetParameter(new core::param::BoolParam(false));
     this->MakeSlotAvailable(&this->absoluteSlot);
+    this->levelSlot.SetParameter(new core::param::IntParam(0, 0));
+    this->MakeSlotAvailable(&this->levelSlot);
     this->minSlot.SetParameter(new core::param::FloatParam(0.0f));
     this->MakeSlotAvailable(&this->minSlot);
     this->maxSlot.SetParameter(new core::param::FloatParam(0.0f));
@@ -84,6 +88,30 @@ bool datatools::ParticleVisibilityFromVolume::manipulateData(
 
     auto* inVol = this->volumeSlot.CallAs<VolumetricDataCall>();
     inVol->SetFrameID(outData.FrameID());
+
+    // only request the part of the volume covered by the particles, bricked sources then only page in these
+    inVol->SetRequestedLevel(this->levelSlot.Param<core::param::IntParam>()->Value());
+    inVol->ResetRequestedRegion();
+    if (inData.AccessBoundingBoxes().IsObjectSpaceBBoxValid() && (*inVol)(VolumetricDataCall::IDX_GET_METADATA) &&
+        inVol->GetMetadata() != nullptr) {
+        const auto* fullMeta = inVol->GetMetadata();
+        const auto& bbox = inData.AccessBoundingBoxes().ObjectSpaceBBox();
+        const float lo[3] = {bbox.Left(), bbox.Bottom(), bbox.Back()};
+        const float hi[3] = {bbox.Right(), bbox.Top(), bbox.Front()};
+        size_t regionMin[3], regionMax[3];
+        for (int d = 0; d < 3; ++d) {
+            const auto res = static_cast<float>(fullMeta->Resolution[d]);
+            const float dist = fullMeta->SliceDists[d][0];
+            // one voxel of margin for the trilinear neighbours
+            const float first = (lo[d] - fullMeta->Origin[d]) / dist - 1.0f;
+            const float last = (hi[d] - fullMeta->Origin[d]) / dist + 2.0f;
+            regionMin[d] = static_cast<size_t>(std::clamp(first, 0.0f, res - 1.0f));
+            regionMax[d] = static_cast<size_t>(std::clamp(last, 1.0f, res));
+            regionMax[d] = std::max(regionMax[d], regionMin[d] + 1);
+        }
+        inVol->SetRequestedRegion(regionMin, regionMax);
+    }
+
     if (!(*inVol)(1)) {
         vislib::sys::Log::DefaultLog.WriteError("ParticleVisibilityFromVolume: cannot get extents of volume");
         return false;
@@ -106,7 +134,7 @@ bool datatools::ParticleVisibilityFromVolume::manipulateData(
 
     if (inData.FrameID() == this->lastTime && inData.DataHash() == this->lastParticleHash &&
         inVol->DataHash() == this->lastVolumeHash && !operatorSlot.IsDirty() && !valueSlot.IsDirty() && !epsilonSlot.IsDirty()
-        && !absoluteSlot.IsDirty()) {
+        && !absoluteSlot.IsDirty() && !levelSlot.IsDirty()) {
         // everything should already be correct
         return true;
     }
@@ -134,14 +162,6 @@ bool datatools::ParticleVisibilityFromVolume::manipulateData(
     //bool cycl_y = this->cyclYSlot.Param<megamol::core::param::BoolParam>()->Value();
     //bool cycl_z = this->cyclZSlot.Param<megamol::core::param::BoolParam>()->Value();
 
-    typedef const float (VolumetricDataCall::*getter)(const uint32_t, const uint32_t, const uint32_t, const uint32_t) const;
-    getter getFun;
-    if (absolute) {
-        getFun = &VolumetricDataCall::GetAbsoluteVoxelValue;
-    } else {
-        getFun = &VolumetricDataCall::GetRelativeVoxelValue;
-    }
-
     vislib::sys::Log::DefaultLog.WriteInfo("ParticleVisibilityFromVolume: starting filtering");
     const auto startTime = std::chrono::high_resolution_clock::now();
 
@@ -186,67 +206,57 @@ bool datatools::ParticleVisibilityFromVolume::manipulateData(
             theColorData[i].resize(cnt * cdsize);
         }
 
-#ifdef _OPENMP
-        const auto numThreads = omp_get_num_threads();
-#endif
-
         auto const& parStore = p.GetParticleStore();
         auto const& xAcc = parStore.GetXAcc();
         auto const& yAcc = parStore.GetYAcc();
         auto const& zAcc = parStore.GetZAcc();
 
-        // todo: is this OK?
-        #pragma omp parallel for
-        for (INT64 j = 0; j < cnt; ++j) {
-            const auto x = xAcc->Get_f(j);
-            const auto y = yAcc->Get_f(j);
-            const auto z = zAcc->Get_f(j);
-
-            // relative coordinates in volume
-            const auto rx = (x - volMeta->Origin[0]) / volMeta->SliceDists[0][0];
-            const auto ry = (y - volMeta->Origin[1]) / volMeta->SliceDists[1][0];
-            const auto rz = (z - volMeta->Origin[2]) / volMeta->SliceDists[2][0];
-
-            const int quantX = static_cast<int>(rx);
-            const int quantY = static_cast<int>(ry);
-            const int quantZ = static_cast<int>(rz);
-            int quantX2 = quantX;
-            int quantY2 = quantY;
-            int quantZ2 = quantZ;
-            const float diffX = rx - quantX;
-            const float diffY = ry - quantY;
-            const float diffZ = rz - quantZ;
-
-            if (quantX >= 0 || quantX < static_cast<int>(volMeta->Resolution[0]) || quantY >= 0 ||
-                quantY < static_cast<int>(volMeta->Resolution[1]) || quantZ >= 0 ||
-                quantZ < static_cast<int>(volMeta->Resolution[2])) {
-                // OK actually
-            } else {
-                volumeIsNotBBoxAligned = true;
+        // transform the particles into voxel coordinates, which allows for
+        // sampling all of them in bulk afterwards.
+        std::vector<float> positions(3 * cnt);
+        std::vector<uint8_t> isInside(cnt);
+        std::vector<float> values(cnt);
+        bool listIsNotBBoxAligned = false;
+
+#pragma omp parallel for reduction(|| : listIsNotBBoxAligned)
+        for (INT64 j = 0; j < static_cast<INT64>(cnt); ++j) {
+            const auto rx = (xAcc->Get_f(j) - volMeta->Origin[0]) / volMeta->SliceDists[0][0];
+            const auto ry = (yAcc->Get_f(j) - volMeta->Origin[1]) / volMeta->SliceDists[1][0];
+            const auto rz = (zAcc->Get_f(j) - volMeta->Origin[2]) / volMeta->SliceDists[2][0];
+
+            isInside[j] = (rx >= 0.0f && rx < static_cast<float>(volMeta->Resolution[0]) && ry >= 0.0f &&
+                           ry < static_cast<float>(volMeta->Resolution[1]) && rz >= 0.0f &&
+                           rz < static_cast<float>(volMeta->Resolution[2]));
+            listIsNotBBoxAligned = listIsNotBBoxAligned || !isInside[j];
+
+            positions[3 * j + 0] = rx;
+            positions[3 * j + 1] = ry;
+            positions[3 * j + 2] = rz;
+        }
+        volumeIsNotBBoxAligned = volumeIsNotBBoxAligned || listIsNotBBoxAligned;
+
+        // the right neighbour is clamped at the border, which has no relevance
+        // since its influence is pulled to 0 there anyway.
+        const INT64 batchSize = 4096;
+        bool sampled = true;
+#pragma omp parallel for reduction(&& : sampled)
+        for (INT64 first = 0; first < static_cast<INT64>(cnt); first += batchSize) {
+            const auto batch = std::min<INT64>(batchSize, static_cast<INT64>(cnt) - first);
+            sampled = inVol->SampleTrilinear(positions.data() + 3 * first, batch, values.data() + first, channel,
+                          !absolute) &&
+                      sampled;
+        }
+        if (!sampled) {
+            vislib::sys::Log::DefaultLog.WriteError("ParticleVisibilityFromVolume: cannot sample the volume");
+            return false;
+        }
+
+        for (UINT64 j = 0; j < cnt; ++j) {
+            if (!isInside[j]) {
                 continue;
             }
 
-            // warning: we fake CBC here which has no relevance since at the right border,
-            // the right neighbor influence should be pulled to 0 anyway
-            quantX2 = std::max<size_t>(0, std::min<size_t>(volMeta->Resolution[0] - 1, quantX + 1));
-            quantY2 = std::max<size_t>(0, std::min<size_t>(volMeta->Resolution[1] - 1, quantY + 1));
-            quantZ2 = std::max<size_t>(0, std::min<size_t>(volMeta->Resolution[2] - 1, quantZ + 1));
-
-            const float c000 = ((inVol)->*(getFun))(quantX, quantY, quantZ, channel);
-            const float c100 = ((inVol)->*(getFun))(quantX2, quantY, quantZ, channel);
-            const float c010 = ((inVol)->*(getFun))(quantX, quantY2, quantZ, channel);
-            const float c110 = ((inVol)->*(getFun))(quantX2, quantY2, quantZ, channel);
-            const float c001 = ((inVol)->*(getFun))(quantX, quantY, quantZ2, channel);
-            const float c101 = ((inVol)->*(getFun))(quantX2, quantY, quantZ2, channel);
-            const float c011 = ((inVol)->*(getFun))(quantX, quantY2, quantZ2, channel);
-            const float c111 = ((inVol)->*(getFun))(quantX2, quantY2, quantZ2, channel);
-
-            float volVal = (1.0f - diffX) * (1.0f - diffY) * (1.0f - diffZ) * c000 +
-                           diffX * (1.0f - diffY) * (1.0f - diffZ) * c100 +
-                           (1.0f - diffX) * diffY * (1.0f - diffZ) * c010 + diffX * diffY * (1.0f - diffZ) * c110 +
-                           (1.0f - diffX) * (1.0f - diffY) * diffZ * c001 + diffX * (1.0f - diffY) * diffZ * c101 +
-                           (1.0f - diffX) * diffY * diffZ * c011 + diffX * diffY * diffZ * c111;
-
+            const float volVal = values[j];
             bool isOK = false;
             switch (op) {
             case 0:
@@ -264,18 +274,12 @@ bool datatools::ParticleVisibilityFromVolume::manipulateData(
             }
 
             if (isOK) {
-#ifdef _OPENMP
-                const UINT64 localIdx = cntLeft + omp_get_thread_num();
-#else
-                const UINT64 localIdx = cntLeft;
-#endif
                 if (isInterleaved) {
-                    memcpy(theVertexData[i].data() + vdstride * localIdx, commonBasePointer + vdstride * j, vdstride);
+                    memcpy(theVertexData[i].data() + vdstride * cntLeft, commonBasePointer + vdstride * j, vdstride);
                 } else {
-                    memcpy(theVertexData[i].data() + vdsize * localIdx, vertexBasePointer + vdstride * j, vdsize);
-                    memcpy(theColorData[i].data() + cdsize * localIdx, colorBasePointer + cdstride * j, cdsize);
+                    memcpy(theVertexData[i].data() + vdsize * cntLeft, vertexBasePointer + vdstride * j, vdsize);
+                    memcpy(theColorData[i].data() + cdsize * cntLeft, colorBasePointer + cdstride * j, cdsize);
                 }
-                #pragma omp atomic
                 cntLeft++;
             }
         }
@@ -72,6 +72,9 @@ private:
     /** use absolute values instead */
     core::param::ParamSlot absoluteSlot;
 
+    /** the level of the resolution pyramid of the volume to sample */
+    core::param::ParamSlot levelSlot;
+
     //core::param::ParamSlot cyclXSlot;
     //core::param::ParamSlot cyclYSlot;
     //core::param::ParamSlot cyclZSlot;
@@ -0,0 +1,256 @@
+/*
+ * VolumeBrickExchange.cpp
+ *
+ * Copyright (C) 2020 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+#include "stdafx.h"
+#include "VolumeBrickExchange.h"
+
+#ifdef WITH_MPI
+#include <algorithm>
+#include <climits>
+
+using namespace megamol;
+using namespace megamol::stdplugin;
+
+
+/*
+ * datatools::VolumeBrickExchange::VolumeBrickExchange
+ */
+datatools::VolumeBrickExchange::VolumeBrickExchange(MPI_Comm comm, const size_t resolution[3],
+    size_t components, size_t brickSize, MPI_Op op, float background)
+    : background(background)
+    , brickSize((std::max)(brickSize, static_cast<size_t>(1)))
+    , comm(comm)
+    , components(components)
+    , op(op)
+    , planeSize(resolution[0] * resolution[1] * components)
+    , rank(0)
+    , size(1) {
+    for (int d = 0; d < 3; ++d) {
+        this->resolution[d] = resolution[d];
+        this->bricks[d] = (resolution[d] + this->brickSize - 1) / this->brickSize;
+    }
+    ::MPI_Comm_rank(this->comm, &this->rank);
+    ::MPI_Comm_size(this->comm, &this->size);
+}
+
+
+/*
+ * datatools::VolumeBrickExchange::FindOccupiedBricks
+ */
+size_t datatools::VolumeBrickExchange::FindOccupiedBricks(const float *volume) {
+    const int64_t numBricks = static_cast<int64_t>(this->bricks[0] * this->bricks[1] * this->bricks[2]);
+    std::vector<unsigned char> mask(numBricks, 0);
+
+#pragma omp parallel for schedule(dynamic)
+    for (int64_t b = 0; b < numBricks; ++b) {
+        size_t begin[3], end[3];
+        this->brickRange(static_cast<size_t>(b), begin, end);
+        const size_t rowLength = (end[0] - begin[0]) * this->components;
+        for (size_t z = begin[2]; (z < end[2]) && (mask[b] == 0); ++z) {
+            for (size_t y = begin[1]; (y < end[1]) && (mask[b] == 0); ++y) {
+                const float *row = volume + (z * this->resolution[1] + y) * this->resolution[0] * this->components
+                                   + begin[0] * this->components;
+                for (size_t i = 0; i < rowLength; ++i) {
+                    if (row[i] != this->background) {
+                        mask[b] = 1;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    // a brick must be transferred if it is occupied on any rank.
+    ::MPI_Allreduce(MPI_IN_PLACE, mask.data(), static_cast<int>(numBricks), MPI_UNSIGNED_CHAR, MPI_BOR, this->comm);
+
+    this->occupied.clear();
+    this->offsets.clear();
+    this->offsets.push_back(0);
+    for (int64_t b = 0; b < numBricks; ++b) {
+        if (mask[b] != 0) {
+            size_t begin[3], end[3];
+            this->brickRange(static_cast<size_t>(b), begin, end);
+            this->occupied.push_back(static_cast<size_t>(b));
+            this->offsets.push_back(this->offsets.back()
+                                    + (end[0] - begin[0]) * (end[1] - begin[1]) * (end[2] - begin[2])
+                                          * this->components);
+        }
+    }
+
+    return this->occupied.size();
+}
+
+
+/*
+ * datatools::VolumeBrickExchange::Allreduce
+ */
+bool datatools::VolumeBrickExchange::Allreduce(const float *volume, float *result) {
+    this->pack(volume);
+
+    // the packed bricks can still exceed an int, so reduce in pieces.
+    const size_t chunk = static_cast<size_t>(INT_MAX);
+    for (size_t first = 0; first < this->packed.size(); first += chunk) {
+        const size_t cnt = (std::min)(chunk, this->packed.size() - first);
+        ::MPI_Allreduce(MPI_IN_PLACE, this->packed.data() + first, static_cast<int>(cnt), MPI_FLOAT, this->op,
+            this->comm);
+    }
+
+    std::fill(result, result + this->resolution[2] * this->planeSize, this->background);
+    this->unpack(this->packed.data(), 0, this->occupied.size(), result, 0);
+    return true;
+}
+
+
+/*
+ * datatools::VolumeBrickExchange::ReduceScatter
+ */
+bool datatools::VolumeBrickExchange::ReduceScatter(const float *volume, float *slab) {
+    this->pack(volume);
+
+    // the occupied bricks are sorted by z layer, so the bricks of each rank
+    // are a contiguous range.
+    const size_t layerBricks = this->bricks[0] * this->bricks[1];
+    std::vector<size_t> firstBrick(this->size + 1);
+    for (int r = 0; r <= this->size; ++r) {
+        firstBrick[r] = std::lower_bound(this->occupied.begin(), this->occupied.end(),
+                            this->firstLayer(r) * layerBricks) - this->occupied.begin();
+    }
+
+    std::vector<int> counts(this->size);
+    bool fits = true;
+    for (int r = 0; r < this->size; ++r) {
+        const size_t cnt = this->offsets[firstBrick[r + 1]] - this->offsets[firstBrick[r]];
+        fits = fits && (cnt <= static_cast<size_t>(INT_MAX));
+        counts[r] = static_cast<int>(cnt);
+    }
+    if (!fits) {
+        // all ranks come to the same conclusion, so nobody is left waiting.
+        return false;
+    }
+
+    std::vector<float> mine(counts[this->rank]);
+    ::MPI_Reduce_scatter(this->packed.data(), mine.data(), counts.data(), MPI_FLOAT, this->op, this->comm);
+
+    std::fill(slab, slab + this->SlabSize(this->rank), this->background);
+    this->unpack(mine.data(), firstBrick[this->rank], firstBrick[this->rank + 1], slab,
+        this->SlabBegin(this->rank));
+    return true;
+}
+
+
+/*
+ * datatools::VolumeBrickExchange::GatherSlabs
+ */
+bool datatools::VolumeBrickExchange::GatherSlabs(const float *slab, float *result, int root) {
+    // counting in z planes keeps the counts small for any realistic volume.
+    if (this->planeSize > static_cast<size_t>(INT_MAX)) {
+        return false;
+    }
+
+    MPI_Datatype planeType;
+    ::MPI_Type_contiguous(static_cast<int>(this->planeSize), MPI_FLOAT, &planeType);
+    ::MPI_Type_commit(&planeType);
+
+    std::vector<int> counts(this->size), displs(this->size);
+    for (int r = 0; r < this->size; ++r) {
+        counts[r] = static_cast<int>(this->SlabEnd(r) - this->SlabBegin(r));
+        displs[r] = static_cast<int>(this->SlabBegin(r));
+    }
+    ::MPI_Gatherv(slab, counts[this->rank], planeType, result, counts.data(), displs.data(), planeType, root,
+        this->comm);
+
+    ::MPI_Type_free(&planeType);
+    return true;
+}
+
+
+/*
+ * datatools::VolumeBrickExchange::SlabBegin
+ */
+size_t datatools::VolumeBrickExchange::SlabBegin(int rank) const {
+    return (std::min)(this->firstLayer(rank) * this->brickSize, this->resolution[2]);
+}
+
+
+/*
+ * datatools::VolumeBrickExchange::SlabEnd
+ */
+size_t datatools::VolumeBrickExchange::SlabEnd(int rank) const {
+    return (std::min)(this->firstLayer(rank + 1) * this->brickSize, this->resolution[2]);
+}
+
+
+/*
+ * datatools::VolumeBrickExchange::brickRange
+ */
+void datatools::VolumeBrickExchange::brickRange(size_t idx, size_t begin[3], size_t end[3]) const {
+    const size_t pos[3] = {idx % this->bricks[0], (idx / this->bricks[0]) % this->bricks[1],
+        idx / (this->bricks[0] * this->bricks[1])};
+    for (int d = 0; d < 3; ++d) {
+        begin[d] = pos[d] * this->brickSize;
+        end[d] = (std::min)(begin[d] + this->brickSize, this->resolution[d]);
+    }
+}
+
+
+/*
+ * datatools::VolumeBrickExchange::firstLayer
+ */
+size_t datatools::VolumeBrickExchange::firstLayer(int rank) const {
+    return this->bricks[2] * static_cast<size_t>(rank) / static_cast<size_t>(this->size);
+}
+
+
+/*
+ * datatools::VolumeBrickExchange::pack
+ */
+void datatools::VolumeBrickExchange::pack(const float *volume) {
+    this->packed.resize(this->offsets.back());
+    const int64_t cnt = static_cast<int64_t>(this->occupied.size());
+
+#pragma omp parallel for schedule(dynamic)
+    for (int64_t i = 0; i < cnt; ++i) {
+        size_t begin[3], end[3];
+        this->brickRange(this->occupied[i], begin, end);
+        const size_t rowLength = (end[0] - begin[0]) * this->components;
+        float *dst = this->packed.data() + this->offsets[i];
+        for (size_t z = begin[2]; z < end[2]; ++z) {
+            for (size_t y = begin[1]; y < end[1]; ++y) {
+                const float *row = volume + (z * this->resolution[1] + y) * this->resolution[0] * this->components
+                                   + begin[0] * this->components;
+                std::copy(row, row + rowLength, dst);
+                dst += rowLength;
+            }
+        }
+    }
+}
+
+
+/*
+ * datatools::VolumeBrickExchange::unpack
+ */
+void datatools::VolumeBrickExchange::unpack(
+    const float *src, size_t firstBrick, size_t lastBrick, float *dst, size_t zOffset) const {
+    const size_t base = this->offsets[firstBrick];
+
+#pragma omp parallel for schedule(dynamic)
+    for (int64_t i = static_cast<int64_t>(firstBrick); i < static_cast<int64_t>(lastBrick); ++i) {
+        size_t begin[3], end[3];
+        this->brickRange(this->occupied[i], begin, end);
+        const size_t rowLength = (end[0] - begin[0]) * this->components;
+        const float *from = src + (this->offsets[i] - base);
+        for (size_t z = begin[2]; z < end[2]; ++z) {
+            for (size_t y = begin[1]; y < end[1]; ++y) {
+                float *row = dst + ((z - zOffset) * this->resolution[1] + y) * this->resolution[0] * this->components
+                             + begin[0] * this->components;
+                std::copy(from, from + rowLength, row);
+                from += rowLength;
+            }
+        }
+    }
+}
+
+#endif /* WITH_MPI */
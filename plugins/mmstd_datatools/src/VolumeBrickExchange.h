@@ -0,0 +1,169 @@
+/*
+ * VolumeBrickExchange.h
+ *
+ * Copyright (C) 2020 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MEGAMOLCORE_VOLUMEBRICKEXCHANGE_H_INCLUDED
+#define MEGAMOLCORE_VOLUMEBRICKEXCHANGE_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#ifdef WITH_MPI
+#include "mpi.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace megamol {
+namespace stdplugin {
+namespace datatools {
+
+    /**
+     * Reduces identically-sized float volumes over MPI brick by brick,
+     * transferring only bricks that hold anything but the background value
+     * on at least one rank. All other bricks are set to the background.
+     *
+     * This is exact if the background is the identity of the reduction
+     * operator, e.g. 0 for MPI_SUM. For idempotent operators like MPI_MAX
+     * and MPI_MIN any background is exact, so a volume with an empty
+     * background of 0 can skip its empty bricks for these, too.
+     *
+     * The volume is split into cubic bricks of brickSize voxels per edge
+     * (smaller at the upper borders). Bricks are numbered x-fastest, so
+     * the bricks of one z layer are contiguous, and each rank owns a slab
+     * of consecutive layers for the reduce-scatter.
+     *
+     * All methods except the Slab* queries are collective.
+     */
+    class VolumeBrickExchange {
+    public:
+
+        /**
+         * Ctor.
+         *
+         * @param comm       The communicator of the participating ranks.
+         * @param resolution The number of voxels in x, y and z.
+         * @param components The number of floats per voxel.
+         * @param brickSize  The edge length of a brick in voxels.
+         * @param op         The reduction operator.
+         * @param background The value of empty voxels, see above.
+         */
+        VolumeBrickExchange(MPI_Comm comm, const size_t resolution[3], size_t components, size_t brickSize,
+            MPI_Op op, float background);
+
+        /**
+         * Find the bricks of 'volume' that do not just hold the background
+         * and agree on the union of these bricks with all ranks.
+         *
+         * @param volume The local volume.
+         *
+         * @return The number of bricks that are non-empty on any rank.
+         */
+        size_t FindOccupiedBricks(const float *volume);
+
+        /**
+         * Reduce the occupied bricks, leaving the full result on all ranks.
+         * Requires FindOccupiedBricks() before.
+         *
+         * @param volume The local volume.
+         * @param result Receives the reduced volume.
+         *
+         * @return false if the packed bricks exceed the element count of MPI.
+         */
+        bool Allreduce(const float *volume, float *result);
+
+        /**
+         * Reduce the occupied bricks, leaving each rank with its slab only.
+         * Requires FindOccupiedBricks() before.
+         *
+         * @param volume The local volume.
+         * @param slab   Receives the reduced slab of the calling rank, which
+         *               is SlabSize(rank) floats.
+         *
+         * @return false if the packed bricks exceed the element count of MPI.
+         */
+        bool ReduceScatter(const float *volume, float *slab);
+
+        /**
+         * Collect the slabs of all ranks on 'root'.
+         *
+         * @param slab   The slab of the calling rank.
+         * @param result Receives the full volume, only used on 'root'.
+         * @param root   The rank collecting the volume.
+         *
+         * @return false if a slab exceeds the element count of MPI.
+         */
+        bool GatherSlabs(const float *slab, float *result, int root);
+
+        /** Answer the first z layer of voxels owned by 'rank'. */
+        size_t SlabBegin(int rank) const;
+
+        /** Answer one past the last z layer of voxels owned by 'rank'. */
+        size_t SlabEnd(int rank) const;
+
+        /** Answer the number of floats in the slab of 'rank'. */
+        inline size_t SlabSize(int rank) const {
+            return (this->SlabEnd(rank) - this->SlabBegin(rank)) * this->planeSize;
+        }
+
+        /** Answer the number of floats of the occupied bricks in the last exchange. */
+        inline size_t TransferSize(void) const {
+            return this->packed.size();
+        }
+
+    private:
+
+        /** Answer the voxel range [begin, end) of brick 'idx' in each dimension. */
+        void brickRange(size_t idx, size_t begin[3], size_t end[3]) const;
+
+        /** Answer the first brick layer owned by 'rank'. */
+        size_t firstLayer(int rank) const;
+
+        /** Pack the occupied bricks of 'volume' into 'packed'. */
+        void pack(const float *volume);
+
+        /**
+         * Unpack the occupied bricks [firstBrick, lastBrick) from 'src' into
+         * 'dst', whose first z layer is 'zOffset'.
+         */
+        void unpack(const float *src, size_t firstBrick, size_t lastBrick, float *dst, size_t zOffset) const;
+
+        float background;
+
+        size_t bricks[3];
+
+        size_t brickSize;
+
+        MPI_Comm comm;
+
+        size_t components;
+
+        /** The indices of the bricks occupied on any rank in ascending order. */
+        std::vector<size_t> occupied;
+
+        /** The offset of each occupied brick in 'packed', plus the total size. */
+        std::vector<size_t> offsets;
+
+        MPI_Op op;
+
+        std::vector<float> packed;
+
+        size_t planeSize;
+
+        int rank;
+
+        size_t resolution[3];
+
+        int size;
+    };
+
+} /* end namespace datatools */
+} /* end namespace stdplugin */
+} /* end namespace megamol */
+
+#endif /* WITH_MPI */
+#endif /* MEGAMOLCORE_VOLUMEBRICKEXCHANGE_H_INCLUDED */
@@ -0,0 +1,503 @@
+/*
+ * ColumnExpression.cpp
+ *
+ * Copyright (C) 2020 by VISUS (University of Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+
+#include "stdafx.h"
+#include "ColumnExpression.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <stdexcept>
+
+using namespace megamol::stdplugin::datatools;
+using namespace megamol::stdplugin::datatools::table;
+using namespace megamol;
+
+namespace {
+
+template <class F> inline void unary(float* dst, const float* a, size_t n, F f) {
+    for (size_t i = 0; i < n; ++i) dst[i] = f(a[i]);
+}
+
+template <class F> inline void binary(float* dst, const float* a, const float* b, size_t n, F f) {
+    for (size_t i = 0; i < n; ++i) dst[i] = f(a[i], b[i]);
+}
+
+template <class F> inline void ternary(float* dst, const float* a, const float* b, const float* c, size_t n, F f) {
+    for (size_t i = 0; i < n; ++i) dst[i] = f(a[i], b[i], c[i]);
+}
+
+} // namespace
+
+
+/*
+ * Recursive descent parser emitting the instructions of a ColumnExpression.
+ */
+class ColumnExpression::Parser {
+public:
+    Parser(ColumnExpression& owner, const std::string& source, const std::vector<std::string>& columnNames)
+        : owner(owner), source(source), pos(0), columnNames(columnNames)
+        , columnRegs(columnNames.size(), std::numeric_limits<uint32_t>::max()) {}
+
+    void ParseAll(void) {
+        while (this->skipSeparators()) {
+            const std::string name = this->parseName();
+            this->skipSpace();
+            if (!this->accept("=") || this->peek() == '=') {
+                this->fail("expected '=' after '" + name + "'");
+            }
+            const uint32_t reg = this->parseExpression();
+            this->skipSpace();
+            if (this->pos < this->source.size() && !this->isSeparator(this->source[this->pos])) {
+                this->fail("unexpected character");
+            }
+
+            this->names[name] = reg;
+            auto it = std::find_if(this->owner.outputs.begin(), this->owner.outputs.end(),
+                [&name](const Output& o) { return o.name == name; });
+            if (it != this->owner.outputs.end()) {
+                it->reg = reg;
+            } else {
+                this->owner.outputs.push_back(Output{name, reg});
+            }
+        }
+    }
+
+private:
+    bool isSeparator(char c) const { return c == '\n' || c == ';' || c == '#'; }
+
+    void fail(const std::string& what) const {
+        throw std::runtime_error(what + " at position " + std::to_string(this->pos));
+    }
+
+    /** skip blanks within a statement */
+    void skipSpace(void) {
+        while (this->pos < this->source.size() &&
+               (this->source[this->pos] == ' ' || this->source[this->pos] == '\t' || this->source[this->pos] == '\r')) {
+            ++this->pos;
+        }
+    }
+
+    /** skip blanks, separators and comments between statements, returns whether there is another one */
+    bool skipSeparators(void) {
+        while (this->pos < this->source.size()) {
+            const char c = this->source[this->pos];
+            if (c == '#') {
+                while (this->pos < this->source.size() && this->source[this->pos] != '\n') ++this->pos;
+            } else if (std::isspace(static_cast<unsigned char>(c)) || c == ';') {
+                ++this->pos;
+            } else {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    char peek(void) {
+        this->skipSpace();
+        return (this->pos < this->source.size()) ? this->source[this->pos] : '\0';
+    }
+
+    bool accept(const char* token) {
+        this->skipSpace();
+        const size_t len = std::char_traits<char>::length(token);
+        if (this->source.compare(this->pos, len, token) == 0) {
+            this->pos += len;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(const char* token) {
+        if (!this->accept(token)) this->fail(std::string("expected '") + token + "'");
+    }
+
+    std::string parseName(void) {
+        this->skipSpace();
+        if (this->accept("[")) {
+            const size_t end = this->source.find(']', this->pos);
+            if (end == std::string::npos) this->fail("missing ']'");
+            std::string name = this->source.substr(this->pos, end - this->pos);
+            this->pos = end + 1;
+            return name;
+        }
+        const size_t start = this->pos;
+        while (this->pos < this->source.size() &&
+               (std::isalnum(static_cast<unsigned char>(this->source[this->pos])) || this->source[this->pos] == '_' ||
+                   this->source[this->pos] == '.')) {
+            ++this->pos;
+        }
+        if (start == this->pos || std::isdigit(static_cast<unsigned char>(this->source[start]))) {
+            this->pos = start;
+            this->fail("expected a name");
+        }
+        return this->source.substr(start, this->pos - start);
+    }
+
+    uint32_t parseExpression(void) {
+        const uint32_t cond = this->parseOr();
+        if (this->accept("?")) {
+            const uint32_t a = this->parseExpression();
+            this->expect(":");
+            const uint32_t b = this->parseExpression();
+            return this->owner.emit(OpCode::SELECT, cond, a, b);
+        }
+        return cond;
+    }
+
+    uint32_t parseOr(void) {
+        uint32_t lhs = this->parseAnd();
+        while (this->accept("||")) {
+            lhs = this->owner.emit(OpCode::OR, lhs, this->parseAnd());
+        }
+        return lhs;
+    }
+
+    uint32_t parseAnd(void) {
+        uint32_t lhs = this->parseComparison();
+        while (this->accept("&&")) {
+            lhs = this->owner.emit(OpCode::AND, lhs, this->parseComparison());
+        }
+        return lhs;
+    }
+
+    uint32_t parseComparison(void) {
+        const uint32_t lhs = this->parseSum();
+        static const std::pair<const char*, OpCode> ops[] = {{"<=", OpCode::LE}, {">=", OpCode::GE},
+            {"==", OpCode::EQ}, {"!=", OpCode::NE}, {"<", OpCode::LT}, {">", OpCode::GT}};
+        for (auto& o : ops) {
+            if (this->accept(o.first)) {
+                return this->owner.emit(o.second, lhs, this->parseSum());
+            }
+        }
+        return lhs;
+    }
+
+    uint32_t parseSum(void) {
+        uint32_t lhs = this->parseProduct();
+        while (true) {
+            if (this->accept("+")) {
+                lhs = this->owner.emit(OpCode::ADD, lhs, this->parseProduct());
+            } else if (this->accept("-")) {
+                lhs = this->owner.emit(OpCode::SUB, lhs, this->parseProduct());
+            } else {
+                return lhs;
+            }
+        }
+    }
+
+    uint32_t parseProduct(void) {
+        uint32_t lhs = this->parseUnary();
+        while (true) {
+            if (this->accept("*")) {
+                lhs = this->owner.emit(OpCode::MUL, lhs, this->parseUnary());
+            } else if (this->accept("/")) {
+                lhs = this->owner.emit(OpCode::DIV, lhs, this->parseUnary());
+            } else if (this->accept("%")) {
+                lhs = this->owner.emit(OpCode::MOD, lhs, this->parseUnary());
+            } else {
+                return lhs;
+            }
+        }
+    }
+
+    uint32_t parseUnary(void) {
+        if (this->accept("-")) {
+            return this->owner.emit(OpCode::NEG, this->parseUnary());
+        }
+        if (this->accept("+")) {
+            return this->parseUnary();
+        }
+        if (this->peek() == '!' && this->source.compare(this->pos, 2, "!=") != 0) {
+            ++this->pos;
+            return this->owner.emit(OpCode::NOT, this->parseUnary());
+        }
+        const uint32_t base = this->parsePrimary();
+        if (this->accept("^")) {
+            // right-associative and binding tighter than a unary minus on its left
+            return this->owner.emit(OpCode::POW, base, this->parseUnary());
+        }
+        return base;
+    }
+
+    uint32_t parsePrimary(void) {
+        const char c = this->peek();
+        if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+            const char* begin = this->source.c_str() + this->pos;
+            char* end = nullptr;
+            const float value = std::strtof(begin, &end);
+            if (end == begin) this->fail("malformed number");
+            this->pos += end - begin;
+            return this->owner.emitConstant(value);
+        }
+        if (this->accept("(")) {
+            const uint32_t retval = this->parseExpression();
+            this->expect(")");
+            return retval;
+        }
+
+        const bool bracketed = (c == '[');
+        const std::string name = this->parseName();
+        if (!bracketed && this->peek() == '(') {
+            return this->parseCall(name);
+        }
+        return this->resolve(name);
+    }
+
+    uint32_t parseCall(const std::string& name) {
+        static const std::map<std::string, OpCode> functions = {{"abs", OpCode::ABS}, {"sqrt", OpCode::SQRT},
+            {"exp", OpCode::EXP}, {"log", OpCode::LOG}, {"log10", OpCode::LOG10}, {"sin", OpCode::SIN},
+            {"cos", OpCode::COS}, {"tan", OpCode::TAN}, {"asin", OpCode::ASIN}, {"acos", OpCode::ACOS},
+            {"atan", OpCode::ATAN}, {"atan2", OpCode::ATAN2}, {"pow", OpCode::POW}, {"min", OpCode::MIN},
+            {"max", OpCode::MAX}, {"floor", OpCode::FLOOR}, {"ceil", OpCode::CEIL}, {"round", OpCode::ROUND},
+            {"clamp", OpCode::CLAMP}, {"if", OpCode::SELECT}};
+
+        const auto it = functions.find(name);
+        if (it == functions.end()) this->fail("unknown function '" + name + "'");
+
+        this->expect("(");
+        uint32_t args[3] = {0, 0, 0};
+        const unsigned int cnt = ColumnExpression::arity(it->second);
+        for (unsigned int i = 0; i < cnt; ++i) {
+            if (i > 0) this->expect(",");
+            args[i] = this->parseExpression();
+        }
+        this->expect(")");
+        return this->owner.emit(it->second, args[0], args[1], args[2]);
+    }
+
+    uint32_t resolve(const std::string& name) {
+        const auto assigned = this->names.find(name);
+        if (assigned != this->names.end()) {
+            return assigned->second;
+        }
+        for (size_t i = 0; i < this->columnNames.size(); ++i) {
+            if (this->columnNames[i] == name) {
+                if (this->columnRegs[i] == std::numeric_limits<uint32_t>::max()) {
+                    this->columnRegs[i] = this->owner.emit(OpCode::COLUMN);
+                    this->owner.program.back().column = i;
+                }
+                return this->columnRegs[i];
+            }
+        }
+        if (name == "pi") {
+            return this->owner.emitConstant(3.14159265358979323846f);
+        }
+        this->fail("unknown column '" + name + "'");
+        return 0;
+    }
+
+    ColumnExpression& owner;
+    const std::string& source;
+    size_t pos;
+    const std::vector<std::string>& columnNames;
+    std::vector<uint32_t> columnRegs;
+    std::map<std::string, uint32_t> names;
+};
+
+
+ColumnExpression::ColumnExpression(void) : program(), outputs() {}
+
+
+ColumnExpression::~ColumnExpression(void) {}
+
+
+bool ColumnExpression::Compile(
+    const std::string& source, const std::vector<std::string>& columnNames, std::string& error) {
+    this->program.clear();
+    this->outputs.clear();
+    try {
+        Parser(*this, source, columnNames).ParseAll();
+    } catch (std::runtime_error& ex) {
+        error = ex.what();
+        this->program.clear();
+        this->outputs.clear();
+        return false;
+    }
+    return true;
+}
+
+
+void ColumnExpression::Evaluate(const TableDataCall& in, float* out, size_t outStride,
+    const std::vector<size_t>& outColumns, std::vector<float>& mins, std::vector<float>& maxs) const {
+    const size_t rows = in.GetRowsCount();
+    const size_t regCount = this->program.size();
+    const float* base = in.GetBaseData();
+    const size_t baseStride = in.GetBaseColumnsCount();
+
+    mins.assign(this->outputs.size(), std::numeric_limits<float>::max());
+    maxs.assign(this->outputs.size(), std::numeric_limits<float>::lowest());
+
+    const int64_t blocks = static_cast<int64_t>((rows + BLOCK_SIZE - 1) / BLOCK_SIZE);
+
+#pragma omp parallel
+    {
+        std::vector<float> storage(regCount * BLOCK_SIZE);
+        std::vector<float*> regs(regCount);
+        for (size_t i = 0; i < regCount; ++i) {
+            regs[i] = storage.data() + i * BLOCK_SIZE;
+            // constants never change, so they are only filled once
+            if (this->program[i].op == OpCode::CONSTANT) {
+                std::fill(regs[i], regs[i] + BLOCK_SIZE, this->program[i].value);
+            }
+        }
+        std::vector<float> localMins(mins), localMaxs(maxs);
+
+#pragma omp for schedule(static)
+        for (int64_t b = 0; b < blocks; ++b) {
+            const size_t first = static_cast<size_t>(b) * BLOCK_SIZE;
+            const size_t n = (std::min)(BLOCK_SIZE, rows - first);
+
+            for (size_t i = 0; i < regCount; ++i) {
+                const Instruction& inst = this->program[i];
+                if (inst.op == OpCode::CONSTANT) continue;
+                if (inst.op == OpCode::COLUMN) {
+                    const size_t col = in.GetBaseColumn(inst.column);
+                    float* dst = regs[i];
+                    for (size_t k = 0; k < n; ++k) {
+                        dst[k] = base[in.GetBaseRow(first + k) * baseStride + col];
+                    }
+                    continue;
+                }
+                execute(inst, regs[i], regs.data(), n);
+            }
+
+            for (size_t o = 0; o < this->outputs.size(); ++o) {
+                const float* src = regs[this->outputs[o].reg];
+                float* dst = out + first * outStride + outColumns[o];
+                for (size_t k = 0; k < n; ++k) {
+                    dst[k * outStride] = src[k];
+                    localMins[o] = (std::min)(localMins[o], src[k]);
+                    localMaxs[o] = (std::max)(localMaxs[o], src[k]);
+                }
+            }
+        }
+
+#pragma omp critical
+        {
+            for (size_t o = 0; o < this->outputs.size(); ++o) {
+                mins[o] = (std::min)(mins[o], localMins[o]);
+                maxs[o] = (std::max)(maxs[o], localMaxs[o]);
+            }
+        }
+    }
+}
+
+
+unsigned int ColumnExpression::arity(OpCode op) {
+    switch (op) {
+    case OpCode::CONSTANT:
+    case OpCode::COLUMN:
+        return 0;
+    case OpCode::SELECT:
+    case OpCode::CLAMP:
+        return 3;
+    default:
+        return (op >= OpCode::ADD) ? 2 : 1;
+    }
+}
+
+
+void ColumnExpression::execute(const Instruction& inst, float* dst, float* const* regs, size_t n) {
+    const float* a = regs[inst.args[0]];
+    const float* b = regs[inst.args[1]];
+    const float* c = regs[inst.args[2]];
+
+    switch (inst.op) {
+    case OpCode::NEG: unary(dst, a, n, [](float x) { return -x; }); break;
+    case OpCode::NOT: unary(dst, a, n, [](float x) { return (x == 0.0f) ? 1.0f : 0.0f; }); break;
+    case OpCode::ABS: unary(dst, a, n, [](float x) { return std::abs(x); }); break;
+    case OpCode::SQRT: unary(dst, a, n, [](float x) { return std::sqrt(x); }); break;
+    case OpCode::EXP: unary(dst, a, n, [](float x) { return std::exp(x); }); break;
+    case OpCode::LOG: unary(dst, a, n, [](float x) { return std::log(x); }); break;
+    case OpCode::LOG10: unary(dst, a, n, [](float x) { return std::log10(x); }); break;
+    case OpCode::SIN: unary(dst, a, n, [](float x) { return std::sin(x); }); break;
+    case OpCode::COS: unary(dst, a, n, [](float x) { return std::cos(x); }); break;
+    case OpCode::TAN: unary(dst, a, n, [](float x) { return std::tan(x); }); break;
+    case OpCode::ASIN: unary(dst, a, n, [](float x) { return std::asin(x); }); break;
+    case OpCode::ACOS: unary(dst, a, n, [](float x) { return std::acos(x); }); break;
+    case OpCode::ATAN: unary(dst, a, n, [](float x) { return std::atan(x); }); break;
+    case OpCode::FLOOR: unary(dst, a, n, [](float x) { return std::floor(x); }); break;
+    case OpCode::CEIL: unary(dst, a, n, [](float x) { return std::ceil(x); }); break;
+    case OpCode::ROUND: unary(dst, a, n, [](float x) { return std::round(x); }); break;
+    case OpCode::ADD: binary(dst, a, b, n, [](float x, float y) { return x + y; }); break;
+    case OpCode::SUB: binary(dst, a, b, n, [](float x, float y) { return x - y; }); break;
+    case OpCode::MUL: binary(dst, a, b, n, [](float x, float y) { return x * y; }); break;
+    case OpCode::DIV: binary(dst, a, b, n, [](float x, float y) { return x / y; }); break;
+    case OpCode::MOD: binary(dst, a, b, n, [](float x, float y) { return std::fmod(x, y); }); break;
+    case OpCode::POW: binary(dst, a, b, n, [](float x, float y) { return std::pow(x, y); }); break;
+    case OpCode::ATAN2: binary(dst, a, b, n, [](float x, float y) { return std::atan2(x, y); }); break;
+    case OpCode::MIN: binary(dst, a, b, n, [](float x, float y) { return (std::min)(x, y); }); break;
+    case OpCode::MAX: binary(dst, a, b, n, [](float x, float y) { return (std::max)(x, y); }); break;
+    case OpCode::LT: binary(dst, a, b, n, [](float x, float y) { return (x < y) ? 1.0f : 0.0f; }); break;
+    case OpCode::LE: binary(dst, a, b, n, [](float x, float y) { return (x <= y) ? 1.0f : 0.0f; }); break;
+    case OpCode::GT: binary(dst, a, b, n, [](float x, float y) { return (x > y) ? 1.0f : 0.0f; }); break;
+    case OpCode::GE: binary(dst, a, b, n, [](float x, float y) { return (x >= y) ? 1.0f : 0.0f; }); break;
+    case OpCode::EQ: binary(dst, a, b, n, [](float x, float y) { return (x == y) ? 1.0f : 0.0f; }); break;
+    case OpCode::NE: binary(dst, a, b, n, [](float x, float y) { return (x != y) ? 1.0f : 0.0f; }); break;
+    case OpCode::AND:
+        binary(dst, a, b, n, [](float x, float y) { return (x != 0.0f && y != 0.0f) ? 1.0f : 0.0f; });
+        break;
+    case OpCode::OR:
+        binary(dst, a, b, n, [](float x, float y) { return (x != 0.0f || y != 0.0f) ? 1.0f : 0.0f; });
+        break;
+    case OpCode::SELECT:
+        // both branches are computed for the whole block, which keeps the loops branch-free
+        ternary(dst, a, b, c, n, [](float x, float y, float z) { return (x != 0.0f) ? y : z; });
+        break;
+    case OpCode::CLAMP:
+        ternary(dst, a, b, c, n, [](float x, float lo, float hi) { return (std::min)((std::max)(x, lo), hi); });
+        break;
+    default:
+        break;
+    }
+}
+
+
+uint32_t ColumnExpression::emit(OpCode op, uint32_t a, uint32_t b, uint32_t c) {
+    Instruction inst;
+    inst.op = op;
+    inst.args[0] = a;
+    inst.args[1] = b;
+    inst.args[2] = c;
+    inst.value = 0.0f;
+    inst.column = 0;
+
+    const unsigned int cnt = arity(op);
+    bool constant = (cnt > 0);
+    for (unsigned int i = 0; i < cnt; ++i) {
+        constant = constant && (this->program[inst.args[i]].op == OpCode::CONSTANT);
+    }
+    if (constant) {
+        float values[3] = {0.0f, 0.0f, 0.0f};
+        float* regs[3] = {&values[0], &values[1], &values[2]};
+        for (unsigned int i = 0; i < cnt; ++i) {
+            values[i] = this->program[inst.args[i]].value;
+            inst.args[i] = i;
+        }
+        float result = 0.0f;
+        execute(inst, &result, regs, 1);
+        return this->emitConstant(result);
+    }
+
+    this->program.push_back(inst);
+    return static_cast<uint32_t>(this->program.size() - 1);
+}
+
+
+uint32_t ColumnExpression::emitConstant(float value) {
+    Instruction inst;
+    inst.op = OpCode::CONSTANT;
+    inst.args[0] = inst.args[1] = inst.args[2] = 0;
+    inst.value = value;
+    inst.column = 0;
+    this->program.push_back(inst);
+    return static_cast<uint32_t>(this->program.size() - 1);
+}
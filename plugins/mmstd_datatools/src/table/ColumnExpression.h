@@ -0,0 +1,123 @@
+/*
+ * ColumnExpression.h
+ *
+ * Copyright (C) 2020 by VISUS (University of Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MEGAMOL_DATATOOLS_TABLE_COLUMNEXPRESSION_H_INCLUDED
+#define MEGAMOL_DATATOOLS_TABLE_COLUMNEXPRESSION_H_INCLUDED
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mmstd_datatools/table/TableDataCall.h"
+
+namespace megamol {
+namespace stdplugin {
+namespace datatools {
+namespace table {
+
+/*
+ * Computes table columns from expressions over whole columns.
+ *
+ * The source is a list of assignments "name = expression", separated by new
+ * lines or ';'. Expressions support numbers, column references (plain
+ * identifiers or arbitrary names in brackets, e.g. [x pos]), earlier
+ * assignments, the constant pi, + - * / % ^, comparisons, && || !, c ? a : b
+ * and the functions abs, sqrt, exp, log, log10, sin, cos, tan, asin, acos,
+ * atan, atan2, pow, min, max, floor, ceil, round, clamp and if.
+ *
+ * All assignments are compiled once into a single instruction list. Evaluation
+ * runs every instruction over a block of rows at a time, with the blocks
+ * distributed over threads.
+ */
+class ColumnExpression {
+public:
+    /** Ctor */
+    ColumnExpression(void);
+
+    /** Dtor */
+    ~ColumnExpression(void);
+
+    /**
+     * Compile 'source' against the columns of the input table.
+     *
+     * @param source      The assignments.
+     * @param columnNames The names of the input columns.
+     * @param error       Receives a description of the first error.
+     *
+     * @return true on success, false otherwise.
+     */
+    bool Compile(const std::string& source, const std::vector<std::string>& columnNames, std::string& error);
+
+    /**
+     * Evaluate all assignments for all rows of 'in'.
+     *
+     * @param in         The input table, which may be a view.
+     * @param out        Row-major output table.
+     * @param outStride  The number of columns per row in 'out'.
+     * @param outColumns For each assignment, the column of 'out' to write.
+     * @param mins       Receives the minimum of each assignment.
+     * @param maxs       Receives the maximum of each assignment.
+     */
+    void Evaluate(const TableDataCall& in, float* out, size_t outStride, const std::vector<size_t>& outColumns,
+        std::vector<float>& mins, std::vector<float>& maxs) const;
+
+    /** Return the number of assignments */
+    inline size_t GetOutputCount(void) const { return this->outputs.size(); }
+
+    /** Return the name assigned by assignment idx */
+    inline const std::string& GetOutputName(size_t idx) const { return this->outputs[idx].name; }
+
+private:
+    enum class OpCode : uint8_t {
+        CONSTANT, COLUMN,
+        NEG, NOT, ABS, SQRT, EXP, LOG, LOG10, SIN, COS, TAN, ASIN, ACOS, ATAN, FLOOR, CEIL, ROUND,
+        ADD, SUB, MUL, DIV, MOD, POW, ATAN2, MIN, MAX, LT, LE, GT, GE, EQ, NE, AND, OR,
+        SELECT, CLAMP
+    };
+
+    /** One instruction, writing register i for instruction i */
+    struct Instruction {
+        OpCode op;
+        uint32_t args[3];
+        float value;
+        size_t column;
+    };
+
+    /** An assignment and the register holding its result */
+    struct Output {
+        std::string name;
+        uint32_t reg;
+    };
+
+    class Parser;
+
+    /** The number of rows evaluated per block */
+    static const size_t BLOCK_SIZE = 1024;
+
+    /** Return the number of operands of op */
+    static unsigned int arity(OpCode op);
+
+    /** Evaluate instruction 'inst' for 'n' rows, registers hold BLOCK_SIZE floats each */
+    static void execute(const Instruction& inst, float* dst, float* const* regs, size_t n);
+
+    /** Append an instruction, folding it if all operands are constant, and return its register */
+    uint32_t emit(OpCode op, uint32_t a = 0, uint32_t b = 0, uint32_t c = 0);
+
+    /** Append a constant and return its register */
+    uint32_t emitConstant(float value);
+
+    std::vector<Instruction> program;
+
+    std::vector<Output> outputs;
+};
+
+} /* end namespace table */
+} /* end namespace datatools */
+} /* end namespace stdplugin */
+} /* end namespace megamol */
+
+#endif /* MEGAMOL_DATATOOLS_TABLE_COLUMNEXPRESSION_H_INCLUDED */
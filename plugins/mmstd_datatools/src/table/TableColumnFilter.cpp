@@ -72,8 +72,6 @@ bool TableColumnFilter::processData(core::Call &c) {
 
             auto column_count = inCall->GetColumnsCount();
             auto column_infos = inCall->GetColumnsInfos();
-            auto rows_count = inCall->GetRowsCount();
-            auto in_data = inCall->GetData();
 
             auto selectionString = this->selectionStringSlot.Param<core::param::StringParam>()->Value();
             selectionString.Remove(vislib::TString(" "));
@@ -89,13 +87,14 @@ bool TableColumnFilter::processData(core::Call &c) {
             this->columnInfos.clear();
             this->columnInfos.reserve(selectors.Count());
 
-            std::vector<size_t> indexMask;
+            std::vector<size_t>& indexMask = this->columnSelection;
+            indexMask.clear();
             indexMask.reserve(selectors.Count());
             for (size_t sel = 0; sel < selectors.Count(); sel++) {
                 for (size_t col = 0; col < column_count; col++) {
                     if (selectors[sel].CompareInsensitive(vislib::TString(
                         column_infos[col].Name().c_str()))) {
-                        indexMask.push_back(col);
+                        indexMask.push_back(inCall->GetBaseColumn(col));
                         this->columnInfos.push_back(column_infos[col]);
                         break;
                     }
@@ -109,18 +108,8 @@ bool TableColumnFilter::processData(core::Call &c) {
                 vislib::sys::Log::DefaultLog.WriteError(_T("%hs: No matches for selectors have been found\n"),
                     ModuleName.c_str());
                 this->columnInfos.clear();
-                this->data.clear();
                 return false;
             }
-
-            this->data.clear();
-            this->data.reserve(rows_count*this->columnInfos.size());
-
-            for (size_t row = 0; row < rows_count; row++) {
-                for (auto &cidx : indexMask) {
-                    this->data.push_back(in_data[cidx + row*column_count]);
-                }
-            }
         }
 
         outCall->SetFrameCount(inCall->GetFrameCount());
@@ -128,8 +117,10 @@ bool TableColumnFilter::processData(core::Call &c) {
         outCall->SetDataHash(this->datahash);
 
         if (this->columnInfos.size() != 0) {
-            outCall->Set(this->columnInfos.size(), this->data.size() / this->columnInfos.size(),
-                this->columnInfos.data(), this->data.data());
+            // project the input without copying, keeping any row selection it already has
+            outCall->SetView(inCall->GetBaseColumnsCount(), inCall->GetBaseData(), this->columnInfos.size(),
+                this->columnSelection.data(), inCall->GetRowsCount(), inCall->GetRowSelection(),
+                this->columnInfos.data());
         } else {
             outCall->Set(0, 0, NULL, NULL);
         }
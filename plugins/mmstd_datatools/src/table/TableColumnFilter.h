@@ -79,8 +79,8 @@ private:
     /** Vector storing information about columns */
     std::vector<TableDataCall::ColumnInfo> columnInfos;
 
-    /** Vector stroing the actual float data */
-    std::vector<float> data;
+    /** Base column indices of the input the output columns refer to */
+    std::vector<size_t> columnSelection;
 }; /* end class TableColumnFilter */
 
 } /* end namespace table */
@@ -7,6 +7,8 @@
 #include "stdafx.h"
 #include "mmstd_datatools/table/TableDataCall.h"
 
+#include <algorithm>
+
 using namespace megamol::stdplugin::datatools;
 using namespace megamol::stdplugin::datatools::table;
 using namespace megamol;
@@ -40,7 +42,9 @@ bool TableDataCall::ColumnInfo::operator==(const ColumnInfo& rhs) const{
 }
 
 
-TableDataCall::TableDataCall(void) : core::AbstractGetDataCall(), columns_count(0), rows_count(0), columns(nullptr), data(nullptr), frameCount(0), frameID(0) {
+TableDataCall::TableDataCall(void) : core::AbstractGetDataCall(), columns_count(0), rows_count(0), columns(nullptr), data(nullptr),
+    base_columns_count(0), column_selection(nullptr), row_selection(nullptr), materialized(), materialized_data(nullptr),
+    materialized_hash(0), materialized_frame(0), frameCount(0), frameID(0) {
     // intentionally empty
 }
 
@@ -50,3 +54,33 @@ TableDataCall::~TableDataCall(void) {
     columns = nullptr; // do not delete, since we do not own the memory of the objects
     data = nullptr; // do not delete, since we do not own the memory of the objects
 }
+
+bool TableDataCall::IsIdentityProjection(void) const {
+    if (columns_count != base_columns_count) return false;
+    for (size_t c = 0; c < columns_count; ++c) {
+        if (column_selection[c] != c) return false;
+    }
+    return true;
+}
+
+const float* TableDataCall::materialize(void) const {
+    if ((materialized_data == nullptr) || (materialized_hash != DataHash()) || (materialized_frame != frameID)) {
+        materialized.resize(columns_count * rows_count);
+        float *dst = materialized.data();
+        for (size_t r = 0; r < rows_count; ++r) {
+            const float *src = data + GetBaseRow(r) * base_columns_count;
+            if (column_selection == nullptr) {
+                std::copy(src, src + columns_count, dst);
+                dst += columns_count;
+            } else {
+                for (size_t c = 0; c < columns_count; ++c) {
+                    *dst++ = src[column_selection[c]];
+                }
+            }
+        }
+        materialized_data = materialized.data();
+        materialized_hash = DataHash();
+        materialized_frame = frameID;
+    }
+    return materialized_data;
+}
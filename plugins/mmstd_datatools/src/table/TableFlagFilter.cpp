@@ -24,6 +24,9 @@ TableFlagFilter::TableFlagFilter()
     , tableInFrameCount(0)
     , tableInDataHash(0)
     , tableInColCount(0)
+    , flagsMirror()
+    , passRows()
+    , flagsVersion(0)
     , dataHash(0)
     , rowCount(0) {
 
@@ -64,10 +67,13 @@ bool TableFlagFilter::getData(core::Call &call) {
         return false;
     }
 
+    // hand out the passing rows as a view on the input table, handleCall just refreshed it.
     auto *tableOutCall = dynamic_cast<TableDataCall *>(&call);
+    auto *tableInCall = this->tableInSlot.CallAs<TableDataCall>();
     tableOutCall->SetFrameCount(this->tableInFrameCount);
     tableOutCall->SetDataHash(this->dataHash);
-    tableOutCall->Set(this->tableInColCount, this->rowCount, this->colInfos.data(), this->data.data());
+    tableOutCall->SetView(tableInCall->GetBaseColumnsCount(), tableInCall->GetBaseData(), this->tableInColCount,
+        tableInCall->GetColumnSelection(), this->rowCount, this->rowSelection.data(), this->colInfos.data());
 
     return true;
 }
@@ -110,70 +116,102 @@ bool TableFlagFilter::handleCall(core::Call &call) {
     (*tableInCall)(0);
     (*flagsInCall)(core::FlagCallRead_GL::CallGetData);
 
-    if (this->tableInFrameCount != tableInCall->GetFrameCount() || this->tableInDataHash != tableInCall->DataHash() || flagsInCall->hasUpdate()) {
-        vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO, "TableFlagFilter: Filter table.");
-
-        this->dataHash++;
+    core::FlagStorage::FlagItemType testMask = core::FlagStorage::ENABLED | core::FlagStorage::FILTERED;
+    core::FlagStorage::FlagItemType passMask = core::FlagStorage::ENABLED;
+    if (static_cast<FilterMode>(this->filterModeParam.Param<core::param::EnumParam>()->Value()) == FilterMode::SELECTED) {
+        testMask = core::FlagStorage::ENABLED | core::FlagStorage::SELECTED | core::FlagStorage::FILTERED;
+        passMask = core::FlagStorage::ENABLED | core::FlagStorage::SELECTED;
+    }
 
-        this->tableInFrameCount = tableInCall->GetFrameCount();
-        this->tableInDataHash = tableInCall->DataHash();
-        this->tableInColCount = tableInCall->GetColumnsCount();
-        size_t tableInRowCount = tableInCall->GetRowsCount();
+    bool tableChanged = this->tableInFrameCount != tableInCall->GetFrameCount() || this->tableInDataHash != tableInCall->DataHash();
+    bool modeChanged = !this->passRows.HasMasks(testMask, passMask);
 
-        // download flags
-        flagsInCall->getData()->validateFlagCount(tableInRowCount);
-        auto flags = flagsInCall->getData()->flags;
-        uint32_t *flagsData = new uint32_t[flags->getByteSize() / sizeof(uint32_t)];
-        flags->bind();
-        glGetBufferSubData(flags->getTarget(), 0, flags->getByteSize(), flagsData);
+    if (!tableChanged && !modeChanged && !flagsInCall->hasUpdate()) {
+        return true;
+    }
 
-        // copy column infos
-        this->colInfos.resize(this->tableInColCount);
-        for (size_t i = 0; i < this->tableInColCount; ++i) {
-            this->colInfos[i] = tableInCall->GetColumnsInfos()[i];
-            this->colInfos[i].SetMinimumValue(std::numeric_limits<float>::max());
-            this->colInfos[i].SetMaximumValue(std::numeric_limits<float>::lowest());
+    size_t tableInRowCount = tableInCall->GetRowsCount();
+    auto flagsVersion = flagsInCall->version();
+    auto const& flagCollection = flagsInCall->getData();
+
+    // download flags, only the changed ranges if the storage can tell which ones these are
+    flagCollection->validateFlagCount(tableInRowCount);
+    auto flags = flagCollection->flags;
+    size_t flagCount = flags->getByteSize() / sizeof(core::FlagStorage::FlagItemType);
+    std::vector<core::FlagRangeLog::Range> changes;
+    bool incremental = !tableChanged && this->flagsMirror.size() == flagCount &&
+                       this->passRows.Size() == tableInRowCount &&
+                       flagCollection->ranges.Collect(this->flagsVersion, changes);
+    flags->bind();
+    if (incremental) {
+        for (auto const& r : changes) {
+            size_t end = (std::min)(r.second, flagCount);
+            if (r.first < end) {
+                glGetBufferSubData(flags->getTarget(), r.first * sizeof(core::FlagStorage::FlagItemType),
+                    (end - r.first) * sizeof(core::FlagStorage::FlagItemType), this->flagsMirror.data() + r.first);
+            }
         }
+    } else {
+        this->flagsMirror.resize(flagCount);
+        glGetBufferSubData(flags->getTarget(), 0, flags->getByteSize(), this->flagsMirror.data());
+    }
+    this->flagsVersion = flagsVersion;
 
-        core::FlagStorage::FlagItemType testMask = core::FlagStorage::ENABLED | core::FlagStorage::FILTERED;
-        core::FlagStorage::FlagItemType passMask = core::FlagStorage::ENABLED;;
-        if (static_cast<FilterMode>(this->filterModeParam.Param<core::param::EnumParam>()->Value()) == FilterMode::SELECTED) {
-            testMask = core::FlagStorage::ENABLED | core::FlagStorage::SELECTED | core::FlagStorage::FILTERED;
-            passMask = core::FlagStorage::ENABLED | core::FlagStorage::SELECTED;
+    bool rowsChanged = false;
+    if (incremental && !modeChanged) {
+        for (auto const& r : changes) {
+            rowsChanged = this->passRows.Update(this->flagsMirror.data(), r.first, r.second) || rowsChanged;
         }
+    } else {
+        this->passRows = core::FlagBitSet(testMask, passMask);
+        this->passRows.Assign(this->flagsMirror.data(), tableInRowCount);
+        rowsChanged = true;
+    }
 
-        // Resize data to size of input table. With this we only need to allocate memory once.
-        this->data.resize(this->tableInColCount * tableInRowCount);
-        this->rowCount = 0;
-
-        const float *tableInData = tableInCall->GetData();
-        for (size_t r = 0; r < tableInRowCount; ++r) {
-            if ((flagsData[r] & testMask) == passMask) {
-                for (size_t c = 0; c < this->tableInColCount; ++c) {
-                    float val = tableInData[this->tableInColCount * r + c];
-                    this->data[this->tableInColCount * this->rowCount + c] = val;
-                    if (val < this->colInfos[c].MinimumValue()) {
-                        this->colInfos[c].SetMinimumValue(val);
-                    }
-                    if (val > this->colInfos[c].MaximumValue()) {
-                        this->colInfos[c].SetMaximumValue(val);
-                    }
-                }
-                this->rowCount++;
-            }
-        }
+    // e.g. a changed soft selection does not change which rows pass the filter
+    if (!tableChanged && !rowsChanged) {
+        return true;
+    }
+
+    vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO, "TableFlagFilter: Filter table.");
+
+    this->dataHash++;
 
-        // delete memory of filtered rows
-        this->data.resize(this->tableInColCount * this->rowCount);
+    this->tableInFrameCount = tableInCall->GetFrameCount();
+    this->tableInDataHash = tableInCall->DataHash();
+    this->tableInColCount = tableInCall->GetColumnsCount();
+
+    // copy column infos
+    this->colInfos.resize(this->tableInColCount);
+    for (size_t i = 0; i < this->tableInColCount; ++i) {
+        this->colInfos[i] = tableInCall->GetColumnsInfos()[i];
+        this->colInfos[i].SetMinimumValue(std::numeric_limits<float>::max());
+        this->colInfos[i].SetMaximumValue(std::numeric_limits<float>::lowest());
+    }
 
-        delete[] flagsData;
+    // Only the indices of the passing rows are stored, the cells stay where they are upstream.
+    this->rowSelection.resize(this->passRows.Count());
+    this->rowCount = 0;
 
-        // nicer output
-        if (this->rowCount == 0) {
-            for (size_t i = 0; i < this->tableInColCount; ++i) {
-                this->colInfos[i].SetMinimumValue(0.0);
-                this->colInfos[i].SetMaximumValue(0.0);
+    this->passRows.ForEachSet([&](size_t r) {
+        this->rowSelection[this->rowCount] = tableInCall->GetBaseRow(r);
+        for (size_t c = 0; c < this->tableInColCount; ++c) {
+            float val = tableInCall->GetData(c, r);
+            if (val < this->colInfos[c].MinimumValue()) {
+                this->colInfos[c].SetMinimumValue(val);
             }
+            if (val > this->colInfos[c].MaximumValue()) {
+                this->colInfos[c].SetMaximumValue(val);
+            }
+        }
+        this->rowCount++;
+    });
+
+    // nicer output
+    if (this->rowCount == 0) {
+        for (size_t i = 0; i < this->tableInColCount; ++i) {
+            this->colInfos[i].SetMinimumValue(0.0);
+            this->colInfos[i].SetMaximumValue(0.0);
         }
     }
 
@@ -11,6 +11,7 @@
 #include "mmcore/Module.h"
 #include "mmcore/CalleeSlot.h"
 #include "mmcore/CallerSlot.h"
+#include "mmcore/FlagBitSet.h"
 #include "mmcore/FlagCall_GL.h"
 #include "mmcore/param/ParamSlot.h"
 #include "mmstd_datatools/table/TableDataCall.h"
@@ -68,11 +69,16 @@ private:
     size_t tableInDataHash;
     size_t tableInColCount;
 
+    // CPU copy of the flags and the rows passing the filter, following only the changed flag ranges
+    std::vector<core::FlagStorage::FlagItemType> flagsMirror;
+    core::FlagBitSet passRows;
+    core::FlagStorage::FlagVersionType flagsVersion;
+
     // filtered table
     size_t dataHash;
     size_t rowCount;
     std::vector<TableDataCall::ColumnInfo> colInfos;
-    std::vector<float> data;
+    std::vector<size_t> rowSelection;
 };
 
 } /* end namespace table */
@@ -8,6 +8,12 @@
 #include "stdafx.h"
 #include "TableJoin.h"
 
+#include "mmcore/param/EnumParam.h"
+#include "mmcore/param/StringParam.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <limits>
 
 using namespace megamol::stdplugin::datatools;
@@ -17,6 +23,8 @@ using namespace megamol;
 std::string TableJoin::ModuleName
     = std::string("TableJoin");
 
+const size_t TableJoin::NO_MATCH = std::numeric_limits<size_t>::max();
+
 size_t hash_combine(size_t lhs, size_t rhs) {
     lhs ^= rhs + 0x9e3779b9 + (lhs << 6) + (lhs >> 2);
     return lhs;
@@ -26,8 +34,12 @@ TableJoin::TableJoin(void) : core::Module(),
     firstTableInSlot("firstTableIn", "First input"),
     secondTableInSlot("secondTableIn", "Second input"),
     dataOutSlot("dataOut", "Output"),
+    joinModeSlot("joinMode", "How rows of both tables are matched"),
+    firstKeySlot("firstKey", "Name of the key column in the first table"),
+    secondKeySlot("secondKey", "Name of the key column in the second table, same as firstKey if empty"),
     frameID(-1),
-    firstDataHash(std::numeric_limits<unsigned long>::max()), secondDataHash(std::numeric_limits<unsigned long>::max()) {
+    firstDataHash(std::numeric_limits<unsigned long>::max()), secondDataHash(std::numeric_limits<unsigned long>::max()),
+    paramHash(0) {
     this->firstTableInSlot.SetCompatibleCall<TableDataCallDescription>();
     this->MakeSlotAvailable(&this->firstTableInSlot);
 
@@ -41,6 +53,19 @@ TableJoin::TableJoin(void) : core::Module(),
         TableDataCall::FunctionName(1),
         &TableJoin::getExtent);
     this->MakeSlotAvailable(&this->dataOutSlot);
+
+    auto* joinMode = new core::param::EnumParam(JoinMode::CONCATENATE);
+    joinMode->SetTypePair(JoinMode::CONCATENATE, "Concatenate rows");
+    joinMode->SetTypePair(JoinMode::INNER, "Inner join on key");
+    joinMode->SetTypePair(JoinMode::LEFT, "Left join on key");
+    this->joinModeSlot << joinMode;
+    this->MakeSlotAvailable(&this->joinModeSlot);
+
+    this->firstKeySlot << new core::param::StringParam("");
+    this->MakeSlotAvailable(&this->firstKeySlot);
+
+    this->secondKeySlot << new core::param::StringParam("");
+    this->MakeSlotAvailable(&this->secondKeySlot);
 }
 
 TableJoin::~TableJoin(void) {
@@ -85,44 +110,60 @@ bool TableJoin::processData(core::Call &c) {
         if (!(*firstInCall)()) return false;
         if (!(*secondInCall)()) return false;
 
+        const bool paramsChanged = this->joinModeSlot.IsDirty() || this->firstKeySlot.IsDirty()
+            || this->secondKeySlot.IsDirty();
+        if (paramsChanged) {
+            this->joinModeSlot.ResetDirty();
+            this->firstKeySlot.ResetDirty();
+            this->secondKeySlot.ResetDirty();
+            ++this->paramHash;
+        }
+
         if (this->firstDataHash != firstInCall->DataHash() || this->secondDataHash != secondInCall->DataHash()
-            || this->frameID != firstInCall->GetFrameID() || this->frameID != secondInCall->GetFrameID()) {
+            || this->frameID != firstInCall->GetFrameID() || this->frameID != secondInCall->GetFrameID()
+            || paramsChanged) {
             this->firstDataHash = firstInCall->DataHash();
             this->secondDataHash = secondInCall->DataHash();
             ASSERT(firstInCall->GetFrameID() == secondInCall->GetFrameID());
             this->frameID = firstInCall->GetFrameID();
 
-            // retrieve data
-            auto firstRowsCount = firstInCall->GetRowsCount();
-            auto firstColumnCount = firstInCall->GetColumnsCount();
-            auto firstColumnInfos = firstInCall->GetColumnsInfos();
-            auto firstData = firstInCall->GetData();
-
-            auto secondRowsCount = secondInCall->GetRowsCount();
-            auto secondColumnCount = secondInCall->GetColumnsCount();
-            auto secondColumnInfos = secondInCall->GetColumnsInfos();
-            auto secondData = secondInCall->GetData();
-
-            // concatenate
-            this->rows_count = std::max(firstRowsCount, secondRowsCount);
-            this->column_count = firstColumnCount + secondColumnCount;
-            this->column_info.clear();
-            this->column_info.reserve(this->column_count);
-            memcpy(this->column_info.data(), firstColumnInfos,
-                sizeof(TableDataCall::ColumnInfo)*firstColumnCount);
-            memcpy(&(this->column_info.data()[firstColumnCount]), secondColumnInfos,
-                sizeof(TableDataCall::ColumnInfo)*secondColumnCount);
-            this->data.clear();
-            this->data.resize(this->rows_count * this->column_count);
-
-            this->concatenate(this->data.data(), this->rows_count, this->column_count,
-				firstData, firstRowsCount, firstColumnCount,
-				secondData, secondRowsCount, secondColumnCount);
+            const auto joinMode = this->joinModeSlot.Param<core::param::EnumParam>()->Value();
+            if (joinMode != JoinMode::CONCATENATE) {
+                if (!this->keyJoin(*firstInCall, *secondInCall, joinMode == JoinMode::LEFT)) {
+                    this->rows_count = 0;
+                    this->column_count = 0;
+                    this->column_info.clear();
+                    this->data.clear();
+                }
+            } else {
+                // retrieve data
+                auto firstRowsCount = firstInCall->GetRowsCount();
+                auto firstColumnCount = firstInCall->GetColumnsCount();
+                auto firstColumnInfos = firstInCall->GetColumnsInfos();
+                auto firstData = firstInCall->GetData();
+
+                auto secondRowsCount = secondInCall->GetRowsCount();
+                auto secondColumnCount = secondInCall->GetColumnsCount();
+                auto secondColumnInfos = secondInCall->GetColumnsInfos();
+                auto secondData = secondInCall->GetData();
+
+                // concatenate
+                this->rows_count = std::max(firstRowsCount, secondRowsCount);
+                this->column_count = firstColumnCount + secondColumnCount;
+                this->column_info.assign(firstColumnInfos, firstColumnInfos + firstColumnCount);
+                this->column_info.insert(this->column_info.end(), secondColumnInfos, secondColumnInfos + secondColumnCount);
+                this->data.clear();
+                this->data.resize(this->rows_count * this->column_count);
+
+                this->concatenate(this->data.data(), this->rows_count, this->column_count,
+                    firstData, firstRowsCount, firstColumnCount,
+                    secondData, secondRowsCount, secondColumnCount);
+            }
         }
 
         outCall->SetFrameCount(firstInCall->GetFrameCount());
         outCall->SetFrameID(this->frameID);
-        outCall->SetDataHash(hash_combine(this->firstDataHash, this->secondDataHash));
+        outCall->SetDataHash(hash_combine(hash_combine(this->firstDataHash, this->secondDataHash), this->paramHash));
         outCall->Set(this->column_count, this->rows_count, this->column_info.data(), this->data.data());
     } catch (...) {
         vislib::sys::Log::DefaultLog.WriteError(_T("Failed to execute %hs::processData\n"),
@@ -159,6 +200,186 @@ void TableJoin::concatenate(
     }
 }
 
+std::vector<float> TableJoin::extractKeys(const TableDataCall& table, const size_t column) {
+    std::vector<float> keys(table.GetRowsCount());
+    const int64_t rows = static_cast<int64_t>(keys.size());
+#pragma omp parallel for
+    for (int64_t row = 0; row < rows; row++) {
+        keys[row] = table.GetData(column, row) + 0.0f;
+    }
+    return keys;
+}
+
+bool TableJoin::isSorted(const std::vector<float>& keys) {
+    for (size_t i = 0; i < keys.size(); i++) {
+        // NaN never matches, so it cannot be merged either
+        if (std::isnan(keys[i]) || (i > 0 && keys[i] < keys[i - 1])) return false;
+    }
+    return true;
+}
+
+void TableJoin::hashJoin(const std::vector<float>& firstKeys, const std::vector<float>& secondKeys,
+    const bool left, std::vector<RowPair>& out) {
+    typedef std::pair<float, size_t> Entry;
+
+    // about 256 rows of the second table per partition
+    unsigned int bits = 0;
+    while (((size_t(1) << bits) * 256 < secondKeys.size()) && (bits < 24)) bits++;
+    const size_t partitions = size_t(1) << bits;
+    auto partitionOf = [bits](float key) -> size_t {
+        uint32_t u;
+        memcpy(&u, &key, sizeof(u));
+        u *= 0x9e3779b1u;
+        return (bits > 0) ? (u >> (32 - bits)) : 0;
+    };
+
+    // scatter the second table into its partitions ...
+    std::vector<size_t> offsets(partitions + 1, 0);
+    for (auto key : secondKeys) {
+        if (!std::isnan(key)) offsets[partitionOf(key) + 1]++;
+    }
+    for (size_t p = 0; p < partitions; p++) {
+        offsets[p + 1] += offsets[p];
+    }
+    std::vector<Entry> entries(offsets.back());
+    {
+        std::vector<size_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t row = 0; row < secondKeys.size(); row++) {
+            if (!std::isnan(secondKeys[row])) entries[fill[partitionOf(secondKeys[row])]++] = Entry(secondKeys[row], row);
+        }
+    }
+
+    // ... and sort each one, so equal keys are adjacent and stay in row order
+    const int64_t partitionCount = static_cast<int64_t>(partitions);
+#pragma omp parallel for schedule(dynamic, 64)
+    for (int64_t p = 0; p < partitionCount; p++) {
+        std::sort(entries.begin() + offsets[p], entries.begin() + offsets[p + 1]);
+    }
+
+    auto matches = [&](float key) -> std::pair<const Entry*, const Entry*> {
+        if (std::isnan(key)) return std::make_pair(nullptr, nullptr);
+        const size_t p = partitionOf(key);
+        const Entry* begin = entries.data() + offsets[p];
+        const Entry* end = entries.data() + offsets[p + 1];
+        begin = std::lower_bound(begin, end, key, [](const Entry& e, float k) { return e.first < k; });
+        end = std::upper_bound(begin, end, key, [](float k, const Entry& e) { return k < e.first; });
+        return std::make_pair(begin, end);
+    };
+
+    // probe twice, counting the output rows first so every thread knows where to write
+    const int64_t rows = static_cast<int64_t>(firstKeys.size());
+    std::vector<size_t> outOffsets(firstKeys.size() + 1, 0);
+#pragma omp parallel for
+    for (int64_t row = 0; row < rows; row++) {
+        const auto m = matches(firstKeys[row]);
+        const size_t cnt = static_cast<size_t>(m.second - m.first);
+        outOffsets[row + 1] = (left && cnt == 0) ? 1 : cnt;
+    }
+    for (size_t row = 0; row < firstKeys.size(); row++) {
+        outOffsets[row + 1] += outOffsets[row];
+    }
+
+    out.resize(outOffsets.back());
+#pragma omp parallel for
+    for (int64_t row = 0; row < rows; row++) {
+        const auto m = matches(firstKeys[row]);
+        size_t o = outOffsets[row];
+        if (m.first == m.second) {
+            if (left) out[o] = RowPair(row, NO_MATCH);
+        } else {
+            for (auto e = m.first; e != m.second; ++e) {
+                out[o++] = RowPair(row, e->second);
+            }
+        }
+    }
+}
+
+void TableJoin::mergeJoin(const std::vector<float>& firstKeys, const std::vector<float>& secondKeys,
+    const bool left, std::vector<RowPair>& out) {
+    out.clear();
+    out.reserve(left ? firstKeys.size() : (std::min)(firstKeys.size(), secondKeys.size()));
+
+    size_t i = 0, j = 0;
+    while (i < firstKeys.size()) {
+        const float key = firstKeys[i];
+        while (j < secondKeys.size() && secondKeys[j] < key) j++;
+        size_t iEnd = i, jEnd = j;
+        while (iEnd < firstKeys.size() && firstKeys[iEnd] == key) iEnd++;
+        while (jEnd < secondKeys.size() && secondKeys[jEnd] == key) jEnd++;
+
+        for (size_t ii = i; ii < iEnd; ii++) {
+            if (j == jEnd) {
+                if (left) out.push_back(RowPair(ii, NO_MATCH));
+            } else {
+                for (size_t jj = j; jj < jEnd; jj++) {
+                    out.push_back(RowPair(ii, jj));
+                }
+            }
+        }
+        i = iEnd;
+        j = jEnd;
+    }
+}
+
+bool TableJoin::keyJoin(const TableDataCall& first, const TableDataCall& second, const bool left) {
+    const std::string firstKey = std::string(T2A(this->firstKeySlot.Param<core::param::StringParam>()->Value()));
+    std::string secondKey = std::string(T2A(this->secondKeySlot.Param<core::param::StringParam>()->Value()));
+    if (secondKey.empty()) secondKey = firstKey;
+
+    auto findColumn = [](const TableDataCall& table, const std::string& name) {
+        for (size_t col = 0; col < table.GetColumnsCount(); col++) {
+            if (table.GetColumnsInfos()[col].Name() == name) return col;
+        }
+        return NO_MATCH;
+    };
+    const size_t firstKeyColumn = findColumn(first, firstKey);
+    const size_t secondKeyColumn = findColumn(second, secondKey);
+    if (firstKeyColumn == NO_MATCH || secondKeyColumn == NO_MATCH) {
+        vislib::sys::Log::DefaultLog.WriteError("%s: Cannot join tables. Key column \"%s\" or \"%s\" not found\n",
+            ModuleName.c_str(), firstKey.c_str(), secondKey.c_str());
+        return false;
+    }
+
+    const auto firstKeys = extractKeys(first, firstKeyColumn);
+    const auto secondKeys = extractKeys(second, secondKeyColumn);
+
+    std::vector<RowPair> pairs;
+    if (isSorted(firstKeys) && isSorted(secondKeys)) {
+        mergeJoin(firstKeys, secondKeys, left, pairs);
+    } else {
+        hashJoin(firstKeys, secondKeys, left, pairs);
+    }
+
+    // all columns of the first table, then those of the second one without its key
+    const size_t firstColumnCount = first.GetColumnsCount();
+    std::vector<size_t> secondColumns;
+    this->column_info.assign(first.GetColumnsInfos(), first.GetColumnsInfos() + firstColumnCount);
+    for (size_t col = 0; col < second.GetColumnsCount(); col++) {
+        if (col == secondKeyColumn) continue;
+        secondColumns.push_back(col);
+        this->column_info.push_back(second.GetColumnsInfos()[col]);
+    }
+    this->column_count = this->column_info.size();
+    this->rows_count = pairs.size();
+    this->data.resize(this->rows_count * this->column_count);
+
+    // the only copy of any cell, straight from the (possibly filtered) inputs into the output
+    const int64_t rows = static_cast<int64_t>(this->rows_count);
+#pragma omp parallel for
+    for (int64_t row = 0; row < rows; row++) {
+        float* out = &this->data[row * this->column_count];
+        const RowPair& pair = pairs[row];
+        for (size_t col = 0; col < firstColumnCount; col++) {
+            out[col] = first.GetData(col, pair.first);
+        }
+        for (size_t col = 0; col < secondColumns.size(); col++) {
+            out[firstColumnCount + col] = (pair.second == NO_MATCH) ? NAN : second.GetData(secondColumns[col], pair.second);
+        }
+    }
+
+    return true;
+}
+
 bool TableJoin::getExtent(core::Call &c) {
     try {
         TableDataCall *outCall = dynamic_cast<TableDataCall *>(&c);
@@ -171,7 +392,7 @@ bool TableJoin::getExtent(core::Call &c) {
         if (!(*inCall)(1)) return false;
 
         outCall->SetFrameCount(inCall->GetFrameCount());
-        outCall->SetDataHash(hash_combine(this->firstDataHash, this->secondDataHash));
+        outCall->SetDataHash(hash_combine(hash_combine(this->firstDataHash, this->secondDataHash), this->paramHash));
     }
     catch (...) {
         vislib::sys::Log::DefaultLog.WriteError(_T("Failed to execute %hs::getExtent\n"), ModuleName.c_str());
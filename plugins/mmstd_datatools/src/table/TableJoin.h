@@ -17,13 +17,16 @@
 
 #include "mmstd_datatools/table/TableDataCall.h"
 
+#include <utility>
+
 namespace megamol {
 namespace stdplugin {
 namespace datatools {
 namespace table {
 
 /**
- * This module joins two tables by copying the values together into one matrix
+ * This module joins two tables by copying the values together into one matrix,
+ * either row by row or by matching the values of a key column.
  */
 class TableJoin : public core::Module {
 public:
@@ -44,7 +47,7 @@ public:
      * @return A human readable description of this module.
      */
     static inline const char *Description(void) {
-        return "Joins two tables (union of columns)";
+        return "Joins two tables (union of columns), row by row or by a key column";
     }
 
     /**
@@ -86,11 +89,37 @@ private:
     /** extent callback */
     bool getExtent(core::Call &c);
 
+    /** how rows of both tables are matched */
+    enum JoinMode { CONCATENATE = 0, INNER = 1, LEFT = 2 };
+
+    /** pair of matching rows, the second one is NO_MATCH for unmatched rows of a left join */
+    typedef std::pair<size_t, size_t> RowPair;
+
+    /** marks a row of the first table without partner in a left join */
+    static const size_t NO_MATCH;
+
     /** concatenates two tables */
     static void concatenate(float* const out, const size_t rowCount, const size_t columnCount,
         const float* const first, const size_t firstRowCount, const size_t firstColumnCount, const float* const second,
         const size_t secondRowCount, const size_t secondColumnCount);
 
+    /** copies the key column, mapping -0 to 0 so keys can be compared bitwise */
+    static std::vector<float> extractKeys(const TableDataCall& table, const size_t column);
+
+    /** answers whether the keys are in non-descending order */
+    static bool isSorted(const std::vector<float>& keys);
+
+    /** matches rows of equal keys by partitioning the second table by hash */
+    static void hashJoin(const std::vector<float>& firstKeys, const std::vector<float>& secondKeys,
+        const bool left, std::vector<RowPair>& out);
+
+    /** matches rows of equal keys in two sorted key sequences */
+    static void mergeJoin(const std::vector<float>& firstKeys, const std::vector<float>& secondKeys,
+        const bool left, std::vector<RowPair>& out);
+
+    /** joins the tables on the key columns into data */
+    bool keyJoin(const TableDataCall& first, const TableDataCall& second, const bool left);
+
     /** input slot of first table */
     core::CallerSlot firstTableInSlot;
 
@@ -100,12 +129,22 @@ private:
     /** data output */
     core::CalleeSlot dataOutSlot;
 
+    /** parameter choosing how rows are matched */
+    core::param::ParamSlot joinModeSlot;
+
+    /** parameter naming the key column of the first table */
+    core::param::ParamSlot firstKeySlot;
+
+    /** parameter naming the key column of the second table, same as the first if empty */
+    core::param::ParamSlot secondKeySlot;
+
     /** frameID */
     int frameID;
 
     /** datahash */
     size_t firstDataHash;
     size_t secondDataHash;
+    size_t paramHash;
 
     /** number of rows of the table */
     size_t rows_count;
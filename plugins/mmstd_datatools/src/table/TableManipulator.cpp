@@ -8,8 +8,11 @@
 #include "stdafx.h"
 #include "TableManipulator.h"
 
+#include "mmcore/param/BoolParam.h"
+#include "mmcore/param/EnumParam.h"
 #include "mmcore/param/StringParam.h"
 
+#include <algorithm>
 #include <limits>
 #include "vislib/StringTokeniser.h"
 #include "vislib/sys/Log.h"
@@ -27,6 +30,9 @@ TableManipulator::TableManipulator(void)
     , dataOutSlot("dataOut", "Output")
     , dataInSlot("dataIn", "Input")
     , scriptSlot("script", "script to execute on incoming table data")
+    , modeSlot("mode", "whether to run the Lua script or the column expressions")
+    , expressionsSlot("expressions", "column expressions 'name = expression', one per line")
+    , keepColumnsSlot("keepColumns", "pass the input columns along with the computed ones")
     , frameID(-1)
     , in_datahash(std::numeric_limits<unsigned long>::max())
     , out_datahash(0)
@@ -88,6 +94,20 @@ TableManipulator::TableManipulator(void)
         "    mmSetOutputColumnRange(c, mins[c], maxes[c])\n"
         "end\n");
     this->MakeSlotAvailable(&this->scriptSlot);
+
+    auto* mode = new core::param::EnumParam(0);
+    mode->SetTypePair(0, "Lua script");
+    mode->SetTypePair(1, "Column expressions");
+    this->modeSlot << mode;
+    this->MakeSlotAvailable(&this->modeSlot);
+
+    this->expressionsSlot << new core::param::StringParam(
+        "# example computing the length of a vector, with arbitrary names in brackets\n"
+        "# length = sqrt(x * x + y * y + [z component] ^ 2)\n");
+    this->MakeSlotAvailable(&this->expressionsSlot);
+
+    this->keepColumnsSlot << new core::param::BoolParam(true);
+    this->MakeSlotAvailable(&this->keepColumnsSlot);
 }
 
 TableManipulator::~TableManipulator(void) { this->Release(); }
@@ -128,29 +148,38 @@ bool TableManipulator::processData(core::Call& c) {
         inCall->SetFrameID(outCall->GetFrameID());
         if (!(*inCall)()) return false;
 
-        if (this->in_datahash != inCall->DataHash() || this->frameID != inCall->GetFrameID() || this->scriptSlot.IsDirty()) {
+        if (this->in_datahash != inCall->DataHash() || this->frameID != inCall->GetFrameID() ||
+            this->scriptSlot.IsDirty() || this->modeSlot.IsDirty() || this->expressionsSlot.IsDirty() ||
+            this->keepColumnsSlot.IsDirty()) {
             this->in_datahash = inCall->DataHash();
             this->frameID = inCall->GetFrameID();
             this->scriptSlot.ResetDirty();
+            this->modeSlot.ResetDirty();
+            this->expressionsSlot.ResetDirty();
+            this->keepColumnsSlot.ResetDirty();
             this->out_datahash++;
 
-            column_count = inCall->GetColumnsCount();
-            column_infos = inCall->GetColumnsInfos();
-            row_count = inCall->GetRowsCount();
-            in_data = inCall->GetData();
+            if (this->modeSlot.Param<core::param::EnumParam>()->Value() == 1) {
+                this->runExpressions(*inCall);
+            } else {
+                column_count = inCall->GetColumnsCount();
+                column_infos = inCall->GetColumnsInfos();
+                row_count = inCall->GetRowsCount();
+                in_data = inCall->GetData();
 
-            const std::string scriptString = std::string(this->scriptSlot.Param<core::param::StringParam>()->Value());
+                const std::string scriptString = std::string(this->scriptSlot.Param<core::param::StringParam>()->Value());
 
-            this->info.clear();
-            this->info.reserve(column_count);
-            this->data.clear();
-            this->data.reserve(column_count * row_count);
+                this->info.clear();
+                this->info.reserve(column_count);
+                this->data.clear();
+                this->data.reserve(column_count * row_count);
 
-            std::string res;
-            const bool ok = theLua.RunString(scriptString, res);
+                std::string res;
+                const bool ok = theLua.RunString(scriptString, res);
 
-            if (!ok) {
-                vislib::sys::Log::DefaultLog.WriteError("TableManipulator: Lua execution is NOT OK and returned '%s'", res.c_str());
+                if (!ok) {
+                    vislib::sys::Log::DefaultLog.WriteError("TableManipulator: Lua execution is NOT OK and returned '%s'", res.c_str());
+                }
             }
         }
 
@@ -172,6 +201,72 @@ bool TableManipulator::processData(core::Call& c) {
     return true;
 }
 
+bool TableManipulator::runExpressions(const TableDataCall& inCall) {
+    const size_t inColumns = inCall.GetColumnsCount();
+    const size_t rows = inCall.GetRowsCount();
+    const TableDataCall::ColumnInfo* inInfos = inCall.GetColumnsInfos();
+
+    this->info.clear();
+    this->data.clear();
+
+    std::vector<std::string> names(inColumns);
+    for (size_t c = 0; c < inColumns; ++c) {
+        names[c] = inInfos[c].Name();
+    }
+
+    std::string error;
+    const std::string source = std::string(this->expressionsSlot.Param<core::param::StringParam>()->Value());
+    if (!this->expressions.Compile(source, names, error)) {
+        vislib::sys::Log::DefaultLog.WriteError("%s: cannot compile expressions: %s", ModuleName.c_str(), error.c_str());
+        return false;
+    }
+
+    // input columns come first, unless they are replaced by an expression of the same name
+    std::vector<size_t> keptColumns;
+    if (this->keepColumnsSlot.Param<core::param::BoolParam>()->Value()) {
+        for (size_t c = 0; c < inColumns; ++c) {
+            this->info.push_back(inInfos[c]);
+            keptColumns.push_back(c);
+        }
+    }
+    std::vector<size_t> outColumns(this->expressions.GetOutputCount());
+    for (size_t e = 0; e < outColumns.size(); ++e) {
+        const std::string& name = this->expressions.GetOutputName(e);
+        auto it = std::find_if(this->info.begin(), this->info.end(),
+            [&name](const TableDataCall::ColumnInfo& ci) { return ci.Name() == name; });
+        if (it == this->info.end()) {
+            this->info.emplace_back();
+            it = this->info.end() - 1;
+        }
+        it->SetName(name);
+        it->SetType(TableDataCall::ColumnType::QUANTITATIVE);
+        outColumns[e] = static_cast<size_t>(it - this->info.begin());
+    }
+    if (this->info.empty()) {
+        return true;
+    }
+
+    const size_t stride = this->info.size();
+    this->data.resize(stride * rows);
+
+    const int64_t rowCount = static_cast<int64_t>(rows);
+#pragma omp parallel for
+    for (int64_t r = 0; r < rowCount; ++r) {
+        for (size_t k = 0; k < keptColumns.size(); ++k) {
+            this->data[r * stride + k] = inCall.GetData(keptColumns[k], r);
+        }
+    }
+
+    std::vector<float> mins, maxs;
+    this->expressions.Evaluate(inCall, this->data.data(), stride, outColumns, mins, maxs);
+    for (size_t e = 0; e < outColumns.size(); ++e) {
+        this->info[outColumns[e]].SetMinimumValue(rows > 0 ? mins[e] : 0.0f);
+        this->info[outColumns[e]].SetMaximumValue(rows > 0 ? maxs[e] : 0.0f);
+    }
+
+    return true;
+}
+
 bool TableManipulator::getExtent(core::Call& c) {
     try {
         TableDataCall* outCall = dynamic_cast<TableDataCall*>(&c);
@@ -18,13 +18,16 @@
 
 #include "mmstd_datatools/table/TableDataCall.h"
 
+#include "ColumnExpression.h"
+
 namespace megamol {
 namespace stdplugin {
 namespace datatools {
 namespace table {
 
 /*
- * Module to manipulate table (copy) via a LUA script.
+ * Module to manipulate table (copy) via a LUA script or, for plain per-row
+ * arithmetic, via column expressions that are evaluated on whole columns.
  */
 class TableManipulator : public core::Module {
 public:
@@ -88,6 +91,9 @@ private:
     /** Data callback */
     bool processData(core::Call& c);
 
+    /** Fill data and info from the column expressions */
+    bool runExpressions(const TableDataCall& inCall);
+
     bool getExtent(core::Call& c);
 
     /** Data output slot */
@@ -99,6 +105,18 @@ private:
     /** Parameter slot for column selection */
     core::param::ParamSlot scriptSlot;
 
+    /** Parameter slot choosing between the Lua script and the column expressions */
+    core::param::ParamSlot modeSlot;
+
+    /** Parameter slot for the column expressions */
+    core::param::ParamSlot expressionsSlot;
+
+    /** Parameter slot for passing the input columns along with the computed ones */
+    core::param::ParamSlot keepColumnsSlot;
+
+    /** The compiled column expressions */
+    ColumnExpression expressions;
+
     /** ID of the current frame */
     int frameID;
 
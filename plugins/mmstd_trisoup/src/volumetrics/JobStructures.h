@@ -16,6 +16,7 @@
 #include "vislib/SmartPtr.h"
 #include "vislib/sys/CriticalSection.h"
 #include "CallVolumetricData.h"
+#include <atomic>
 
 namespace megamol {
 namespace trisoup {
@@ -312,7 +313,7 @@ namespace volumetrics {
     class Surface {
     public:
 
-        Surface(void) : border(new BorderVoxelArray()) {
+        Surface(void) : border(new BorderVoxelArray()), triangleCount(0) {
         }
 
         ~Surface(void) {
@@ -334,6 +335,9 @@ namespace volumetrics {
         /** volume encompassed by this surface */
         VoxelizerFloat volume;
 
+        /** number of triangles making up the surface, regardless of whether the mesh is stored */
+        SIZE_T triangleCount;
+
         /** thomasbm: volume of the "void" space so we can add up enclosed space later ... */
         VoxelizerFloat voidVolume;
 
@@ -434,6 +438,18 @@ namespace volumetrics {
         /** whether to persist the geometry computation takes place on (in result.mesh) */
         bool storeMesh, storeVolume;
 
+        /**
+         * whether the job uses the per-worker arena and hands its results to
+         * VoluMetricJob::MergeStreamedSubJob instead of stitching itself
+         */
+        bool streaming;
+
+        /** streaming mode: set once the surfaces of the job are final */
+        std::atomic<bool> finished;
+
+        /** streaming mode: number of jobs (including this one) still needing the border geometry */
+        std::atomic<int> borderRefs;
+
         VoluMetricJob *parent;
 
         VISLIB_FORCEINLINE unsigned cellIndex(const vislib::math::Point<unsigned,3>& p) {return cellIndex(p.X(), p.Y(), p.Z()); }
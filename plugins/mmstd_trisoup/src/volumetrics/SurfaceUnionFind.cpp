@@ -0,0 +1,96 @@
+/*
+ * SurfaceUnionFind.cpp
+ *
+ * Copyright (C) 2020 by VISUS (Universitaet Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+#include "stdafx.h"
+#include "SurfaceUnionFind.h"
+
+#include <utility>
+
+using namespace megamol;
+using namespace megamol::trisoup;
+using namespace megamol::trisoup::volumetrics;
+
+
+SurfaceUnionFind::SurfaceUnionFind(void) : chunks(new std::atomic<Chunk *>[MAX_CHUNKS]), count(0) {
+    for (unsigned int i = 0; i < MAX_CHUNKS; i++) {
+        this->chunks[i].store(nullptr);
+    }
+}
+
+
+SurfaceUnionFind::~SurfaceUnionFind(void) {
+    this->Clear();
+}
+
+
+unsigned int SurfaceUnionFind::Add(const unsigned int cnt) {
+    const unsigned int first = this->count.fetch_add(cnt);
+    for (unsigned int i = first; i < first + cnt; i++) {
+        this->parent(i).store(i, std::memory_order_release);
+    }
+    return first;
+}
+
+
+void SurfaceUnionFind::Clear(void) {
+    for (unsigned int i = 0; i < MAX_CHUNKS; i++) {
+        delete[] this->chunks[i].exchange(nullptr);
+    }
+    this->count.store(0);
+}
+
+
+unsigned int SurfaceUnionFind::Find(unsigned int id) {
+    while (true) {
+        unsigned int p = this->parent(id).load(std::memory_order_acquire);
+        if (p == id) {
+            return id;
+        }
+        const unsigned int gp = this->parent(p).load(std::memory_order_acquire);
+        if (gp != p) {
+            // path halving: only ever moves 'id' closer to its root, so a
+            // failed exchange just means someone else did the work.
+            this->parent(id).compare_exchange_weak(p, gp, std::memory_order_acq_rel);
+        }
+        id = gp;
+    }
+}
+
+
+void SurfaceUnionFind::Unite(unsigned int a, unsigned int b) {
+    while (true) {
+        a = this->Find(a);
+        b = this->Find(b);
+        if (a == b) {
+            return;
+        }
+        if (a > b) {
+            std::swap(a, b);
+        }
+        // link the larger root to the smaller one; this fails if 'b' stopped
+        // being a root in the meantime, in which case we retry.
+        unsigned int expected = b;
+        if (this->parent(b).compare_exchange_strong(expected, a, std::memory_order_acq_rel)) {
+            return;
+        }
+    }
+}
+
+
+std::atomic<unsigned int>& SurfaceUnionFind::parent(const unsigned int id) {
+    std::atomic<Chunk *>& slot = this->chunks[id >> CHUNK_BITS];
+    Chunk *chunk = slot.load(std::memory_order_acquire);
+    if (chunk == nullptr) {
+        Chunk *fresh = new Chunk[1];
+        if (slot.compare_exchange_strong(chunk, fresh, std::memory_order_acq_rel)) {
+            chunk = fresh;
+        } else {
+            // another thread was faster, 'chunk' now holds its allocation.
+            delete[] fresh;
+        }
+    }
+    return (*chunk)[id & ((1u << CHUNK_BITS) - 1)];
+}
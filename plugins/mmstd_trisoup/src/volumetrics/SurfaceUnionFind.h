@@ -0,0 +1,109 @@
+/*
+ * SurfaceUnionFind.h
+ *
+ * Copyright (C) 2020 by VISUS (Universitaet Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MEGAMOLCORE_SURFACEUNIONFIND_H_INCLUDED
+#define MEGAMOLCORE_SURFACEUNIONFIND_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include <atomic>
+#include <memory>
+
+
+namespace megamol {
+namespace trisoup {
+namespace volumetrics {
+
+    /**
+     * Lock-free disjoint-set forest over surface IDs which is used for
+     * merging the surfaces of neighbouring sub-volumes while the other
+     * sub-volumes are still being computed.
+     *
+     * IDs are handed out in consecutive ranges by Add(). Sets are always
+     * linked to the root with the smaller ID, so the final root of each set
+     * is its smallest member. Add(), Find() and Unite() may be called
+     * concurrently, Clear() may not.
+     */
+    class SurfaceUnionFind {
+    public:
+
+        /** Ctor. */
+        SurfaceUnionFind(void);
+
+        /** Dtor. */
+        ~SurfaceUnionFind(void);
+
+        /**
+         * Create 'cnt' new singleton sets.
+         *
+         * @param cnt The number of IDs to be allocated.
+         *
+         * @return The first of the 'cnt' consecutive IDs.
+         */
+        unsigned int Add(const unsigned int cnt);
+
+        /**
+         * Remove all sets.
+         */
+        void Clear(void);
+
+        /**
+         * Answer the number of IDs allocated so far.
+         *
+         * @return The number of IDs.
+         */
+        inline unsigned int Count(void) const {
+            return this->count.load();
+        }
+
+        /**
+         * Answer the representative of the set containing 'id'.
+         *
+         * @param id A valid ID.
+         *
+         * @return The root of the set.
+         */
+        unsigned int Find(unsigned int id);
+
+        /**
+         * Merge the sets containing 'a' and 'b'.
+         *
+         * @param a A valid ID.
+         * @param b A valid ID.
+         */
+        void Unite(unsigned int a, unsigned int b);
+
+    private:
+
+        /** The number of bits of an ID addressing the element in a chunk. */
+        static const unsigned int CHUNK_BITS = 16;
+
+        /** The number of chunks that can be allocated. */
+        static const unsigned int MAX_CHUNKS = 1u << (32 - CHUNK_BITS);
+
+        /** A chunk of parent pointers. */
+        typedef std::atomic<unsigned int> Chunk[1u << CHUNK_BITS];
+
+        /**
+         * Answer the parent pointer of 'id', allocating its chunk if
+         * necessary.
+         */
+        std::atomic<unsigned int>& parent(const unsigned int id);
+
+        /** The chunks of parent pointers, which are never moved. */
+        std::unique_ptr<std::atomic<Chunk *>[]> chunks;
+
+        /** The number of IDs allocated. */
+        std::atomic<unsigned int> count;
+    };
+
+} /* end namespace volumetrics */
+} /* end namespace trisoup */
+} /* end namespace megamol */
+
+#endif /* MEGAMOLCORE_SURFACEUNIONFIND_H_INCLUDED */
@@ -6,6 +6,7 @@
 #include "MarchingCubeTables.h"
 #include "vislib/math/Vector.h"
 #include "VoluMetricJob.h"
+#include "VoxelArena.h"
 #include <climits>
 #include <cfloat>
 
@@ -86,7 +87,7 @@ void TetraVoxelizer::debugPrintTriangle(vislib::math::ShallowShallowTriangle<dou
         tri.PeekCoordinates()[2][0], tri.PeekCoordinates()[2][1], tri.PeekCoordinates()[2][2]);
 }
 
-TetraVoxelizer::TetraVoxelizer(void) : terminate(false), sjd(NULL) {
+TetraVoxelizer::TetraVoxelizer(void) : terminate(false), sjd(NULL), arena(NULL) {
     //triangleSoup.SetCapacityIncrement(90); // AKA 10 triangles?
 }
 
@@ -165,8 +166,11 @@ void TetraVoxelizer::CollectCell(FatVoxel *theVolume, unsigned int x, unsigned i
         surf.fullFaces = 0;
         surf.globalID = UINT_MAX;
 
-        for (SIZE_T cellIdx = 0; cellIdx < static_cast<SIZE_T>(sjd->resX * sjd->resY * sjd->resZ); cellIdx++)
-            theVolume[cellIdx].borderVoxel = NULL;
+        // only the cells touched by the previous surface can hold a BorderVoxel
+        for (auto c : this->borderCells) {
+            c->borderVoxel = NULL;
+        }
+        this->borderCells.clear();
 
         cellFIFO.Append(vislib::math::Point<unsigned int, 4>(x, y, z, triIdx));
 #ifdef ULTRADEBUG
@@ -447,6 +451,7 @@ VISLIB_FORCEINLINE void TetraVoxelizer::ProcessTriangle(vislib::math::ShallowSha
     }
 
     surf.surface += triangle.Area<VoxelizerFloat>();
+    surf.triangleCount++;
 //    surf.volume += cell.triangles[triIdx];
 
     // thomasbm: grow bounding volume based on intersecting voxels ...
@@ -461,6 +466,7 @@ VISLIB_FORCEINLINE void TetraVoxelizer::ProcessTriangle(vislib::math::ShallowSha
             cell.borderVoxel->z = z + sjd->offsetZ;
             cell.borderVoxel->triangles.AssertCapacity(cell.numTriangles * 9);
             surf.border->Add(cell.borderVoxel);
+            this->borderCells.push_back(&cell);
         }
         cell.borderVoxel->triangles.SetCount(cell.borderVoxel->triangles.Count() + 9);
         tmpTriangle.SetPointer(const_cast<VoxelizerFloat *>(cell.borderVoxel->triangles.PeekElements()
@@ -562,9 +568,15 @@ void TetraVoxelizer::MarchCell(FatVoxel *theVolume, unsigned int x, unsigned int
         }
     }
 
-    currVoxel.triangles = new VoxelizerFloat[currVoxel.numTriangles * 3 * 3];
-    currVoxel.volumes = new VoxelizerFloat[currVoxel.numTriangles];
-	currVoxel.corners = new unsigned char[currVoxel.numTriangles];
+    if (this->arena != NULL) {
+        currVoxel.triangles = this->arena->Allocate<VoxelizerFloat>(currVoxel.numTriangles * 3 * 3);
+        currVoxel.volumes = this->arena->Allocate<VoxelizerFloat>(currVoxel.numTriangles);
+        currVoxel.corners = this->arena->Allocate<unsigned char>(currVoxel.numTriangles);
+    } else {
+        currVoxel.triangles = new VoxelizerFloat[currVoxel.numTriangles * 3 * 3];
+        currVoxel.volumes = new VoxelizerFloat[currVoxel.numTriangles];
+        currVoxel.corners = new unsigned char[currVoxel.numTriangles];
+    }
     vislib::math::ShallowShallowTriangle<VoxelizerFloat, 3> tri(currVoxel.triangles);
     vislib::math::ShallowShallowTriangle<VoxelizerFloat, 3> tri2(currVoxel.triangles);
     vislib::math::Point<VoxelizerFloat, 3> temp;
@@ -961,7 +973,16 @@ DWORD TetraVoxelizer::Run(void *userData) {
 //#endif
 
     unsigned int fifoEnd = 0, fifoCur = 0;
-    FatVoxel *volume = new FatVoxel[sjd->resX * sjd->resY * sjd->resZ];
+    // in streaming mode, the whole scratch memory of the job comes from the
+    // arena of the worker thread, which is recycled for the next job.
+    this->arena = sjd->streaming ? &VoxelArena::ForCurrentThread() : NULL;
+    if (this->arena != NULL) {
+        this->arena->Reset();
+    }
+    this->borderCells.clear();
+    FatVoxel *volume = (this->arena != NULL)
+        ? this->arena->Allocate<FatVoxel>(sjd->resX * sjd->resY * sjd->resZ)
+        : new FatVoxel[sjd->resX * sjd->resY * sjd->resZ];
     // we can do that when using structs ... - its safer doing memzero (in case new members get added to the FatVoxel struct)
     memset(volume, 0, sizeof(FatVoxel)*(sjd->resX * sjd->resY * sjd->resZ));
     for (SIZE_T i = 0; i < static_cast<SIZE_T>(sjd->resX * sjd->resY * sjd->resZ); i++) {
@@ -1199,6 +1220,13 @@ DWORD TetraVoxelizer::Run(void *userData) {
 
     // dealloc stuff in volume
     // dealloc volume as a whole etc.
+    if (this->arena != NULL) {
+        this->arena = NULL;
+        this->borderCells.clear();
+        sjd->parent->MergeStreamedSubJob(sjd);
+        sjd->Result.done = true;
+        return 0;
+    }
     for (int x = 0; x < static_cast<int>(sjd->resX) - 1; x++) {
         for (int y = 0; y < static_cast<int>(sjd->resY) - 1; y++) {
             for (int z = 0; z < static_cast<int>(sjd->resZ) - 1; z++) {
@@ -7,7 +7,9 @@
 #include "vislib/sys/ThreadPool.h"
 #include "JobStructures.h"
 #include "TagVolume.h"
+#include "VoxelArena.h"
 #include "vislib/math/ShallowShallowTriangle.h"
+#include <vector>
 
 namespace megamol {
 namespace trisoup {
@@ -88,6 +90,12 @@ namespace volumetrics {
 
         SubJobData *sjd;
 
+        /** the arena the per-cell geometry is allocated from, NULL for the heap */
+        VoxelArena *arena;
+
+        /** the cells that received a BorderVoxel while collecting the current surface */
+        std::vector<FatVoxel *> borderCells;
+
         vislib::SingleLinkedList<vislib::math::Point<unsigned int, 4> > cellFIFO;
 };
 
@@ -22,8 +22,11 @@
 #include "vislib/sys/sysfunctions.h"
 #include "vislib/sys/ConsoleProgressBar.h"
 #include "vislib/sys/SystemInformation.h"
+#include "vislib/sys/AutoLock.h"
 #include <climits>
 #include <cfloat>
+#include <unordered_map>
+#include <vector>
 
 using namespace megamol;
 using namespace megamol::trisoup;
@@ -49,6 +52,10 @@ VoluMetricJob::VoluMetricJob(void) : core::job::AbstractThreadedJob(), core::Mod
         outVolDataSlot("outVolData", "Slot that outputs debug volume data"),
         cellSizeRatioSlot("cellSizeRatioSlot", "Fraction of the minimal particle radius that is used as cell size"),
         subVolumeResolutionSlot("subVolumeResolutionSlot", "maximum edge length of a subvolume processed as a separate job"),
+        streamingModeSlot("streamingModeSlot", "use per-worker arenas, join the surfaces of neighbouring subvolumes "
+        "as soon as they finish and stream their geometry instead of keeping it (disables the debug outputs)"),
+        meshStreamFilenameSlot("meshStreamFilenameSlot", "streaming mode: file that receives the geometry of the "
+        "finished subvolumes"),
         MaxRad(0), backBufferIndex(0), meshBackBufferIndex(0), hash(0) {
 
     this->getDataSlot.SetCompatibleCall<core::moldyn::MultiParticleDataCallDescription>();
@@ -81,6 +88,12 @@ VoluMetricJob::VoluMetricJob(void) : core::job::AbstractThreadedJob(), core::Mod
     this->subVolumeResolutionSlot << new core::param::IntParam(128, 16, 2048);
     this->MakeSlotAvailable(&this->subVolumeResolutionSlot);
 
+    this->streamingModeSlot << new core::param::BoolParam(false);
+    this->MakeSlotAvailable(&this->streamingModeSlot);
+
+    this->meshStreamFilenameSlot << new core::param::FilePathParam("");
+    this->MakeSlotAvailable(&this->meshStreamFilenameSlot);
+
     this->outLineDataSlot.SetCallback("LinesDataCall", "GetData", &VoluMetricJob::getLineDataCallback);
     this->outLineDataSlot.SetCallback("LinesDataCall", "GetExtent", &VoluMetricJob::getLineExtentCallback);
     this->MakeSlotAvailable(&this->outLineDataSlot);
@@ -154,6 +167,16 @@ DWORD VoluMetricJob::Run(void *userData) {
         }
     }
 
+    const bool streaming = this->streamingModeSlot.Param<core::param::BoolParam>()->Value();
+    if (streaming && !meshStreamFilenameSlot.Param<core::param::FilePathParam>()->Value().IsEmpty()) {
+        if (!this->meshStreamFile.Open(meshStreamFilenameSlot.Param<core::param::FilePathParam>()->Value(),
+            vislib::sys::File::WRITE_ONLY, vislib::sys::File::SHARE_READ,
+            vislib::sys::File::CREATE_OVERWRITE)) {
+            Log::DefaultLog.WriteError("Could not open mesh stream file for writing");
+            return -3;
+        }
+    }
+
     vislib::Array<TetraVoxelizer*> voxelizerList;
 
     voxelizerList.SetCapacityIncrement(16);
@@ -173,6 +196,7 @@ DWORD VoluMetricJob::Run(void *userData) {
         } while (datacall->FrameID() != frameI && (vislib::sys::Thread::Sleep(100), true));
 
         this->MaxGlobalID = 0;
+        this->surfaceSets.Clear();
 
         // clear submitted stuff, dealloc.
         while (voxelizerList.Count() > 0) {
@@ -278,6 +302,11 @@ DWORD VoluMetricJob::Run(void *userData) {
             (this->outTriDataSlot.GetStatus() == megamol::core::AbstractSlot::STATUS_CONNECTED);
         bool storeVolume = //storeMesh; // debug for now ...
             (this->outVolDataSlot.GetStatus() == megamol::core::AbstractSlot::STATUS_CONNECTED);
+        if (streaming) {
+            // meshes only live until they are written to the stream
+            storeMesh = this->meshStreamFile.IsOpen();
+            storeVolume = false;
+        }
 
         vislib::sys::ConsoleProgressBar pb;
         pb.Start("Computing Frame", divX * divY * divZ);
@@ -324,17 +353,30 @@ DWORD VoluMetricJob::Run(void *userData) {
                     sjd->MaxRad = MaxRad / RadMult;
                     sjd->storeMesh = storeMesh;
                     sjd->storeVolume = storeVolume;
+                    sjd->streaming = streaming;
+                    sjd->finished.store(false);
+                    sjd->borderRefs.store(1);
                     SubJobDataList.Add(sjd);
                     TetraVoxelizer *v = new TetraVoxelizer();
                     voxelizerList.Add(v);
-
-                    //if (z == 0 && y == 0) {
-                        pool.QueueUserWorkItem(v, sjd);
-                    //}
                 }
             }
         }
         //}
+
+        // the jobs look up each other in SubJobDataList, so it must be
+        // complete before the first one starts.
+        for (SIZE_T i = 0; i < SubJobDataList.Count(); i++) {
+            SubJobData *sjd = SubJobDataList[i];
+            for (unsigned int neighbIdx = 0; neighbIdx < 6; neighbIdx++) {
+                if (this->subJobIndex(sjd->gridX + TetraVoxelizer::moreNeighbors[neighbIdx].X(),
+                        sjd->gridY + TetraVoxelizer::moreNeighbors[neighbIdx].Y(),
+                        sjd->gridZ + TetraVoxelizer::moreNeighbors[neighbIdx].Z()) >= 0) {
+                    sjd->borderRefs++;
+                }
+            }
+            pool.QueueUserWorkItem(voxelizerList[i], sjd);
+        }
         this->debugLines[backBufferIndex][0].Set(
                 static_cast<unsigned int>(idxNumOffset * 2),
                 this->bboxIdxData[backBufferIndex].As<unsigned int>(), this->bboxVertData[backBufferIndex].As<VoxelizerFloat>(),
@@ -359,6 +401,11 @@ DWORD VoluMetricJob::Run(void *userData) {
             if (lastCount != pool.CountUserWorkItems()) {
                 pb.Set(static_cast<vislib::sys::ConsoleProgressBar::Size>(
                     divX * divY * divZ - pool.CountUserWorkItems()));
+                if (streaming) {
+                    // the jobs join their surfaces themselves
+                    lastCount = pool.CountUserWorkItems();
+                    continue;
+                }
                 generateStatistics(uniqueIDs, countPerID, surfPerID, volPerID, voidVolPerID);
                 if (storeMesh)
                     copyMeshesToBackbuffer(uniqueIDs);
@@ -367,12 +414,29 @@ DWORD VoluMetricJob::Run(void *userData) {
                 lastCount = pool.CountUserWorkItems();
             }
         }
-        generateStatistics(uniqueIDs, countPerID, surfPerID, volPerID, voidVolPerID);
-        outputStatistics(frameI, uniqueIDs, countPerID, surfPerID, volPerID, voidVolPerID);
-        if (storeMesh)
-            copyMeshesToBackbuffer(uniqueIDs);
-        if (storeVolume)
-            copyVolumesToBackBuffer();
+        if (streaming) {
+            generateStreamedStatistics(uniqueIDs, countPerID, surfPerID, volPerID, voidVolPerID);
+            outputStatistics(frameI, uniqueIDs, countPerID, surfPerID, volPerID, voidVolPerID);
+            if (this->meshStreamFile.IsOpen()) {
+                // the ID table mapping the provisional IDs used in the stream to the final ones
+                std::vector<UINT32> table;
+                table.reserve(this->surfaceSets.Count() + 3);
+                table.push_back(UINT_MAX);
+                table.push_back(frameI);
+                table.push_back(this->surfaceSets.Count());
+                for (unsigned int i = 0; i < this->surfaceSets.Count(); i++) {
+                    table.push_back(this->surfaceSets.Find(i));
+                }
+                this->meshStreamFile.Write(table.data(), table.size() * sizeof(UINT32));
+            }
+        } else {
+            generateStatistics(uniqueIDs, countPerID, surfPerID, volPerID, voidVolPerID);
+            outputStatistics(frameI, uniqueIDs, countPerID, surfPerID, volPerID, voidVolPerID);
+            if (storeMesh)
+                copyMeshesToBackbuffer(uniqueIDs);
+            if (storeVolume)
+                copyVolumesToBackBuffer();
+        }
         pb.Stop();
         Log::DefaultLog.WriteInfo("Done marching.");
         pool.Terminate(true);
@@ -390,6 +454,9 @@ DWORD VoluMetricJob::Run(void *userData) {
     if (!metricsFilenameSlot.Param<core::param::FilePathParam>()->Value().IsEmpty()) {
         statisticsFile.Close();
     }
+    if (this->meshStreamFile.IsOpen()) {
+        this->meshStreamFile.Close();
+    }
     return 0;
 }
 
@@ -619,6 +686,52 @@ VISLIB_FORCEINLINE void VoluMetricJob::joinSurfaces(int sjdIdx1, int surfIdx1, i
     RewriteGlobalID.Unlock();
 }
 
+void VoluMetricJob::MergeStreamedSubJob(SubJobData *sjd) {
+    const unsigned int surfCnt = static_cast<unsigned int>(sjd->Result.surfaces.Count());
+    const unsigned int firstID = this->surfaceSets.Add(surfCnt);
+    for (unsigned int surfIdx = 0; surfIdx < surfCnt; surfIdx++) {
+        sjd->Result.surfaces[surfIdx].globalID = firstID + surfIdx;
+    }
+
+    // publish the surfaces. publishing and checking the neighbours are both
+    // sequentially consistent, so of two neighbours finishing at the same
+    // time at least one sees the other and joins their surfaces.
+    sjd->finished.store(true);
+
+    const int thisIndex = this->subJobIndex(sjd->gridX, sjd->gridY, sjd->gridZ);
+    int neighbours[6];
+    for (unsigned int neighbIdx = 0; neighbIdx < 6; neighbIdx++) {
+        neighbours[neighbIdx] = this->subJobIndex(sjd->gridX + TetraVoxelizer::moreNeighbors[neighbIdx].X(),
+            sjd->gridY + TetraVoxelizer::moreNeighbors[neighbIdx].Y(),
+            sjd->gridZ + TetraVoxelizer::moreNeighbors[neighbIdx].Z());
+        if (neighbours[neighbIdx] < 0 || !SubJobDataList[neighbours[neighbIdx]]->finished.load()) {
+            continue;
+        }
+
+        SubJobData *other = SubJobDataList[neighbours[neighbIdx]];
+        for (unsigned int surfIdx = 0; surfIdx < surfCnt; surfIdx++) {
+            for (unsigned int otherSurfIdx = 0; otherSurfIdx < other->Result.surfaces.Count(); otherSurfIdx++) {
+                if (areSurfacesJoinable(thisIndex, surfIdx, neighbours[neighbIdx], otherSurfIdx)) {
+                    this->surfaceSets.Unite(sjd->Result.surfaces[surfIdx].globalID,
+                        other->Result.surfaces[otherSurfIdx].globalID);
+                }
+            }
+        }
+    }
+
+    if (this->meshStreamFile.IsOpen()) {
+        this->writeStreamedGeometry(sjd);
+    }
+
+    // this job is done with its own border and those of its neighbours.
+    this->releaseStreamedBorders(sjd);
+    for (unsigned int neighbIdx = 0; neighbIdx < 6; neighbIdx++) {
+        if (neighbours[neighbIdx] >= 0) {
+            this->releaseStreamedBorders(SubJobDataList[neighbours[neighbIdx]]);
+        }
+    }
+}
+
 VISLIB_FORCEINLINE bool VoluMetricJob::isSurfaceJoinableWithSubvolume(SubJobData *surfJob, int surfIdx, SubJobData *volume) {
     for (unsigned int i = 0; i < 6; i++) {
         if (surfJob->Result.surfaces[surfIdx].fullFaces & (1 << i)) {
@@ -770,6 +883,43 @@ restart:
     }
 }
 
+void VoluMetricJob::generateStreamedStatistics(vislib::Array<unsigned int> &uniqueIDs,
+                                               vislib::Array<SIZE_T> &countPerID,
+                                               vislib::Array<VoxelizerFloat> &surfPerID,
+                                               vislib::Array<VoxelizerFloat> &volPerID,
+                                               vislib::Array<VoxelizerFloat> &voidVolPerID) {
+    uniqueIDs.Clear();
+    countPerID.Clear();
+    surfPerID.Clear();
+    volPerID.Clear();
+    voidVolPerID.Clear();
+
+    std::unordered_map<unsigned int, SIZE_T> positions;
+    for (unsigned int sjdIdx = 0; sjdIdx < SubJobDataList.Count(); sjdIdx++) {
+        SubJobData *sjd = SubJobDataList[sjdIdx];
+        for (unsigned int surfIdx = 0; surfIdx < sjd->Result.surfaces.Count(); surfIdx++) {
+            Surface& surf = sjd->Result.surfaces[surfIdx];
+            surf.globalID = this->surfaceSets.Find(surf.globalID);
+
+            auto it = positions.find(surf.globalID);
+            if (it == positions.end()) {
+                positions[surf.globalID] = uniqueIDs.Count();
+                uniqueIDs.Add(surf.globalID);
+                countPerID.Add(surf.triangleCount);
+                surfPerID.Add(surf.surface);
+                volPerID.Add(surf.volume);
+                voidVolPerID.Add(surf.voidVolume);
+            } else {
+                const SIZE_T pos = it->second;
+                countPerID[pos] = countPerID[pos] + surf.triangleCount;
+                surfPerID[pos] = surfPerID[pos] + surf.surface;
+                volPerID[pos] = volPerID[pos] + surf.volume;
+                voidVolPerID[pos] = voidVolPerID[pos] + surf.voidVolume;
+            }
+        }
+    }
+}
+
 /*
 bool rayTriangleIntersect(ShallowShallowTriangle<VoxelizerFloat,3>& triangle, ) {
 
@@ -938,12 +1088,16 @@ void VoluMetricJob::outputStatistics(unsigned int frameNumber,
     globalIdBoxes.SetCount(uniqueIDs.Count());
     vislib::Array<vislib::Array<Surface*> > globaIdSurfaces/*(uniqueIDs.Count(), vislib::Array<Surface*>(10)?)*/;
     globaIdSurfaces.SetCount(uniqueIDs.Count());
+    std::unordered_map<unsigned int, int> uniqueIdPositions;
+    for (unsigned int i = 0; i < uniqueIDs.Count(); i++) {
+        uniqueIdPositions[uniqueIDs[i]] = static_cast<int>(i);
+    }
     for(unsigned int sjdIdx = 0; sjdIdx < SubJobDataList.Count(); sjdIdx++) {
         SubJobData *subJob = SubJobDataList[sjdIdx];
         for (unsigned int surfIdx = 0; surfIdx < subJob->Result.surfaces.Count(); surfIdx++) {
             Surface& surface = subJob->Result.surfaces[surfIdx];
             int globalId = surface.globalID;
-            int uniqueIdPos = static_cast<int>(uniqueIDs.IndexOf(globalId));
+            int uniqueIdPos = uniqueIdPositions[globalId];
             globalIdBoxes[uniqueIdPos].Union(surface.boundingBox);
             globaIdSurfaces[uniqueIdPos].Add(&surface);
         }
@@ -1131,3 +1285,44 @@ void VoluMetricJob::copyMeshesToBackbuffer(vislib::Array<unsigned int> &uniqueID
     meshBackBufferIndex = 1 - meshBackBufferIndex;
     this->hash++;
 }
+
+void VoluMetricJob::releaseStreamedBorders(SubJobData *sjd) {
+    if (sjd->borderRefs.fetch_sub(1) == 1) {
+        for (SIZE_T surfIdx = 0; surfIdx < sjd->Result.surfaces.Count(); surfIdx++) {
+            sjd->Result.surfaces[surfIdx].border = NULL;
+        }
+    }
+}
+
+int VoluMetricJob::subJobIndex(int x, int y, int z) const {
+    if (x < 0 || y < 0 || z < 0 || x >= divX || y >= divY || z >= divZ) {
+        return -1;
+    }
+    // same order as the jobs are created in Run
+    return (x * divY + y) * divZ + z;
+}
+
+void VoluMetricJob::writeStreamedGeometry(SubJobData *sjd) {
+    std::vector<float> buffer;
+    for (SIZE_T surfIdx = 0; surfIdx < sjd->Result.surfaces.Count(); surfIdx++) {
+        Surface& surf = sjd->Result.surfaces[surfIdx];
+        const SIZE_T triCount = surf.mesh.Count() / 9;
+        if (triCount == 0) {
+            continue;
+        }
+
+        const SIZE_T offset = buffer.size();
+        buffer.resize(offset + 2 + triCount * 9);
+        reinterpret_cast<UINT32 *>(buffer.data() + offset)[0] = surf.globalID;
+        reinterpret_cast<UINT32 *>(buffer.data() + offset)[1] = static_cast<UINT32>(triCount);
+        for (SIZE_T i = 0; i < triCount * 9; i++) {
+            buffer[offset + 2 + i] = static_cast<float>(surf.mesh[i]);
+        }
+        surf.mesh.Clear(true);
+    }
+
+    if (!buffer.empty()) {
+        vislib::sys::AutoLock lock(this->AccessMeshStream);
+        this->meshStreamFile.Write(buffer.data(), buffer.size() * sizeof(float));
+    }
+}
@@ -22,6 +22,8 @@
 #include "mmcore/param/ParamSlot.h"
 #include "vislib/math/Cuboid.h"
 #include "JobStructures.h"
+#include "SurfaceUnionFind.h"
+#include "vislib/sys/CriticalSection.h"
 #include "vislib/sys/File.h"
 
 namespace megamol {
@@ -86,6 +88,16 @@ namespace volumetrics {
 
         vislib::Array<SubJobData*> SubJobDataList;
 
+        /**
+         * Streaming mode: publishes the surfaces of a finished job, joins
+         * them with those of finished neighbours, writes the geometry to the
+         * mesh stream and releases the memory that is not needed any more.
+         * Called from the worker thread that computed the job.
+         *
+         * @param sjd the job that has just finished
+         */
+        void MergeStreamedSubJob(SubJobData *sjd);
+
     protected:
 
         /**
@@ -211,8 +223,36 @@ namespace volumetrics {
             vislib::Array<VoxelizerFloat> &volPerID,
             vislib::Array<VoxelizerFloat> &voidVolPerID);
 
+        /**
+         * Streaming mode: resolves the final surface IDs and collects the
+         * statistics from the per-surface metrics without any geometry.
+         */
+        void generateStreamedStatistics(vislib::Array<unsigned int> &uniqueIDs,
+            vislib::Array<SIZE_T> &countPerID,
+            vislib::Array<VoxelizerFloat> &surfPerID,
+            vislib::Array<VoxelizerFloat> &volPerID,
+            vislib::Array<VoxelizerFloat> &voidVolPerID);
+
         bool isSurfaceJoinableWithSubvolume(SubJobData *surfJob, int surfIdx, SubJobData *volume);
 
+        /**
+         * Streaming mode: drops one reference to the border geometry of sjd
+         * and frees it when no job needs it any more.
+         */
+        void releaseStreamedBorders(SubJobData *sjd);
+
+        /**
+         * Answer the index of the job at the given grid position in
+         * SubJobDataList, or -1 if the position lies outside the grid.
+         */
+        int subJobIndex(int x, int y, int z) const;
+
+        /**
+         * Streaming mode: appends the meshes of sjd to the mesh stream and
+         * drops them from memory.
+         */
+        void writeStreamedGeometry(SubJobData *sjd);
+
         //void joinSurfaces(vislib::Array<vislib::Array<unsigned int> > &globalSurfaceIDs,
         //    int i, int j, int k, int l);
 
@@ -225,6 +265,8 @@ namespace volumetrics {
         core::param::ParamSlot continueToNextFrameSlot;
 
         core::param::ParamSlot metricsFilenameSlot;
+
+        core::param::ParamSlot meshStreamFilenameSlot;
         
         core::param::ParamSlot showBoundingBoxesSlot;
 
@@ -238,6 +280,8 @@ namespace volumetrics {
 
         core::param::ParamSlot resetContinueSlot;
 
+        core::param::ParamSlot streamingModeSlot;
+
         core::CalleeSlot outLineDataSlot;
 
         core::CalleeSlot outTriDataSlot;
@@ -265,6 +309,21 @@ namespace volumetrics {
 
         vislib::sys::File statisticsFile;
 
+        /**
+         * streaming mode: receives the geometry of the finished jobs. Each
+         * surface is written as its provisional ID and triangle count (both
+         * UINT32) followed by the triangles as 9 floats each. A frame is
+         * terminated by UINT_MAX, the frame number, the number of
+         * provisional IDs and the final ID of each of them (all UINT32).
+         */
+        vislib::sys::File meshStreamFile;
+
+        /** serialises the writes to meshStreamFile */
+        vislib::sys::CriticalSection AccessMeshStream;
+
+        /** streaming mode: the surfaces joined so far, identified by their provisional IDs */
+        SurfaceUnionFind surfaceSets;
+
         /**
          * lines data. debugLines[backBufferIndex][*] is writable, the other one readable.
          * debugLines[*][0] contains the bounding boxes, [*][1] the boundaries (in future)
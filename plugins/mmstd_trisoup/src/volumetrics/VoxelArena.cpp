@@ -0,0 +1,67 @@
+/*
+ * VoxelArena.cpp
+ *
+ * Copyright (C) 2020 by VISUS (Universitaet Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+#include "stdafx.h"
+#include "VoxelArena.h"
+
+using namespace megamol;
+using namespace megamol::trisoup;
+using namespace megamol::trisoup::volumetrics;
+
+
+VoxelArena& VoxelArena::ForCurrentThread(void) {
+    static thread_local VoxelArena arena;
+    return arena;
+}
+
+
+VoxelArena::VoxelArena(const size_t blockSize) : blockSize(blockSize), current(0), offset(0) {
+}
+
+
+VoxelArena::~VoxelArena(void) {
+}
+
+
+size_t VoxelArena::Capacity(void) const {
+    size_t retval = 0;
+    for (auto& b : this->blocks) {
+        retval += b.size;
+    }
+    return retval;
+}
+
+
+void VoxelArena::Reset(void) {
+    this->current = 0;
+    this->offset = 0;
+}
+
+
+void *VoxelArena::allocate(const size_t size) {
+    const size_t align = alignof(std::max_align_t);
+    const size_t padded = (size + align - 1) / align * align;
+
+    // find the first block from the current one on with enough room left.
+    while (this->current < this->blocks.size()) {
+        Block& b = this->blocks[this->current];
+        if (this->offset + padded <= b.size) {
+            void *retval = b.data.get() + this->offset;
+            this->offset += padded;
+            return retval;
+        }
+        ++this->current;
+        this->offset = 0;
+    }
+
+    Block b;
+    b.size = (padded > this->blockSize) ? padded : this->blockSize;
+    b.data.reset(new unsigned char[b.size]);
+    this->blocks.push_back(std::move(b));
+    this->current = this->blocks.size() - 1;
+    this->offset = padded;
+    return this->blocks.back().data.get();
+}
@@ -0,0 +1,105 @@
+/*
+ * VoxelArena.h
+ *
+ * Copyright (C) 2020 by VISUS (Universitaet Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MEGAMOLCORE_VOXELARENA_H_INCLUDED
+#define MEGAMOLCORE_VOXELARENA_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+
+namespace megamol {
+namespace trisoup {
+namespace volumetrics {
+
+    /**
+     * Bump allocator for the short-lived per-cell geometry of a sub-volume.
+     *
+     * Memory is handed out from large blocks and only released as a whole,
+     * either by Reset(), which keeps the blocks for the next sub-volume, or
+     * by destroying the arena. Each worker thread owns its own arena, so no
+     * synchronisation is required.
+     */
+    class VoxelArena {
+    public:
+
+        /**
+         * Answer the arena of the calling thread.
+         *
+         * @return The arena of the calling thread.
+         */
+        static VoxelArena& ForCurrentThread(void);
+
+        /**
+         * Ctor.
+         *
+         * @param blockSize The minimum size of a block in bytes.
+         */
+        VoxelArena(const size_t blockSize = 4 * 1024 * 1024);
+
+        /** Dtor. */
+        ~VoxelArena(void);
+
+        /**
+         * Allocate uninitialised memory for 'cnt' elements of type T. The
+         * memory remains valid until the next call to Reset().
+         *
+         * @param cnt The number of elements.
+         *
+         * @return Pointer to the memory.
+         */
+        template<class T> inline T *Allocate(const size_t cnt) {
+            return static_cast<T *>(this->allocate(cnt * sizeof(T)));
+        }
+
+        /**
+         * Answer the number of bytes reserved by the arena.
+         *
+         * @return The number of bytes held in blocks.
+         */
+        size_t Capacity(void) const;
+
+        /**
+         * Invalidate all allocations, but keep the blocks for reuse.
+         */
+        void Reset(void);
+
+    private:
+
+        /** A block of memory the allocations are served from. */
+        struct Block {
+            std::unique_ptr<unsigned char[]> data;
+            size_t size;
+        };
+
+        /**
+         * Allocate 'size' bytes aligned to the maximum fundamental alignment.
+         */
+        void *allocate(const size_t size);
+
+        /** The blocks owned by the arena. */
+        std::vector<Block> blocks;
+
+        /** The minimum size of a new block. */
+        size_t blockSize;
+
+        /** The index of the block allocations are currently served from. */
+        size_t current;
+
+        /** The number of bytes used in the current block. */
+        size_t offset;
+    };
+
+} /* end namespace volumetrics */
+} /* end namespace trisoup */
+} /* end namespace megamol */
+
+#endif /* MEGAMOLCORE_VOXELARENA_H_INCLUDED */
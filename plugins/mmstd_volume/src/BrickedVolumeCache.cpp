@@ -0,0 +1,734 @@
+/*
+ * BrickedVolumeCache.cpp
+ *
+ * Copyright (C) 2020 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#include "stdafx.h"
+#include "BrickedVolumeCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "zlib.h"
+
+#include "vislib/sys/Log.h"
+
+
+namespace {
+
+/** Magic number at the begin of each cache file. */
+const char CACHE_MAGIC[8] = {'M', 'M', 'B', 'V', 'C', '\0', '\0', '\0'};
+
+
+/** Answer whether the machine is little endian. */
+bool isLittleEndian(void) {
+    const uint16_t word = 0x0001;
+    return *reinterpret_cast<const uint8_t*>(&word) == 0x01;
+}
+
+
+/** Reverses the bytes of 'cnt' scalars of length 'length' in place. */
+void swapBytes(uint8_t* data, const size_t cnt, const size_t length) {
+    for (size_t i = 0; i < cnt; ++i, data += length) {
+        std::reverse(data, data + length);
+    }
+}
+
+
+/**
+ * Seeks from the begin of 'fd' to 'offset'. z_off_t has only 32 bits on
+ * Windows, so larger offsets are approached in relative steps of 1 GiB.
+ */
+bool seekRaw(gzFile fd, const uint64_t offset) {
+    if (sizeof(z_off_t) >= sizeof(uint64_t)) {
+        return ::gzseek(fd, static_cast<z_off_t>(offset), SEEK_SET) == static_cast<z_off_t>(offset);
+    }
+    const uint64_t step = static_cast<uint64_t>(1) << 30;
+    for (uint64_t remaining = offset; remaining > 0;) {
+        const uint64_t s = std::min(remaining, step);
+        if (::gzseek(fd, static_cast<z_off_t>(s), SEEK_CUR) == -1) return false;
+        remaining -= s;
+    }
+    return true;
+}
+
+
+/** Retrieves size and modification time of a file. */
+bool statFile(const char* path, uint64_t& outSize, int64_t& outTime) {
+#ifdef _WIN32
+    struct _stat64 st;
+    if (::_stat64(path, &st) != 0) return false;
+#else  /* _WIN32 */
+    struct stat st;
+    if (::stat(path, &st) != 0) return false;
+#endif /* _WIN32 */
+    outSize = static_cast<uint64_t>(st.st_size);
+    outTime = static_cast<int64_t>(st.st_mtime);
+    return true;
+}
+
+
+/** Updates the per-component ranges 'range' with 'cnt' voxels in 'data'. */
+template<class T>
+void accumulateRange(const uint8_t* data, const size_t cnt, const size_t components, double* range) {
+    const T* values = reinterpret_cast<const T*>(data);
+    for (size_t i = 0; i < cnt; ++i) {
+        for (size_t c = 0; c < components; ++c) {
+            const double v = static_cast<double>(values[i * components + c]);
+            if (v < range[2 * c]) range[2 * c] = v;
+            if (v > range[2 * c + 1]) range[2 * c + 1] = v;
+        }
+    }
+}
+
+
+/** Dispatches accumulateRange on the dat/raw format. */
+void accumulateRange(const DatRawDataFormat format, const uint8_t* data, const size_t cnt,
+    const size_t components, double* range) {
+    switch (format) {
+    case DR_FORMAT_CHAR: accumulateRange<int8_t>(data, cnt, components, range); break;
+    case DR_FORMAT_UCHAR: accumulateRange<uint8_t>(data, cnt, components, range); break;
+    case DR_FORMAT_SHORT: accumulateRange<int16_t>(data, cnt, components, range); break;
+    case DR_FORMAT_USHORT: accumulateRange<uint16_t>(data, cnt, components, range); break;
+    case DR_FORMAT_INT: accumulateRange<int32_t>(data, cnt, components, range); break;
+    case DR_FORMAT_UINT: accumulateRange<uint32_t>(data, cnt, components, range); break;
+    case DR_FORMAT_LONG: accumulateRange<int64_t>(data, cnt, components, range); break;
+    case DR_FORMAT_ULONG: accumulateRange<uint64_t>(data, cnt, components, range); break;
+    case DR_FORMAT_FLOAT: accumulateRange<float>(data, cnt, components, range); break;
+    case DR_FORMAT_DOUBLE: accumulateRange<double>(data, cnt, components, range); break;
+    default: break;
+    }
+}
+
+
+/**
+ * Computes a brick of the next coarser level by averaging 2x2x2 voxels of
+ * the up to eight child bricks in 'children' (indexed by x + 2 * (y + 2 * z)).
+ */
+template<class T>
+void downsampleBrick(const uint8_t* const* children, const size_t brickSize, const size_t components,
+    const uint64_t* brick, const uint64_t* resolution, const uint64_t* childResolution, uint8_t* dst) {
+    T* out = reinterpret_cast<T*>(dst);
+    const bool isIntegral = std::numeric_limits<T>::is_integer;
+
+    for (size_t z = 0; z < brickSize; ++z) {
+        const uint64_t gz = std::min<uint64_t>(brick[2] * brickSize + z, resolution[2] - 1);
+        const uint64_t cz[2] = {2 * gz, std::min<uint64_t>(2 * gz + 1, childResolution[2] - 1)};
+        for (size_t y = 0; y < brickSize; ++y) {
+            const uint64_t gy = std::min<uint64_t>(brick[1] * brickSize + y, resolution[1] - 1);
+            const uint64_t cy[2] = {2 * gy, std::min<uint64_t>(2 * gy + 1, childResolution[1] - 1)};
+            for (size_t x = 0; x < brickSize; ++x) {
+                const uint64_t gx = std::min<uint64_t>(brick[0] * brickSize + x, resolution[0] - 1);
+                const uint64_t cx[2] = {2 * gx, std::min<uint64_t>(2 * gx + 1, childResolution[0] - 1)};
+
+                for (size_t c = 0; c < components; ++c) {
+                    double sum = 0.0;
+                    for (int k = 0; k < 8; ++k) {
+                        const uint64_t sx = cx[k & 1], sy = cy[(k >> 1) & 1], sz = cz[(k >> 2) & 1];
+                        const size_t child = (sx / brickSize - 2 * brick[0]) +
+                                             2 * ((sy / brickSize - 2 * brick[1]) +
+                                                     2 * (sz / brickSize - 2 * brick[2]));
+                        const size_t local = ((sz % brickSize) * brickSize + (sy % brickSize)) * brickSize +
+                                             (sx % brickSize);
+                        sum += static_cast<double>(
+                            reinterpret_cast<const T*>(children[child])[local * components + c]);
+                    }
+                    sum *= 0.125;
+                    if (isIntegral) sum = std::floor(sum + 0.5);
+                    out[((z * brickSize + y) * brickSize + x) * components + c] = static_cast<T>(sum);
+                }
+            }
+        }
+    }
+}
+
+} /* end namespace */
+
+
+/*
+ * megamol::stdplugin::volume::BrickedVolumeCache::CountLevels
+ */
+unsigned int megamol::stdplugin::volume::BrickedVolumeCache::CountLevels(
+    const size_t* resolution, const size_t brickSize) {
+    unsigned int retval = 1;
+    size_t r[3] = {resolution[0], resolution[1], resolution[2]};
+    while ((brickSize > 0) && (std::max(r[0], std::max(r[1], r[2])) > brickSize)) {
+        for (int d = 0; d < 3; ++d) {
+            r[d] = (r[d] + 1) / 2;
+        }
+        ++retval;
+    }
+    return retval;
+}
+
+
+/*
+ * megamol::stdplugin::volume::BrickedVolumeCache::IsSupported
+ */
+bool megamol::stdplugin::volume::BrickedVolumeCache::IsSupported(const DatRawDataFormat format) {
+    switch (format) {
+    case DR_FORMAT_CHAR:
+    case DR_FORMAT_UCHAR:
+    case DR_FORMAT_SHORT:
+    case DR_FORMAT_USHORT:
+    case DR_FORMAT_INT:
+    case DR_FORMAT_UINT:
+    case DR_FORMAT_LONG:
+    case DR_FORMAT_ULONG:
+    case DR_FORMAT_FLOAT:
+    case DR_FORMAT_DOUBLE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+
+/*
+ * megamol::stdplugin::volume::BrickedVolumeCache::VERSION
+ */
+const uint32_t megamol::stdplugin::volume::BrickedVolumeCache::VERSION = 1;
+
+
+/*
+ * megamol::stdplugin::volume::BrickedVolumeCache::BrickedVolumeCache
+ */
+megamol::stdplugin::volume::BrickedVolumeCache::BrickedVolumeCache(void) : memoryBudget(512 * 1024 * 1024) {
+    ::memset(&this->header, 0, sizeof(this->header));
+}
+
+
+/*
+ * megamol::stdplugin::volume::BrickedVolumeCache::~BrickedVolumeCache
+ */
+megamol::stdplugin::volume::BrickedVolumeCache::~BrickedVolumeCache(void) { this->Close(); }
+
+
+/*
+ * megamol::stdplugin::volume::BrickedVolumeCache::Close
+ */
+void megamol::stdplugin::volume::BrickedVolumeCache::Close(void) {
+    if (this->file.is_open()) {
+        this->file.close();
+    }
+    this->file.clear();
+    this->lru.clear();
+    this->lruIndex.clear();
+    this->levels.clear();
+    this->ranges.clear();
+    this->brickRanges.clear();
+    ::memset(&this->header, 0, sizeof(this->header));
+}
+
+
+/*
+ * megamol::stdplugin::volume::BrickedVolumeCache::GetBrickRange
+ */
+void megamol::stdplugin::volume::BrickedVolumeCache::GetBrickRange(const unsigned int level, const size_t brick,
+    const size_t component, double& outMin, double& outMax) const {
+    const auto& r = this->brickRanges[level];
+    const size_t idx = 2 * (brick * this->header.Components + component);
+    outMin = r[idx];
+    outMax = r[idx + 1];
+}
+
+
+/*
+ * megamol::stdplugin::volume::BrickedVolumeCache::Open
+ */
+bool megamol::stdplugin::volume::BrickedVolumeCache::Open(const DatRawFileInfo& info, const unsigned int frame,
+    const std::string& cachePath, const size_t brickSize) {
+    using vislib::sys::Log;
+
+    this->Close();
+
+    if (!BrickedVolumeCache::IsSupported(static_cast<DatRawDataFormat>(info.dataFormat))) {
+        Log::DefaultLog.WriteError(
+            "The data format %s cannot be bricked.", ::datRaw_getDataFormatName(info.dataFormat));
+        return false;
+    }
+    if ((info.dimensions < 1) || (info.dimensions > 3) || (brickSize < 2)) {
+        Log::DefaultLog.WriteError("Only one- to three-dimensional grids can be bricked.");
+        return false;
+    }
+
+    /* Identify the source by size and modification time of the raw file. */
+    uint64_t sourceSize = 0;
+    int64_t sourceTime = 0;
+    {
+        char* rawFile = info.multiDataFiles
+                            ? ::getMultifileFilename(const_cast<DatRawFileInfo*>(&info), static_cast<int>(frame))
+                            : info.dataFileName;
+        const bool haveStat = (rawFile != nullptr) && statFile(rawFile, sourceSize, sourceTime);
+        if (info.multiDataFiles) ::free(rawFile);
+        if (!haveStat) {
+            Log::DefaultLog.WriteError("Cannot access the raw file of frame %u.", frame);
+            return false;
+        }
+    }
+
+    /* Try to reuse an existing cache file. */
+    this->file.open(cachePath.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+    if (this->file.is_open()) {
+        FileHeader h;
+        this->file.read(reinterpret_cast<char*>(&h), sizeof(h));
+        bool isValid = this->file.good() && (::memcmp(h.Magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0) &&
+                       (h.Version == VERSION) && (h.BrickSize == brickSize) &&
+                       (h.Components == static_cast<uint32_t>(info.numComponents)) &&
+                       (h.DataFormat == info.dataFormat) && (h.Frame == frame) && (h.SourceSize == sourceSize) &&
+                       (h.SourceTime == sourceTime);
+        for (int d = 0; isValid && (d < 3); ++d) {
+            const uint64_t r = (d < info.dimensions) ? info.resolution[d] : 1;
+            isValid = (h.Resolution[d] == r);
+        }
+
+        if (isValid) {
+            this->header = h;
+            this->layoutLevels();
+            this->ranges.resize(2 * h.Components);
+            this->file.seekg(sizeof(FileHeader) + this->levels.size() * sizeof(LevelInfo));
+            this->file.read(reinterpret_cast<char*>(this->ranges.data()), this->ranges.size() * sizeof(double));
+            this->brickRanges.resize(this->levels.size());
+            for (size_t l = 0; l < this->levels.size(); ++l) {
+                const auto& li = this->levels[l];
+                this->brickRanges[l].resize(2 * li.Bricks[0] * li.Bricks[1] * li.Bricks[2] * h.Components);
+                this->file.seekg(li.RangeOffset);
+                this->file.read(reinterpret_cast<char*>(this->brickRanges[l].data()),
+                    this->brickRanges[l].size() * sizeof(double));
+            }
+            if (this->file.good()) {
+                Log::DefaultLog.WriteInfo("Using bricked volume cache \"%s\" with %u levels.", cachePath.c_str(),
+                    static_cast<unsigned int>(this->levels.size()));
+                return true;
+            }
+        }
+
+        Log::DefaultLog.WriteInfo("Bricked volume cache \"%s\" is outdated and will be rebuilt.", cachePath.c_str());
+        this->Close();
+    }
+
+    ::memset(&this->header, 0, sizeof(this->header));
+    this->header.BrickSize = static_cast<uint32_t>(brickSize);
+    return this->build(info, frame, cachePath, sourceSize, sourceTime);
+}
+
+
+/*
+ * megamol::stdplugin::volume::BrickedVolumeCache::Read
+ */
+bool megamol::stdplugin::volume::BrickedVolumeCache::Read(
+    const unsigned int level, const size_t* min, const size_t* max, void* dst) {
+    if (!this->IsOpen() || (level >= this->levels.size())) {
+        return false;
+    }
+
+    const auto& li = this->levels[level];
+    const size_t b = this->header.BrickSize;
+    const size_t voxelSize = this->VoxelSize();
+    for (int d = 0; d < 3; ++d) {
+        if ((min[d] >= max[d]) || (max[d] > li.Resolution[d])) {
+            return false;
+        }
+    }
+
+    const size_t ext[3] = {max[0] - min[0], max[1] - min[1], max[2] - min[2]};
+    auto out = static_cast<uint8_t*>(dst);
+
+    for (size_t bz = min[2] / b; bz <= (max[2] - 1) / b; ++bz) {
+        for (size_t by = min[1] / b; by <= (max[1] - 1) / b; ++by) {
+            for (size_t bx = min[0] / b; bx <= (max[0] - 1) / b; ++bx) {
+                const size_t brick = (bz * li.Bricks[1] + by) * li.Bricks[0] + bx;
+                const uint8_t* data = this->getBrick(level, brick);
+                if (data == nullptr) {
+                    return false;
+                }
+
+                /* Overlap of the brick and the region in level coordinates. */
+                const size_t x0 = std::max(min[0], bx * b), x1 = std::min(max[0], (bx + 1) * b);
+                const size_t y0 = std::max(min[1], by * b), y1 = std::min(max[1], (by + 1) * b);
+                const size_t z0 = std::max(min[2], bz * b), z1 = std::min(max[2], (bz + 1) * b);
+                const size_t run = (x1 - x0) * voxelSize;
+
+                for (size_t z = z0; z < z1; ++z) {
+                    for (size_t y = y0; y < y1; ++y) {
+                        const size_t src = (((z - bz * b) * b + (y - by * b)) * b + (x0 - bx * b)) * voxelSize;
+                        const size_t dstOff = (((z - min[2]) * ext[1] + (y - min[1])) * ext[0] + (x0 - min[0])) *
+                                              voxelSize;
+                        ::memcpy(out + dstOff, data + src, run);
+                    }
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+
+/*
+ * megamol::stdplugin::volume::BrickedVolumeCache::SetMemoryBudget
+ */
+void megamol::stdplugin::volume::BrickedVolumeCache::SetMemoryBudget(const size_t bytes) {
+    this->memoryBudget = bytes;
+    const size_t maxBricks = std::max<size_t>(1, this->memoryBudget / std::max<size_t>(1, this->brickBytes()));
+    while (this->lru.size() > maxBricks) {
+        this->lruIndex.erase(this->lru.back().Key);
+        this->lru.pop_back();
+    }
+}
+
+
+/*
+ * megamol::stdplugin::volume::BrickedVolumeCache::build
+ */
+bool megamol::stdplugin::volume::BrickedVolumeCache::build(const DatRawFileInfo& info, const unsigned int frame,
+    const std::string& cachePath, const uint64_t sourceSize, const int64_t sourceTime) {
+    using vislib::sys::Log;
+
+    ::memcpy(this->header.Magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    this->header.Version = VERSION;
+    for (int d = 0; d < 3; ++d) {
+        this->header.Resolution[d] = (d < info.dimensions) ? info.resolution[d] : 1;
+    }
+    this->header.Components = static_cast<uint32_t>(info.numComponents);
+    this->header.DataFormat = info.dataFormat;
+    this->header.ScalarLength = static_cast<uint32_t>(::datRaw_getFormatSize(info.dataFormat));
+    this->header.Frame = frame;
+    this->header.SourceSize = sourceSize;
+    this->header.SourceTime = sourceTime;
+
+    /* Halve the resolution until a single brick covers the level. */
+    {
+        const size_t r[3] = {static_cast<size_t>(this->header.Resolution[0]),
+            static_cast<size_t>(this->header.Resolution[1]), static_cast<size_t>(this->header.Resolution[2])};
+        this->header.Levels = BrickedVolumeCache::CountLevels(r, this->header.BrickSize);
+    }
+    this->layoutLevels();
+
+    Log::DefaultLog.WriteInfo("Building bricked volume cache \"%s\" with %u levels of %u^3 bricks...",
+        cachePath.c_str(), this->header.Levels, this->header.BrickSize);
+
+    this->file.open(cachePath.c_str(), std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!this->file.is_open()) {
+        Log::DefaultLog.WriteError("Cannot create bricked volume cache \"%s\".", cachePath.c_str());
+        return false;
+    }
+
+    /* Mark the file invalid until it is complete. */
+    FileHeader incomplete = this->header;
+    incomplete.Version = 0;
+    this->file.write(reinterpret_cast<const char*>(&incomplete), sizeof(incomplete));
+    this->file.write(reinterpret_cast<const char*>(this->levels.data()), this->levels.size() * sizeof(LevelInfo));
+
+    this->ranges.resize(2 * this->header.Components);
+    for (size_t c = 0; c < this->header.Components; ++c) {
+        this->ranges[2 * c] = std::numeric_limits<double>::max();
+        this->ranges[2 * c + 1] = std::numeric_limits<double>::lowest();
+    }
+    this->brickRanges.resize(this->levels.size());
+    for (size_t l = 0; l < this->levels.size(); ++l) {
+        const auto& li = this->levels[l];
+        this->brickRanges[l].resize(2 * li.Bricks[0] * li.Bricks[1] * li.Bricks[2] * this->header.Components);
+        for (size_t i = 0; i < this->brickRanges[l].size(); i += 2) {
+            this->brickRanges[l][i] = std::numeric_limits<double>::max();
+            this->brickRanges[l][i + 1] = std::numeric_limits<double>::lowest();
+        }
+    }
+
+    bool retval = this->buildLevel0(info, frame);
+    for (unsigned int l = 1; retval && (l < this->header.Levels); ++l) {
+        retval = this->buildLevel(l);
+    }
+
+    if (retval) {
+        this->file.seekp(sizeof(FileHeader) + this->levels.size() * sizeof(LevelInfo));
+        this->file.write(reinterpret_cast<const char*>(this->ranges.data()), this->ranges.size() * sizeof(double));
+        for (size_t l = 0; l < this->levels.size(); ++l) {
+            this->file.seekp(this->levels[l].RangeOffset);
+            this->file.write(reinterpret_cast<const char*>(this->brickRanges[l].data()),
+                this->brickRanges[l].size() * sizeof(double));
+        }
+        this->file.seekp(0);
+        this->file.write(reinterpret_cast<const char*>(&this->header), sizeof(this->header));
+        this->file.flush();
+        retval = this->file.good();
+    }
+
+    if (retval) {
+        Log::DefaultLog.WriteInfo("Bricked volume cache \"%s\" is complete.", cachePath.c_str());
+    } else {
+        Log::DefaultLog.WriteError("Building bricked volume cache \"%s\" failed.", cachePath.c_str());
+        this->Close();
+    }
+    return retval;
+}
+
+
+/*
+ * megamol::stdplugin::volume::BrickedVolumeCache::buildLevel
+ */
+bool megamol::stdplugin::volume::BrickedVolumeCache::buildLevel(const unsigned int level) {
+    ASSERT(level > 0);
+    const auto& li = this->levels[level];
+    const auto& ci = this->levels[level - 1];
+    const size_t b = this->header.BrickSize;
+    const size_t bytes = this->brickBytes();
+    const size_t components = this->header.Components;
+    const auto format = static_cast<DatRawDataFormat>(this->header.DataFormat);
+
+    std::vector<uint8_t> childData(8 * bytes);
+    const uint8_t* children[8];
+    std::vector<uint8_t> brickData(bytes);
+    std::vector<double> range(2 * components);
+
+    for (uint64_t bz = 0; bz < li.Bricks[2]; ++bz) {
+        for (uint64_t by = 0; by < li.Bricks[1]; ++by) {
+            for (uint64_t bx = 0; bx < li.Bricks[0]; ++bx) {
+                const uint64_t brick[3] = {bx, by, bz};
+
+                /* Page in the children, missing ones are never sampled. */
+                for (int k = 0; k < 8; ++k) {
+                    const uint64_t cx = std::min(2 * bx + (k & 1), ci.Bricks[0] - 1);
+                    const uint64_t cy = std::min(2 * by + ((k >> 1) & 1), ci.Bricks[1] - 1);
+                    const uint64_t cz = std::min(2 * bz + ((k >> 2) & 1), ci.Bricks[2] - 1);
+                    const uint64_t child = (cz * ci.Bricks[1] + cy) * ci.Bricks[0] + cx;
+                    this->file.seekg(ci.DataOffset + child * bytes);
+                    this->file.read(reinterpret_cast<char*>(childData.data() + k * bytes), bytes);
+                    children[k] = childData.data() + k * bytes;
+                }
+                if (!this->file.good()) {
+                    return false;
+                }
+
+                switch (format) {
+                case DR_FORMAT_CHAR:
+                    downsampleBrick<int8_t>(children, b, components, brick, li.Resolution, ci.Resolution,
+                        brickData.data());
+                    break;
+                case DR_FORMAT_UCHAR:
+                    downsampleBrick<uint8_t>(children, b, components, brick, li.Resolution, ci.Resolution,
+                        brickData.data());
+                    break;
+                case DR_FORMAT_SHORT:
+                    downsampleBrick<int16_t>(children, b, components, brick, li.Resolution, ci.Resolution,
+                        brickData.data());
+                    break;
+                case DR_FORMAT_USHORT:
+                    downsampleBrick<uint16_t>(children, b, components, brick, li.Resolution, ci.Resolution,
+                        brickData.data());
+                    break;
+                case DR_FORMAT_INT:
+                    downsampleBrick<int32_t>(children, b, components, brick, li.Resolution, ci.Resolution,
+                        brickData.data());
+                    break;
+                case DR_FORMAT_UINT:
+                    downsampleBrick<uint32_t>(children, b, components, brick, li.Resolution, ci.Resolution,
+                        brickData.data());
+                    break;
+                case DR_FORMAT_LONG:
+                    downsampleBrick<int64_t>(children, b, components, brick, li.Resolution, ci.Resolution,
+                        brickData.data());
+                    break;
+                case DR_FORMAT_ULONG:
+                    downsampleBrick<uint64_t>(children, b, components, brick, li.Resolution, ci.Resolution,
+                        brickData.data());
+                    break;
+                case DR_FORMAT_FLOAT:
+                    downsampleBrick<float>(children, b, components, brick, li.Resolution, ci.Resolution,
+                        brickData.data());
+                    break;
+                case DR_FORMAT_DOUBLE:
+                    downsampleBrick<double>(children, b, components, brick, li.Resolution, ci.Resolution,
+                        brickData.data());
+                    break;
+                default:
+                    return false;
+                }
+
+                for (size_t c = 0; c < components; ++c) {
+                    range[2 * c] = std::numeric_limits<double>::max();
+                    range[2 * c + 1] = std::numeric_limits<double>::lowest();
+                }
+                accumulateRange(format, brickData.data(), b * b * b, components, range.data());
+                this->writeBrick(level, (bz * li.Bricks[1] + by) * li.Bricks[0] + bx, brickData.data(), range.data());
+            }
+        }
+    }
+
+    return this->file.good();
+}
+
+
+/*
+ * megamol::stdplugin::volume::BrickedVolumeCache::buildLevel0
+ */
+bool megamol::stdplugin::volume::BrickedVolumeCache::buildLevel0(const DatRawFileInfo& info, const unsigned int frame) {
+    using vislib::sys::Log;
+
+    const auto& li = this->levels[0];
+    const size_t b = this->header.BrickSize;
+    const size_t components = this->header.Components;
+    const size_t scalarLength = this->header.ScalarLength;
+    const size_t voxelSize = this->VoxelSize();
+    const auto format = static_cast<DatRawDataFormat>(this->header.DataFormat);
+    const size_t sliceBytes = li.Resolution[0] * li.Resolution[1] * voxelSize;
+    const size_t tileBytes = b * b * voxelSize;
+    const bool isSwap = (info.byteOrder == DR_LITTLE_ENDIAN) != isLittleEndian();
+
+    /* Open the raw file and skip to the requested frame. */
+    char* rawFile = info.multiDataFiles
+                        ? ::getMultifileFilename(const_cast<DatRawFileInfo*>(&info), static_cast<int>(frame))
+                        : info.dataFileName;
+    gzFile fd = (rawFile != nullptr) ? ::gzopen(rawFile, "rb") : nullptr;
+    if (info.multiDataFiles) ::free(rawFile);
+    if (fd == nullptr) {
+        Log::DefaultLog.WriteError("Cannot open the raw file of frame %u.", frame);
+        return false;
+    }
+    uint64_t offset = (info.dataOffset > 0) ? static_cast<uint64_t>(info.dataOffset) : 0;
+    if (!info.multiDataFiles) {
+        offset += static_cast<uint64_t>(frame) *
+                  static_cast<uint64_t>(::datRaw_getBufferSize(&info, static_cast<DatRawDataFormat>(info.dataFormat)));
+    }
+    if ((offset > 0) && !seekRaw(fd, offset)) {
+        Log::DefaultLog.WriteError("Cannot seek to offset %llu of frame %u in the raw file.",
+            static_cast<unsigned long long>(offset), frame);
+        ::gzclose(fd);
+        return false;
+    }
+
+    /*
+     * Stream the frame slice by slice and scatter each slice into the tiles
+     * of the brick row it intersects. Only a single slice is held in memory.
+     */
+    std::vector<uint8_t> slice(sliceBytes);
+    std::vector<uint8_t> tile(tileBytes);
+    bool retval = true;
+
+    for (uint64_t z = 0; retval && (z < li.Bricks[2] * b); ++z) {
+        if (z < li.Resolution[2]) {
+            if (::gzread(fd, slice.data(), static_cast<unsigned int>(sliceBytes)) != static_cast<int>(sliceBytes)) {
+                Log::DefaultLog.WriteError("Reading slice %u of frame %u failed.", static_cast<unsigned int>(z), frame);
+                retval = false;
+                break;
+            }
+            if (isSwap) {
+                swapBytes(slice.data(), sliceBytes / scalarLength, scalarLength);
+            }
+            accumulateRange(format, slice.data(), sliceBytes / voxelSize, components, this->ranges.data());
+        }
+        /* Beyond the last slice, the last slice is replicated as padding. */
+
+        const uint64_t bz = z / b;
+        for (uint64_t by = 0; by < li.Bricks[1]; ++by) {
+            for (uint64_t bx = 0; bx < li.Bricks[0]; ++bx) {
+                for (size_t y = 0; y < b; ++y) {
+                    const uint64_t sy = std::min<uint64_t>(by * b + y, li.Resolution[1] - 1);
+                    for (size_t x = 0; x < b; ++x) {
+                        const uint64_t sx = std::min<uint64_t>(bx * b + x, li.Resolution[0] - 1);
+                        ::memcpy(tile.data() + (y * b + x) * voxelSize,
+                            slice.data() + (sy * li.Resolution[0] + sx) * voxelSize, voxelSize);
+                    }
+                }
+
+                const size_t brick = (bz * li.Bricks[1] + by) * li.Bricks[0] + bx;
+                auto range = this->brickRanges[0].data() + 2 * brick * components;
+                accumulateRange(format, tile.data(), b * b, components, range);
+                this->file.seekp(li.DataOffset + brick * this->brickBytes() + (z % b) * tileBytes);
+                this->file.write(reinterpret_cast<const char*>(tile.data()), tileBytes);
+            }
+        }
+        retval = retval && this->file.good();
+    }
+
+    ::gzclose(fd);
+    return retval;
+}
+
+
+/*
+ * megamol::stdplugin::volume::BrickedVolumeCache::getBrick
+ */
+const uint8_t* megamol::stdplugin::volume::BrickedVolumeCache::getBrick(const unsigned int level, const size_t brick) {
+    const BrickKey key(level, brick);
+    auto it = this->lruIndex.find(key);
+    if (it != this->lruIndex.end()) {
+        this->lru.splice(this->lru.begin(), this->lru, it->second);
+        return this->lru.front().Data.data();
+    }
+
+    /* Evict the least recently used bricks, but always keep one. */
+    const size_t bytes = this->brickBytes();
+    const size_t maxBricks = std::max<size_t>(1, this->memoryBudget / bytes);
+    std::vector<uint8_t> data;
+    while (this->lru.size() >= maxBricks) {
+        this->lruIndex.erase(this->lru.back().Key);
+        data.swap(this->lru.back().Data);
+        this->lru.pop_back();
+    }
+
+    data.resize(bytes);
+    this->file.seekg(this->levels[level].DataOffset + brick * bytes);
+    this->file.read(reinterpret_cast<char*>(data.data()), bytes);
+    if (!this->file.good()) {
+        vislib::sys::Log::DefaultLog.WriteError(
+            "Reading brick %u of level %u failed.", static_cast<unsigned int>(brick), level);
+        this->file.clear();
+        return nullptr;
+    }
+
+    this->lru.push_front(CachedBrick());
+    this->lru.front().Key = key;
+    this->lru.front().Data.swap(data);
+    this->lruIndex[key] = this->lru.begin();
+    return this->lru.front().Data.data();
+}
+
+
+/*
+ * megamol::stdplugin::volume::BrickedVolumeCache::layoutLevels
+ */
+void megamol::stdplugin::volume::BrickedVolumeCache::layoutLevels(void) {
+    const uint64_t b = this->header.BrickSize;
+    this->levels.resize(this->header.Levels);
+
+    /* Header, levels, global ranges, brick ranges of all levels, bricks. */
+    uint64_t offset = sizeof(FileHeader) + this->levels.size() * sizeof(LevelInfo);
+    offset += 2 * this->header.Components * sizeof(double);
+
+    for (size_t l = 0; l < this->levels.size(); ++l) {
+        auto& li = this->levels[l];
+        for (int d = 0; d < 3; ++d) {
+            li.Resolution[d] = (l == 0) ? this->header.Resolution[d] : (this->levels[l - 1].Resolution[d] + 1) / 2;
+            li.Bricks[d] = (li.Resolution[d] + b - 1) / b;
+        }
+        li.RangeOffset = offset;
+        offset += 2 * li.Bricks[0] * li.Bricks[1] * li.Bricks[2] * this->header.Components * sizeof(double);
+    }
+
+    for (auto& li : this->levels) {
+        li.DataOffset = offset;
+        offset += li.Bricks[0] * li.Bricks[1] * li.Bricks[2] * this->brickBytes();
+    }
+}
+
+
+/*
+ * megamol::stdplugin::volume::BrickedVolumeCache::writeBrick
+ */
+void megamol::stdplugin::volume::BrickedVolumeCache::writeBrick(
+    const unsigned int level, const size_t brick, const uint8_t* data, const double* range) {
+    const size_t bytes = this->brickBytes();
+    this->file.seekp(this->levels[level].DataOffset + brick * bytes);
+    this->file.write(reinterpret_cast<const char*>(data), bytes);
+    const size_t components = this->header.Components;
+    ::memcpy(this->brickRanges[level].data() + 2 * brick * components, range, 2 * components * sizeof(double));
+}
@@ -0,0 +1,306 @@
+/*
+ * BrickedVolumeCache.h
+ *
+ * Copyright (C) 2020 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MEGAMOL_MMSTD_VOLUME_BRICKEDVOLUMECACHE_H_INCLUDED
+#define MEGAMOL_MMSTD_VOLUME_BRICKEDVOLUMECACHE_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#    pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include <cstdint>
+#include <fstream>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "datRaw.h"
+
+namespace megamol {
+namespace stdplugin {
+namespace volume {
+
+/**
+ * Disk-backed cache of a single frame of a dat/raw volume, which is split
+ * into cubic bricks and stored together with a mip pyramid of the frame.
+ *
+ * The cache file is built once by streaming slabs of the raw file, ie the
+ * frame never needs to fit into memory, and is reused as long as the raw
+ * file does not change. Afterwards, arbitrary regions of any level of the
+ * pyramid can be read while only the bricks touched are paged in. Recently
+ * used bricks are kept in memory up to a configurable budget.
+ *
+ * The cache stores the scalars in the native format of the raw file.
+ */
+class BrickedVolumeCache {
+
+public:
+    /**
+     * Answer whether the cache can handle the given data format.
+     *
+     * @param format The data format of the raw file.
+     *
+     * @return true if bricks and pyramid can be built for the format.
+     */
+    static bool IsSupported(const DatRawDataFormat format);
+
+    /**
+     * Answer the number of levels of the pyramid of a grid, ie how often the
+     * resolution can be halved until a single brick covers the grid.
+     *
+     * @param resolution The resolution of the three dimensions.
+     * @param brickSize  The edge length of a brick in voxels.
+     *
+     * @return The number of levels including the full resolution.
+     */
+    static unsigned int CountLevels(const size_t* resolution, const size_t brickSize);
+
+    /**
+     * Initialises a new instance.
+     */
+    BrickedVolumeCache(void);
+
+    /**
+     * Finalises an instance.
+     */
+    ~BrickedVolumeCache(void);
+
+    /**
+     * Answer the edge length of a brick in voxels.
+     *
+     * @return The edge length of a brick.
+     */
+    inline size_t BrickSize(void) const { return this->header.BrickSize; }
+
+    /**
+     * Closes the cache file and drops all bricks held in memory.
+     */
+    void Close(void);
+
+    /**
+     * Gets the edge lengths of the brick grid of the given level.
+     *
+     * @param level The level of the pyramid.
+     *
+     * @return Pointer to the number of bricks in x, y and z.
+     */
+    inline const uint64_t* GetBrickCount(const unsigned int level) const { return this->levels[level].Bricks; }
+
+    /**
+     * Gets the value range of a brick.
+     *
+     * @param level     The level of the pyramid.
+     * @param brick     The linear index of the brick in the brick grid.
+     * @param component The component to get the range for.
+     * @param outMin    Receives the minimum value.
+     * @param outMax    Receives the maximum value.
+     */
+    void GetBrickRange(const unsigned int level, const size_t brick, const size_t component, double& outMin,
+        double& outMax) const;
+
+    /**
+     * Gets the minimum value of a component over the whole frame.
+     *
+     * @param component The component.
+     *
+     * @return The minimum value.
+     */
+    inline double GetMin(const size_t component) const { return this->ranges[2 * component]; }
+
+    /**
+     * Gets the maximum value of a component over the whole frame.
+     *
+     * @param component The component.
+     *
+     * @return The maximum value.
+     */
+    inline double GetMax(const size_t component) const { return this->ranges[2 * component + 1]; }
+
+    /**
+     * Gets the resolution of the given level of the pyramid.
+     *
+     * @param level The level of the pyramid.
+     *
+     * @return Pointer to the resolution in x, y and z.
+     */
+    inline const uint64_t* GetResolution(const unsigned int level) const { return this->levels[level].Resolution; }
+
+    /**
+     * Answer whether a cache file is open.
+     *
+     * @return true if the cache is ready for reading.
+     */
+    inline bool IsOpen(void) const { return this->file.is_open(); }
+
+    /**
+     * Answer the number of levels of the pyramid, including the full
+     * resolution.
+     *
+     * @return The number of levels.
+     */
+    inline unsigned int Levels(void) const { return static_cast<unsigned int>(this->levels.size()); }
+
+    /**
+     * Opens the cache file for the given frame of the data set described by
+     * 'info'. If the file does not exist or is outdated, it is (re-)built
+     * from the raw file.
+     *
+     * @param info      The header of the dat file.
+     * @param frame     The frame to be cached.
+     * @param cachePath The path of the cache file.
+     * @param brickSize The edge length of a brick in voxels.
+     *
+     * @return true on success, false otherwise.
+     */
+    bool Open(const DatRawFileInfo& info, const unsigned int frame, const std::string& cachePath,
+        const size_t brickSize);
+
+    /**
+     * Copies the voxels [min, max[ of the given level into the dense,
+     * x-fastest buffer 'dst', which must be large enough to hold all of
+     * them. All bricks touched are paged in if necessary.
+     *
+     * @param level The level of the pyramid.
+     * @param min   The first voxel in the grid of 'level'.
+     * @param max   The end (exclusive) of the region in the grid of 'level'.
+     * @param dst   The destination buffer.
+     *
+     * @return true on success, false otherwise.
+     */
+    bool Read(const unsigned int level, const size_t* min, const size_t* max, void* dst);
+
+    /**
+     * Sets the amount of memory used for keeping bricks in memory.
+     *
+     * @param bytes The budget in bytes.
+     */
+    void SetMemoryBudget(const size_t bytes);
+
+    /**
+     * Answer the size of a voxel in bytes.
+     *
+     * @return The size of a voxel.
+     */
+    inline size_t VoxelSize(void) const { return this->header.ScalarLength * this->header.Components; }
+
+private:
+    /** The header at the begin of each cache file. */
+    struct FileHeader {
+        char Magic[8];
+        uint32_t Version;
+        uint32_t BrickSize;
+        uint64_t Resolution[3];
+        uint32_t Components;
+        int32_t DataFormat;
+        uint32_t ScalarLength;
+        uint32_t Levels;
+        uint32_t Frame;
+        uint32_t Reserved;
+        uint64_t SourceSize;
+        int64_t SourceTime;
+    };
+
+    /** The description of a level of the pyramid in the cache file. */
+    struct LevelInfo {
+        uint64_t Resolution[3];
+        uint64_t Bricks[3];
+        uint64_t RangeOffset;
+        uint64_t DataOffset;
+    };
+
+    /** Identifies a brick in the in-memory cache. */
+    typedef std::pair<unsigned int, size_t> BrickKey;
+
+    /** Hash for BrickKey. */
+    struct BrickKeyHash {
+        inline size_t operator()(const BrickKey& key) const {
+            return std::hash<size_t>()(key.second) ^ (static_cast<size_t>(key.first) << 58);
+        }
+    };
+
+    /** A brick held in memory. */
+    struct CachedBrick {
+        BrickKey Key;
+        std::vector<uint8_t> Data;
+    };
+
+    /** The version of the cache file format. */
+    static const uint32_t VERSION;
+
+    /**
+     * Builds the cache file from the raw file.
+     */
+    bool build(const DatRawFileInfo& info, const unsigned int frame, const std::string& cachePath,
+        const uint64_t sourceSize, const int64_t sourceTime);
+
+    /**
+     * Builds the bricks of level 'level' > 0 from the bricks of the level
+     * before.
+     */
+    bool buildLevel(const unsigned int level);
+
+    /**
+     * Builds the bricks of the full resolution by streaming slabs of the
+     * raw file.
+     */
+    bool buildLevel0(const DatRawFileInfo& info, const unsigned int frame);
+
+    /**
+     * Answer the number of bytes of a brick.
+     */
+    inline size_t brickBytes(void) const {
+        const size_t b = this->header.BrickSize;
+        return b * b * b * this->VoxelSize();
+    }
+
+    /**
+     * Gets the brick 'brick' of level 'level', either from the memory cache
+     * or from the cache file.
+     */
+    const uint8_t* getBrick(const unsigned int level, const size_t brick);
+
+    /**
+     * Computes the layout of the levels, ie resolutions and file offsets,
+     * from 'header'.
+     */
+    void layoutLevels(void);
+
+    /**
+     * Writes a brick and remembers its value ranges while building.
+     */
+    void writeBrick(const unsigned int level, const size_t brick, const uint8_t* data, const double* range);
+
+    /** The cache file. */
+    std::fstream file;
+
+    /** The header of the open cache file. */
+    FileHeader header;
+
+    /** The layout of the levels. */
+    std::vector<LevelInfo> levels;
+
+    /** The bricks held in memory, most recently used first. */
+    std::list<CachedBrick> lru;
+
+    /** Finds the bricks in 'lru'. */
+    std::unordered_map<BrickKey, std::list<CachedBrick>::iterator, BrickKeyHash> lruIndex;
+
+    /** The maximum number of bytes held in 'lru'. */
+    size_t memoryBudget;
+
+    /** The minimum and maximum of each component over the frame. */
+    std::vector<double> ranges;
+
+    /** The minimum and maximum of each component of each brick of each level. */
+    std::vector<std::vector<double>> brickRanges;
+};
+
+} /* end namespace volume */
+} /* end namespace stdplugin */
+} /* end namespace megamol */
+
+#endif /* MEGAMOL_MMSTD_VOLUME_BRICKEDVOLUMECACHE_H_INCLUDED */
@@ -38,6 +38,7 @@
  */
 megamol::stdplugin::volume::VolumetricDataSource::VolumetricDataSource(void)
     : Base()
+    , brickedFrame(static_cast<unsigned int>(-1))
     , dataHash(-234895)
     , fileInfo(nullptr)
     , loaderThread(VolumetricDataSource::loadAsync)
@@ -45,6 +46,10 @@ megamol::stdplugin::volume::VolumetricDataSource::VolumetricDataSource(void)
     , paramAsyncWake("AsyncWake", "The time in milliseconds after that the loader wakes itself.")
     , paramBuffers("Buffers", "The number of buffers for loading frames asynchronously.")
     , paramFileName("FileName", "The path to the dat file to be loaded.")
+    , paramBricked("Bricked", "Serve the data from a bricked cache with resolution pyramid.")
+    , paramBrickCacheDir("BrickCacheDirectory", "The directory of the brick caches (empty for next to the dat file).")
+    , paramBrickMemory("BrickMemory", "The memory in MB used for holding bricks in memory.")
+    , paramBrickSize("BrickSize", "The edge length of a brick in voxels.")
     , paramOutputDataSize("OutputDataSize", "Forces the scalar type to the specified size.")
     , paramOutputDataType("OutputDataType", "Enforces the type of a scalar during loading.")
     , paramLoadAsync("LoadAsync", "Start asynchronous loading of frames.")
@@ -67,6 +72,20 @@ megamol::stdplugin::volume::VolumetricDataSource::VolumetricDataSource(void)
     this->paramFileName.SetUpdateCallback(&VolumetricDataSource::onFileNameChanged);
     this->MakeSlotAvailable(&this->paramFileName);
 
+    this->paramBricked.SetParameter(new core::param::BoolParam(false));
+    this->MakeSlotAvailable(&this->paramBricked);
+
+    this->paramBrickCacheDir.SetParameter(new core::param::FilePathParam(_T("")));
+    this->MakeSlotAvailable(&this->paramBrickCacheDir);
+
+    this->paramBrickMemory.SetParameter(new core::param::IntParam(512, 1));
+    this->MakeSlotAvailable(&this->paramBrickMemory);
+
+    this->paramBrickSize.SetParameter(new core::param::IntParam(64, 8, 1024));
+    this->MakeSlotAvailable(&this->paramBrickSize);
+    ::ZeroMemory(this->brickedRegion, sizeof(this->brickedRegion));
+    ::ZeroMemory(this->brickedSliceDists, sizeof(this->brickedSliceDists));
+
     enumParam = new core::param::EnumParam(-1);
     enumParam->SetTypePair(-1, _T("Auto"));
     enumParam->SetTypePair(1, _T("1 Byte/Scalar"));
@@ -114,6 +133,30 @@ megamol::stdplugin::volume::VolumetricDataSource::~VolumetricDataSource(void) {
 }
 
 
+/*
+ * megamol::stdplugin::volume::VolumetricDataSource::brickCachePath
+ */
+std::string megamol::stdplugin::volume::VolumetricDataSource::brickCachePath(const unsigned int frame) const {
+    using core::param::FilePathParam;
+    std::string datFile(vislib::StringA(this->paramFileName.Param<FilePathParam>()->Value()).PeekBuffer());
+    std::string dir(vislib::StringA(this->paramBrickCacheDir.Param<FilePathParam>()->Value()).PeekBuffer());
+
+    if (!dir.empty()) {
+        const auto sep = datFile.find_last_of("/\\");
+        if (sep != std::string::npos) {
+            datFile = datFile.substr(sep + 1);
+        }
+        if ((dir.back() != '/') && (dir.back() != '\\')) {
+            dir += '/';
+        }
+        datFile = dir + datFile;
+    }
+
+    return datFile + ".f" + std::to_string(frame) + ".b" +
+           std::to_string(this->paramBrickSize.Param<core::param::IntParam>()->Value()) + ".mmbvc";
+}
+
+
 /*
  * megamol::stdplugin::volume::VolumetricDataSource::calcFrameSize
  */
@@ -216,6 +259,10 @@ bool megamol::stdplugin::volume::VolumetricDataSource::onFileNameChanged(core::p
     using core::misc::VolumetricDataCall;
     using vislib::sys::Log;
 
+    /* Drop the brick cache of the previous data set. */
+    this->bricks.Close();
+    this->brickedFrame = static_cast<unsigned int>(-1);
+
     /* Allocate header or prepare it for re-use. */
     if (this->fileInfo == nullptr) {
         this->fileInfo = new DatRawFileInfo();
@@ -430,6 +477,11 @@ bool megamol::stdplugin::volume::VolumetricDataSource::onGetData(core::Call& cal
 
     VolumetricDataCall& c = dynamic_cast<VolumetricDataCall&>(call);
 
+    if (this->paramBricked.Param<BoolParam>()->Value()) {
+        return this->onGetBrickedData(c);
+    }
+    c.SetDataRegion(0, nullptr);
+
     if (c.DataHash() != this->dataHash) {
         try {
             /* Evaluate parameter changes. */
@@ -723,6 +775,121 @@ bool megamol::stdplugin::volume::VolumetricDataSource::onGetData(core::Call& cal
 }
 
 
+/*
+ * megamol::stdplugin::volume::VolumetricDataSource::onGetBrickedData
+ */
+bool megamol::stdplugin::volume::VolumetricDataSource::onGetBrickedData(core::misc::VolumetricDataCall& c) {
+    using core::misc::VolumetricDataCall;
+    using core::param::IntParam;
+    using vislib::sys::Log;
+
+    try {
+        /* Sanity checks. */
+        if (this->fileInfo == nullptr) {
+            throw vislib::IllegalStateException(_T("A valid dat file must be ")
+                                                _T("loaded before the data can be read."),
+                __FILE__, __LINE__);
+        }
+        if ((this->metadata.GridType != VolumetricDataCall::GridType::CARTESIAN) &&
+            !((this->metadata.GridType == VolumetricDataCall::GridType::RECTILINEAR) && this->metadata.IsUniform[0] &&
+                this->metadata.IsUniform[1] && this->metadata.IsUniform[2])) {
+            throw vislib::IllegalStateException(_T("Only uniform grids can be bricked."), __FILE__, __LINE__);
+        }
+        if (this->getOutputDataFormat() != this->fileInfo->dataFormat) {
+            Log::DefaultLog.WriteWarn(_T("The output data format is ignored for bricked data."));
+        }
+        /* The call may still hold the buffer we returned for the previous request. */
+        if ((c.GetData() != nullptr) && (c.GetData() != this->brickedData.data())) {
+            throw vislib::IllegalStateException(_T("A user-defined destination ")
+                                                _T("buffer cannot be used for bricked data."),
+                __FILE__, __LINE__);
+        }
+
+        /* Open or build the cache of the requested frame. */
+        const unsigned int frame =
+            c.FrameID() % static_cast<unsigned int>(vislib::math::Max<size_t>(1, this->metadata.NumberOfFrames));
+        const size_t brickSize = this->paramBrickSize.Param<IntParam>()->Value();
+        if (!this->bricks.IsOpen() || (this->brickedFrame != frame) || (this->bricks.BrickSize() != brickSize)) {
+            this->brickedFrame = static_cast<unsigned int>(-1);
+            if (!this->bricks.Open(*this->fileInfo, frame, this->brickCachePath(frame), brickSize)) {
+                return false;
+            }
+            this->brickedFrame = frame;
+            ::ZeroMemory(this->brickedRegion, sizeof(this->brickedRegion));
+        }
+        this->bricks.SetMemoryBudget(static_cast<size_t>(this->paramBrickMemory.Param<IntParam>()->Value()) << 20);
+
+        /* Translate the request into the grid of the requested level. */
+        size_t region[7];
+        auto& level = region[0];
+        auto min = region + 1;
+        auto max = region + 4;
+        level = vislib::math::Min<size_t>(c.GetRequestedLevel(), this->bricks.Levels() - 1);
+        const auto resolution = this->bricks.GetResolution(static_cast<unsigned int>(level));
+        for (int d = 0; d < 3; ++d) {
+            if (c.HasRequestedRegion()) {
+                min[d] = c.GetRequestedRegionMin()[d] >> level;
+                max[d] = (c.GetRequestedRegionMax()[d] + (static_cast<size_t>(1) << level) - 1) >> level;
+                min[d] = vislib::math::Min<size_t>(min[d], resolution[d] - 1);
+                max[d] = vislib::math::Clamp<size_t>(max[d], min[d] + 1, resolution[d]);
+            } else {
+                min[d] = 0;
+                max[d] = resolution[d];
+            }
+        }
+
+        /* Page in the bricks unless the region was served before. */
+        if (::memcmp(region, this->brickedRegion, sizeof(region)) != 0) {
+            this->brickedData.resize((max[0] - min[0]) * (max[1] - min[1]) * (max[2] - min[2]) *
+                                     this->bricks.VoxelSize());
+            if (!this->bricks.Read(static_cast<unsigned int>(level), min, max, this->brickedData.data())) {
+                ::ZeroMemory(this->brickedRegion, sizeof(this->brickedRegion));
+                throw vislib::IllegalStateException(_T("Reading the bricks ")
+                                                    _T("of the requested region failed."),
+                    __FILE__, __LINE__);
+            }
+            ::memcpy(this->brickedRegion, region, sizeof(region));
+            ++this->dataHash;
+        }
+
+        /* Describe the region in the metadata. */
+        this->mins.resize(this->metadata.Components);
+        this->maxes.resize(this->metadata.Components);
+        for (size_t i = 0; i < this->metadata.Components; ++i) {
+            this->mins[i] = this->bricks.GetMin(i);
+            this->maxes[i] = this->bricks.GetMax(i);
+        }
+        this->metadata.MinValues = this->mins.data();
+        this->metadata.MaxValues = this->maxes.data();
+
+        this->brickedMetadata = this->metadata;
+        for (int d = 0; d < 3; ++d) {
+            this->brickedSliceDists[d] = this->metadata.SliceDists[d][0] * static_cast<float>(1 << level);
+            this->brickedMetadata.SliceDists[d] = this->brickedSliceDists + d;
+            this->brickedMetadata.IsUniform[d] = true;
+            this->brickedMetadata.Resolution[d] = max[d] - min[d];
+            this->brickedMetadata.Origin[d] = this->metadata.Origin[d] + min[d] * this->brickedSliceDists[d];
+            this->brickedMetadata.Extents[d] = (max[d] - min[d] - 1) * this->brickedSliceDists[d];
+        }
+
+        c.SetDataHash(this->dataHash);
+        c.SetMetadata(&this->brickedMetadata);
+        c.SetData(this->brickedData.data(), 1);
+        c.SetDataRegion(static_cast<unsigned int>(level), min);
+        c.SetAvailableLevels(this->bricks.Levels());
+        return true;
+
+    } catch (vislib::Exception& e) {
+        Log::DefaultLog.WriteError(1, e.GetMsg());
+        return false;
+    } catch (...) {
+        Log::DefaultLog.WriteError(1, _T("Unexpected exception in callback ")
+                                      _T("onGetBrickedData (please check the call)."));
+        return false;
+    }
+}
+
+
 /*
  * megamol::stdplugin::volume::VolumetricDataSource::onGetExtents
  */
@@ -789,6 +956,12 @@ bool megamol::stdplugin::volume::VolumetricDataSource::onGetMetadata(core::Call&
          */
 
         c.SetMetadata(&this->metadata);
+        if (this->paramBricked.Param<core::param::BoolParam>()->Value()) {
+            c.SetAvailableLevels(BrickedVolumeCache::CountLevels(
+                this->metadata.Resolution, this->paramBrickSize.Param<core::param::IntParam>()->Value()));
+        } else {
+            c.SetAvailableLevels(1);
+        }
         return true;
     } catch (vislib::Exception e) {
         Log::DefaultLog.WriteError(1, e.GetMsg());
@@ -1019,6 +1192,9 @@ void megamol::stdplugin::volume::VolumetricDataSource::release(void) {
                                       _T("stopping volume loader thread during release of data source."));
     }
 
+    this->bricks.Close();
+    this->brickedFrame = static_cast<unsigned int>(-1);
+
     if (this->fileInfo != nullptr) {
         Log::DefaultLog.WriteInfo(10, _T("Releasing dat file..."));
         ::datRaw_close(this->fileInfo);
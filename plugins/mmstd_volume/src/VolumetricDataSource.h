@@ -13,10 +13,13 @@
 
 #include <atomic>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "datRaw.h"
 
+#include "BrickedVolumeCache.h"
+
 #include "mmcore/misc/VolumetricDataCall.h"
 
 #include "mmcore/param/ParamSlot.h"
@@ -73,6 +76,15 @@ protected:
     /** Superclass typedef. */
     typedef core::Module Base;
 
+    /**
+     * Computes the path of the bricked cache file for the given frame.
+     *
+     * @param frame The frame to be cached.
+     *
+     * @return The path of the cache file.
+     */
+    std::string brickCachePath(const unsigned int frame) const;
+
     /**
      * Computes the size of a single frame.
      *
@@ -114,6 +126,17 @@ protected:
      */
     bool onGetData(core::Call& call);
 
+    /**
+     * Serves a data request from the bricked cache, which is built on first
+     * access of a frame. Only the bricks intersecting the requested region
+     * of interest at the requested level of the pyramid are paged in.
+     *
+     * @param call The calling call.
+     *
+     * @return 'true' on success, 'false' on failure.
+     */
+    bool onGetBrickedData(core::misc::VolumetricDataCall& call);
+
     /**
      * Gets the data extents.
      *
@@ -335,6 +358,24 @@ private:
     /** The buffers that volume data can be loaded to. */
     vislib::PtrArray<BufferSlot> buffers;
 
+    /** The bricked cache of the frame 'brickedFrame'. */
+    BrickedVolumeCache bricks;
+
+    /** The frame in 'bricks' or -1 if none. */
+    unsigned int brickedFrame;
+
+    /** The level and region [min, max[ served last from 'bricks'. */
+    size_t brickedRegion[7];
+
+    /** The region of interest served from the bricked cache. */
+    std::vector<uint8_t> brickedData;
+
+    /** The metadata describing 'brickedData'. */
+    core::misc::VolumetricDataCall::Metadata brickedMetadata;
+
+    /** The slice distances of 'brickedData'. */
+    float brickedSliceDists[3];
+
     /** Hash for the data set. */
     unsigned int dataHash;
 
@@ -378,6 +419,18 @@ private:
     /** The path to the dat file. */
     core::param::ParamSlot paramFileName;
 
+    /** Enables serving the data from a bricked cache with mip pyramid. */
+    core::param::ParamSlot paramBricked;
+
+    /** The directory of the bricked cache files. */
+    core::param::ParamSlot paramBrickCacheDir;
+
+    /** The memory budget for bricks in MB. */
+    core::param::ParamSlot paramBrickMemory;
+
+    /** The edge length of the bricks in voxels. */
+    core::param::ParamSlot paramBrickSize;
+
     /**
      * The number of bytes the data set should be converted to during
      * loading.
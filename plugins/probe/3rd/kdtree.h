@@ -486,6 +486,19 @@ template <typename shvecPointT> struct PointCloudAdaptor {
       radiusSearch(const PointT &point, double radius, std::vector<uint32_t> &k_indices,
                     std::vector<float> &k_sqr_distances, unsigned int max_nn = 0) const override;
 
+      /** \brief Search for all the neighbors of the query point in a given radius, reusing the caller's buffer.
+        *
+        * Unlike the overload above this does not allocate any temporaries and does not sort the result, which makes
+        * it suitable for many concurrent queries from worker threads that each own a buffer.
+        *
+        * \param[in] point a given \a valid (i.e., finite) query point
+        * \param[in] radius the search radius, compared against squared distances exactly like the overload above
+        * \param[out] matches the resultant (index, squared distance) pairs in no particular order
+        * \return number of neighbors found in radius
+        */
+      int
+      radiusSearch(const PointT &point, double radius, std::vector<std::pair<size_t, double>> &matches) const;
+
     private:
       /** \brief Internal cleanup method. */
       void 
@@ -716,6 +729,17 @@ int pcl::KdTreeFLANN<PointT>::radiusSearch(const PointT& point, double radius, s
     return (neighbors_in_radius);
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+int pcl::KdTreeFLANN<PointT>::radiusSearch(
+    const PointT& point, double radius, std::vector<std::pair<size_t, double>>& matches) const {
+    assert(point_representation_->isValid(point) && "Invalid (NaN, Inf) point coordinates given to radiusSearch!");
+
+    // the result set clears 'matches', but keeps its capacity
+    return static_cast<int>(
+        flann_index_->radiusSearch(point.data, radius, matches, ::nanoflann::SearchParams(32, epsilon_, false)));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void pcl::KdTreeFLANN<PointT>::cleanup() {
     // Data array cleanup
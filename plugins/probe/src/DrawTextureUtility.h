@@ -43,15 +43,15 @@ public:
 
     inline GraphType getGraphType() const { return this->_graph_type; }
 
-    template <typename T> uint8_t* draw(std::vector<T>& data, T min, T max);
+    template <typename Samples, typename T> uint8_t* draw(Samples const& data, T min, T max);
 
-    template <typename T> uint8_t* draw(std::vector<T>& data, std::array<float,3> probe_direction);
+    template <typename Samples> uint8_t* draw(Samples const& data, std::array<float, 3> probe_direction);
 
 private:
-    template <typename T> void drawPlot(std::vector<T>& data, T min, T max);
-    template <typename T> void drawStar(std::vector<T>& data, T min, T max);
-    template <typename T> void drawLinear(std::vector<T>& data, T min, T max);
-    template <typename T> void drawRadarGlyph(std::vector<T>& data, std::array<float, 3> probe_direction);
+    template <typename Samples, typename T> void drawPlot(Samples const& data, T min, T max);
+    template <typename Samples, typename T> void drawStar(Samples const& data, T min, T max);
+    template <typename Samples, typename T> void drawLinear(Samples const& data, T min, T max);
+    template <typename Samples> void drawRadarGlyph(Samples const& data, std::array<float, 3> probe_direction);
 
     uint32_t _pixel_width = 0;
     uint32_t _pixel_height = 0;
@@ -64,7 +64,7 @@ private:
 };
 
 
-template <typename T> uint8_t* DrawTextureUtility::draw(std::vector<T>& data, T min, T max) {
+template <typename Samples, typename T> uint8_t* DrawTextureUtility::draw(Samples const& data, T min, T max) {
     _img = BLImage(this->_pixel_width, this->_pixel_height, BL_FORMAT_PRGB32);
     _ctx = BLContext(_img);
 
@@ -97,8 +97,8 @@ template <typename T> uint8_t* DrawTextureUtility::draw(std::vector<T>& data, T
     return this->_pixel_data;
 }
 
-template <typename T>
-inline uint8_t* DrawTextureUtility::draw(std::vector<T>& data, std::array<float, 3> probe_direction) {
+template <typename Samples>
+inline uint8_t* DrawTextureUtility::draw(Samples const& data, std::array<float, 3> probe_direction) {
 
     _img = BLImage(this->_pixel_width, this->_pixel_height, BL_FORMAT_PRGB32);
     _ctx = BLContext(_img);
@@ -129,7 +129,7 @@ inline uint8_t* DrawTextureUtility::draw(std::vector<T>& data, std::array<float,
     return NULL;
 }
 
-template <typename T> void DrawTextureUtility::drawPlot(std::vector<T>& data, T min, T max) {
+template <typename Samples, typename T> void DrawTextureUtility::drawPlot(Samples const& data, T min, T max) {
 
     uint32_t width_halo = this->_pixel_width * 0.1f;
     uint32_t height_halo = this->_pixel_height * 0.1f;
@@ -168,7 +168,7 @@ template <typename T> void DrawTextureUtility::drawPlot(std::vector<T>& data, T
     _ctx.strokePath(path);
 }
 
-template <typename T> void DrawTextureUtility::drawStar(std::vector<T>& data, T min, T max) {
+template <typename Samples, typename T> void DrawTextureUtility::drawStar(Samples const& data, T min, T max) {
 
     uint32_t width_halo = this->_pixel_width * 0.1f;
     uint32_t height_halo = this->_pixel_height * 0.1f;
@@ -250,7 +250,7 @@ template <typename T> void DrawTextureUtility::drawStar(std::vector<T>& data, T
 
 }
 
-template <typename T> void DrawTextureUtility::drawLinear(std::vector<T>& data, T min, T max) {
+template <typename Samples, typename T> void DrawTextureUtility::drawLinear(Samples const& data, T min, T max) {
     
     uint32_t width_halo = this->_pixel_width * 0.2f;
     uint32_t height_halo = this->_pixel_height * 0.1f;
@@ -308,8 +308,8 @@ template <typename T> void DrawTextureUtility::drawLinear(std::vector<T>& data,
 
 }
 
-template <typename T>
-inline void DrawTextureUtility::drawRadarGlyph(std::vector<T>& data, std::array<float, 3> probe_direction) {
+template <typename Samples>
+inline void DrawTextureUtility::drawRadarGlyph(Samples const& data, std::array<float, 3> probe_direction) {
 
     uint32_t width_halo = this->_pixel_width * 0.1f;
     uint32_t height_halo = this->_pixel_height * 0.1f;
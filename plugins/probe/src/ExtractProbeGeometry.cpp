@@ -52,20 +52,23 @@ std::shared_ptr<megamol::mesh::MeshDataAccessCollection> megamol::probe::Extract
     _line_attribs.resize(probe_count);
     _vertex_data.resize(2*probe_count);
 
+    auto const& positions = this->_probes->getPositions();
+    auto const& directions = this->_probes->getDirections();
+    auto const& begins = this->_probes->getBegins();
+    auto const& ends = this->_probes->getEnds();
+
 //#pragma omp parallel for
     for (auto i = 0; i < probe_count; i++) {
-        auto probe = this->_probes->getProbe<FloatProbe>(i);
-
         std::array<float,4> vert1, vert2;
 
-        vert1[0] = probe.m_position[0] + probe.m_direction[0] * probe.m_begin;
-        vert1[1] = probe.m_position[1] + probe.m_direction[1] * probe.m_begin;
-        vert1[2] = probe.m_position[2] + probe.m_direction[2] * probe.m_begin;
+        vert1[0] = positions[i][0] + directions[i][0] * begins[i];
+        vert1[1] = positions[i][1] + directions[i][1] * begins[i];
+        vert1[2] = positions[i][2] + directions[i][2] * begins[i];
         vert1[3] = 1.0f;
 
-        vert2[0] = probe.m_position[0] + probe.m_direction[0] * probe.m_end;
-        vert2[1] = probe.m_position[1] + probe.m_direction[1] * probe.m_end;
-        vert2[2] = probe.m_position[2] + probe.m_direction[2] * probe.m_end;
+        vert2[0] = positions[i][0] + directions[i][0] * ends[i];
+        vert2[1] = positions[i][1] + directions[i][1] * ends[i];
+        vert2[2] = positions[i][2] + directions[i][2] * ends[i];
         vert2[3] = 1.0f;
 
         _vertex_data[2 * i + 0] = vert1;
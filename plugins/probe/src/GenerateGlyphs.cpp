@@ -38,44 +38,42 @@ GenerateGlyphs::GenerateGlyphs()
 GenerateGlyphs::~GenerateGlyphs() { this->Release(); }
 
 
-bool GenerateGlyphs::doScalarGlyphGeneration(FloatProbe& probe) {
+bool GenerateGlyphs::doScalarGlyphGeneration(ProbeCollection::ProbeView const& probe) {
 
-    // get probe
-    // auto probe = this->_probe_data->getProbe<FloatProbe>(i);
     // read samples of probe
-    auto samples = probe.getSamplingResult();
+    auto const samples = probe.getFloatSamples();
 
-    if (samples->samples.empty()) {
+    if (samples.empty()) {
         vislib::sys::Log::DefaultLog.WriteError("[GenerateGlyphs] Probes have not been sampled.");
         return false;
     }
 
     bool skip = false;
-    if (approxEq(samples->min_value, samples->max_value)) {
+    if (approxEq(probe.getMinValue(), probe.getMaxValue())) {
         // if ( i <= 0.5* this->_probe_data->getProbeCount()) {
         skip = true;
     }
 
     // calc vertices
-    auto dir = probe.m_direction;
+    auto dir = probe.getDirection();
     auto smallest_normal_index = std::distance(dir.begin(), std::min_element(dir.begin(), dir.end()));
     dir[smallest_normal_index] = 1.0f;
     // auto second_smallest_normal_index = std::distance(dir.begin(), std::min_element(dir.begin(), dir.end()));
     // auto largest_normal_index = std::distance(
-    //    probe.m_direction.begin(), std::max_element(probe.m_direction.begin(), probe.m_direction.end()));
+    //    probe.getDirection().begin(), std::max_element(probe.getDirection().begin(), probe.getDirection().end()));
 
     std::array<float, 3> axis0 = {0.0f, 0.0f, 0.0f};
     // if (smallest_normal_index == 1) smallest_normal_index = second_smallest_normal_index;
     axis0[smallest_normal_index] = 1.0f;
     std::array<float, 3> plane_vec_1;
-    plane_vec_1[0] = probe.m_direction[1] * axis0[2] - probe.m_direction[2] * axis0[1];
-    plane_vec_1[1] = probe.m_direction[2] * axis0[0] - probe.m_direction[0] * axis0[2];
-    plane_vec_1[2] = probe.m_direction[0] * axis0[1] - probe.m_direction[1] * axis0[0];
+    plane_vec_1[0] = probe.getDirection()[1] * axis0[2] - probe.getDirection()[2] * axis0[1];
+    plane_vec_1[1] = probe.getDirection()[2] * axis0[0] - probe.getDirection()[0] * axis0[2];
+    plane_vec_1[2] = probe.getDirection()[0] * axis0[1] - probe.getDirection()[1] * axis0[0];
 
     std::array<float, 3> plane_vec_2;
-    plane_vec_2[0] = probe.m_direction[1] * plane_vec_1[2] - probe.m_direction[2] * plane_vec_1[1];
-    plane_vec_2[1] = probe.m_direction[2] * plane_vec_1[0] - probe.m_direction[0] * plane_vec_1[2];
-    plane_vec_2[2] = probe.m_direction[0] * plane_vec_1[1] - probe.m_direction[1] * plane_vec_1[0];
+    plane_vec_2[0] = probe.getDirection()[1] * plane_vec_1[2] - probe.getDirection()[2] * plane_vec_1[1];
+    plane_vec_2[1] = probe.getDirection()[2] * plane_vec_1[0] - probe.getDirection()[0] * plane_vec_1[2];
+    plane_vec_2[2] = probe.getDirection()[0] * plane_vec_1[1] - probe.getDirection()[1] * plane_vec_1[0];
 
     float plane_vec_1_length =
         std::sqrt(plane_vec_1[0] * plane_vec_1[0] + plane_vec_1[1] * plane_vec_1[1] + plane_vec_1[2] * plane_vec_1[2]);
@@ -90,9 +88,9 @@ bool GenerateGlyphs::doScalarGlyphGeneration(FloatProbe& probe) {
     plane_vec_2[2] /= plane_vec_2_length;
 
     std::array<float, 3> middle;
-    middle[0] = probe.m_position[0] + probe.m_direction[0] * probe.m_begin;
-    middle[1] = probe.m_position[1] + probe.m_direction[1] * probe.m_begin;
-    middle[2] = probe.m_position[2] + probe.m_direction[2] * probe.m_begin;
+    middle[0] = probe.getPosition()[0] + probe.getDirection()[0] * probe.getBegin();
+    middle[1] = probe.getPosition()[1] + probe.getDirection()[1] * probe.getBegin();
+    middle[2] = probe.getPosition()[2] + probe.getDirection()[2] * probe.getBegin();
 
     std::array<float, 3> vertex1;
     vertex1[0] = middle[0] + scale / 2 * plane_vec_1[0] + scale / 2 * plane_vec_2[0];
@@ -153,21 +151,19 @@ bool GenerateGlyphs::doScalarGlyphGeneration(FloatProbe& probe) {
         _dtu.back().setResolution(300, 300);                 // should be changeable
         _dtu.back().setGraphType(DrawTextureUtility::GLYPH); // should be changeable
 
-        auto tex_ptr = _dtu.back().draw(samples->samples, samples->min_value, samples->max_value);
+        auto tex_ptr = _dtu.back().draw(samples, probe.getMinValue(), probe.getMaxValue());
         this->_tex_data->addImage(mesh::ImageDataAccessCollection::RGBA8, _dtu.back().getPixelWidth(),
             _dtu.back().getPixelHeight(), tex_ptr, 4 * _dtu.back().getPixelWidth() * _dtu.back().getPixelHeight());
     }
     return true;
 }
 
-bool GenerateGlyphs::doVectorRibbonGlyphGeneration(Vec4Probe& probe) {
+bool GenerateGlyphs::doVectorRibbonGlyphGeneration(ProbeCollection::ProbeView const& probe) {
 
-    // get probe
-    // auto probe = this->_probe_data->getProbe<FloatProbe>(i);
     // read samples of probe
-    auto samples = probe.getSamplingResult();
+    auto const samples = probe.getVec4Samples();
 
-    if (samples->samples.empty()) {
+    if (samples.empty()) {
         vislib::sys::Log::DefaultLog.WriteError("[GenerateGlyphs] Probes have not been sampled.");
         return false;
     }
@@ -177,23 +173,23 @@ bool GenerateGlyphs::doVectorRibbonGlyphGeneration(Vec4Probe& probe) {
     // create first pair of vertices at the base of the ribbon
     float ribbon_width = 0.0001f;
     std::array<float, 3> ribbon_base;
-    ribbon_base[0] = probe.m_position[0] + probe.m_begin * probe.m_direction[0];
-    ribbon_base[1] = probe.m_position[1] + probe.m_begin * probe.m_direction[1];
-    ribbon_base[2] = probe.m_position[2] + probe.m_begin * probe.m_direction[2];
+    ribbon_base[0] = probe.getPosition()[0] + probe.getBegin() * probe.getDirection()[0];
+    ribbon_base[1] = probe.getPosition()[1] + probe.getBegin() * probe.getDirection()[1];
+    ribbon_base[2] = probe.getPosition()[2] + probe.getBegin() * probe.getDirection()[2];
 
     std::array<float, 3> vertex1;
-    vertex1[0] = ribbon_base[0] + ribbon_width * samples->samples.front()[0];
-    vertex1[1] = ribbon_base[1] + ribbon_width * samples->samples.front()[1];
-    vertex1[2] = ribbon_base[2] + ribbon_width * samples->samples.front()[2];
+    vertex1[0] = ribbon_base[0] + ribbon_width * samples.front()[0];
+    vertex1[1] = ribbon_base[1] + ribbon_width * samples.front()[1];
+    vertex1[2] = ribbon_base[2] + ribbon_width * samples.front()[2];
 
     std::array<float, 3> vertex2;
-    vertex2[0] = ribbon_base[0] - ribbon_width * samples->samples.front()[0];
-    vertex2[1] = ribbon_base[1] - ribbon_width * samples->samples.front()[1];
-    vertex2[2] = ribbon_base[2] - ribbon_width * samples->samples.front()[2];
+    vertex2[0] = ribbon_base[0] - ribbon_width * samples.front()[0];
+    vertex2[1] = ribbon_base[1] - ribbon_width * samples.front()[1];
+    vertex2[2] = ribbon_base[2] - ribbon_width * samples.front()[2];
 
     // update ribbon base
     std::array<float, 3> sample_vector = {
-        samples->samples.front()[0], samples->samples.front()[1], samples->samples.front()[2]};
+        samples.front()[0], samples.front()[1], samples.front()[2]};
 
     float sample_vector_length = std::sqrt(sample_vector[0] * sample_vector[0] + sample_vector[1] * sample_vector[1] +
                                      sample_vector[2] * sample_vector[2]);
@@ -202,9 +198,9 @@ bool GenerateGlyphs::doVectorRibbonGlyphGeneration(Vec4Probe& probe) {
     sample_vector[2] /= sample_vector_length;
 
     std::array<float, 3> offset_direction; // TODO
-    offset_direction[0] = probe.m_direction[1] * sample_vector[2] - probe.m_direction[2] * sample_vector[1];
-    offset_direction[1] = probe.m_direction[2] * sample_vector[0] - probe.m_direction[0] * sample_vector[2];
-    offset_direction[2] = probe.m_direction[0] * sample_vector[1] - probe.m_direction[1] * sample_vector[0];
+    offset_direction[0] = probe.getDirection()[1] * sample_vector[2] - probe.getDirection()[2] * sample_vector[1];
+    offset_direction[1] = probe.getDirection()[2] * sample_vector[0] - probe.getDirection()[0] * sample_vector[2];
+    offset_direction[2] = probe.getDirection()[0] * sample_vector[1] - probe.getDirection()[1] * sample_vector[0];
 
     ribbon_base[0] = ribbon_base[0] + ribbon_width * 2.0f * offset_direction[0];
     ribbon_base[1] = ribbon_base[1] + ribbon_width * 2.0f * offset_direction[1];
@@ -225,9 +221,9 @@ bool GenerateGlyphs::doVectorRibbonGlyphGeneration(Vec4Probe& probe) {
     size_t base_vertex = _generated_mesh_vertices.size();
     size_t base_index = _generated_mesh_indices.size();
 
-    for (int i = 1; i < samples->samples.size(); ++i) {
+    for (int i = 1; i < samples.size(); ++i) {
 
-        std::array<float, 3> sample_vector = {samples->samples[i][0], samples->samples[i][1], samples->samples[i][2]};
+        std::array<float, 3> sample_vector = {samples[i][0], samples[i][1], samples[i][2]};
         float sample_vector_length = std::sqrt(
             sample_vector[0] * sample_vector[0] + 
             sample_vector[1] * sample_vector[1] +
@@ -287,7 +283,7 @@ bool GenerateGlyphs::doVectorRibbonGlyphGeneration(Vec4Probe& probe) {
     mesh::MeshDataAccessCollection::VertexAttribute pos_attrib;
     pos_attrib.data = reinterpret_cast<uint8_t*>(&this->_generated_mesh_vertices[base_vertex]);
     pos_attrib.stride = sizeof(std::array<float, 3>);
-    pos_attrib.byte_size = pos_attrib.stride * samples->samples.size();
+    pos_attrib.byte_size = pos_attrib.stride * samples.size();
     pos_attrib.component_cnt = 3;
     pos_attrib.component_type = mesh::MeshDataAccessCollection::FLOAT;
     pos_attrib.offset = 0;
@@ -297,7 +293,7 @@ bool GenerateGlyphs::doVectorRibbonGlyphGeneration(Vec4Probe& probe) {
     mesh::MeshDataAccessCollection::VertexAttribute normal_attrib;
     normal_attrib.data = reinterpret_cast<uint8_t*>(&this->_generated_mesh_normals[base_vertex]);
     normal_attrib.stride = sizeof(std::array<float, 3>);
-    normal_attrib.byte_size = normal_attrib.stride * samples->samples.size();
+    normal_attrib.byte_size = normal_attrib.stride * samples.size();
     normal_attrib.component_cnt = 3;
     normal_attrib.component_type = mesh::MeshDataAccessCollection::FLOAT;
     normal_attrib.offset = 0;
@@ -316,7 +312,7 @@ bool GenerateGlyphs::doVectorRibbonGlyphGeneration(Vec4Probe& probe) {
 
     mesh::MeshDataAccessCollection::IndexData index_data;
     index_data.data = reinterpret_cast<uint8_t*>(&this->_generated_mesh_indices[base_index]);
-    index_data.byte_size = sizeof(uint32_t) * 6 * samples->samples.size() -1;
+    index_data.byte_size = sizeof(uint32_t) * 6 * samples.size() -1;
     index_data.type = mesh::MeshDataAccessCollection::UNSIGNED_INT;
 
     this->_mesh_data->addMesh(vertex_attributes, index_data);
@@ -324,39 +320,37 @@ bool GenerateGlyphs::doVectorRibbonGlyphGeneration(Vec4Probe& probe) {
     return false; 
 }
 
-bool GenerateGlyphs::doVectorRadarGlyphGeneration(Vec4Probe& probe) {
+bool GenerateGlyphs::doVectorRadarGlyphGeneration(ProbeCollection::ProbeView const& probe) {
 
-    // get probe
-    // auto probe = this->_probe_data->getProbe<FloatProbe>(i);
     // read samples of probe
-    auto samples = probe.getSamplingResult();
+    auto const samples = probe.getVec4Samples();
 
-    if (samples->samples.empty()) {
+    if (samples.empty()) {
         vislib::sys::Log::DefaultLog.WriteError("[GenerateGlyphs] Probes have not been sampled.");
         return false;
     }
 
     {
         // calc vertices
-        auto dir = probe.m_direction;
+        auto dir = probe.getDirection();
         auto smallest_normal_index = std::distance(dir.begin(), std::min_element(dir.begin(), dir.end()));
         dir[smallest_normal_index] = 1.0f;
         // auto second_smallest_normal_index = std::distance(dir.begin(), std::min_element(dir.begin(), dir.end()));
         // auto largest_normal_index = std::distance(
-        //    probe.m_direction.begin(), std::max_element(probe.m_direction.begin(), probe.m_direction.end()));
+        //    probe.getDirection().begin(), std::max_element(probe.getDirection().begin(), probe.getDirection().end()));
 
         std::array<float, 3> axis0 = {0.0f, 0.0f, 0.0f};
         // if (smallest_normal_index == 1) smallest_normal_index = second_smallest_normal_index;
         axis0[smallest_normal_index] = 1.0f;
         std::array<float, 3> plane_vec_1;
-        plane_vec_1[0] = probe.m_direction[1] * axis0[2] - probe.m_direction[2] * axis0[1];
-        plane_vec_1[1] = probe.m_direction[2] * axis0[0] - probe.m_direction[0] * axis0[2];
-        plane_vec_1[2] = probe.m_direction[0] * axis0[1] - probe.m_direction[1] * axis0[0];
+        plane_vec_1[0] = probe.getDirection()[1] * axis0[2] - probe.getDirection()[2] * axis0[1];
+        plane_vec_1[1] = probe.getDirection()[2] * axis0[0] - probe.getDirection()[0] * axis0[2];
+        plane_vec_1[2] = probe.getDirection()[0] * axis0[1] - probe.getDirection()[1] * axis0[0];
 
         std::array<float, 3> plane_vec_2;
-        plane_vec_2[0] = probe.m_direction[1] * plane_vec_1[2] - probe.m_direction[2] * plane_vec_1[1];
-        plane_vec_2[1] = probe.m_direction[2] * plane_vec_1[0] - probe.m_direction[0] * plane_vec_1[2];
-        plane_vec_2[2] = probe.m_direction[0] * plane_vec_1[1] - probe.m_direction[1] * plane_vec_1[0];
+        plane_vec_2[0] = probe.getDirection()[1] * plane_vec_1[2] - probe.getDirection()[2] * plane_vec_1[1];
+        plane_vec_2[1] = probe.getDirection()[2] * plane_vec_1[0] - probe.getDirection()[0] * plane_vec_1[2];
+        plane_vec_2[2] = probe.getDirection()[0] * plane_vec_1[1] - probe.getDirection()[1] * plane_vec_1[0];
 
         float plane_vec_1_length =
             std::sqrt(plane_vec_1[0] * plane_vec_1[0] + plane_vec_1[1] * plane_vec_1[1] + plane_vec_1[2] * plane_vec_1[2]);
@@ -371,9 +365,9 @@ bool GenerateGlyphs::doVectorRadarGlyphGeneration(Vec4Probe& probe) {
         plane_vec_2[2] /= plane_vec_2_length;
 
         std::array<float, 3> middle;
-        middle[0] = probe.m_position[0] + probe.m_direction[0] * probe.m_begin;
-        middle[1] = probe.m_position[1] + probe.m_direction[1] * probe.m_begin;
-        middle[2] = probe.m_position[2] + probe.m_direction[2] * probe.m_begin;
+        middle[0] = probe.getPosition()[0] + probe.getDirection()[0] * probe.getBegin();
+        middle[1] = probe.getPosition()[1] + probe.getDirection()[1] * probe.getBegin();
+        middle[2] = probe.getPosition()[2] + probe.getDirection()[2] * probe.getBegin();
 
         std::array<float, 3> vertex1;
         vertex1[0] = middle[0] + scale / 2 * plane_vec_1[0] + scale / 2 * plane_vec_2[0];
@@ -434,7 +428,7 @@ bool GenerateGlyphs::doVectorRadarGlyphGeneration(Vec4Probe& probe) {
     _dtu.back().setResolution(400, 400);                 // should be changeable
     _dtu.back().setGraphType(DrawTextureUtility::RADARGLYPH); // should be changeable
 
-    auto tex_ptr = _dtu.back().draw(samples->samples, probe.m_direction);
+    auto tex_ptr = _dtu.back().draw(samples, probe.getDirection());
     this->_tex_data->addImage(mesh::ImageDataAccessCollection::RGBA8, _dtu.back().getPixelWidth(),
         _dtu.back().getPixelHeight(), tex_ptr, 4 * _dtu.back().getPixelWidth() * _dtu.back().getPixelHeight());
 
@@ -486,22 +480,22 @@ bool GenerateGlyphs::getMesh(core::Call& call) {
         //#pragma omp parallel for
         for (int i = 0; i < this->_probe_data->getProbeCount(); i++) {
 
-            auto generic_probe = this->_probe_data->getGenericProbe(i);
-
-            auto visitor = [this](auto&& arg) {
-                using T = std::decay_t<decltype(arg)>;
-                if constexpr (std::is_same_v<T, FloatProbe>) {
-                    doScalarGlyphGeneration(arg);
-                } else if constexpr (std::is_same_v<T, IntProbe>) {
-                    // TODO
-                } else if constexpr (std::is_same_v<T, Vec4Probe>) {
-                    doVectorRadarGlyphGeneration(arg);
-                } else {
-                    // unknown probe type, throw error? do nothing?
-                }
-            };
-
-            std::visit(visitor, generic_probe);
+            auto const probe = this->_probe_data->getProbeView(i);
+
+            switch (probe.getProbeTypeIdx()) {
+            case ProbeCollection::FLOAT_PROBE:
+                doScalarGlyphGeneration(probe);
+                break;
+            case ProbeCollection::INT_PROBE:
+                // TODO
+                break;
+            case ProbeCollection::VEC4_PROBE:
+                doVectorRadarGlyphGeneration(probe);
+                break;
+            default:
+                // unknown probe type, throw error? do nothing?
+                break;
+            }
         } // end for probe count
 
     }
@@ -570,26 +564,22 @@ bool GenerateGlyphs::getTexture(core::Call& call) {
         //#pragma omp parallel for
         for (int i = 0; i < this->_probe_data->getProbeCount(); i++) {
 
-            auto generic_probe = this->_probe_data->getGenericProbe(i);
-
-            auto visitor =
-                [this](auto&& arg) {
-                    using T = std::decay_t<decltype(arg)>;
-                if constexpr (std::is_same_v<T, FloatProbe>) {
-                    doScalarGlyphGeneration(arg);
-                }
-                else if constexpr (std::is_same_v<T, IntProbe>) {
-                    //TODO
-                }
-                else if constexpr (std::is_same_v<T, Vec4Probe>) {
-                    doVectorRadarGlyphGeneration(arg);
-                } else {
-                    // unknown probe type, throw error? do nothing?
-                }
-            };
-
-            std::visit(visitor, generic_probe);
-
+            auto const probe = this->_probe_data->getProbeView(i);
+
+            switch (probe.getProbeTypeIdx()) {
+            case ProbeCollection::FLOAT_PROBE:
+                doScalarGlyphGeneration(probe);
+                break;
+            case ProbeCollection::INT_PROBE:
+                // TODO
+                break;
+            case ProbeCollection::VEC4_PROBE:
+                doVectorRadarGlyphGeneration(probe);
+                break;
+            default:
+                // unknown probe type, throw error? do nothing?
+                break;
+            }
         } // end for probe count
     }
 
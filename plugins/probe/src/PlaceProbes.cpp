@@ -40,16 +40,7 @@ megamol::probe::PlaceProbes::PlaceProbes()
 
     this->m_probes_per_unit_slot << new core::param::IntParam(1,0);
 
-    /* Feasibility test */
     m_probes = std::make_shared<ProbeCollection>();
-    m_probes->addProbe(FloatProbe());
-
-    auto retrieved_probe = m_probes->getProbe<FloatProbe>(0);
-
-    float data;
-    retrieved_probe.probe(&data);
-
-    auto result = retrieved_probe.getSamplingResult();
 }
 
 megamol::probe::PlaceProbes::~PlaceProbes() { this->Release(); }
@@ -11,9 +11,16 @@
 
 #include "probe/probe.h"
 
+#include <algorithm>
 #include <array>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
 #include <string>
+#include <type_traits>
 #include <variant>
+#include <vector>
 
 namespace megamol {
 namespace probe {
@@ -79,26 +86,466 @@ private:
 using GenericProbe = std::variant<FloatProbe, IntProbe, Vec4Probe, BaseProbe>;
 
 
+/**
+ * Probe storage as structure of arrays. Geometry is kept in contiguous per-attribute arrays and the sampling results
+ * of all probes share one flat sample array per sample type, addressed by per-probe offsets.
+ *
+ * getProbeView returns a lightweight view of one probe that reads straight from the arrays. The older accessors
+ * (getProbe, getGenericProbe) assemble a probe and return a copy, including a copy of its samples.
+ */
 class ProbeCollection {
 public:
+    /** Type of a probe, equal to the index of the corresponding alternative of GenericProbe */
+    enum ProbeTypeIdx : uint8_t { FLOAT_PROBE = 0, INT_PROBE = 1, VEC4_PROBE = 2, BASE_PROBE = 3 };
+
+    /** Non-owning view of the samples of one probe */
+    template <typename SampleType> struct SampleView {
+        SampleType* data;
+        size_t count;
+
+        SampleType* begin() const { return data; }
+        SampleType* end() const { return data + count; }
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        SampleType& front() const { return data[0]; }
+        SampleType& operator[](size_t idx) const { return data[idx]; }
+    };
+
+    class ProbeView;
+
     ProbeCollection() = default;
     ~ProbeCollection() = default;
 
-    template <typename ProbeType> void addProbe(ProbeType const& probe) { m_probes.push_back(probe); }
+    template <typename ProbeType> void addProbe(ProbeType const& probe) {
+        m_types.push_back(BASE_PROBE);
+        m_timestamps.push_back(0);
+        m_value_name_ids.push_back(0);
+        m_positions.emplace_back();
+        m_directions.emplace_back();
+        m_begins.push_back(0.0f);
+        m_ends.push_back(0.0f);
+        m_sample_offsets.push_back(0);
+        m_sample_counts.push_back(0);
+        m_min_values.push_back(0.0f);
+        m_max_values.push_back(0.0f);
+        m_average_values.push_back(0.0f);
+        setProbe(m_types.size() - 1, probe);
+    }
+
+    /**
+     * Replace the probe at idx. Samples are overwritten in place if the probe already holds at least as many samples
+     * of the same type, otherwise they are appended to the flat sample array.
+     */
+    template <typename ProbeType> void setProbe(size_t idx, ProbeType const& probe) {
+        m_timestamps[idx] = probe.m_timestamp;
+        m_value_name_ids[idx] = internValueName(probe.m_value_name);
+        m_positions[idx] = probe.m_position;
+        m_directions[idx] = probe.m_direction;
+        m_begins[idx] = probe.m_begin;
+        m_ends[idx] = probe.m_end;
+
+        if constexpr (std::is_same_v<ProbeType, FloatProbe>) {
+            auto const result = probe.getSamplingResult();
+            storeSamples(idx, FLOAT_PROBE, m_float_samples, result->samples);
+            m_min_values[idx] = result->min_value;
+            m_max_values[idx] = result->max_value;
+            m_average_values[idx] = result->average_value;
+        } else if constexpr (std::is_same_v<ProbeType, Vec4Probe>) {
+            storeSamples(idx, VEC4_PROBE, m_vec4_samples, probe.getSamplingResult()->samples);
+        } else {
+            releaseSamples(idx);
+            m_types[idx] = typeIdxOf<ProbeType>();
+            m_sample_offsets[idx] = 0;
+            compactSparseSamples();
+        }
+    }
+
+    /** Answer a view of the probe at idx, valid until the collection is modified */
+    ProbeView getProbeView(size_t idx) const;
+
+    /** Assemble a copy of the probe at idx, throws std::bad_variant_access if it is not a ProbeType */
+    template <typename ProbeType> ProbeType getProbe(size_t idx) const {
+        if (m_types[idx] != typeIdxOf<ProbeType>()) {
+            throw std::bad_variant_access();
+        }
+        ProbeType probe;
+        probe.m_timestamp = m_timestamps[idx];
+        probe.m_value_name = m_value_names[m_value_name_ids[idx]];
+        probe.m_position = m_positions[idx];
+        probe.m_direction = m_directions[idx];
+        probe.m_begin = m_begins[idx];
+        probe.m_end = m_ends[idx];
+
+        if constexpr (std::is_same_v<ProbeType, FloatProbe>) {
+            auto const samples = getFloatSamples(idx);
+            auto result = probe.getSamplingResult();
+            result->samples.assign(samples.begin(), samples.end());
+            result->min_value = m_min_values[idx];
+            result->max_value = m_max_values[idx];
+            result->average_value = m_average_values[idx];
+        } else if constexpr (std::is_same_v<ProbeType, Vec4Probe>) {
+            auto const samples = getVec4Samples(idx);
+            probe.getSamplingResult()->samples.assign(samples.begin(), samples.end());
+        }
+        return probe;
+    }
+
+    GenericProbe getGenericProbe(size_t idx) const {
+        switch (m_types[idx]) {
+        case FLOAT_PROBE:
+            return getProbe<FloatProbe>(idx);
+        case INT_PROBE:
+            return getProbe<IntProbe>(idx);
+        case VEC4_PROBE:
+            return getProbe<Vec4Probe>(idx);
+        default:
+            return getProbe<BaseProbe>(idx);
+        }
+    }
+
+    uint32_t getProbeCount() const { return m_types.size(); }
+
+    ProbeTypeIdx getProbeTypeIdx(size_t idx) const { return static_cast<ProbeTypeIdx>(m_types[idx]); }
+
+    size_t getTimestamp(size_t idx) const { return static_cast<size_t>(m_timestamps[idx]); }
+    std::string const& getValueName(size_t idx) const { return m_value_names[m_value_name_ids[idx]]; }
+
+    std::vector<std::array<float, 3>> const& getPositions() const { return m_positions; }
+    std::vector<std::array<float, 3>> const& getDirections() const { return m_directions; }
+    std::vector<float> const& getBegins() const { return m_begins; }
+    std::vector<float> const& getEnds() const { return m_ends; }
+
+    /**
+     * Turn all probes into ProbeType (FloatProbe or Vec4Probe) with samples_per_probe samples each, stored as one
+     * contiguous matrix with one row per probe. Geometry is kept, previous samples are discarded. Afterwards the
+     * samples and statistics of distinct probes may be written concurrently.
+     */
+    template <typename ProbeType> void allocateSamples(size_t samples_per_probe) {
+        static_assert(std::is_same_v<ProbeType, FloatProbe> || std::is_same_v<ProbeType, Vec4Probe>,
+            "only probes with sampling results can hold samples");
+        auto const probe_cnt = m_types.size();
+        if constexpr (std::is_same_v<ProbeType, FloatProbe>) {
+            std::fill(m_types.begin(), m_types.end(), FLOAT_PROBE);
+            m_float_samples.assign(probe_cnt * samples_per_probe, 0.0f);
+            m_vec4_samples.clear();
+            m_vec4_samples.shrink_to_fit();
+        } else {
+            std::fill(m_types.begin(), m_types.end(), VEC4_PROBE);
+            m_vec4_samples.assign(probe_cnt * samples_per_probe, std::array<float, 4>{0.0f, 0.0f, 0.0f, 0.0f});
+            m_float_samples.clear();
+            m_float_samples.shrink_to_fit();
+        }
+        m_unused_float_samples = 0;
+        m_unused_vec4_samples = 0;
+        for (size_t idx = 0; idx < probe_cnt; ++idx) {
+            m_sample_offsets[idx] = idx * samples_per_probe;
+            m_sample_counts[idx] = static_cast<uint32_t>(samples_per_probe);
+        }
+        std::fill(m_min_values.begin(), m_min_values.end(), 0.0f);
+        std::fill(m_max_values.begin(), m_max_values.end(), 0.0f);
+        std::fill(m_average_values.begin(), m_average_values.end(), 0.0f);
+    }
+
+    SampleView<float> getFloatSamples(size_t idx) { return view(m_float_samples.data(), FLOAT_PROBE, idx); }
+    SampleView<const float> getFloatSamples(size_t idx) const { return view(m_float_samples.data(), FLOAT_PROBE, idx); }
+    SampleView<std::array<float, 4>> getVec4Samples(size_t idx) { return view(m_vec4_samples.data(), VEC4_PROBE, idx); }
+    SampleView<const std::array<float, 4>> getVec4Samples(size_t idx) const {
+        return view(m_vec4_samples.data(), VEC4_PROBE, idx);
+    }
+
+    void setSampleStatistics(size_t idx, float min_value, float max_value, float average_value) {
+        m_min_values[idx] = min_value;
+        m_max_values[idx] = max_value;
+        m_average_values[idx] = average_value;
+    }
+    float getMinValue(size_t idx) const { return m_min_values[idx]; }
+    float getMaxValue(size_t idx) const { return m_max_values[idx]; }
+    float getAverageValue(size_t idx) const { return m_average_values[idx]; }
+
+    /**
+     * Write the collection in a binary format that stores each array as a whole.
+     *
+     * @return 'true' on success, 'false' if the stream failed.
+     */
+    bool serialize(std::ostream& stream) const {
+        uint64_t const header[2] = {SERIALIZATION_MAGIC, SERIALIZATION_VERSION};
+        stream.write(reinterpret_cast<char const*>(header), sizeof(header));
+
+        writeArray(stream, m_types);
+        writeArray(stream, m_timestamps);
+        writeArray(stream, m_value_name_ids);
+        writeArray(stream, m_positions);
+        writeArray(stream, m_directions);
+        writeArray(stream, m_begins);
+        writeArray(stream, m_ends);
+        writeArray(stream, m_sample_offsets);
+        writeArray(stream, m_sample_counts);
+        writeArray(stream, m_min_values);
+        writeArray(stream, m_max_values);
+        writeArray(stream, m_average_values);
+        writeArray(stream, m_float_samples);
+        writeArray(stream, m_vec4_samples);
+
+        uint64_t const name_cnt = m_value_names.size();
+        stream.write(reinterpret_cast<char const*>(&name_cnt), sizeof(name_cnt));
+        for (auto const& name : m_value_names) {
+            uint64_t const length = name.size();
+            stream.write(reinterpret_cast<char const*>(&length), sizeof(length));
+            stream.write(name.data(), length);
+        }
+
+        return stream.good();
+    }
+
+    /**
+     * Replace the content of the collection by data written with serialize.
+     *
+     * @return 'true' on success, 'false' if the stream failed or does not hold a valid collection. In the latter
+     *         case the collection is left empty.
+     */
+    bool deserialize(std::istream& stream) {
+        *this = ProbeCollection();
+
+        uint64_t header[2] = {0, 0};
+        stream.read(reinterpret_cast<char*>(header), sizeof(header));
+        if (!stream || header[0] != SERIALIZATION_MAGIC || header[1] != SERIALIZATION_VERSION) return false;
+
+        bool ok = readArray(stream, m_types) && readArray(stream, m_timestamps) &&
+                  readArray(stream, m_value_name_ids) && readArray(stream, m_positions) &&
+                  readArray(stream, m_directions) && readArray(stream, m_begins) && readArray(stream, m_ends) &&
+                  readArray(stream, m_sample_offsets) && readArray(stream, m_sample_counts) &&
+                  readArray(stream, m_min_values) && readArray(stream, m_max_values) &&
+                  readArray(stream, m_average_values) && readArray(stream, m_float_samples) &&
+                  readArray(stream, m_vec4_samples);
+
+        uint64_t name_cnt = 0;
+        m_value_names.clear();
+        ok = ok && stream.read(reinterpret_cast<char*>(&name_cnt), sizeof(name_cnt));
+        for (uint64_t i = 0; ok && i < name_cnt; ++i) {
+            uint64_t length = 0;
+            ok = ok && stream.read(reinterpret_cast<char*>(&length), sizeof(length));
+            if (ok) {
+                m_value_names.emplace_back(length, '\0');
+                ok = ok && stream.read(&m_value_names.back()[0], length);
+            }
+        }
+
+        if (!ok || !isConsistent()) {
+            *this = ProbeCollection();
+            return false;
+        }
+        m_unused_float_samples = m_float_samples.size();
+        m_unused_vec4_samples = m_vec4_samples.size();
+        for (size_t idx = 0; idx < m_types.size(); ++idx) {
+            if (m_types[idx] == FLOAT_PROBE) m_unused_float_samples -= m_sample_counts[idx];
+            if (m_types[idx] == VEC4_PROBE) m_unused_vec4_samples -= m_sample_counts[idx];
+        }
+        return true;
+    }
+
+private:
+    static constexpr uint64_t SERIALIZATION_MAGIC = 0x4c4f43424f52504dull; // "MPROBCOL"
+    static constexpr uint64_t SERIALIZATION_VERSION = 1;
+
+    template <typename ProbeType> static constexpr ProbeTypeIdx typeIdxOf() {
+        if constexpr (std::is_same_v<ProbeType, FloatProbe>) {
+            return FLOAT_PROBE;
+        } else if constexpr (std::is_same_v<ProbeType, IntProbe>) {
+            return INT_PROBE;
+        } else if constexpr (std::is_same_v<ProbeType, Vec4Probe>) {
+            return VEC4_PROBE;
+        } else {
+            return BASE_PROBE;
+        }
+    }
+
+    uint32_t internValueName(std::string const& name) {
+        auto const it = std::find(m_value_names.begin(), m_value_names.end(), name);
+        if (it != m_value_names.end()) {
+            return static_cast<uint32_t>(it - m_value_names.begin());
+        }
+        m_value_names.push_back(name);
+        return static_cast<uint32_t>(m_value_names.size() - 1);
+    }
+
+    /**
+     * Store the samples of the probe at idx. The current range is reused if the samples fit, otherwise they are
+     * appended. Unused ranges are counted and the storage is compacted once they make up half of it.
+     */
+    template <typename SampleType>
+    void storeSamples(
+        size_t idx, ProbeTypeIdx type, std::vector<SampleType>& storage, std::vector<SampleType> const& samples) {
+        if (m_types[idx] == type && samples.size() <= m_sample_counts[idx]) {
+            unusedSamples(type) += m_sample_counts[idx] - samples.size();
+        } else {
+            releaseSamples(idx);
+            m_sample_offsets[idx] = storage.size();
+            storage.resize(storage.size() + samples.size());
+        }
+        m_types[idx] = type;
+        m_sample_counts[idx] = static_cast<uint32_t>(samples.size());
+        std::copy(samples.begin(), samples.end(), storage.begin() + m_sample_offsets[idx]);
+        compactSparseSamples();
+    }
+
+    size_t& unusedSamples(ProbeTypeIdx type) {
+        return (type == FLOAT_PROBE) ? m_unused_float_samples : m_unused_vec4_samples;
+    }
+
+    /** Mark the samples of the probe at idx as unused */
+    void releaseSamples(size_t idx) {
+        if (m_types[idx] == FLOAT_PROBE || m_types[idx] == VEC4_PROBE) {
+            unusedSamples(static_cast<ProbeTypeIdx>(m_types[idx])) += m_sample_counts[idx];
+        }
+        m_sample_counts[idx] = 0;
+    }
+
+    /** Compact each flat sample array of which at least half is unused */
+    void compactSparseSamples() {
+        if (m_unused_float_samples > 0 && 2 * m_unused_float_samples >= m_float_samples.size()) {
+            compactSamples(FLOAT_PROBE, m_float_samples);
+        }
+        if (m_unused_vec4_samples > 0 && 2 * m_unused_vec4_samples >= m_vec4_samples.size()) {
+            compactSamples(VEC4_PROBE, m_vec4_samples);
+        }
+    }
+
+    /** Move the samples of all probes of the given type together, in probe order */
+    template <typename SampleType> void compactSamples(ProbeTypeIdx type, std::vector<SampleType>& storage) {
+        std::vector<SampleType> compacted;
+        compacted.reserve(storage.size() - unusedSamples(type));
+        for (size_t idx = 0; idx < m_types.size(); ++idx) {
+            if (m_types[idx] != type) continue;
+            auto const first = storage.begin() + m_sample_offsets[idx];
+            m_sample_offsets[idx] = compacted.size();
+            compacted.insert(compacted.end(), first, first + m_sample_counts[idx]);
+        }
+        storage.swap(compacted);
+        unusedSamples(type) = 0;
+    }
+
+    template <typename SampleType>
+    SampleView<SampleType> view(SampleType* storage, ProbeTypeIdx type, size_t idx) const {
+        if (m_types[idx] != type) {
+            return SampleView<SampleType>{nullptr, 0};
+        }
+        return SampleView<SampleType>{storage + m_sample_offsets[idx], m_sample_counts[idx]};
+    }
+
+    bool isConsistent() const {
+        auto const probe_cnt = m_types.size();
+        if (m_timestamps.size() != probe_cnt || m_value_name_ids.size() != probe_cnt ||
+            m_positions.size() != probe_cnt || m_directions.size() != probe_cnt || m_begins.size() != probe_cnt ||
+            m_ends.size() != probe_cnt || m_sample_offsets.size() != probe_cnt ||
+            m_sample_counts.size() != probe_cnt || m_min_values.size() != probe_cnt ||
+            m_max_values.size() != probe_cnt || m_average_values.size() != probe_cnt) {
+            return false;
+        }
+        for (size_t idx = 0; idx < probe_cnt; ++idx) {
+            if (m_types[idx] > BASE_PROBE || m_value_name_ids[idx] >= m_value_names.size()) {
+                return false;
+            }
+            size_t const storage_size = (m_types[idx] == FLOAT_PROBE)
+                                            ? m_float_samples.size()
+                                            : (m_types[idx] == VEC4_PROBE) ? m_vec4_samples.size() : 0;
+            if (m_sample_counts[idx] > 0 && (m_sample_offsets[idx] > storage_size ||
+                                                m_sample_counts[idx] > storage_size - m_sample_offsets[idx])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename T> static void writeArray(std::ostream& stream, std::vector<T> const& array) {
+        static_assert(std::is_trivially_copyable_v<T>, "arrays are written as raw memory");
+        uint64_t const cnt = array.size();
+        stream.write(reinterpret_cast<char const*>(&cnt), sizeof(cnt));
+        stream.write(reinterpret_cast<char const*>(array.data()), cnt * sizeof(T));
+    }
+
+    template <typename T> static bool readArray(std::istream& stream, std::vector<T>& array) {
+        static_assert(std::is_trivially_copyable_v<T>, "arrays are read as raw memory");
+        uint64_t cnt = 0;
+        if (!stream.read(reinterpret_cast<char*>(&cnt), sizeof(cnt))) return false;
+        // read in chunks, so a corrupt count fails at the end of the stream instead of allocating it all upfront
+        uint64_t const chunk = (std::max<uint64_t>)(1, (1ull << 24) / sizeof(T));
+        array.clear();
+        for (uint64_t read = 0; read < cnt;) {
+            auto const n = (std::min)(chunk, cnt - read);
+            array.resize(static_cast<size_t>(read + n));
+            if (!stream.read(reinterpret_cast<char*>(array.data() + read), n * sizeof(T))) return false;
+            read += n;
+        }
+        return true;
+    }
 
-    template <typename ProbeType> void setProbe(size_t idx, ProbeType const& probe) { m_probes[idx] = probe; }
+    /** GenericProbe alternative of each probe */
+    std::vector<uint8_t> m_types;
 
-    template <typename ProbeType> ProbeType getProbe(size_t idx) const { return std::get<ProbeType>(m_probes[idx]); }
+    std::vector<uint64_t> m_timestamps;
+    /** index into m_value_names for each probe */
+    std::vector<uint32_t> m_value_name_ids;
+    std::vector<std::string> m_value_names = {std::string()};
 
-    GenericProbe getGenericProbe(size_t idx) const { return m_probes[idx]; }
+    std::vector<std::array<float, 3>> m_positions;
+    std::vector<std::array<float, 3>> m_directions;
+    std::vector<float> m_begins;
+    std::vector<float> m_ends;
+
+    /** first sample and number of samples of each probe in the flat array of its sample type */
+    std::vector<uint64_t> m_sample_offsets;
+    std::vector<uint32_t> m_sample_counts;
+
+    /** sample statistics, only meaningful for FloatProbes */
+    std::vector<float> m_min_values;
+    std::vector<float> m_max_values;
+    std::vector<float> m_average_values;
+
+    std::vector<float> m_float_samples;
+    std::vector<std::array<float, 4>> m_vec4_samples;
+
+    /** number of samples in the flat arrays that belong to no probe */
+    size_t m_unused_float_samples = 0;
+    size_t m_unused_vec4_samples = 0;
+};
 
-    uint32_t getProbeCount() const { return m_probes.size(); }
+
+/**
+ * Non-owning view of one probe of a ProbeCollection. Copying a view is cheap, all accessors read the arrays of the
+ * collection, which must outlive the view and must not be modified while it is used.
+ */
+class ProbeCollection::ProbeView {
+public:
+    ProbeView(ProbeCollection const& collection, size_t idx) : m_collection(&collection), m_idx(idx) {}
+
+    size_t getIndex() const { return m_idx; }
+    ProbeTypeIdx getProbeTypeIdx() const { return m_collection->getProbeTypeIdx(m_idx); }
+
+    size_t getTimestamp() const { return m_collection->getTimestamp(m_idx); }
+    std::string const& getValueName() const { return m_collection->getValueName(m_idx); }
+    std::array<float, 3> const& getPosition() const { return m_collection->m_positions[m_idx]; }
+    std::array<float, 3> const& getDirection() const { return m_collection->m_directions[m_idx]; }
+    float getBegin() const { return m_collection->m_begins[m_idx]; }
+    float getEnd() const { return m_collection->m_ends[m_idx]; }
+
+    /** Samples of a FloatProbe, empty for all other types */
+    SampleView<const float> getFloatSamples() const { return m_collection->getFloatSamples(m_idx); }
+    /** Samples of a Vec4Probe, empty for all other types */
+    SampleView<const std::array<float, 4>> getVec4Samples() const { return m_collection->getVec4Samples(m_idx); }
+
+    float getMinValue() const { return m_collection->getMinValue(m_idx); }
+    float getMaxValue() const { return m_collection->getMaxValue(m_idx); }
+    float getAverageValue() const { return m_collection->getAverageValue(m_idx); }
 
 private:
-    std::vector<GenericProbe> m_probes;
+    ProbeCollection const* m_collection;
+    size_t m_idx;
 };
 
 
+inline ProbeCollection::ProbeView ProbeCollection::getProbeView(size_t idx) const { return ProbeView(*this, idx); }
+
+
 } // namespace probe
 } // namespace megamol
 
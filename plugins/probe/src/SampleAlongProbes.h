@@ -8,6 +8,12 @@
 #ifndef SAMPLE_ALONG_PROBES_H_INCLUDED
 #define SAMPLE_ALONG_PROBES_H_INCLUDED
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <vector>
+
 #include "mmcore/CalleeSlot.h"
 #include "mmcore/CallerSlot.h"
 #include "mmcore/Module.h"
@@ -15,6 +21,7 @@
 #include "ProbeCollection.h"
 #include "mmcore/param/ParamSlot.h"
 #include "kdtree.h"
+#include "mmcore/param/FloatParam.h"
 #include "mmcore/param/IntParam.h"
 #include "adios_plugin/CallADIOSData.h"
 
@@ -75,6 +82,26 @@ protected:
     core::param::ParamSlot _vec_param_to_samplex_w;
 
 private:
+    /** Maximum number of consecutive samples of a probe answered by a single tree query */
+    static const int MAX_SAMPLE_BATCH = 16;
+
+    /** Query buffers reused for all probes sampled by one thread */
+    struct SampleBuffers {
+        std::vector<std::pair<size_t, double>> matches;
+        std::vector<uint32_t> neighbors;
+        std::vector<uint32_t> k_indices;
+        std::vector<float> k_distances;
+    };
+
+    /**
+     * Finds the neighbours of all samples along the probe and passes them to accumulate(sample index, neighbours).
+     * Samples without any point in range use their nearest neighbour.
+     */
+    template <typename Accumulate>
+    static void sampleProbe(const pcl::KdTreeFLANN<pcl::PointXYZ>& tree, const std::array<float, 3>& position,
+        const std::array<float, 3>& direction, float end, int samples_per_probe, float sample_radius_factor,
+        SampleBuffers& buffers, Accumulate&& accumulate);
+
 	//TODO rename to "doScalarSampling" ?
     template <typename T>
     void doSampling(const std::shared_ptr<pcl::KdTreeFLANN<pcl::PointXYZ>>& tree, std::vector<T>& data);
@@ -95,83 +122,132 @@ private:
 };
 
 
-template <typename T>
-void SampleAlongPobes::doSampling(const std::shared_ptr<pcl::KdTreeFLANN<pcl::PointXYZ>>& tree, std::vector<T>& data) {
-
-    const int samples_per_probe = this->_num_samples_per_probe_slot.Param<core::param::IntParam>()->Value();
-    const float sample_radius_factor = this->_sample_radius_factor_slot.Param<core::param::FloatParam>()->Value();
-
-//#pragma omp parallel for
-    for (int32_t i = 0; i < static_cast<int32_t>(_probes->getProbeCount()); i++) {
-
-        FloatProbe probe;
-
-        auto visitor = [&probe, i, this](auto&& arg) {
-            using T = std::decay_t<decltype(arg)>;
-            if constexpr (std::is_same_v<T, probe::BaseProbe> || std::is_same_v<T, probe::Vec4Probe>) {
-
-                probe.m_timestamp = arg.m_timestamp;
-                probe.m_value_name = arg.m_value_name;
-                probe.m_position = arg.m_position;
-                probe.m_direction = arg.m_direction;
-                probe.m_begin = arg.m_begin;
-                probe.m_end = arg.m_end;
-
-                _probes->setProbe(i, probe);
-
-            } else if constexpr (std::is_same_v<T, probe::FloatProbe>) {
-                probe = arg;
-
-            } else {
-                // unknown/incompatible probe type, throw error? do nothing?
+template <typename Accumulate>
+void SampleAlongPobes::sampleProbe(const pcl::KdTreeFLANN<pcl::PointXYZ>& tree, const std::array<float, 3>& position,
+    const std::array<float, 3>& direction, float end, int samples_per_probe, float sample_radius_factor,
+    SampleBuffers& buffers, Accumulate&& accumulate) {
+
+    auto const& points = tree.getInputCloud()->points;
+
+    auto const sample_step = end / static_cast<float>(samples_per_probe);
+    auto const radius = sample_step * sample_radius_factor;
+
+    auto const sample_point = [&position, &direction, sample_step](int j) {
+        pcl::PointXYZ sample_point;
+        sample_point.x = position[0] + j * sample_step * direction[0];
+        sample_point.y = position[1] + j * sample_step * direction[1];
+        sample_point.z = position[2] + j * sample_step * direction[2];
+        return sample_point;
+    };
+
+    // The tree compares the radius against squared distances, so this is the extent of the sphere per sample.
+    float const reach = std::sqrt(std::max(radius, 0.0f));
+    float const step_length = std::abs(sample_step) *
+                              std::sqrt(direction[0] * direction[0] + direction[1] * direction[1] +
+                                        direction[2] * direction[2]);
+
+    // Consecutive samples closer than their query radius share most neighbours, so they are answered by one query
+    // with a sphere enclosing all of them and filtered afterwards. Batches are kept short enough that the enclosing
+    // sphere stays at most 1.5 times as large as a single query.
+    int batch_size = MAX_SAMPLE_BATCH;
+    if (step_length > 0.0f && (reach / step_length) < static_cast<float>(MAX_SAMPLE_BATCH - 1)) {
+        batch_size = 1 + static_cast<int>(reach / step_length);
+    }
+
+    for (int first = 0; first < samples_per_probe; first += batch_size) {
+        int const last = std::min(first + batch_size, samples_per_probe) - 1;
+
+        if (first == last) {
+            buffers.neighbors.clear();
+            tree.radiusSearch(sample_point(first), radius, buffers.matches);
+            for (auto const& match : buffers.matches) {
+                buffers.neighbors.push_back(static_cast<uint32_t>(match.first));
+            }
+        } else {
+            auto const front = sample_point(first);
+            auto const back = sample_point(last);
+            pcl::PointXYZ center;
+            center.x = 0.5f * (front.x + back.x);
+            center.y = 0.5f * (front.y + back.y);
+            center.z = 0.5f * (front.z + back.z);
+            auto const half_length = 0.5f * step_length * static_cast<float>(last - first);
+            auto const batch_reach = static_cast<double>(reach) + half_length;
+            tree.radiusSearch(center, batch_reach * batch_reach, buffers.matches);
+        }
+
+        for (int j = first; j <= last; j++) {
+            if (first != last) {
+                // same metric as L2_Simple_Adaptor: float differences, double accumulation
+                auto const p = sample_point(j);
+                buffers.neighbors.clear();
+                for (auto const& match : buffers.matches) {
+                    auto const& q = points[match.first];
+                    float const dx = p.x - q.x;
+                    float const dy = p.y - q.y;
+                    float const dz = p.z - q.z;
+                    double const dist = static_cast<double>(dx * dx) + static_cast<double>(dy * dy) +
+                                        static_cast<double>(dz * dz);
+                    if (dist < radius) {
+                        buffers.neighbors.push_back(static_cast<uint32_t>(match.first));
+                    }
+                }
             }
-        };
-
-        auto generic_probe = _probes->getGenericProbe(i);
-        std::visit(visitor, generic_probe);
-
-        std::shared_ptr<FloatProbe::SamplingResult> samples = probe.getSamplingResult();
-
-        auto sample_step = probe.m_end / static_cast<float>(samples_per_probe);
-        auto radius = sample_step * sample_radius_factor;
-
-        float min_value = std::numeric_limits<float>::max();
-        float max_value = -std::numeric_limits<float>::max();
-        float avg_value = 0.0f;
-        samples->samples.resize(samples_per_probe);
-
-        for (int j = 0; j < samples_per_probe; j++) {
 
-            pcl::PointXYZ sample_point;
-            sample_point.x = probe.m_position[0] + j * sample_step * probe.m_direction[0];
-            sample_point.y = probe.m_position[1] + j * sample_step * probe.m_direction[1];
-            sample_point.z = probe.m_position[2] + j * sample_step * probe.m_direction[2];
+            if (buffers.neighbors.empty()) {
+                tree.nearestKSearch(sample_point(j), 1, buffers.k_indices, buffers.k_distances);
+                buffers.neighbors.push_back(buffers.k_indices[0]);
+            }
 
-            std::vector<uint32_t> k_indices;
-            std::vector<float> k_distances;
+            accumulate(j, buffers.neighbors);
+        }
+    }
+}
 
-            auto num_neighbors = tree->radiusSearch(sample_point, radius, k_indices, k_distances);
-            if (num_neighbors == 0) {
-                num_neighbors = tree->nearestKSearch(sample_point, 1, k_indices, k_distances);
-            }
+template <typename T>
+void SampleAlongPobes::doSampling(const std::shared_ptr<pcl::KdTreeFLANN<pcl::PointXYZ>>& tree, std::vector<T>& data) {
 
+    const int samples_per_probe = this->_num_samples_per_probe_slot.Param<core::param::IntParam>()->Value();
+    const float sample_radius_factor = this->_sample_radius_factor_slot.Param<core::param::FloatParam>()->Value();
 
-            // accumulate values
-            float value = 0;
-            for (int n = 0; n < num_neighbors; n++) {
-                value += data[k_indices[n]];
-            } // end num_neighbors
-            value /= num_neighbors;
-            samples->samples[j] = value;
-            min_value = std::min(min_value, value);
-            max_value = std::max(max_value, value);
-            avg_value += value;
-        } // end num samples per probe
-        avg_value /= samples_per_probe;
-        samples->average_value = avg_value;
-        samples->max_value = max_value;
-        samples->min_value = min_value;
-    } // end for probes
+    auto const probe_cnt = static_cast<int32_t>(_probes->getProbeCount());
+    auto const& positions = _probes->getPositions();
+    auto const& directions = _probes->getDirections();
+    auto const& ends = _probes->getEnds();
+
+    // turns all probes into FloatProbes sharing one sample matrix
+    _probes->allocateSamples<FloatProbe>(samples_per_probe);
+
+#pragma omp parallel
+    {
+        SampleBuffers buffers;
+
+#pragma omp for schedule(dynamic, 16)
+        for (int32_t i = 0; i < probe_cnt; i++) {
+
+            auto samples = _probes->getFloatSamples(i);
+
+            float min_value = std::numeric_limits<float>::max();
+            float max_value = -std::numeric_limits<float>::max();
+            float avg_value = 0.0f;
+
+            sampleProbe(*tree, positions[i], directions[i], ends[i], samples_per_probe, sample_radius_factor, buffers,
+                [&](int j, std::vector<uint32_t> const& neighbors) {
+                    // accumulate values
+                    float value = 0;
+                    for (auto const n : neighbors) {
+                        value += data[n];
+                    } // end num_neighbors
+                    value /= neighbors.size();
+                    samples[j] = value;
+                    min_value = std::min(min_value, value);
+                    max_value = std::max(max_value, value);
+                    avg_value += value;
+                });
+
+            avg_value /= samples_per_probe;
+            _probes->setSampleStatistics(i, min_value, max_value, avg_value);
+        } // end for probes
+    }
 }
 
 template <typename T>
@@ -185,83 +261,40 @@ inline void SampleAlongPobes::doVectorSamling(
     const int samples_per_probe = this->_num_samples_per_probe_slot.Param<core::param::IntParam>()->Value();
     const float sample_radius_factor = this->_sample_radius_factor_slot.Param<core::param::FloatParam>()->Value();
 
-    //#pragma omp parallel for
-    for (int32_t i = 0; i < static_cast<int32_t>(_probes->getProbeCount()); i++) {
-
-        Vec4Probe probe;
-
-        auto visitor = [&probe,i,this](auto&& arg) {
-            using T = std::decay_t<decltype(arg)>;
-            if constexpr (std::is_same_v<T, probe::BaseProbe> || std::is_same_v<T, probe::FloatProbe>) {
-
-                probe.m_timestamp = arg.m_timestamp;
-                probe.m_value_name = arg.m_value_name;
-                probe.m_position = arg.m_position;
-                probe.m_direction = arg.m_direction;
-                probe.m_begin = arg.m_begin;
-                probe.m_end = arg.m_end;
-
-                _probes->setProbe(i, probe);
-
-            } else if constexpr (std::is_same_v<T, probe::Vec4Probe>) {
-                probe = arg;
-
-            } else {
-                // unknown/incompatible probe type, throw error? do nothing?
-            }
-        };
-
-        auto generic_probe = _probes->getGenericProbe(i);
-        std::visit(visitor, generic_probe);
-
-        std::shared_ptr<Vec4Probe::SamplingResult> samples = probe.getSamplingResult();
-
-        auto sample_step = probe.m_end / static_cast<float>(samples_per_probe);
-        auto radius = sample_step * sample_radius_factor;
-
-        float min_value = std::numeric_limits<float>::max();
-        float max_value = -std::numeric_limits<float>::max();
-        float avg_value = 0.0f;
-        samples->samples.resize(samples_per_probe);
-
-        for (int j = 0; j < samples_per_probe; j++) {
-
-            pcl::PointXYZ sample_point;
-            sample_point.x = probe.m_position[0] + j * sample_step * probe.m_direction[0];
-            sample_point.y = probe.m_position[1] + j * sample_step * probe.m_direction[1];
-            sample_point.z = probe.m_position[2] + j * sample_step * probe.m_direction[2];
-
-            std::vector<uint32_t> k_indices;
-            std::vector<float> k_distances;
-
-            auto num_neighbors = tree->radiusSearch(sample_point, radius, k_indices, k_distances);
-            if (num_neighbors == 0) {
-                num_neighbors = tree->nearestKSearch(sample_point, 1, k_indices, k_distances);
-            }
-
-
-            // accumulate values
-            float value_x = 0, value_y = 0, value_z = 0, value_w = 0;
-            for (int n = 0; n < num_neighbors; n++) {
-                value_x += data_x[k_indices[n]];
-                value_y += data_y[k_indices[n]];
-                value_z += data_z[k_indices[n]];
-                value_w += data_w[k_indices[n]];
-            } // end num_neighbors
-            samples->samples[j][0] = value_x / num_neighbors;;
-            samples->samples[j][1] = value_y / num_neighbors;;
-            samples->samples[j][2] = value_z / num_neighbors;;
-            samples->samples[j][3] = value_w / num_neighbors;;
-            //min_value = std::min(min_value, value);
-            //max_value = std::max(max_value, value);
-            //avg_value += value;
-        } // end num samples per probe
-        //avg_value /= samples_per_probe;
-        //samples->average_value = avg_value;
-        //samples->max_value = max_value;
-        //samples->min_value = min_value;
-    } // end for probes
-
+    auto const probe_cnt = static_cast<int32_t>(_probes->getProbeCount());
+    auto const& positions = _probes->getPositions();
+    auto const& directions = _probes->getDirections();
+    auto const& ends = _probes->getEnds();
+
+    // turns all probes into Vec4Probes sharing one sample matrix
+    _probes->allocateSamples<Vec4Probe>(samples_per_probe);
+
+#pragma omp parallel
+    {
+        SampleBuffers buffers;
+
+#pragma omp for schedule(dynamic, 16)
+        for (int32_t i = 0; i < probe_cnt; i++) {
+
+            auto samples = _probes->getVec4Samples(i);
+
+            sampleProbe(*tree, positions[i], directions[i], ends[i], samples_per_probe, sample_radius_factor, buffers,
+                [&](int j, std::vector<uint32_t> const& neighbors) {
+                    // accumulate values
+                    float value_x = 0, value_y = 0, value_z = 0, value_w = 0;
+                    for (auto const n : neighbors) {
+                        value_x += data_x[n];
+                        value_y += data_y[n];
+                        value_z += data_z[n];
+                        value_w += data_w[n];
+                    } // end num_neighbors
+                    samples[j][0] = value_x / neighbors.size();
+                    samples[j][1] = value_y / neighbors.size();
+                    samples[j][2] = value_z / neighbors.size();
+                    samples[j][3] = value_w / neighbors.size();
+                });
+        } // end for probes
+    }
 }
 
 
@@ -5,8 +5,14 @@
  */
 
 #include "SurfaceNets.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include "mmcore/param/BoolParam.h"
 #include "mmcore/param/FloatParam.h"
 #include "mmcore/param/EnumParam.h"
+#include "mmcore/param/IntParam.h"
 #include "mmcore/misc/VolumetricDataCall.h"
 #include "mmcore/moldyn/MultiParticleDataCall.h"
 
@@ -20,7 +26,9 @@ SurfaceNets::SurfaceNets()
     , _deployMeshCall("deployMesh", "")
     , _deployNormalsCall("deployNormals", "")
     , _isoSlot("IsoValue", "")
-    , _faceTypeSlot("FaceType", "") {
+    , _faceTypeSlot("FaceType", "")
+    , _levelSlot("VolumeLevel", "Level of the resolution pyramid of the volume, if the source provides one")
+    , _incrementalSlot("Incremental", "Only re-extract bricks whose value range contains the iso value") {
 
     this->_isoSlot << new core::param::FloatParam(1.0f);
     this->_isoSlot.SetUpdateCallback(&SurfaceNets::isoChanged);
@@ -32,6 +40,14 @@ SurfaceNets::SurfaceNets()
     this->_faceTypeSlot << ep;
     this->MakeSlotAvailable(&this->_faceTypeSlot);
 
+    this->_levelSlot << new core::param::IntParam(0, 0);
+    this->_levelSlot.SetUpdateCallback(&SurfaceNets::isoChanged);
+    this->MakeSlotAvailable(&this->_levelSlot);
+
+    this->_incrementalSlot << new core::param::BoolParam(false);
+    this->_incrementalSlot.SetUpdateCallback(&SurfaceNets::isoChanged);
+    this->MakeSlotAvailable(&this->_incrementalSlot);
+
     this->_deployMeshCall.SetCallback(
         mesh::CallMesh::ClassName(), mesh::CallMesh::FunctionName(0), &SurfaceNets::getData);
     this->_deployMeshCall.SetCallback(
@@ -265,22 +281,73 @@ void SurfaceNets::calculateSurfaceNets() {
     //})();
 }
 
-void SurfaceNets::calculateSurfaceNets2() {
+void SurfaceNets::buildBlocks(bool incremental) {
 
-    _vertices.clear();
-    _faces.clear();
+    _blocks.clear();
+    _voxel_lookup.assign(static_cast<size_t>(_dims[0]) * _dims[1] * _dims[2], 0);
+    _blocks_incremental = incremental;
+    _blocks_dirty = false;
+
+    if (_dims[0] < 2 || _dims[1] < 2 || _dims[2] < 2) return;
+
+    std::array<uint32_t, 3> const cells = {_dims[0] - 1, _dims[1] - 1, _dims[2] - 1};
+
+    if (!incremental) {
+        // Slabs along z: concatenating them in order yields the same vertex and face order as a serial sweep.
+        uint32_t const slab_cnt =
+            std::max(1u, std::min(cells[2], 4 * std::max(1u, std::thread::hardware_concurrency())));
+        for (uint32_t s = 0; s < slab_cnt; ++s) {
+            Block block;
+            block.begin = {0, 0, static_cast<uint32_t>((static_cast<uint64_t>(cells[2]) * s) / slab_cnt)};
+            block.end = {cells[0], cells[1], static_cast<uint32_t>((static_cast<uint64_t>(cells[2]) * (s + 1)) / slab_cnt)};
+            if (block.end[2] > block.begin[2]) {
+                _blocks.emplace_back(std::move(block));
+            }
+        }
+        return;
+    }
+
+    for (uint32_t z = 0; z < cells[2]; z += BRICK_SIZE) {
+        for (uint32_t y = 0; y < cells[1]; y += BRICK_SIZE) {
+            for (uint32_t x = 0; x < cells[0]; x += BRICK_SIZE) {
+                Block block;
+                block.begin = {x, y, z};
+                block.end = {std::min(x + BRICK_SIZE, cells[0]), std::min(y + BRICK_SIZE, cells[1]),
+                    std::min(z + BRICK_SIZE, cells[2])};
+                _blocks.emplace_back(std::move(block));
+            }
+        }
+    }
+
+    // The range of a brick covers all samples touched by its cells, i.e. includes the far boundary layer.
+    auto const dims = _dims;
+    auto const data = _data;
+    auto const block_cnt = static_cast<int64_t>(_blocks.size());
+#pragma omp parallel for schedule(dynamic)
+    for (int64_t b = 0; b < block_cnt; ++b) {
+        auto& block = _blocks[b];
+        float min_value = std::numeric_limits<float>::max();
+        float max_value = std::numeric_limits<float>::lowest();
+        for (uint32_t z = block.begin[2]; z <= block.end[2]; ++z) {
+            for (uint32_t y = block.begin[1]; y <= block.end[1]; ++y) {
+                auto const row = data + (static_cast<size_t>(dims[0]) * dims[1] * z + static_cast<size_t>(dims[0]) * y);
+                for (uint32_t x = block.begin[0]; x <= block.end[0]; ++x) {
+                    min_value = std::min(min_value, row[x]);
+                    max_value = std::max(max_value, row[x]);
+                }
+            }
+        }
+        block.min_value = min_value;
+        block.max_value = max_value;
+    }
+}
+
+void SurfaceNets::extractBlock(Block& block, float iso_value) const {
 
-    std::array<std::array<uint32_t, 3>, 8> cube_offsets;
-    cube_offsets[0] = {0, 0, 0};
-    cube_offsets[1] = {1, 0, 0};
-    cube_offsets[2] = {0, 0, 1};
-    cube_offsets[3] = {1, 0, 1};
-    cube_offsets[4] = {0, 1, 0};
-    cube_offsets[5] = {1, 1, 0};
-    cube_offsets[6] = {0, 1, 1};
-    cube_offsets[7] = {1, 1, 1};
-
-    const std::array<uint32_t,24> edge_vertex_offsets = {// 0
+    static const std::array<std::array<uint32_t, 3>, 8> cube_offsets = {{{0, 0, 0}, {1, 0, 0}, {0, 0, 1}, {1, 0, 1},
+        {0, 1, 0}, {1, 1, 0}, {0, 1, 1}, {1, 1, 1}}};
+
+    static const std::array<uint32_t, 24> edge_vertex_offsets = {// 0
         0, 1,
         // 1
         0, 2,
@@ -305,171 +372,231 @@ void SurfaceNets::calculateSurfaceNets2() {
         // 11
         2, 6};
 
-    float const iso_value = this->_isoSlot.Param<core::param::FloatParam>()->Value();
-
-    std::vector<uint32_t> voxel_lookup(_dims[0]*_dims[1]*_dims[2]);
-    std::vector<uint32_t> voxel_filled;
-    voxel_filled.reserve(voxel_lookup.size());
-
-    std::vector<uint32_t> voxel_edge_crossings(_dims[0] * _dims[1] * _dims[2]);
-
-    auto dims = _dims;
+    // Maps the inside/outside configuration of the corners to the crossed edges.
+    static const std::array<uint16_t, 256> edge_table = []() {
+        std::array<uint16_t, 256> table;
+        for (uint32_t mask = 0; mask < 256; ++mask) {
+            uint16_t edges = 0;
+            for (uint32_t i = 0; i < 12; ++i) {
+                edges |= static_cast<uint16_t>(
+                    (((mask >> edge_vertex_offsets[i * 2 + 0]) ^ (mask >> edge_vertex_offsets[i * 2 + 1])) & 1) << i);
+            }
+            table[mask] = edges;
+        }
+        return table;
+    }();
+
+    block.vertices.clear();
+    block.normals.clear();
+    block.cells.clear();
+    block.crossings.clear();
+
+    auto const dims = _dims;
+    auto const data = _data;
+    auto const offset_now = [dims](uint32_t x, uint32_t y, uint32_t z) {
+        return static_cast<size_t>(dims[0]) * dims[1] * z + static_cast<size_t>(dims[0]) * y + x;
+    };
+    std::array<size_t, 8> corner_offsets;
+    for (uint32_t c = 0; c < 8; ++c) {
+        corner_offsets[c] = offset_now(cube_offsets[c][0], cube_offsets[c][1], cube_offsets[c][2]);
+    }
 
-    auto const offset_now = [dims](uint32_t x, uint32_t y, uint32_t z) { return dims[0] * dims[1] * z + dims[0] * y + x; };
+    for (uint32_t z = block.begin[2]; z < block.end[2]; z++) {
+        for (uint32_t y = block.begin[1]; y < block.end[1]; y++) {
+            for (uint32_t x = block.begin[0]; x < block.end[0]; x++) {
 
-    for (uint32_t z = 0; z < _dims[2] - 1; z++) {
-        for (uint32_t y = 0; y < _dims[1] - 1; y++) {
-            for (uint32_t x = 0; x < _dims[0] - 1; x++) {
+                auto const cell = offset_now(x, y, z);
 
                 std::array<float, 8> sample_value;
-                sample_value[0] =
-                    _data[offset_now(x + cube_offsets[0][0], y + cube_offsets[0][1], z + cube_offsets[0][2])];
-                sample_value[1] =
-                    _data[offset_now(x + cube_offsets[1][0], y + cube_offsets[1][1], z + cube_offsets[1][2])];
-                sample_value[2] =
-                    _data[offset_now(x + cube_offsets[2][0], y + cube_offsets[2][1], z + cube_offsets[2][2])];
-                sample_value[3] =
-                    _data[offset_now(x + cube_offsets[3][0], y + cube_offsets[3][1], z + cube_offsets[3][2])];
-                sample_value[4] =
-                    _data[offset_now(x + cube_offsets[4][0], y + cube_offsets[4][1], z + cube_offsets[4][2])];
-                sample_value[5] =
-                    _data[offset_now(x + cube_offsets[5][0], y + cube_offsets[5][1], z + cube_offsets[5][2])];
-                sample_value[6] =
-                    _data[offset_now(x + cube_offsets[6][0], y + cube_offsets[6][1], z + cube_offsets[6][2])];
-                sample_value[7] =
-                    _data[offset_now(x + cube_offsets[7][0], y + cube_offsets[7][1], z + cube_offsets[7][2])];
-
-                uint32_t edge_crossings = 0;
+                uint32_t mask = 0;
+                for (uint32_t c = 0; c < 8; ++c) {
+                    sample_value[c] = data[cell + corner_offsets[c]];
+                    mask |= static_cast<uint32_t>(sample_value[c] > iso_value) << c;
+                }
+
+                uint32_t const edge_crossings = edge_table[mask];
+                if (edge_crossings == 0) continue;
 
                 std::array<float, 3> center_of_mass = {0.0f, 0.0f, 0.0f};
                 float normalization = 0.0f;
 
-                // Compute edge crossings and center of mass
-                for (int i = 0; i < 12; ++i) {
+                // Compute center of mass of the crossed edges only
+                for (uint32_t i = 0; i < 12; ++i) {
+                    if (!((edge_crossings >> i) & 1)) continue;
+
                     uint32_t const idx_0 = edge_vertex_offsets[i * 2 + 0];
                     uint32_t const idx_1 = edge_vertex_offsets[i * 2 + 1];
 
                     auto const v_0 = sample_value[idx_0];
                     auto const v_1 = sample_value[idx_1];
 
-                    auto edge_crossing = uint32_t(!((v_0 > iso_value) == (v_1 > iso_value)));
-                    edge_crossings |= (edge_crossing << i);
-
-
-                    if (edge_crossing == 1) {
-
-                        float d = ((iso_value - v_0) / (v_1 - v_0));
-                        std::array<float, 3> mix;
-                        mix[0] = static_cast<float>(cube_offsets[idx_0][0]) * (1.0f - d) +
-                                 static_cast<float>(cube_offsets[idx_1][0]) * d;
-                        mix[1] = static_cast<float>(cube_offsets[idx_0][1]) * (1.0f - d) +
-                                 static_cast<float>(cube_offsets[idx_1][1]) * d;
-                        mix[2] = static_cast<float>(cube_offsets[idx_0][2]) * (1.0f - d) +
-                                 static_cast<float>(cube_offsets[idx_1][2]) * d;
-                        std::array<float, 3> intersect_pos;
-                        intersect_pos[0] = static_cast<float>(x) + mix[0];
-                        intersect_pos[1] = static_cast<float>(y) + mix[1];
-                        intersect_pos[2] = static_cast<float>(z) + mix[2];
-                        center_of_mass[0] += intersect_pos[0];
-                        center_of_mass[1] += intersect_pos[1];
-                        center_of_mass[2] += intersect_pos[2];
-                        normalization += 1.0f;
-                    }
+                    float d = ((iso_value - v_0) / (v_1 - v_0));
+                    std::array<float, 3> mix;
+                    mix[0] = static_cast<float>(cube_offsets[idx_0][0]) * (1.0f - d) +
+                             static_cast<float>(cube_offsets[idx_1][0]) * d;
+                    mix[1] = static_cast<float>(cube_offsets[idx_0][1]) * (1.0f - d) +
+                             static_cast<float>(cube_offsets[idx_1][1]) * d;
+                    mix[2] = static_cast<float>(cube_offsets[idx_0][2]) * (1.0f - d) +
+                             static_cast<float>(cube_offsets[idx_1][2]) * d;
+                    center_of_mass[0] += static_cast<float>(x) + mix[0];
+                    center_of_mass[1] += static_cast<float>(y) + mix[1];
+                    center_of_mass[2] += static_cast<float>(z) + mix[2];
+                    normalization += 1.0f;
                 } // for i < 12
 
-                voxel_edge_crossings[offset_now(x, y, z)] = edge_crossings;
-
-                if (normalization > 0.0f) {
-
-                    center_of_mass[0] /= normalization;
-                    center_of_mass[1] /= normalization;
-                    center_of_mass[2] /= normalization;
-
-                    std::array<float, 3> position;
-                    position[0] = ((center_of_mass[0] / _dims[0]) * _dims[0] * _spacing[0]) + _volume_origin[0];
-                    position[1] = ((center_of_mass[1] / _dims[1]) * _dims[1] * _spacing[1]) + _volume_origin[1];
-                    position[2] = ((center_of_mass[2] / _dims[2]) * _dims[2] * _spacing[2]) + _volume_origin[2];
-                    _vertices.push_back(position);
-
-                    voxel_lookup[offset_now(x, y, z)] = _vertices.size() - 1;
-                    voxel_filled.push_back(offset_now(x, y, z));
-
-                    std::array<float,3> normal;
-                    normal[0] =
-                        _data[offset_now(x >= _dims[0]-1 ? x : x + 1, y, z)] - _data[offset_now(x < 1 ? x : x - 1, y, z)];
-                    normal[1] =
-                        _data[offset_now(x, y >= _dims[1] -1 ? y : y + 1, z)] - _data[offset_now(x, y < 1 ? y : y - 1, z)];
-                    normal[2] =
-                        _data[offset_now(x, y, z>= _dims[2] -1 ? z : z + 1)] - _data[offset_now(x, y, z < 1 ? z : z - 1)];
-                    if (normal[0] <= 1e-6 && normal[1] <= 1e-6 && normal[2] <= 1e-6) {
-                        normal[0] = _data[offset_now(x >= _dims[0] - 2 ? x : x + 2, y, z)] -
-                                    _data[offset_now(x < 2 ? x : x - 2, y, z)];
-                        normal[1] = _data[offset_now(x, y >= _dims[1] - 2 ? y : y + 2, z)] -
-                                    _data[offset_now(x, y < 2 ? y : y - 2, z)];
-                        normal[2] = _data[offset_now(x, y, z >= _dims[2] - 2 ? z : z + 2)] -
-                                    _data[offset_now(x, y, z < 2 ? z : z - 2)];
-                    }
-                    auto const normal_length = std::sqrt(normal[0]*normal[0] + normal[1]*normal[1] + normal[2]*normal[2]);
-                    normal[0] /= (normal_length < 0.00000001) ? 1.0 : normal_length;
-                    normal[1] /= (normal_length < 0.00000001) ? 1.0 : normal_length;
-                    normal[2] /= (normal_length < 0.00000001) ? 1.0 : normal_length;
-                    _normals.push_back(normal);
+                center_of_mass[0] /= normalization;
+                center_of_mass[1] /= normalization;
+                center_of_mass[2] /= normalization;
+
+                std::array<float, 3> position;
+                position[0] = ((center_of_mass[0] / dims[0]) * dims[0] * _spacing[0]) + _volume_origin[0];
+                position[1] = ((center_of_mass[1] / dims[1]) * dims[1] * _spacing[1]) + _volume_origin[1];
+                position[2] = ((center_of_mass[2] / dims[2]) * dims[2] * _spacing[2]) + _volume_origin[2];
+                block.vertices.push_back(position);
+                block.cells.push_back(cell);
+                block.crossings.push_back(static_cast<uint8_t>(edge_crossings & 0x7));
+
+                std::array<float, 3> normal;
+                normal[0] =
+                    data[offset_now(x >= dims[0] - 1 ? x : x + 1, y, z)] - data[offset_now(x < 1 ? x : x - 1, y, z)];
+                normal[1] =
+                    data[offset_now(x, y >= dims[1] - 1 ? y : y + 1, z)] - data[offset_now(x, y < 1 ? y : y - 1, z)];
+                normal[2] =
+                    data[offset_now(x, y, z >= dims[2] - 1 ? z : z + 1)] - data[offset_now(x, y, z < 1 ? z : z - 1)];
+                if (normal[0] <= 1e-6 && normal[1] <= 1e-6 && normal[2] <= 1e-6) {
+                    normal[0] = data[offset_now(x >= dims[0] - 2 ? x : x + 2, y, z)] -
+                                data[offset_now(x < 2 ? x : x - 2, y, z)];
+                    normal[1] = data[offset_now(x, y >= dims[1] - 2 ? y : y + 2, z)] -
+                                data[offset_now(x, y < 2 ? y : y - 2, z)];
+                    normal[2] = data[offset_now(x, y, z >= dims[2] - 2 ? z : z + 2)] -
+                                data[offset_now(x, y, z < 2 ? z : z - 2)];
                 }
+                auto const normal_length =
+                    std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+                normal[0] /= (normal_length < 0.00000001) ? 1.0 : normal_length;
+                normal[1] /= (normal_length < 0.00000001) ? 1.0 : normal_length;
+                normal[2] /= (normal_length < 0.00000001) ? 1.0 : normal_length;
+                block.normals.push_back(normal);
             } // for x
         }     // for y
     }         // for z
-    voxel_filled.shrink_to_fit();
-
-    auto const coordinateFromLinearIndex = [](uint32_t idx, uint32_t max_x, uint32_t max_y) {
-        std::array<uint32_t,3> coords;
-        coords[0] = idx % (max_x) ;
-        idx /= (max_x);
-        coords[1] = idx % (max_y);
-        idx /= (max_y);
-        coords[2] = idx;
-        return coords;
+}
+
+void SurfaceNets::connectBlock(Block& block) const {
+
+    block.faces.clear();
+
+    auto const dims = _dims;
+    auto const offset_now = [dims](uint32_t x, uint32_t y, uint32_t z) {
+        return static_cast<size_t>(dims[0]) * dims[1] * z + static_cast<size_t>(dims[0]) * y + x;
     };
 
+    // All four cells around a crossed edge are filled, so the lookup only hits entries written in this pass.
+    for (size_t v = 0; v < block.cells.size(); ++v) {
+        auto id = block.cells[v];
+        std::array<uint32_t, 3> coords;
+        coords[0] = static_cast<uint32_t>(id % dims[0]);
+        id /= dims[0];
+        coords[1] = static_cast<uint32_t>(id % dims[1]);
+        id /= dims[1];
+        coords[2] = static_cast<uint32_t>(id);
+        if (coords[0] == 0 || coords[1] == 0 || coords[2] == 0) continue;
 
-    for (auto id : voxel_filled) {
         for (uint32_t i = 0; i < 3; ++i) {
-            auto const edge_crossing = 1 & (voxel_edge_crossings[id] >> i);
-            if (edge_crossing == 1) {
-                auto coords = coordinateFromLinearIndex(id, _dims[0], _dims[1]);
-                if (coords[0] > 0 && coords[1] > 0 && coords[2] > 0) {
-                    std::array<uint32_t, 4> indices;
-                    std::array<uint32_t, 3> triangle1;
-                    std::array<uint32_t, 3> triangle2;
-                    if (i == 0) {
-                        indices[0] = voxel_lookup[offset_now(coords[0], coords[1] - 1, coords[2])];
-                        indices[1] = voxel_lookup[offset_now(coords[0], coords[1] - 1, coords[2] - 1)];
-                        indices[2] = voxel_lookup[offset_now(coords[0], coords[1], coords[2] - 1)];
-                        indices[3] = voxel_lookup[offset_now(coords[0], coords[1], coords[2])]; // or just id
-                    } else if (i == 1) {
-                        indices[0] = voxel_lookup[offset_now(coords[0] - 1, coords[1] - 1, coords[2])];
-                        indices[1] = voxel_lookup[offset_now(coords[0], coords[1] - 1, coords[2])];
-                        indices[2] = voxel_lookup[offset_now(coords[0], coords[1], coords[2])];
-                        indices[3] = voxel_lookup[offset_now(coords[0] - 1, coords[1], coords[2])];
-                    } else if (i == 2) {
-                        indices[0] = voxel_lookup[offset_now(coords[0] - 1, coords[1], coords[2])];
-                        indices[1] = voxel_lookup[offset_now(coords[0], coords[1], coords[2])];
-                        indices[2] = voxel_lookup[offset_now(coords[0], coords[1], coords[2] - 1)];
-                        indices[3] = voxel_lookup[offset_now(coords[0] - 1, coords[1], coords[2] - 1)];
-                    }
-                    triangle1[0] = indices[0];
-                    triangle1[1] = indices[1];
-                    triangle1[2] = indices[2];
-                    triangle2[0] = indices[0];
-                    triangle2[1] = indices[2];
-                    triangle2[2] = indices[3];
-
-                    _faces.emplace_back(indices);
-                    _triangles.emplace_back(triangle1);
-                    _triangles.emplace_back(triangle2);
-                }
+            if (!((block.crossings[v] >> i) & 1)) continue;
+
+            std::array<uint32_t, 4> indices;
+            if (i == 0) {
+                indices[0] = _voxel_lookup[offset_now(coords[0], coords[1] - 1, coords[2])];
+                indices[1] = _voxel_lookup[offset_now(coords[0], coords[1] - 1, coords[2] - 1)];
+                indices[2] = _voxel_lookup[offset_now(coords[0], coords[1], coords[2] - 1)];
+                indices[3] = _voxel_lookup[offset_now(coords[0], coords[1], coords[2])];
+            } else if (i == 1) {
+                indices[0] = _voxel_lookup[offset_now(coords[0] - 1, coords[1] - 1, coords[2])];
+                indices[1] = _voxel_lookup[offset_now(coords[0], coords[1] - 1, coords[2])];
+                indices[2] = _voxel_lookup[offset_now(coords[0], coords[1], coords[2])];
+                indices[3] = _voxel_lookup[offset_now(coords[0] - 1, coords[1], coords[2])];
+            } else {
+                indices[0] = _voxel_lookup[offset_now(coords[0] - 1, coords[1], coords[2])];
+                indices[1] = _voxel_lookup[offset_now(coords[0], coords[1], coords[2])];
+                indices[2] = _voxel_lookup[offset_now(coords[0], coords[1], coords[2] - 1)];
+                indices[3] = _voxel_lookup[offset_now(coords[0] - 1, coords[1], coords[2] - 1)];
             }
+            block.faces.emplace_back(indices);
         } // for i < 3
-    } // for voxel_filled
+    }
+}
+
+void SurfaceNets::calculateSurfaceNets2() {
+
+    float const iso_value = this->_isoSlot.Param<core::param::FloatParam>()->Value();
+    bool const incremental = this->_incrementalSlot.Param<core::param::BoolParam>()->Value();
+
+    if (_blocks_dirty || incremental != _blocks_incremental) {
+        this->buildBlocks(incremental);
+    }
+
+    // Extract the vertices of each block with block-local numbering. In incremental mode, bricks whose value range
+    // does not contain the iso value cannot produce a vertex and are skipped.
+    auto const block_cnt = static_cast<int64_t>(_blocks.size());
+#pragma omp parallel for schedule(dynamic)
+    for (int64_t b = 0; b < block_cnt; ++b) {
+        auto& block = _blocks[b];
+        if (incremental && !(block.min_value <= iso_value && block.max_value > iso_value)) {
+            if (!block.cells.empty()) {
+                block.vertices.clear();
+                block.normals.clear();
+                block.cells.clear();
+                block.crossings.clear();
+            }
+            continue;
+        }
+        this->extractBlock(block, iso_value);
+    }
+
+    // Prefix sum over the vertex counts gives the global numbering.
+    std::vector<size_t> vertex_offsets(_blocks.size() + 1, 0);
+    for (size_t b = 0; b < _blocks.size(); ++b) {
+        vertex_offsets[b + 1] = vertex_offsets[b] + _blocks[b].vertices.size();
+    }
+    _vertices.resize(vertex_offsets.back());
+    _normals.resize(vertex_offsets.back());
+
+#pragma omp parallel for schedule(dynamic)
+    for (int64_t b = 0; b < block_cnt; ++b) {
+        auto const& block = _blocks[b];
+        auto const offset = vertex_offsets[b];
+        std::copy(block.vertices.begin(), block.vertices.end(), _vertices.begin() + offset);
+        std::copy(block.normals.begin(), block.normals.end(), _normals.begin() + offset);
+        for (size_t v = 0; v < block.cells.size(); ++v) {
+            _voxel_lookup[block.cells[v]] = static_cast<uint32_t>(offset + v);
+        }
+    }
+
+    // Faces may reference vertices of neighbouring blocks, so they are built once all vertices are numbered.
+#pragma omp parallel for schedule(dynamic)
+    for (int64_t b = 0; b < block_cnt; ++b) {
+        this->connectBlock(_blocks[b]);
+    }
+
+    std::vector<size_t> face_offsets(_blocks.size() + 1, 0);
+    for (size_t b = 0; b < _blocks.size(); ++b) {
+        face_offsets[b + 1] = face_offsets[b] + _blocks[b].faces.size();
+    }
+    _faces.resize(face_offsets.back());
+    _triangles.resize(2 * face_offsets.back());
+
+#pragma omp parallel for schedule(dynamic)
+    for (int64_t b = 0; b < block_cnt; ++b) {
+        auto const& block = _blocks[b];
+        auto const offset = face_offsets[b];
+        for (size_t f = 0; f < block.faces.size(); ++f) {
+            auto const& indices = block.faces[f];
+            _faces[offset + f] = indices;
+            _triangles[2 * (offset + f) + 0] = {indices[0], indices[1], indices[2]};
+            _triangles[2 * (offset + f) + 1] = {indices[0], indices[2], indices[3]};
+        }
+    }
 }
 
 bool SurfaceNets::getData(core::Call& call) {
@@ -483,9 +610,12 @@ bool SurfaceNets::getData(core::Call& call) {
     if (cd == nullptr) return false;
 
     // get data from adios
-    if (cd->DataHash() != _old_datahash) {
+    const auto level = static_cast<unsigned int>(this->_levelSlot.Param<core::param::IntParam>()->Value());
+    if (cd->DataHash() != _old_datahash || cd->GetRequestedLevel() != level) {
+        cd->SetRequestedLevel(level);
         if (!(*cd)(core::misc::VolumetricDataCall::IDX_GET_DATA)) return false;
         something_changed = true;
+        _blocks_dirty = true;
 
         auto mesh_meta_data = cm->getMetaData();
         mesh_meta_data.m_bboxs = cd->AccessBoundingBoxes();
@@ -592,9 +722,12 @@ bool SurfaceNets::getNormalData(core::Call& call) {
     auto cd = this->_getDataCall.CallAs<core::misc::VolumetricDataCall>();
     if (cd == nullptr) return false;
 
-    if (cd->DataHash() != _old_datahash) {
+    const auto level = static_cast<unsigned int>(this->_levelSlot.Param<core::param::IntParam>()->Value());
+    if (cd->DataHash() != _old_datahash || cd->GetRequestedLevel() != level) {
+        cd->SetRequestedLevel(level);
         if (!(*cd)(core::misc::VolumetricDataCall::IDX_GET_DATA)) return false;
         something_changed = true;
+        _blocks_dirty = true;
     }
 
     _dims[0] = cd->GetResolution(0);
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <cstdlib>
+#include <vector>
 #include "concave_hull.h"
 #include "mesh/MeshCalls.h"
 #include "mmcore/CalleeSlot.h"
@@ -58,14 +59,43 @@ protected:
 
     core::param::ParamSlot _isoSlot;
     core::param::ParamSlot _faceTypeSlot;
+    core::param::ParamSlot _levelSlot;
+    core::param::ParamSlot _incrementalSlot;
 
 
 private:
+    /** Edge length of the bricks in cells used in incremental mode */
+    static const uint32_t BRICK_SIZE = 32;
+
+    /**
+     * Part of the cell grid that is extracted independently. Without incremental mode these are slabs along z,
+     * otherwise bricks of BRICK_SIZE^3 cells.
+     */
+    struct Block {
+        std::array<uint32_t, 3> begin = {0, 0, 0}; // first cell
+        std::array<uint32_t, 3> end = {0, 0, 0};   // one past the last cell
+
+        // value range of all samples touched by the cells, only computed in incremental mode
+        float min_value = 0.0f;
+        float max_value = 0.0f;
+
+        // extracted vertices with block-local numbering
+        std::vector<std::array<float, 3>> vertices;
+        std::vector<std::array<float, 3>> normals;
+        std::vector<size_t> cells;       // linear grid index of the cell of each vertex
+        std::vector<uint8_t> crossings;  // crossings of the three edges leaving corner 0 of each cell
+        std::vector<std::array<uint32_t, 4>> faces;
+    };
+
     bool InterfaceIsDirty();
 
     void calculateSurfaceNets();
     void calculateSurfaceNets2();
 
+    void buildBlocks(bool incremental);
+    void extractBlock(Block& block, float iso_value) const;
+    void connectBlock(Block& block) const;
+
     bool getMetaData(core::Call& call);
     bool getData(core::Call& call);
 
@@ -94,6 +124,12 @@ private:
     std::vector<std::array<float, 3>> _normals;
     std::vector<std::array<uint32_t, 4>> _faces;
     std::vector<std::array<uint32_t, 3>> _triangles;
+
+    // blocks and the global vertex index of each filled cell
+    std::vector<Block> _blocks;
+    std::vector<uint32_t> _voxel_lookup;
+    bool _blocks_dirty = true;
+    bool _blocks_incremental = false;
 };
 
 } // namespace probe
@@ -170,21 +170,13 @@ bool megamol::probe_gl::ProbeBillboardGlyphRenderTasks::getDataCallback(core::Ca
 
                     assert(probe_cnt <= (gpu_mtl_storage->getMaterials()[0].textures.size() * 2048) );
 
-                    auto generic_probe = probes->getGenericProbe(probe_idx);
-
                     GLuint64 texture_handle = gpu_mtl_storage->getMaterials()[0].textures[probe_idx / 2048]->getTextureHandle();
                     float slice_idx = probe_idx % 2048;
                     gpu_mtl_storage->getMaterials()[0].textures[probe_idx / 2048]->makeResident();
 
-                    auto visitor = [&textured_gylph_draw_commands, draw_command, scale, texture_handle, slice_idx, probe_idx, this](auto&& arg) {
-                        using T = std::decay_t<decltype(arg)>;
-
-                        auto glyph_data = createTexturedGlyphData(arg, probe_idx, texture_handle, slice_idx, scale);
-                        textured_gylph_draw_commands.push_back(draw_command);
-                        this->m_textured_glyph_data.push_back(glyph_data);
-                    };
-
-                    std::visit(visitor, generic_probe);
+                    auto glyph_data = createTexturedGlyphData(*probes, probe_idx, texture_handle, slice_idx, scale);
+                    textured_gylph_draw_commands.push_back(draw_command);
+                    this->m_textured_glyph_data.push_back(glyph_data);
                 }
             }
 
@@ -233,35 +225,29 @@ bool megamol::probe_gl::ProbeBillboardGlyphRenderTasks::getDataCallback(core::Ca
 
             for (int probe_idx = 0; probe_idx < probe_cnt; ++probe_idx) {
 
-                auto generic_probe = probes->getGenericProbe(probe_idx);
+                auto const probe_type = probes->getProbeTypeIdx(probe_idx);
 
-                auto visitor = [&vector_probe_gylph_draw_commands, &scalar_probe_gylph_draw_commands, draw_command,
-                                   scale, probe_idx, texture_handle, this](auto&& arg) {
-                    using T = std::decay_t<decltype(arg)>;
-                    if constexpr (std::is_same_v<T, probe::FloatProbe>) {
+                if (probe_type == probe::ProbeCollection::FLOAT_PROBE) {
 
-                        auto glyph_data = createScalarProbeGlyphData(arg, probe_idx, scale);
-                        glyph_data.tf_texture_handle = texture_handle;
-                        scalar_probe_gylph_draw_commands.push_back(draw_command);
-                        this->m_scalar_probe_glyph_data.push_back(glyph_data);
+                    auto glyph_data = createScalarProbeGlyphData(*probes, probe_idx, scale);
+                    glyph_data.tf_texture_handle = texture_handle;
+                    scalar_probe_gylph_draw_commands.push_back(draw_command);
+                    this->m_scalar_probe_glyph_data.push_back(glyph_data);
 
-                    } else if constexpr (std::is_same_v<T, probe::IntProbe>) {
-                        // TODO
-                    } else if constexpr (std::is_same_v<T, probe::Vec4Probe>) {
+                } else if (probe_type == probe::ProbeCollection::INT_PROBE) {
+                    // TODO
+                } else if (probe_type == probe::ProbeCollection::VEC4_PROBE) {
 
-                        auto glyph_data = createVectorProbeGlyphData(arg, probe_idx, scale);
-                        glyph_data.tf_texture_handle = texture_handle;
-                        glyph_data.tf_min = m_tf_min;
-                        glyph_data.tf_max = m_tf_max;
-                        vector_probe_gylph_draw_commands.push_back(draw_command);
-                        this->m_vector_probe_glyph_data.push_back(glyph_data);
+                    auto glyph_data = createVectorProbeGlyphData(*probes, probe_idx, scale);
+                    glyph_data.tf_texture_handle = texture_handle;
+                    glyph_data.tf_min = m_tf_min;
+                    glyph_data.tf_max = m_tf_max;
+                    vector_probe_gylph_draw_commands.push_back(draw_command);
+                    this->m_vector_probe_glyph_data.push_back(glyph_data);
 
-                    } else {
-                        // unknown probe type, throw error? do nothing?
-                    }
-                };
-
-                std::visit(visitor, generic_probe);
+                } else {
+                    // unknown probe type, throw error? do nothing?
+                }
             }
 
             // scan all scalar probes to compute global min/max
@@ -411,27 +397,32 @@ bool megamol::probe_gl::ProbeBillboardGlyphRenderTasks::getMetaDataCallback(core
 
 megamol::probe_gl::ProbeBillboardGlyphRenderTasks::GlyphScalarProbeData
 megamol::probe_gl::ProbeBillboardGlyphRenderTasks::createScalarProbeGlyphData(
-    probe::FloatProbe const& probe, int probe_id, float scale) {
+    probe::ProbeCollection const& probes, int probe_id, float scale) {
+    auto const& position = probes.getPositions()[probe_id];
+    auto const& direction = probes.getDirections()[probe_id];
+    auto const begin = probes.getBegins()[probe_id];
+    auto const samples = probes.getFloatSamples(probe_id);
+
     GlyphScalarProbeData glyph_data;
-    glyph_data.position = glm::vec4(probe.m_position[0] + probe.m_direction[0] * (probe.m_begin * 1.25f),
-        probe.m_position[1] + probe.m_direction[1] * (probe.m_begin * 1.25f),
-        probe.m_position[2] + probe.m_direction[2] * (probe.m_begin * 1.25f), 1.0f);
+    glyph_data.position = glm::vec4(position[0] + direction[0] * (begin * 1.25f),
+        position[1] + direction[1] * (begin * 1.25f),
+        position[2] + direction[2] * (begin * 1.25f), 1.0f);
 
-    glyph_data.probe_direction = glm::vec4(probe.m_direction[0], probe.m_direction[1], probe.m_direction[2], 1.0f);
+    glyph_data.probe_direction = glm::vec4(direction[0], direction[1], direction[2], 1.0f);
 
     glyph_data.scale = scale;
 
-    if (probe.getSamplingResult()->samples.size() > 32) {
+    if (samples.size() > 32) {
         // TODO print warning/error message
     }
 
-    glyph_data.min_value = probe.getSamplingResult()->min_value;
-    glyph_data.max_value = probe.getSamplingResult()->max_value;
+    glyph_data.min_value = probes.getMinValue(probe_id);
+    glyph_data.max_value = probes.getMaxValue(probe_id);
 
-    glyph_data.sample_cnt = std::min(static_cast<size_t>(32), probe.getSamplingResult()->samples.size());
+    glyph_data.sample_cnt = std::min(static_cast<size_t>(32), samples.size());
 
     for (int i = 0; i < glyph_data.sample_cnt; ++i) {
-        glyph_data.samples[i] = probe.getSamplingResult()->samples[i];
+        glyph_data.samples[i] = samples[i];
     }
 
     glyph_data.probe_id = probe_id;
@@ -441,25 +432,29 @@ megamol::probe_gl::ProbeBillboardGlyphRenderTasks::createScalarProbeGlyphData(
 
 megamol::probe_gl::ProbeBillboardGlyphRenderTasks::GlyphVectorProbeData
 megamol::probe_gl::ProbeBillboardGlyphRenderTasks::createVectorProbeGlyphData(
-    probe::Vec4Probe const& probe, int probe_id, float scale) {
+    probe::ProbeCollection const& probes, int probe_id, float scale) {
+    auto const& position = probes.getPositions()[probe_id];
+    auto const& direction = probes.getDirections()[probe_id];
+    auto const begin = probes.getBegins()[probe_id];
+    auto const samples = probes.getVec4Samples(probe_id);
 
     GlyphVectorProbeData glyph_data;
-    glyph_data.position = glm::vec4(probe.m_position[0] + probe.m_direction[0] * (probe.m_begin * 1.25f),
-        probe.m_position[1] + probe.m_direction[1] * (probe.m_begin * 1.25f),
-        probe.m_position[2] + probe.m_direction[2] * (probe.m_begin * 1.25f), 1.0f);
+    glyph_data.position = glm::vec4(position[0] + direction[0] * (begin * 1.25f),
+        position[1] + direction[1] * (begin * 1.25f),
+        position[2] + direction[2] * (begin * 1.25f), 1.0f);
 
-    glyph_data.probe_direction = glm::vec4(probe.m_direction[0], probe.m_direction[1], probe.m_direction[2], 1.0f);
+    glyph_data.probe_direction = glm::vec4(direction[0], direction[1], direction[2], 1.0f);
 
     glyph_data.scale = scale;
 
-    if (probe.getSamplingResult()->samples.size() > 32) {
+    if (samples.size() > 32) {
         // TODO print warning/error message
     }
 
-    glyph_data.sample_cnt = std::min(static_cast<size_t>(32), probe.getSamplingResult()->samples.size());
+    glyph_data.sample_cnt = std::min(static_cast<size_t>(32), samples.size());
 
     for (int i = 0; i < glyph_data.sample_cnt; ++i) {
-        glyph_data.samples[i] = probe.getSamplingResult()->samples[i];
+        glyph_data.samples[i] = samples[i];
     }
 
     glyph_data.probe_id = probe_id;
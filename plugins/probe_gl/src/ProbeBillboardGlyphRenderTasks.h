@@ -123,33 +123,35 @@ private:
     std::vector<GlyphVectorProbeData> m_vector_probe_glyph_data;
     std::vector<GlyphScalarProbeData> m_scalar_probe_glyph_data;
 
-    template <typename ProbeType>
     TexturedGlyphData createTexturedGlyphData(
-        ProbeType const& probe, 
+        probe::ProbeCollection const& probes,
         int probe_id,
         GLuint64 texture_handle,
         float slice_idx,
         float scale);
 
      GlyphScalarProbeData createScalarProbeGlyphData(
-        probe::FloatProbe const& probe,
+        probe::ProbeCollection const& probes,
         int probe_id,
         float scale);
 
     GlyphVectorProbeData createVectorProbeGlyphData(
-        probe::Vec4Probe const& probe,
+        probe::ProbeCollection const& probes,
         int probe_id,
         float scale);
 };
 
-template <typename ProbeType>
 inline ProbeBillboardGlyphRenderTasks::TexturedGlyphData ProbeBillboardGlyphRenderTasks::createTexturedGlyphData(
-    ProbeType const& probe, int probe_id, GLuint64 texture_handle, float slice_idx, float scale) {
+    probe::ProbeCollection const& probes, int probe_id, GLuint64 texture_handle, float slice_idx, float scale) {
+    auto const& position = probes.getPositions()[probe_id];
+    auto const& direction = probes.getDirections()[probe_id];
+    auto const begin = probes.getBegins()[probe_id];
+
     TexturedGlyphData glyph_data;
     glyph_data.position = glm::vec4(
-        probe.m_position[0] + probe.m_direction[0] * (probe.m_begin * 1.1f),
-        probe.m_position[1] + probe.m_direction[1] * (probe.m_begin * 1.1f),
-        probe.m_position[2] + probe.m_direction[2] * (probe.m_begin * 1.1f),
+        position[0] + direction[0] * (begin * 1.1f),
+        position[1] + direction[1] * (begin * 1.1f),
+        position[2] + direction[2] * (begin * 1.1f),
         1.0f);
     glyph_data.texture_handle = texture_handle;
     glyph_data.slice_idx = slice_idx;
@@ -80,38 +80,11 @@ bool megamol::probe_gl::ProbeRenderTasks::getDataCallback(core::Call& caller) {
 
         for (int probe_idx = 0; probe_idx < probe_cnt; ++probe_idx) {
             try {
-                //auto probe = probes->getProbe<probe::FloatProbe>(probe_idx);
-
-                auto generic_probe = probes->getGenericProbe(probe_idx);
-
-                std::array<float, 3> direction;
-                std::array<float, 3> position;
-                float begin;
-                float end;
-
-                auto visitor = [&direction, &position, &begin, &end](auto&& arg) {
-                    using T = std::decay_t<decltype(arg)>;
-                    if constexpr (std::is_same_v<T, probe::FloatProbe>) {
-                        direction = arg.m_direction;
-                        position = arg.m_position;
-                        begin = arg.m_begin;
-                        end = arg.m_end;
-                    } else if constexpr (std::is_same_v<T, probe::IntProbe>) {
-                        direction = arg.m_direction;
-                        position = arg.m_position;
-                        begin = arg.m_begin;
-                        end = arg.m_end;
-                    } else if constexpr (std::is_same_v<T, probe::Vec4Probe>) {
-                        direction = arg.m_direction;
-                        position = arg.m_position;
-                        begin = arg.m_begin;
-                        end = arg.m_end;
-                    } else {
-                        // unknown probe type, throw error? do nothing?
-                    }
-                };
-
-                std::visit(visitor, generic_probe);
+                // geometry is read straight from the probe arrays, so no probe (and no samples) is copied
+                auto const& direction = probes->getDirections()[probe_idx];
+                auto const& position = probes->getPositions()[probe_idx];
+                float begin = probes->getBegins()[probe_idx];
+                float end = probes->getEnds()[probe_idx];
 
                 // TODO create and add new render task for probe
 
@@ -13,11 +13,24 @@
 #include <cmath>
 #include <math.h>
 #include "mmcore/CallVolumeData.h"
+#include "mmcore/param/BoolParam.h"
+#include "mmcore/param/FilePathParam.h"
+#include "mmcore/param/IntParam.h"
+#include "mmcore/utility/CacheFile.h"
+#include "vislib/sys/Log.h"
 #include <omp.h>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <future>
 #include <iostream>
+#include <sstream>
 #include <float.h>
 
 #define _USE_MATH_DEFINES 1
+
+using megamol::core::utility::CacheFile;
+
 /*
  * megamol::protein::AggregatedDensity::AggregatedDensity
  */
@@ -26,7 +39,10 @@ megamol::protein::AggregatedDensity::AggregatedDensity(void) :
    getZvelocitySlot("sendAggregatedZvelocity", "Sends the aggrated velocity data"), 
    is_aggregated(false),
    framecounter(0),
-   molDataCallerSlot ("getMolecularData", "Connects the aggregation with molecule data storage")
+   molDataCallerSlot ("getMolecularData", "Connects the aggregation with molecule data storage"),
+   parallelSlot("parallel", "Prefetches the frames asynchronously and bins them on multiple threads"),
+   threadsSlot("threads", "The number of binning threads (0 = OpenMP default)"),
+   cacheFileSlot("cacheFile", "The file storing the aggregated density for later runs")
 {
 
     this->getDensitySlot.SetCallback("CallVolumeData", "getData", &AggregatedDensity::getDensityCallback);
@@ -41,6 +57,15 @@ megamol::protein::AggregatedDensity::AggregatedDensity(void) :
 	this->molDataCallerSlot.SetCompatibleCall<megamol::protein_calls::MolecularDataCallDescription>();
     this->MakeSlotAvailable (&this->molDataCallerSlot);
 
+    this->parallelSlot << new megamol::core::param::BoolParam(false);
+    this->MakeSlotAvailable(&this->parallelSlot);
+
+    this->threadsSlot << new megamol::core::param::IntParam(0, 0);
+    this->MakeSlotAvailable(&this->threadsSlot);
+
+    this->cacheFileSlot << new megamol::core::param::FilePathParam("");
+    this->MakeSlotAvailable(&this->cacheFileSlot);
+
 	pdbfilename="K.pdb";
 	xtcfilenames.push_back("K.xtc");
 
@@ -171,15 +196,29 @@ bool megamol::protein::AggregatedDensity::aggregate() {
 // this number must remain constant!
 	unsigned int n_atoms = mol->AtomCount();
 
+    const vislib::TString cacheFile = this->cacheFileSlot.Param<megamol::core::param::FilePathParam>()->Value();
+    const std::string key = this->cacheKey(*mol);
+    if (!cacheFile.IsEmpty() && this->loadCache(key)) {
+        mol->Unlock();
+        is_aggregated = true;
+        return true;
+    }
+
+    if (this->parallelSlot.Param<megamol::core::param::BoolParam>()->Value()) {
+        if (!this->aggregateParallel(mol, n_atoms)) return false;
+    } else {
 	float * pos0 = new float[mol->AtomCount() * 3];
 	float * vel  = new float[mol->AtomCount() * 3];
 	memcpy( pos0, mol->AtomPositions(), mol->AtomCount() * 3 * sizeof( float));
+	mol->Unlock();
 
 	for (unsigned int frame=0; frame < mol->FrameCount(); frame++) {
 		mol->SetFrameID(frame);
 		if (!(*mol)(megamol::protein_calls::MolecularDataCall::CallForGetData)) return false;
 		if (mol->AtomCount()!=n_atoms) {
-			delete[] pos0, vel;
+			mol->Unlock();
+			delete[] pos0;
+			delete[] vel;
 			return false;
 		}
     	const float* pos_new = mol->AtomPositions();
@@ -188,11 +227,14 @@ bool megamol::protein::AggregatedDensity::aggregate() {
 			vel[i] =  pos_new[i] - pos0[i];
 		}
 		memcpy( pos0, mol->AtomPositions(), mol->AtomCount() * 3 * sizeof( float));
+		mol->Unlock();
         this->aggregate_frame(pos0, vel, n_atoms);
         framecounter++;
 	}
 
-	delete[] pos0, vel;
+	delete[] pos0;
+	delete[] vel;
+    }
     is_aggregated = true;
     float maxdensity=0;
     float minvelocity=FLT_MAX;
@@ -212,93 +254,178 @@ bool megamol::protein::AggregatedDensity::aggregate() {
     std::cout << "The max is " << maxdensity << std::endl;
     std::cout << "The max vel is " << maxvelocity << std::endl;
     std::cout << "The min vel is " << minvelocity << std::endl;
+    if (!cacheFile.IsEmpty()) {
+        this->saveCache(key);
+    }
+    return true;
+}
+
+bool megamol::protein::AggregatedDensity::aggregateParallel(megamol::protein_calls::MolecularDataCall *mol,
+        unsigned int n_atoms) {
+    using vislib::sys::Log;
+    typedef std::chrono::steady_clock clock;
+
+    const unsigned int frameCount = mol->FrameCount();
+    const size_t cells = static_cast<size_t>(xbins) * ybins * zbins;
+    int threads = this->threadsSlot.Param<megamol::core::param::IntParam>()->Value();
+    if (threads <= 0) threads = omp_get_max_threads();
+
+    // Each thread bins its share of the atoms into its own grids, so no
+    // synchronisation is needed until the final reduction.
+    std::vector<std::vector<float>> dens(threads, std::vector<float>(cells, 0.0f));
+    std::vector<std::vector<float>> velo(threads, std::vector<float>(3 * cells, 0.0f));
+    std::vector<float> pos(mol->AtomPositions(), mol->AtomPositions() + 3 * n_atoms);
+    std::vector<float> vel(3 * n_atoms, 0.0f);
+    mol->Unlock();
+
+    const auto start = clock::now();
+    unsigned int reported = 0;
+    for (unsigned int frame = 0; frame < frameCount; frame++) {
+        // Fetch the next frame while the current one is binned.
+        std::future<bool> next;
+        if (frame + 1 < frameCount) {
+            next = mol->RequestFrameAsync(frame + 1);
+        }
+
+#pragma omp parallel num_threads(threads)
+        {
+            const int t = omp_get_thread_num();
+            const int nt = omp_get_num_threads();
+            const unsigned int first = static_cast<unsigned int>(static_cast<UINT64>(n_atoms) * t / nt);
+            const unsigned int last = static_cast<unsigned int>(static_cast<UINT64>(n_atoms) * (t + 1) / nt);
+            this->splat(pos.data(), vel.data(), first, last, dens[t].data(), velo[t].data());
+        }
+        framecounter++;
+
+        const unsigned int percent = (frame + 1) * 10 / frameCount;
+        if (percent > reported) {
+            reported = percent;
+            const std::chrono::duration<double> elapsed = clock::now() - start;
+            Log::DefaultLog.WriteInfo("Aggregated %u of %u frames (%.1f frames/s)", frame + 1, frameCount,
+                (frame + 1) / vislib::math::Max(elapsed.count(), 1.0e-6));
+        }
+
+        if (next.valid()) {
+            if (!next.get() || (mol->AtomCount() != n_atoms)) {
+                mol->Unlock();
+                Log::DefaultLog.WriteError("Unable to aggregate frame %u", frame + 1);
+                return false;
+            }
+            const float *pos_new = mol->AtomPositions();
+            for (unsigned int i = 0; i < 3 * n_atoms; i++) {
+                vel[i] = pos_new[i] - pos[i];
+                pos[i] = pos_new[i];
+            }
+            mol->Unlock();
+        }
+    }
+
+    const int cellCount = static_cast<int>(cells);
+#pragma omp parallel for
+    for (int c = 0; c < cellCount; c++) {
+        for (int t = 0; t < threads; t++) {
+            density[c] += dens[t][c];
+            velocity[3 * c + 0] += velo[t][3 * c + 0];
+            velocity[3 * c + 1] += velo[t][3 * c + 1];
+            velocity[3 * c + 2] += velo[t][3 * c + 2];
+        }
+    }
     return true;
 }
 
 bool megamol::protein::AggregatedDensity::aggregate_frame(float* pos, float* vel, unsigned int n_atoms) {
+    this->splat(pos, vel, 0, n_atoms, density, velocity);
+	return true;
+}
+
+void megamol::protein::AggregatedDensity::splat(const float *pos, const float *vel, unsigned int first,
+        unsigned int last, float *dens, float *velo) const {
 	float x, y, z, dx, dy, dz;
-	unsigned int X,Y,Z;
+	int X,Y,Z;
 	float weight;
 	unsigned int linear_index;
-	for (unsigned int i = 0; i<3*n_atoms; i++) {
+	for (unsigned int i = first; i<last; i++) {
 		x=(pos[3*i+0]-origin_x)/res; // in lattice constants
-		X=static_cast<unsigned int>(floor(x));
+		X=static_cast<int>(floor(x));
 		dx=x-X;
 		y=(pos[3*i+1]-origin_y)/res; // in lattice constants
-		Y=static_cast<unsigned int>(floor(y));
+		Y=static_cast<int>(floor(y));
 		dy=y-Y;
 		z=(pos[3*i+2]-origin_z)/res; // in lattice constants
-		Z=static_cast<unsigned int>(floor(z));
+		Z=static_cast<int>(floor(z));
 		dz=z-Z;
 
-		if (X>0 && X<xbins-1 && Y>0 && Y<ybins-1 && Z>0 && Z<zbins-1  ) {
-          //weight=1;
-          //density[X+xbins*Y+xbins*ybins*Z]+=weight;
-  		  weight=(1-dx)*(1-dy)*(1-dz);
-          linear_index = (X+0) + (Y+0)*xbins + (Z+0)*xbins*ybins;
-		  density[linear_index]+=weight;
-		  velocity[3*linear_index+0]+=weight*vel[3*i+0];
-		  velocity[3*linear_index+1]+=weight*vel[3*i+1];
-		  velocity[3*linear_index+2]+=weight*vel[3*i+2];
-
-		  weight=(1-dx)*(1-dy)*(dz);
-          linear_index = (X+0) + (Y+0)*xbins + (Z+1)*xbins*ybins;
-		  		  density[linear_index]+=weight;
-		  velocity[3*linear_index+0]+=weight*vel[3*i+0];
-		  velocity[3*linear_index+1]+=weight*vel[3*i+1];
-		  velocity[3*linear_index+2]+=weight*vel[3*i+2];
-		  
-		  weight=(1-dx)*(dy)*(1-dz);
-          linear_index = (X+0) + (Y+1)*xbins + (Z+0)*xbins*ybins;
-		  density[linear_index]+=weight;
-		  velocity[3*linear_index+0]+=weight*vel[3*i+0];
-		  velocity[3*linear_index+1]+=weight*vel[3*i+1];
-		  velocity[3*linear_index+2]+=weight*vel[3*i+2];
-
-		  weight=(1-dx)*(dy)*(dz);
-          linear_index = (X+0) + (Y+1)*xbins + (Z+1)*xbins*ybins;
-		  density[linear_index]+=weight;
-		  velocity[3*linear_index+0]+=weight*vel[3*i+0];
-		  velocity[3*linear_index+1]+=weight*vel[3*i+1];
-		  velocity[3*linear_index+2]+=weight*vel[3*i+2];
-
-		  weight=(dx)*(1-dy)*(1-dz);
-          linear_index = (X+1) + (Y+0)*xbins + (Z+0)*xbins*ybins;
-		  density[linear_index]+=weight;
-		  velocity[3*linear_index+0]+=weight*vel[3*i+0];
-		  velocity[3*linear_index+1]+=weight*vel[3*i+1];
-		  velocity[3*linear_index+2]+=weight*vel[3*i+2];
-
-		  weight=(dx)*(1-dy)*(dz);
-          linear_index = (X+1) + (Y+0)*xbins + (Z+1)*xbins*ybins;
-		  density[linear_index]+=weight;
-		  velocity[3*linear_index+0]+=weight*vel[3*i+0];
-		  velocity[3*linear_index+1]+=weight*vel[3*i+1];
-		  velocity[3*linear_index+2]+=weight*vel[3*i+2];
-		  
-		  weight=(dx)*(dy)*(1-dz);
-          linear_index = (X+1) + (Y+1)*xbins + (Z+0)*xbins*ybins;
-		  density[linear_index]+=weight;
-		  velocity[3*linear_index+0]+=weight*vel[3*i+0];
-		  velocity[3*linear_index+1]+=weight*vel[3*i+1];
-		  velocity[3*linear_index+2]+=weight*vel[3*i+2];
-
-		  weight=(dx)*(dy)*(dz);
-          linear_index = (X+1) + (Y+1)*xbins + (Z+1)*xbins*ybins;
-		  density[linear_index]+=weight;
-		  velocity[3*linear_index+0]+=weight*vel[3*i+0];
-		  velocity[3*linear_index+1]+=weight*vel[3*i+1];
-		  velocity[3*linear_index+2]+=weight*vel[3*i+2];
-
-
-
+		if (X>0 && X<static_cast<int>(xbins)-1 && Y>0 && Y<static_cast<int>(ybins)-1 && Z>0 && Z<static_cast<int>(zbins)-1  ) {
+			for (int c = 0; c < 8; c++) {
+				const int ox = (c >> 2) & 1, oy = (c >> 1) & 1, oz = c & 1;
+				weight = (ox ? dx : 1 - dx) * (oy ? dy : 1 - dy) * (oz ? dz : 1 - dz);
+				linear_index = (X+ox) + (Y+oy)*xbins + (Z+oz)*xbins*ybins;
+				dens[linear_index]+=weight;
+				velo[3*linear_index+0]+=weight*vel[3*i+0];
+				velo[3*linear_index+1]+=weight*vel[3*i+1];
+				velo[3*linear_index+2]+=weight*vel[3*i+2];
+			}
 		}
+	}
+}
 
+namespace {
 
+    /** The magic number and version of cache files */
+    const char CACHE_MAGIC[CacheFile::MAGIC_LENGTH] = {'M', 'M', 'A', 'G', 'G', 'D', 'E', 'N'};
+    const UINT32 CACHE_VERSION = 1;
 
+}
 
-	}
-	return true;
+std::string megamol::protein::AggregatedDensity::cacheKey(const megamol::protein_calls::MolecularDataCall& mol) const {
+    // The XTC file is not known to the call, so the positions of the first
+    // frame and the frame count stand in for it.
+    double checksum = 0.0;
+    for (unsigned int i = 0; i < 3 * mol.AtomCount(); i++) {
+        checksum += mol.AtomPositions()[i];
+    }
+    std::stringstream key;
+    key << CacheFile::FileKey(mol.GetPDBFilename()) << "|" << mol.AtomCount() << "|" << mol.FrameCount() << "|"
+        << checksum << "|" << origin_x << "," << origin_y << "," << origin_z << "|" << box_x << "," << box_y << ","
+        << box_z << "|" << res;
+    return key.str();
 }
 
+bool megamol::protein::AggregatedDensity::loadCache(const std::string& key) {
+    std::ifstream in(vislib::StringA(this->cacheFileSlot.Param<megamol::core::param::FilePathParam>()->Value())
+        .PeekBuffer(), std::ios::binary);
+    if (!in) return false;
+
+    const size_t cells = static_cast<size_t>(xbins) * ybins * zbins;
+    UINT32 frames;
+    if (!CacheFile::ReadHeader(in, CACHE_MAGIC, CACHE_VERSION, key) || !CacheFile::Read(in, frames)) return false;
+
+    std::vector<float> dens(cells), velo(3 * cells);
+    if (!in.read(reinterpret_cast<char*>(dens.data()), cells * sizeof(float))) return false;
+    if (!in.read(reinterpret_cast<char*>(velo.data()), 3 * cells * sizeof(float))) return false;
+    if (!CacheFile::ReadEnd(in)) return false;
+
+    memcpy(density, dens.data(), cells * sizeof(float));
+    memcpy(velocity, velo.data(), 3 * cells * sizeof(float));
+    framecounter = frames;
+    vislib::sys::Log::DefaultLog.WriteInfo("Loaded the density of %u frames from \"%s\"", frames,
+        vislib::StringA(this->cacheFileSlot.Param<megamol::core::param::FilePathParam>()->Value()).PeekBuffer());
+    return true;
+}
 
+void megamol::protein::AggregatedDensity::saveCache(const std::string& key) const {
+    const vislib::StringA path(this->cacheFileSlot.Param<megamol::core::param::FilePathParam>()->Value());
+    const size_t cells = static_cast<size_t>(xbins) * ybins * zbins;
+    std::ofstream out(path.PeekBuffer(), std::ios::binary | std::ios::trunc);
+    if (out) {
+        CacheFile::WriteHeader(out, CACHE_MAGIC, CACHE_VERSION, key);
+        CacheFile::Write(out, static_cast<UINT32>(framecounter));
+        out.write(reinterpret_cast<const char*>(density), cells * sizeof(float));
+        out.write(reinterpret_cast<const char*>(velocity), 3 * cells * sizeof(float));
+        CacheFile::WriteEnd(out);
+        out.close();
+    }
+    if (!out) {
+        vislib::sys::Log::DefaultLog.WriteWarn("Unable to write density cache file \"%s\"", path.PeekBuffer());
+    }
+}
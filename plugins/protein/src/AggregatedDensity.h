@@ -15,6 +15,9 @@
 #include "mmcore/CalleeSlot.h"
 #include "mmcore/CallerSlot.h"
 #include "mmcore/Module.h"
+#include "mmcore/param/ParamSlot.h"
+#include <string>
+#include <vector>
 
 namespace megamol { 
 	namespace protein {
@@ -64,6 +67,37 @@ class AggregatedDensity : public megamol::core::Module {
 		bool aggregate();
 		bool aggregate_frame(float* pos, float* vel, unsigned int n_atoms);
 
+        /**
+         * Aggregates all frames, fetching the next frame asynchronously
+         * while the current one is binned by multiple threads into private
+         * grids, which are summed up at the end.
+         *
+         * @param mol     The call, holding frame 0.
+         * @param n_atoms The number of atoms of every frame.
+         *
+         * @return 'true' on success, 'false' on failure.
+         */
+        bool aggregateParallel(megamol::protein_calls::MolecularDataCall *mol, unsigned int n_atoms);
+
+        /**
+         * Adds the atoms [first, last) to the given density and velocity
+         * grids using trilinear weights.
+         */
+        void splat(const float *pos, const float *vel, unsigned int first, unsigned int last,
+            float *dens, float *velo) const;
+
+        /**
+         * Answer the key identifying the trajectory and grid in the cache
+         * file.
+         */
+        std::string cacheKey(const megamol::protein_calls::MolecularDataCall& mol) const;
+
+        /** Loads the aggregated grids, answers 'false' if the file does not match 'key' */
+        bool loadCache(const std::string& key);
+
+        /** Writes the aggregated grids */
+        void saveCache(const std::string& key) const;
+
         /**
          * Implementation of 'Create'.
          *
@@ -106,6 +140,15 @@ class AggregatedDensity : public megamol::core::Module {
 		 /** MolecularDataCall caller slot */
         megamol::core::CallerSlot molDataCallerSlot;
 
+        /** Whether frames are prefetched and binned in parallel */
+        megamol::core::param::ParamSlot parallelSlot;
+
+        /** The number of binning threads */
+        megamol::core::param::ParamSlot threadsSlot;
+
+        /** The file storing the aggregated grids */
+        megamol::core::param::ParamSlot cacheFileSlot;
+
         /** The distance volume resolution */
         unsigned int volRes;
 
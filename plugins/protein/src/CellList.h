@@ -0,0 +1,443 @@
+/*
+ * CellList.h
+ *
+ * Copyright (C) 2020 by University of Stuttgart (VISUS).
+ * All rights reserved.
+ */
+
+#ifndef MMPROTEINPLUGIN_CELLLIST_H_INCLUDED
+#define MMPROTEINPLUGIN_CELLLIST_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include "vislib/Array.h"
+#include "vislib/math/Cuboid.h"
+#include "vislib/types.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <omp.h>
+
+namespace megamol {
+namespace protein {
+
+    /**
+     * Uniform grid for fixed-radius neighbour queries on atom positions.
+     *
+     * The points are sorted into the cells by a counting sort and stored as
+     * one contiguous array per grid, so a query only reads the positions of
+     * the cells around the query point. Each dimension can be periodic, in
+     * which case the bounding box passed to 'Build' is the periodic cell,
+     * points are wrapped into it and distances follow the minimum image
+     * convention. The query distance must then not exceed half the box.
+     *
+     * Large grids are built in parallel with OpenMP. Queries are const and
+     * can be issued from multiple threads, and batches of queries are
+     * processed in parallel by 'FindNeighboursInRange'.
+     */
+    template<class T> class CellList {
+    public:
+
+        /** Ctor */
+        CellList(void) : cellStart(), points(), ids(), cellOf(), counters(), counterSize(0), count(0) {
+            for (int d = 0; d < 3; ++d) {
+                this->origin[d] = static_cast<T>(0);
+                this->box[d] = static_cast<T>(0);
+                this->invCellSize[d] = static_cast<T>(0);
+                this->resolution[d] = 1;
+                this->periodic[d] = false;
+            }
+        }
+
+        /**
+         * Sets which dimensions are periodic. Takes effect with the next
+         * call of 'Build'.
+         *
+         * @param x Whether the x dimension is periodic.
+         * @param y Whether the y dimension is periodic.
+         * @param z Whether the z dimension is periodic.
+         */
+        void SetPeriodic(bool x, bool y, bool z) {
+            this->periodic[0] = x;
+            this->periodic[1] = y;
+            this->periodic[2] = z;
+        }
+
+        /**
+         * Sorts the points into the grid. The positions are copied.
+         *
+         * Points outside 'bbox' are kept in the border cells of non-periodic
+         * dimensions, so the box only affects the performance there.
+         *
+         * @param pos      The positions, three values per point.
+         * @param cnt      The number of points.
+         * @param bbox     The bounding box or periodic cell of the points.
+         * @param cellSize The edge length of the cells, usually the largest
+         *                 query distance.
+         * @param filter   Optional, points with a filter value of -1 are
+         *                 left out.
+         */
+        void Build(const T *pos, unsigned int cnt, const vislib::math::Cuboid<T>& bbox, T cellSize,
+                const int *filter = nullptr) {
+            this->setupGrid(bbox, cellSize, cnt);
+            const unsigned int cellCnt = static_cast<unsigned int>(this->cellStart.size() - 1);
+            this->cellOf.resize(cnt);
+
+            if ((cnt < PARALLEL_BUILD_COUNT) || (omp_get_max_threads() < 2)) {
+                // Counting sort: count the points per cell, compute the
+                // offset of each cell and scatter the points.
+                std::fill(this->cellStart.begin(), this->cellStart.end(), 0);
+                for (unsigned int i = 0; i < cnt; ++i) {
+                    this->cellOf[i] = ((filter != nullptr) && (filter[i] == -1)) ? cellCnt
+                        : this->cellIndex(&pos[3 * i]);
+                    if (this->cellOf[i] != cellCnt) ++this->cellStart[this->cellOf[i] + 1];
+                }
+                for (unsigned int c = 0; c < cellCnt; ++c) {
+                    this->cellStart[c + 1] += this->cellStart[c];
+                }
+                this->count = this->cellStart[cellCnt];
+                std::vector<unsigned int> fill(this->cellStart.begin(), this->cellStart.end() - 1);
+                this->ids.resize(this->count);
+                for (unsigned int i = 0; i < cnt; ++i) {
+                    if (this->cellOf[i] != cellCnt) this->ids[fill[this->cellOf[i]]++] = i;
+                }
+                this->points.resize(3 * static_cast<size_t>(this->count));
+                this->gather(pos, 0, cellCnt);
+                return;
+            }
+
+            // The same counting sort with atomic counters. The order within
+            // the cells is restored afterwards, so the result does not
+            // depend on the thread schedule.
+            const int pointCnt = static_cast<int>(cnt);
+            const int cells = static_cast<int>(cellCnt);
+            if (this->counterSize < cellCnt) {
+                this->counters.reset(new std::atomic<unsigned int>[cellCnt]);
+                this->counterSize = cellCnt;
+            }
+#pragma omp parallel for
+            for (int c = 0; c < cells; ++c) {
+                this->counters[c].store(0, std::memory_order_relaxed);
+            }
+#pragma omp parallel for
+            for (int i = 0; i < pointCnt; ++i) {
+                this->cellOf[i] = ((filter != nullptr) && (filter[i] == -1)) ? cellCnt : this->cellIndex(&pos[3 * i]);
+                if (this->cellOf[i] != cellCnt) {
+                    this->counters[this->cellOf[i]].fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+
+            // Blocked prefix sum: each thread sums its block, the block sums
+            // are scanned, and each thread adds the offset of its block.
+            std::vector<unsigned int> blockSum(omp_get_max_threads() + 1, 0);
+            this->cellStart[0] = 0;
+#pragma omp parallel num_threads(static_cast<int>(blockSum.size() - 1))
+            {
+                const int nt = omp_get_num_threads();
+                const int t = omp_get_thread_num();
+                const unsigned int first = static_cast<unsigned int>(static_cast<UINT64>(cellCnt) * t / nt);
+                const unsigned int last = static_cast<unsigned int>(static_cast<UINT64>(cellCnt) * (t + 1) / nt);
+                unsigned int sum = 0;
+                for (unsigned int c = first; c < last; ++c) {
+                    sum += this->counters[c].load(std::memory_order_relaxed);
+                    this->cellStart[c + 1] = sum;
+                }
+                blockSum[t + 1] = sum;
+#pragma omp barrier
+#pragma omp single
+                for (int i = 0; i < nt; ++i) {
+                    blockSum[i + 1] += blockSum[i];
+                }
+                // cellStart[first] belongs to the previous block and may
+                // still be updated, so the start of each cell is derived
+                // from its own end and count.
+                for (unsigned int c = first; c < last; ++c) {
+                    const unsigned int end = this->cellStart[c + 1] + blockSum[t];
+                    this->cellStart[c + 1] = end;
+                    this->counters[c].store(end - this->counters[c].load(std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+                }
+            }
+            this->count = this->cellStart[cellCnt];
+
+            this->ids.resize(this->count);
+            this->points.resize(3 * static_cast<size_t>(this->count));
+#pragma omp parallel for
+            for (int i = 0; i < pointCnt; ++i) {
+                if (this->cellOf[i] != cellCnt) {
+                    this->ids[this->counters[this->cellOf[i]].fetch_add(1, std::memory_order_relaxed)] = i;
+                }
+            }
+#pragma omp parallel for schedule(dynamic, 1024)
+            for (int c = 0; c < cells; ++c) {
+                std::sort(this->ids.begin() + this->cellStart[c], this->ids.begin() + this->cellStart[c + 1]);
+            }
+#pragma omp parallel
+            {
+                const int nt = omp_get_num_threads();
+                const int t = omp_get_thread_num();
+                this->gather(pos, static_cast<unsigned int>(static_cast<UINT64>(cellCnt) * t / nt),
+                    static_cast<unsigned int>(static_cast<UINT64>(cellCnt) * (t + 1) / nt));
+            }
+        }
+
+        /**
+         * Answer the number of points in the grid.
+         *
+         * @return The number of points.
+         */
+        inline unsigned int Count(void) const {
+            return this->count;
+        }
+
+        /**
+         * Calls 'func(index, squaredDistance)' for every point within
+         * 'distance' of 'point'. If 'func' returns 'false', the query stops.
+         *
+         * @param point    The query position.
+         * @param distance The query distance.
+         * @param func     The callback.
+         *
+         * @return 'false' if the query was stopped by 'func'.
+         */
+        template<class F> bool ForEachNeighbour(const T *point, T distance, F func) const {
+            if (this->count == 0) return true;
+            const T sqDist = distance * distance;
+            T p[3];
+            int lo[3], hi[3];
+            for (int d = 0; d < 3; ++d) {
+                p[d] = this->wrap(point[d], d);
+                const T rel = p[d] - this->origin[d];
+                lo[d] = static_cast<int>(std::floor((rel - distance) * this->invCellSize[d]));
+                hi[d] = static_cast<int>(std::floor((rel + distance) * this->invCellSize[d]));
+                const int res = static_cast<int>(this->resolution[d]);
+                if (this->periodic[d] && (hi[d] - lo[d] + 1 < res)) continue;
+                // Points outside the box are stored in the border cells.
+                lo[d] = std::min(std::max(lo[d], 0), res - 1);
+                hi[d] = std::max(std::min(hi[d], res - 1), 0);
+            }
+
+            for (int z = lo[2]; z <= hi[2]; ++z) {
+                const unsigned int cz = this->cellCoord(z, 2);
+                for (int y = lo[1]; y <= hi[1]; ++y) {
+                    const unsigned int cy = this->cellCoord(y, 1);
+                    for (int x = lo[0]; x <= hi[0]; ++x) {
+                        const unsigned int c = this->cellCoord(x, 0)
+                            + this->resolution[0] * (cy + this->resolution[1] * cz);
+                        const unsigned int end = this->cellStart[c + 1];
+                        for (unsigned int i = this->cellStart[c]; i < end; ++i) {
+                            const T sq = this->squaredDistance(p, &this->points[3 * i]);
+                            if ((sq <= sqDist) && !func(this->ids[i], sq)) return false;
+                        }
+                    }
+                }
+            }
+            return true;
+        }
+
+        /**
+         * Answer whether any point lies within 'distance' of 'point'.
+         *
+         * @param point    The query position.
+         * @param distance The query distance.
+         *
+         * @return 'true' if there is at least one point in range.
+         */
+        bool HasNeighbour(const T *point, T distance) const {
+            return !this->ForEachNeighbour(point, distance, [](unsigned int, T) { return false; });
+        }
+
+        /**
+         * Adds the indices of all points within 'distance' of 'point' to
+         * 'resIdx', like GridNeighbourFinder::FindNeighboursInRange.
+         *
+         * @param point    The query position.
+         * @param distance The query distance.
+         * @param resIdx   Receives the indices.
+         */
+        void FindNeighboursInRange(const T *point, T distance, vislib::Array<unsigned int>& resIdx) const {
+            this->ForEachNeighbour(point, distance, [&resIdx](unsigned int idx, T) {
+                resIdx.Add(idx);
+                return true;
+            });
+        }
+
+        /**
+         * Finds the neighbours of many query points in parallel. The indices
+         * of the neighbours of query 'i' are stored in 'indices' in the
+         * range ['offsets[i]', 'offsets[i + 1]'), in ascending order per
+         * cell.
+         *
+         * @param queries  The query positions, three values per point.
+         * @param cnt      The number of query points.
+         * @param distance The query distance.
+         * @param offsets  Receives 'cnt + 1' offsets into 'indices'.
+         * @param indices  Receives the indices of the neighbours.
+         */
+        void FindNeighboursInRange(const T *queries, unsigned int cnt, T distance,
+                std::vector<unsigned int>& offsets, std::vector<unsigned int>& indices) const {
+            // Each thread collects the neighbours of a contiguous range of
+            // queries, the parts are concatenated afterwards.
+            std::vector<std::vector<unsigned int>> parts(omp_get_max_threads());
+            std::vector<size_t> base(parts.size() + 1, 0);
+            offsets.resize(static_cast<size_t>(cnt) + 1);
+#pragma omp parallel num_threads(static_cast<int>(parts.size()))
+            {
+                const int nt = omp_get_num_threads();
+                const int t = omp_get_thread_num();
+                const unsigned int first = static_cast<unsigned int>(static_cast<UINT64>(cnt) * t / nt);
+                const unsigned int last = static_cast<unsigned int>(static_cast<UINT64>(cnt) * (t + 1) / nt);
+                std::vector<unsigned int>& part = parts[t];
+                for (unsigned int i = first; i < last; ++i) {
+                    offsets[i] = static_cast<unsigned int>(part.size());
+                    this->ForEachNeighbour(&queries[3 * i], distance, [&part](unsigned int idx, T) {
+                        part.push_back(idx);
+                        return true;
+                    });
+                }
+                base[t + 1] = part.size();
+#pragma omp barrier
+#pragma omp single
+                {
+                    for (int i = 0; i < nt; ++i) {
+                        base[i + 1] += base[i];
+                    }
+                    indices.resize(base[nt]);
+                    offsets[cnt] = static_cast<unsigned int>(base[nt]);
+                }
+                for (unsigned int i = first; i < last; ++i) {
+                    offsets[i] += static_cast<unsigned int>(base[t]);
+                }
+                std::copy(part.begin(), part.end(), indices.begin() + base[t]);
+            }
+        }
+
+    private:
+
+        /** Below this number of points, the grid is built serially */
+        static const unsigned int PARALLEL_BUILD_COUNT = 16384;
+
+        /** Copies the positions of the cells [first, last) into sorted order */
+        void gather(const T *pos, unsigned int first, unsigned int last) {
+            for (unsigned int i = this->cellStart[first]; i < this->cellStart[last]; ++i) {
+                for (int d = 0; d < 3; ++d) {
+                    this->points[3 * i + d] = this->wrap(pos[3 * this->ids[i] + d], d);
+                }
+            }
+        }
+
+        /** Computes the grid resolution and allocates the cell offsets */
+        void setupGrid(const vislib::math::Cuboid<T>& bbox, T cellSize, unsigned int cnt) {
+            const T size[3] = {bbox.Width(), bbox.Height(), bbox.Depth()};
+            this->origin[0] = bbox.Left();
+            this->origin[1] = bbox.Bottom();
+            this->origin[2] = bbox.Back();
+            cellSize = std::max(cellSize, static_cast<T>(1.0e-4));
+
+            // Limit the number of cells to a few per point, which only
+            // happens for very sparse points and small query distances.
+            const double maxCells = std::max(64.0, 4.0 * static_cast<double>(cnt));
+            double cells = 1.0;
+            for (int d = 0; d < 3; ++d) {
+                cells *= std::max(1.0, std::floor(static_cast<double>(size[d] / cellSize)));
+            }
+            if (cells > maxCells) {
+                cellSize *= static_cast<T>(std::cbrt(cells / maxCells));
+            }
+
+            size_t cellCnt = 1;
+            for (int d = 0; d < 3; ++d) {
+                this->box[d] = size[d];
+                if (size[d] <= static_cast<T>(0)) this->periodic[d] = false;
+                // Periodic cells must not be smaller than the cell size,
+                // so the minimum image always is in a neighbouring cell.
+                this->resolution[d] = std::max(1u, static_cast<unsigned int>(
+                    this->periodic[d] ? std::floor(size[d] / cellSize) : std::ceil(size[d] / cellSize)));
+                this->invCellSize[d] = this->periodic[d] ? (static_cast<T>(this->resolution[d]) / size[d])
+                    : (static_cast<T>(1) / cellSize);
+                cellCnt *= this->resolution[d];
+            }
+            this->cellStart.resize(cellCnt + 1);
+        }
+
+        /** Answer the cell of a point */
+        inline unsigned int cellIndex(const T *p) const {
+            unsigned int c[3];
+            for (int d = 0; d < 3; ++d) {
+                const int i = static_cast<int>(std::floor((this->wrap(p[d], d) - this->origin[d]) * this->invCellSize[d]));
+                c[d] = static_cast<unsigned int>(std::min(std::max(i, 0), static_cast<int>(this->resolution[d]) - 1));
+            }
+            return c[0] + this->resolution[0] * (c[1] + this->resolution[1] * c[2]);
+        }
+
+        /** Maps a cell coordinate of a query range into the grid */
+        inline unsigned int cellCoord(int i, int d) const {
+            const int res = static_cast<int>(this->resolution[d]);
+            return static_cast<unsigned int>(((i % res) + res) % res);
+        }
+
+        /** Wraps a coordinate into the periodic cell */
+        inline T wrap(T v, int d) const {
+            if (!this->periodic[d] || (this->box[d] <= static_cast<T>(0))) return v;
+            const T rel = v - this->origin[d];
+            return v - this->box[d] * std::floor(rel / this->box[d]);
+        }
+
+        /** Answer the squared (minimum image) distance of two points */
+        inline T squaredDistance(const T *a, const T *b) const {
+            T sq = static_cast<T>(0);
+            for (int d = 0; d < 3; ++d) {
+                T v = a[d] - b[d];
+                if (this->periodic[d]) {
+                    v -= this->box[d] * std::round(v / this->box[d]);
+                }
+                sq += v * v;
+            }
+            return sq;
+        }
+
+        /** The offset of each cell in 'points', plus the total count */
+        std::vector<unsigned int> cellStart;
+
+        /** The positions sorted by cell */
+        std::vector<T> points;
+
+        /** The original index of each sorted point */
+        std::vector<unsigned int> ids;
+
+        /** The cell of each input point, kept to reuse the memory */
+        std::vector<unsigned int> cellOf;
+
+        /** The per-cell counters of the parallel build */
+        std::unique_ptr<std::atomic<unsigned int>[]> counters;
+
+        /** The number of allocated 'counters' */
+        unsigned int counterSize;
+
+        /** The number of points in the grid */
+        unsigned int count;
+
+        /** The minimum corner of the grid */
+        T origin[3];
+
+        /** The size of the bounding box or periodic cell */
+        T box[3];
+
+        /** The inverse edge length of the cells */
+        T invCellSize[3];
+
+        /** The number of cells in each dimension */
+        unsigned int resolution[3];
+
+        /** Whether each dimension is periodic */
+        bool periodic[3];
+
+    };
+
+} /* end namespace protein */
+} /* end namespace megamol */
+
+#endif /* MMPROTEINPLUGIN_CELLLIST_H_INCLUDED */
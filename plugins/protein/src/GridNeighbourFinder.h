@@ -26,6 +26,8 @@ using namespace megamol;
 
 /**
  * Simple nearest-neighbour-search implementation which uses a regular grid to speed up search queries.
+ *
+ * Superseded by CellList, kept as reference for utils/NeighbourSearchBench.
  */
 namespace megamol {
 namespace protein {
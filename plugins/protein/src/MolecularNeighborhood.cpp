@@ -13,7 +13,7 @@
 #include "vislib/math/Point.h"
 #include "vislib/sys/Log.h"
 
-#include "GridNeighbourFinder.h"
+#include "CellList.h"
 
 #include <iostream>
 #include <chrono>
@@ -132,17 +132,13 @@ bool MolecularNeighborhood::getExtent(core::Call& call) {
  *	MolecularNeighborhood::findNeighborhoods
  */
 void MolecularNeighborhood::findNeighborhoods(MolecularDataCall& call, float radius) {
-	GridNeighbourFinder<float> finder;
-	finder.SetPointData(call.AtomPositions(), call.AtomCount(), call.AccessBoundingBoxes().ObjectSpaceBBox(), radius);
-	neighborhood.clear();
-	neighborhood.resize(call.AtomCount());
-	neighborhoodSizes.clear();
+	CellList<float> finder;
+	finder.Build(call.AtomPositions(), call.AtomCount(), call.AccessBoundingBoxes().ObjectSpaceBBox(), radius);
+	finder.FindNeighboursInRange(call.AtomPositions(), call.AtomCount(), radius, neighborhoodOffsets, neighborhood);
 	neighborhoodSizes.resize(call.AtomCount());
-	dataPointers.clear();
 	dataPointers.resize(call.AtomCount());
 	for (unsigned int i = 0; i < call.AtomCount(); i++) {
-		finder.FindNeighboursInRange(&call.AtomPositions()[i * 3], radius, neighborhood[i]);
-		neighborhoodSizes[i] = static_cast<unsigned int>(neighborhood[i].Count());
-		dataPointers[i] = neighborhood[i].PeekElements();
+		neighborhoodSizes[i] = neighborhoodOffsets[i + 1] - neighborhoodOffsets[i];
+		dataPointers[i] = neighborhood.data() + neighborhoodOffsets[i];
 	}
 }
\ No newline at end of file
@@ -103,8 +103,11 @@ namespace protein {
 		/** The last data set hash that was sent to the render */
 		SIZE_T lastHashSent;
 
-		/** Vector containing the neighborhood for each atom as array of atom indices */
-		std::vector<vislib::Array<unsigned int>> neighborhood;
+		/** The atom indices of the neighborhoods of all atoms */
+		std::vector<unsigned int> neighborhood;
+
+		/** The offset of the neighborhood of each atom in 'neighborhood' */
+		std::vector<unsigned int> neighborhoodOffsets;
 
 		/** Vector containing the sizes of the neighborhoods */
 		std::vector<unsigned int> neighborhoodSizes;
@@ -12,6 +12,7 @@
 #include "mmcore/param/IntParam.h"
 #include "mmcore/param/BoolParam.h"
 #include "mmcore/param/StringParam.h"
+#include "mmcore/utility/CacheFile.h"
 #include "vislib/ArrayAllocator.h"
 #include "vislib/sys/Log.h"
 #include "vislib/math/mathfunctions.h"
@@ -25,6 +26,7 @@
 #include <ctime>
 #include <iostream>
 #include <fstream>
+#include <memory>
 #include <string>
 
 #define SFB716DEMO
@@ -761,6 +763,9 @@ PDBLoader::PDBLoader(void) : AnimDataModule(),
         calcBBoxPerFrameSlot("calcBBoxPerFrame", "Calculate the bounding box for each frame separately"),
         calcBondsSlot("calculateBonds", "Calculate covalent bonds when loading the file"),
 		recomputeStridePerFrameSlot( "recomputeSTRIDEeachFrame", "If STRIDE is used, should it be recomputed each frame?"),
+        precomputeStrideSlot( "precomputeSTRIDE", "If STRIDE is used, compute it for all frames on worker threads"),
+        strideThreadsSlot( "STRIDEThreads", "The number of threads precomputing STRIDE (0 = all cores but one)"),
+        strideCacheFileSlot( "STRIDECacheFile", "The file caching the precomputed secondary structure"),
         bbox(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f),
         datahash(0),
         stride( 0), secStructAvailable( false), numXTCFrames( 0),
@@ -800,6 +805,15 @@ PDBLoader::PDBLoader(void) : AnimDataModule(),
 	this->recomputeStridePerFrameSlot << new param::BoolParam(false);
 	this->MakeSlotAvailable(&this->recomputeStridePerFrameSlot);
 
+    this->precomputeStrideSlot << new param::BoolParam(false);
+    this->MakeSlotAvailable(&this->precomputeStrideSlot);
+
+    this->strideThreadsSlot << new param::IntParam(0, 0);
+    this->MakeSlotAvailable(&this->strideThreadsSlot);
+
+    this->strideCacheFileSlot << new param::FilePathParam("");
+    this->MakeSlotAvailable(&this->strideCacheFileSlot);
+
     mdd = NULL; // no mdd object
 }
 
@@ -970,7 +984,22 @@ bool PDBLoader::getData( core::Call& call) {
     dc->SetChains( static_cast<unsigned int>(this->chain.Count()),
         (MolecularDataCall::Chain*)this->chain.PeekElements());
 
-    if( (!this->secStructAvailable || this->recomputeStridePerFrameSlot.Param<param::BoolParam>()->Value() )  && this->strideFlagSlot.Param<param::BoolParam>()->Value() ) {
+    if (this->precomputeStrideSlot.IsDirty() || this->strideThreadsSlot.IsDirty()
+            || this->strideCacheFileSlot.IsDirty()) {
+        this->precomputeStrideSlot.ResetDirty();
+        this->strideThreadsSlot.ResetDirty();
+        this->strideCacheFileSlot.ResetDirty();
+        this->strideCache.Clear();
+    }
+
+    if (this->precomputeStrideSlot.Param<param::BoolParam>()->Value()
+            && this->strideFlagSlot.Param<param::BoolParam>()->Value()) {
+        if (!this->strideCache.IsStarted()) {
+            this->startStrideCache(*dc);
+        }
+        this->strideCache.WriteToInterface(dc->FrameID(), dc);
+        this->secStructAvailable = true;
+    } else if( (!this->secStructAvailable || this->recomputeStridePerFrameSlot.Param<param::BoolParam>()->Value() )  && this->strideFlagSlot.Param<param::BoolParam>()->Value() ) {
         time_t t = clock(); // DEBUG
         if( this->stride ) delete this->stride;
         this->stride = new Stride( dc );
@@ -1041,8 +1070,10 @@ bool PDBLoader::getExtent( core::Call& call) {
  * PDBLoader::release
  */
 void PDBLoader::release(void) {
-    // stop frame-loading thread before clearing data array
+    // stop frame-loading thread and the STRIDE workers, which read the
+    // frames and the molecule, before clearing data array
     resetFrameCache();
+    this->strideCache.Clear();
 
 	for (int i = 0; i < (int)this->data.Count(); i++)
         delete data[i];
@@ -1105,6 +1136,45 @@ void PDBLoader::loadFrame( view::AnimDataModule::Frame *frame,
     //( double( clock() - t) / double( CLOCKS_PER_SEC) )); // DEBUG
 }
 
+/*
+ * PDBLoader::startStrideCache
+ */
+void PDBLoader::startStrideCache(const MolecularDataCall& mol) {
+    const vislib::TString pdbFile = this->pdbFilenameSlot.Param<core::param::FilePathParam>()->Value();
+    std::string key = core::utility::CacheFile::FileKey(pdbFile);
+    unsigned int frameCnt;
+    StrideCache::PositionSource source;
+
+    if (!this->xtcFileValid) {
+        frameCnt = vislib::math::Max(1U, static_cast<unsigned int>(this->data.Count()));
+        source = [this](unsigned int idx, std::vector<float>& pos) {
+            const float *p = this->data[idx]->AtomPositions();
+            pos.assign(p, p + 3 * this->data[idx]->AtomCount());
+            return true;
+        };
+    } else {
+        // The workers read the XTC file themselves, bypassing the frame
+        // cache of the AnimDataModule.
+        const vislib::TString xtcFile = this->xtcFilenameSlot.Param<core::param::FilePathParam>()->Value();
+        key += "|" + core::utility::CacheFile::FileKey(xtcFile);
+        frameCnt = vislib::math::Max(1U, static_cast<unsigned int>(this->numXTCFrames));
+        source = [this, xtcFile](unsigned int idx, std::vector<float>& pos) {
+            std::unique_ptr<Frame> fr(new Frame(*this));
+            fr->SetAtomCount(this->data[0]->AtomCount());
+            std::fstream file(vislib::StringA(xtcFile).PeekBuffer(), std::ios::in | std::ios::binary);
+            if (!file) return false;
+            file.seekg(this->XTCFrameOffset[idx]);
+            fr->readFrame(&file);
+            pos.assign(fr->AtomPositions(), fr->AtomPositions() + 3 * fr->AtomCount());
+            return true;
+        };
+    }
+
+    this->strideCache.Start(mol, frameCnt, source,
+        static_cast<unsigned int>(this->strideThreadsSlot.Param<param::IntParam>()->Value()),
+        this->strideCacheFileSlot.Param<param::FilePathParam>()->Value(), key);
+}
+
 /*
  * PDBLoader::loadFile
  */
@@ -2055,8 +2125,10 @@ bool PDBLoader::IsAminoAcid( vislib::StringA resName ) {
  * reset all data containers.
  */
 void PDBLoader::resetAllData() {
-    // stop frame-loading thread before clearing data array
+    // stop frame-loading thread and the STRIDE workers, which read the
+    // frames and the molecule, before clearing data array
     resetFrameCache();
+    this->strideCache.Clear();
 
     unsigned int cnt;
     //this->data.Clear();
@@ -21,6 +21,7 @@
 #include "protein_calls/MolecularDataCall.h"
 #include "ForceDataCall.h"
 #include "Stride.h"
+#include "StrideCache.h"
 #include "mmcore/view/AnimDataModule.h"
 #include "MDDriverConnector.h"
 #include <fstream>
@@ -521,6 +522,14 @@ namespace protein {
 		
 #endif
 
+        /**
+         * Starts computing the secondary structure of all frames on worker
+         * threads, or loads it from the cache file.
+         *
+         * @param mol The call holding the topology of the current data.
+         */
+        void startStrideCache(const megamol::protein_calls::MolecularDataCall& mol);
+
         /**
          * Loads a PDB file.
          *
@@ -653,6 +662,12 @@ namespace protein {
         core::param::ParamSlot calcBondsSlot;
 		/** Determine whether to recompute STRIDE each frame */
 		core::param::ParamSlot recomputeStridePerFrameSlot;
+        /** Determine whether to compute STRIDE for all frames in advance */
+        core::param::ParamSlot precomputeStrideSlot;
+        /** The number of threads computing STRIDE in advance */
+        core::param::ParamSlot strideThreadsSlot;
+        /** The file caching the precomputed secondary structure */
+        core::param::ParamSlot strideCacheFileSlot;
 
         /** The data */
         vislib::Array<Frame*> data;
@@ -708,6 +723,8 @@ namespace protein {
 
         /** Stride secondary structure computation */
         Stride *stride;
+        /** Secondary structure of all frames, computed in advance */
+        StrideCache strideCache;
         /** Flag whether secondary structure is available */
         bool secStructAvailable;
 
@@ -9,6 +9,7 @@
 #include "SolventCounter.h"
 #include "vislib/assert.h"
 #include "vislib/sys/Log.h"
+#include "mmcore/param/BoolParam.h"
 #include "mmcore/param/FloatParam.h"
 #include "protein_calls/PerAtomFloatCall.h"
 #include <omp.h>
@@ -30,6 +31,7 @@ getDataSlot("getdata", "The slot publishing the loaded data"),
 molDataSlot("moldata", "The slot requesting molecular data"),
 solDataSlot("soldata", "The slot requesting solvent data"),
 radiusParam("radius", "The search radius for solvent molecules"),
+periodicParam("periodicBoundary", "Treat the bounding box of the solvent atoms as periodic cell"),
 minValue(0.0f), midValue(0.0f), maxValue(0.0f) {
     // the data out slot
     this->getDataSlot.SetCallback(PerAtomFloatCall::ClassName(), PerAtomFloatCall::FunctionName(PerAtomFloatCall::CallForGetFloat), &SolventCounter::getDataCallback);
@@ -45,6 +47,9 @@ minValue(0.0f), midValue(0.0f), maxValue(0.0f) {
     this->radiusParam.SetParameter(new param::FloatParam(3.0f, 0.1f));
     this->MakeSlotAvailable(&this->radiusParam);
 
+    this->periodicParam.SetParameter(new param::BoolParam(false));
+    this->MakeSlotAvailable(&this->periodicParam);
+
 }
 
 
@@ -73,6 +78,34 @@ void SolventCounter::release(void) {
 }
 
 
+/*
+* SolventCounter::countSolvent
+*/
+void SolventCounter::countSolvent(const MolecularDataCall& mol, const MolecularDataCall& sol, float radius,
+        bool periodic, bool once) {
+    const float *solPos = sol.AtomPositions();
+    const float *molPos = mol.AtomPositions();
+    if ((sol.AtomCount() == 0) || (solPos == NULL) || (molPos == NULL)) return;
+
+    // The grid covers the solvent atoms, which fill the periodic cell of
+    // the simulation if the boundary is periodic.
+    vislib::math::Cuboid<float> bbox(solPos[0], solPos[1], solPos[2], solPos[0], solPos[1], solPos[2]);
+    for (unsigned int j = 1; j < sol.AtomCount(); j++) {
+        bbox.GrowToPoint(solPos[3 * j], solPos[3 * j + 1], solPos[3 * j + 2]);
+    }
+    this->solventGrid.SetPeriodic(periodic, periodic, periodic);
+    this->solventGrid.Build(solPos, sol.AtomCount(), bbox, radius);
+
+    const int atomCount = static_cast<int>(mol.AtomCount());
+#pragma omp parallel for
+    for (int i = 0; i < atomCount; i++) {
+        if (this->solventGrid.HasNeighbour(&molPos[3 * i], radius)) {
+            this->solvent[i] = once ? 1.0f : (this->solvent[i] + 1.0f);
+        }
+    }
+}
+
+
 /*
 * SolventCounter::getDataCallback
 */
@@ -95,23 +128,17 @@ bool SolventCounter::getDataCallback(core::Call& call) {
     sol->SetFrameID(dc->FrameID());
     if (!(*sol)(MolecularDataCall::CallForGetData)) return false;
 
-    if (solvent.Count() != mol->AtomCount() || this->datahash != mol->DataHash()) {
+    if (solvent.Count() != mol->AtomCount() || this->datahash != mol->DataHash()
+            || this->radiusParam.IsDirty() || this->periodicParam.IsDirty()) {
+        this->radiusParam.ResetDirty();
+        this->periodicParam.ResetDirty();
         this->solvent.Clear();
         this->solvent.SetCount(mol->AtomCount());
-        vislib::math::Vector<float, 3> molAtomPos, solAtomPos;
         for (unsigned int i = 0; i < mol->AtomCount(); i++) {
-            molAtomPos.Set(mol->AtomPositions()[3 * i],
-                mol->AtomPositions()[3 * i + 1], mol->AtomPositions()[3 * i + 2]);
             this->solvent[i] = 0.0f;
-            for (unsigned int j = 0; j < sol->AtomCount(); j++) {
-                solAtomPos.Set(sol->AtomPositions()[3 * j],
-                    sol->AtomPositions()[3 * j + 1], sol->AtomPositions()[3 * j + 2]);
-                // increase counter if the current solvent atom is within the given radius
-                if ((molAtomPos - solAtomPos).Length() <= this->radiusParam.Param<param::FloatParam>()->Value()) {
-                    this->solvent[i] = 1.0f;
-                }
-            }
         }
+        this->countSolvent(*mol, *sol, this->radiusParam.Param<param::FloatParam>()->Value(),
+            this->periodicParam.Param<param::BoolParam>()->Value(), true);
         this->datahash = mol->DataHash();
     }
     mol->Unlock();
@@ -121,7 +148,12 @@ bool SolventCounter::getDataCallback(core::Call& call) {
     if (sol->FrameCount() != mol->FrameCount()) return false;
     unsigned int frameCount = mol->FrameCount();
     // only recompute everything if this is necessary
-    if (solvent.Count() != mol->AtomCount() || this->datahash != mol->DataHash()) {
+    if (solvent.Count() != mol->AtomCount() || this->datahash != mol->DataHash()
+            || this->radiusParam.IsDirty() || this->periodicParam.IsDirty()) {
+        this->radiusParam.ResetDirty();
+        this->periodicParam.ResetDirty();
+        const float radius = this->radiusParam.Param<param::FloatParam>()->Value();
+        const bool periodic = this->periodicParam.Param<param::BoolParam>()->Value();
         // load data once...
         mol->SetFrameID(0);
         if (!(*mol)(MolecularDataCall::CallForGetData)) return false;
@@ -137,7 +169,6 @@ bool SolventCounter::getDataCallback(core::Call& call) {
         this->minValue = FLT_MAX;
         this->maxValue = FLT_MIN;
         // loop over all frames
-        vislib::math::Vector<float, 3> molAtomPos, solAtomPos;
         for (unsigned int fID = 0; fID < frameCount; fID++) {
             if ( fID % 100 == 0 )
                 vislib::sys::Log::DefaultLog.WriteInfo("Computing Frame %i", fID);
@@ -145,20 +176,8 @@ bool SolventCounter::getDataCallback(core::Call& call) {
             if (!(*mol)(MolecularDataCall::CallForGetData)) return false;
             sol->SetFrameID(fID);
             if (!(*sol)(MolecularDataCall::CallForGetData)) return false;
-            // loop over all molecule atoms and check for neighboring solvent atoms
-            for (unsigned int i = 0; i < mol->AtomCount(); i++) {
-                molAtomPos.Set(mol->AtomPositions()[3 * i],
-                    mol->AtomPositions()[3 * i + 1], mol->AtomPositions()[3 * i + 2]);
-                for (unsigned int j = 0; j < sol->AtomCount(); j++) {
-                    solAtomPos.Set(sol->AtomPositions()[3 * j],
-                        sol->AtomPositions()[3 * j + 1], sol->AtomPositions()[3 * j + 2]);
-                    // increase counter if the current solvent atom is within the given radius
-                    if ((molAtomPos - solAtomPos).Length() <= this->radiusParam.Param<param::FloatParam>()->Value()) {
-                        this->solvent[i] += 1.0f;
-                        break;
-                    }
-                }
-            }
+            // count the molecule atoms with neighboring solvent atoms
+            this->countSolvent(*mol, *sol, radius, periodic, false);
             this->datahash = mol->DataHash();
             mol->Unlock();
             sol->Unlock();
@@ -18,6 +18,7 @@
 #include "mmcore/param/ParamSlot.h"
 #include "protein_calls/MolecularDataCall.h"
 #include "vislib/Array.h"
+#include "CellList.h"
 
 
 namespace megamol {
@@ -91,6 +92,20 @@ namespace protein {
         */
         bool getDataCallback(core::Call& caller);
 
+        /**
+        * Marks the atoms of 'mol' having a solvent atom of 'sol' within
+        * 'radius' in 'solvent'.
+        *
+        * @param mol      The molecule.
+        * @param sol      The solvent.
+        * @param radius   The search radius.
+        * @param periodic Whether the bounding box of the solvent is periodic.
+        * @param once     Sets the marked values to one instead of
+        *                 incrementing them.
+        */
+        void countSolvent(const protein_calls::MolecularDataCall& mol,
+            const protein_calls::MolecularDataCall& sol, float radius, bool periodic, bool once);
+
         /** The slot for requesting data */
         core::CalleeSlot getDataSlot;
 
@@ -103,6 +118,12 @@ namespace protein {
         /** MSMS detail parameter */
         megamol::core::param::ParamSlot radiusParam;
 
+        /** Periodic boundary parameter */
+        megamol::core::param::ParamSlot periodicParam;
+
+        /** The grid of the solvent atoms of the current frame */
+        CellList<float> solventGrid;
+
         /** The array that stores the solvent around each atom */
         vislib::Array<float> solvent;
 
@@ -244,7 +244,7 @@ void megamol::protein::SolventHydroBondGenerator::calcHydroBondsForCurFrame(Mole
 
 #if 0
 	float hbondDist = hBondDistance.Param<param::FloatParam>()->Value();
-	neighbourFinder.SetPointData(atomPositions, data->AtomCount(), data->AccessBoundingBoxes().ObjectSpaceBBox(), hbondDist);
+	neighbourFinder.Build(atomPositions, data->AtomCount(), data->AccessBoundingBoxes().ObjectSpaceBBox(), hbondDist);
 
 	// looping over residues may not be a good idea?! (index-traversal?) loop over all possible acceptors ...
 #pragma omp parallel for
@@ -344,7 +344,7 @@ Wasserstoffbruecken bilden und dabei als Donor und Aktzeptor dienen koenne. Dabe
 	// only fill in donors/acceptors into the neighbour finder grid ...
 	float hbondDonorAcceptorDist = hBondDonorAcceptorDistance.Param<param::FloatParam>()->Value();
 	float hbondDonorAcceptorAngle = hBondDonorAcceptorAngle.Param<param::FloatParam>()->Value() * static_cast<float>(vislib::math::PI_DOUBLE / 180.0);
-	neighbourFinder.SetPointData(atomPositions, data->AtomCount(), data->AccessBoundingBoxes().ObjectSpaceBBox(), hbondDonorAcceptorDist, &donorAcceptors[0] );
+	neighbourFinder.Build(atomPositions, data->AtomCount(), data->AccessBoundingBoxes().ObjectSpaceBBox(), hbondDonorAcceptorDist, &donorAcceptors[0] );
 
 	const int *hydrogenConnectionsPtr = hydrogenConnections.PeekElements();
 
@@ -14,7 +14,8 @@
 #include "mmcore/param/ParamSlot.h"
 #include "mmcore/CalleeSlot.h"
 #include "mmcore/CallerSlot.h"
-#include "GridNeighbourFinder.h"
+#include "CellList.h"
+#include "vislib/math/ShallowPoint.h"
 #include "vislib/Array.h"
 #include "vislib/math/Vector.h"
 #include "vislib/math/Cuboid.h"
@@ -177,7 +178,7 @@ namespace protein {
 		vislib::Array<int> middleAtomPosHBonds;
 
 		/** our grid based neighbour finder ... */
-		GridNeighbourFinder<float> neighbourFinder;
+		CellList<float> neighbourFinder;
 
 		/** temporary variable to store the neighbour indices for the hydrogen-bound search ...*/
 		vislib::Array<unsigned int> *neighbourIndices;
@@ -829,7 +829,7 @@ bool protein::SolventVolumeRenderer::Render( Call& call ) {
 #if 0
     float dist = 50.f;
     unsigned int ai = 0;
-    gnf.SetPointData( mol->AtomPositions(), mol->AtomCount(), mol->AccessBoundingBoxes().ObjectSpaceBBox(), dist);
+    gnf.Build( mol->AtomPositions(), mol->AtomCount(), mol->AccessBoundingBoxes().ObjectSpaceBBox(), dist);
     vislib::Array<unsigned int> na;
     gnf.FindNeighboursInRange( &mol->AtomPositions()[ai*3], dist, na);
     
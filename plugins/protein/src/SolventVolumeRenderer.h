@@ -22,7 +22,7 @@
 #include "vislib/graphics/gl/SimpleFont.h"
 #include "vislib/graphics/gl/FramebufferObject.h"
 #include <list>
-#include "GridNeighbourFinder.h"
+#include "CellList.h"
 
 #define CHECK_FOR_OGL_ERROR() do { GLenum err; err = glGetError();if (err != GL_NO_ERROR) { fprintf(stderr, "%s(%d) glError: %s\n", __FILE__, __LINE__, gluErrorString(err)); } } while(0)
 
@@ -392,7 +392,7 @@ namespace protein {
 
         bool forceUpdateVolumeTexture, forceUpdateColoringMode;
 
-		megamol::protein::GridNeighbourFinder<float> gnf;
+		megamol::protein::CellList<float> gnf;
 
 		// array for rendering the solvent molecules' atoms
 		vislib::Array<float> solventAtomPos;
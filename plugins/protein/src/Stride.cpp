@@ -1761,7 +1761,7 @@ int Stride::FindAtom( CHAIN *Chain, int ResNumb, const char *Atom, int *AtNumb)
 
 char Stride::SpaceToDash( char Id)
 {
-  static char NewId;
+  char NewId;
 
   if( Id == ' ' )
     NewId = '-';
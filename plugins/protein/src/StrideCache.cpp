@@ -0,0 +1,283 @@
+/*
+ * StrideCache.cpp
+ *
+ * Copyright (C) 2020 by University of Stuttgart (VISUS).
+ * All rights reserved.
+ */
+
+#include "stdafx.h"
+#include "StrideCache.h"
+#include "Stride.h"
+#include "mmcore/utility/CacheFile.h"
+#include "vislib/sys/Log.h"
+#include <algorithm>
+#include <fstream>
+
+using namespace megamol;
+using namespace megamol::protein;
+using namespace megamol::protein_calls;
+using megamol::core::utility::CacheFile;
+
+
+namespace {
+
+    /** The magic number and version of cache files */
+    const char CACHE_MAGIC[CacheFile::MAGIC_LENGTH] = {'M', 'M', 'S', 'T', 'R', 'I', 'D', 'E'};
+    const UINT32 CACHE_VERSION = 1;
+
+}
+
+
+/*
+ * StrideCache::StrideCache
+ */
+StrideCache::StrideCache(void) : topology(), molecules(), source(), frames(), ready(), lock(), next(0), done(0),
+        cancel(false), workers(), started(), cacheFile(), key() {
+    // intentionally empty
+}
+
+
+/*
+ * StrideCache::~StrideCache
+ */
+StrideCache::~StrideCache(void) {
+    this->Clear();
+}
+
+
+/*
+ * StrideCache::Clear
+ */
+void StrideCache::Clear(void) {
+    this->cancel.store(true);
+    for (auto& w : this->workers) {
+        w.join();
+    }
+    this->workers.clear();
+    this->frames.clear();
+    this->ready.clear();
+    this->done.store(0);
+}
+
+
+/*
+ * StrideCache::Start
+ */
+void StrideCache::Start(const MolecularDataCall& mol, unsigned int frameCount, PositionSource source,
+        unsigned int threads, const vislib::TString& cacheFile, const std::string& key) {
+    using vislib::sys::Log;
+
+    this->Clear();
+    if (frameCount == 0) return;
+
+    this->molecules.assign(mol.Molecules(), mol.Molecules() + mol.MoleculeCount());
+    this->topology.SetAtoms(mol.AtomCount(), mol.AtomTypeCount(), mol.AtomTypeIndices(), nullptr, mol.AtomTypes(),
+        mol.AtomResidueIndices(), mol.AtomBFactors(), mol.AtomCharges(), mol.AtomOccupancies());
+    this->topology.SetResidues(mol.ResidueCount(), mol.Residues());
+    this->topology.SetResidueTypeNames(mol.ResidueTypeNameCount(), mol.ResidueTypeNames());
+    this->topology.SetMolecules(static_cast<unsigned int>(this->molecules.size()), this->molecules.data());
+    this->topology.SetChains(mol.ChainCount(), mol.Chains());
+
+    this->source = source;
+    this->cacheFile = cacheFile;
+    this->key = key + "|" + std::to_string(mol.AtomCount()) + "|" + std::to_string(mol.MoleculeCount());
+    this->frames.resize(frameCount);
+    this->ready.assign(frameCount, 0);
+    this->next.store(0);
+    this->done.store(0);
+    this->cancel.store(false);
+    this->started = std::chrono::steady_clock::now();
+
+    if (!this->cacheFile.IsEmpty() && this->load()) {
+        Log::DefaultLog.WriteInfo("Loaded secondary structure of %u frames from \"%s\"", frameCount,
+            vislib::StringA(this->cacheFile).PeekBuffer());
+        return;
+    }
+
+    if (threads == 0) {
+        threads = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    }
+    threads = std::min(threads, frameCount);
+    for (unsigned int i = 0; i < threads; ++i) {
+        this->workers.emplace_back(&StrideCache::work, this);
+    }
+    Log::DefaultLog.WriteInfo("Computing secondary structure of %u frames via STRIDE on %u threads", frameCount,
+        threads);
+}
+
+
+/*
+ * StrideCache::WriteToInterface
+ */
+bool StrideCache::WriteToInterface(unsigned int idx, MolecularDataCall *mol) {
+    if ((mol == nullptr) || (idx >= this->frames.size())) return false;
+
+    bool isReady;
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+        isReady = (this->ready[idx] != 0);
+    }
+    if (!isReady) {
+        std::vector<MolecularDataCall::Molecule> mols(this->molecules);
+        Frame frame;
+        this->compute(mol->AtomPositions(), mols, frame);
+        this->store(idx, frame);
+    }
+
+    // A stored frame is never changed until the cache is cleared.
+    const Frame& frame = this->frames[idx];
+    if (frame.valid) {
+        mol->SetSecondaryStructureCount(static_cast<unsigned int>(frame.secStructs.size()));
+        for (unsigned int i = 0; i < frame.secStructs.size(); ++i) {
+            mol->SetSecondaryStructure(i, frame.secStructs[i]);
+        }
+        const unsigned int molCnt = std::min(mol->MoleculeCount(),
+            static_cast<unsigned int>(frame.molSecStructs.size() / 2));
+        for (unsigned int i = 0; i < molCnt; ++i) {
+            mol->SetMoleculeSecondaryStructure(i, frame.molSecStructs[2 * i], frame.molSecStructs[2 * i + 1]);
+        }
+    }
+    mol->SetHydrogenBonds(frame.hydrogenBonds.data(), static_cast<unsigned int>(frame.hydrogenBonds.size() / 2));
+    return frame.valid;
+}
+
+
+/*
+ * StrideCache::compute
+ */
+void StrideCache::compute(const float *pos, std::vector<MolecularDataCall::Molecule>& mols, Frame& frame) const {
+    const MolecularDataCall& topo = this->topology;
+    MolecularDataCall mol;
+    mol.SetAtoms(topo.AtomCount(), topo.AtomTypeCount(), topo.AtomTypeIndices(), pos, topo.AtomTypes(),
+        topo.AtomResidueIndices(), topo.AtomBFactors(), topo.AtomCharges(), topo.AtomOccupancies());
+    mol.SetResidues(topo.ResidueCount(), topo.Residues());
+    mol.SetResidueTypeNames(topo.ResidueTypeNameCount(), topo.ResidueTypeNames());
+    mol.SetMolecules(static_cast<unsigned int>(mols.size()), mols.data());
+    mol.SetChains(topo.ChainCount(), topo.Chains());
+
+    Stride stride(&mol);
+    frame.valid = stride.WriteToInterface(&mol);
+
+    frame.secStructs.clear();
+    for (unsigned int i = 0; i < mol.SecondaryStructureCount(); ++i) {
+        frame.secStructs.push_back(mol.SecondaryStructures()[i]);
+    }
+    frame.molSecStructs.resize(2 * mols.size());
+    for (size_t i = 0; i < mols.size(); ++i) {
+        frame.molSecStructs[2 * i] = mols[i].FirstSecStructIndex();
+        frame.molSecStructs[2 * i + 1] = mols[i].SecStructCount();
+    }
+    frame.hydrogenBonds.assign(mol.GetHydrogenBonds(), mol.GetHydrogenBonds() + 2 * mol.HydrogenBondCount());
+}
+
+
+/*
+ * StrideCache::store
+ */
+void StrideCache::store(unsigned int idx, Frame& frame) {
+    bool complete = false;
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+        if (this->ready[idx] != 0) return;
+        this->frames[idx] = std::move(frame);
+        this->ready[idx] = 1;
+        complete = (this->done.fetch_add(1) + 1 == this->frames.size());
+    }
+    if (complete) {
+        const std::chrono::duration<double> d = std::chrono::steady_clock::now() - this->started;
+        vislib::sys::Log::DefaultLog.WriteInfo("Secondary structure of %u frames computed via STRIDE in %f seconds.",
+            static_cast<unsigned int>(this->frames.size()), d.count());
+        if (!this->cacheFile.IsEmpty()) this->save();
+    }
+}
+
+
+/*
+ * StrideCache::work
+ */
+void StrideCache::work(void) {
+    const size_t posCnt = 3 * static_cast<size_t>(this->topology.AtomCount());
+    std::vector<MolecularDataCall::Molecule> mols;
+    std::vector<float> pos;
+    Frame frame;
+
+    while (!this->cancel.load()) {
+        const unsigned int idx = this->next.fetch_add(1);
+        if (idx >= this->frames.size()) break;
+        {
+            std::lock_guard<std::mutex> guard(this->lock);
+            if (this->ready[idx] != 0) continue;
+        }
+        // Frames which cannot be read are left to 'WriteToInterface'.
+        if (!this->source(idx, pos) || (pos.size() < posCnt)) continue;
+        mols = this->molecules;
+        this->compute(pos.data(), mols, frame);
+        this->store(idx, frame);
+    }
+}
+
+
+/*
+ * StrideCache::load
+ */
+bool StrideCache::load(void) {
+    std::ifstream in(vislib::StringA(this->cacheFile).PeekBuffer(), std::ios::binary);
+    if (!in) return false;
+
+    UINT32 frameCnt;
+    if (!CacheFile::ReadHeader(in, CACHE_MAGIC, CACHE_VERSION, this->key)) return false;
+    if (!CacheFile::Read(in, frameCnt) || (frameCnt != this->frames.size())) return false;
+
+    std::vector<Frame> loaded(frameCnt);
+    std::vector<unsigned int> secStructs;
+    for (auto& f : loaded) {
+        unsigned char valid;
+        if (!CacheFile::Read(in, valid) || !CacheFile::ReadArray(in, secStructs) || ((secStructs.size() % 3) != 0)) return false;
+        if (!CacheFile::ReadArray(in, f.molSecStructs) || !CacheFile::ReadArray(in, f.hydrogenBonds)) return false;
+        f.valid = (valid != 0);
+        f.secStructs.resize(secStructs.size() / 3);
+        for (size_t i = 0; i < f.secStructs.size(); ++i) {
+            f.secStructs[i].SetPosition(secStructs[3 * i], secStructs[3 * i + 1]);
+            f.secStructs[i].SetType(static_cast<MolecularDataCall::SecStructure::ElementType>(secStructs[3 * i + 2]));
+        }
+    }
+    if (!CacheFile::ReadEnd(in)) return false;
+
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->frames.swap(loaded);
+    this->ready.assign(this->frames.size(), 1);
+    this->done.store(static_cast<unsigned int>(this->frames.size()));
+    return true;
+}
+
+
+/*
+ * StrideCache::save
+ */
+void StrideCache::save(void) const {
+    const vislib::StringA path(this->cacheFile);
+    std::ofstream out(path.PeekBuffer(), std::ios::binary | std::ios::trunc);
+    if (out) {
+        CacheFile::WriteHeader(out, CACHE_MAGIC, CACHE_VERSION, this->key);
+        CacheFile::Write(out, static_cast<UINT32>(this->frames.size()));
+
+        std::vector<unsigned int> secStructs;
+        for (const auto& f : this->frames) {
+            secStructs.clear();
+            for (const auto& s : f.secStructs) {
+                secStructs.push_back(s.FirstAminoAcidIndex());
+                secStructs.push_back(s.AminoAcidCount());
+                secStructs.push_back(static_cast<unsigned int>(s.Type()));
+            }
+            CacheFile::Write(out, static_cast<unsigned char>(f.valid ? 1 : 0));
+            CacheFile::WriteArray(out, secStructs);
+            CacheFile::WriteArray(out, f.molSecStructs);
+            CacheFile::WriteArray(out, f.hydrogenBonds);
+        }
+        CacheFile::WriteEnd(out);
+        out.close();
+    }
+    if (!out) {
+        vislib::sys::Log::DefaultLog.WriteWarn("Unable to write STRIDE cache file \"%s\"", path.PeekBuffer());
+    }
+}
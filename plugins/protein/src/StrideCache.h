@@ -0,0 +1,178 @@
+/*
+ * StrideCache.h
+ *
+ * Copyright (C) 2020 by University of Stuttgart (VISUS).
+ * All rights reserved.
+ */
+
+#ifndef MMPROTEINPLUGIN_STRIDECACHE_H_INCLUDED
+#define MMPROTEINPLUGIN_STRIDECACHE_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include "protein_calls/MolecularDataCall.h"
+#include "vislib/String.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace megamol {
+namespace protein {
+
+    /**
+     * Secondary structure of all frames of a trajectory.
+     *
+     * The frames are computed with STRIDE on worker threads, each of which
+     * uses its own Stride object and its own copy of the molecules. Frames
+     * requested before a worker reached them are computed on the calling
+     * thread. The results can be stored in a cache file, which is reused
+     * as long as the key passed to 'Start' does not change.
+     */
+    class StrideCache {
+    public:
+
+        /**
+         * Writes the atom positions of a frame (three floats per atom) to
+         * the given buffer. Called concurrently from the worker threads.
+         */
+        typedef std::function<bool(unsigned int frame, std::vector<float>& positions)> PositionSource;
+
+        /** Ctor */
+        StrideCache(void);
+
+        /** Dtor, stops the workers */
+        ~StrideCache(void);
+
+        /**
+         * Stops the workers and discards all frames.
+         */
+        void Clear(void);
+
+        /**
+         * Answer whether 'Start' was called since the last 'Clear'
+         *
+         * @return 'true' if frames are computed or cached
+         */
+        inline bool IsStarted(void) const {
+            return !this->frames.empty();
+        }
+
+        /**
+         * Answer the number of computed frames
+         *
+         * @return The number of computed frames
+         */
+        inline unsigned int ComputedFrames(void) const {
+            return this->done.load();
+        }
+
+        /**
+         * Loads the cache file, if it matches 'key', or starts computing all
+         * frames on the worker threads.
+         *
+         * The topology of 'mol' (atoms, residues, molecules and chains) must
+         * remain valid until the cache is cleared.
+         *
+         * @param mol        The call holding the topology of the trajectory.
+         * @param frameCount The number of frames.
+         * @param source     Provides the atom positions of the frames.
+         * @param threads    The number of worker threads, 0 for one less
+         *                   than the number of cores.
+         * @param cacheFile  The cache file or an empty string.
+         * @param key        Identifies the trajectory in the cache file.
+         */
+        void Start(const protein_calls::MolecularDataCall& mol, unsigned int frameCount, PositionSource source,
+            unsigned int threads, const vislib::TString& cacheFile, const std::string& key);
+
+        /**
+         * Writes the secondary structure and the hydrogen bonds of 'frame'
+         * to 'mol'. If the frame is not computed yet, it is computed from
+         * the atom positions currently set in 'mol'.
+         *
+         * @param frame The frame.
+         * @param mol   The call to write to.
+         *
+         * @return 'true' if STRIDE found a secondary structure.
+         */
+        bool WriteToInterface(unsigned int frame, protein_calls::MolecularDataCall *mol);
+
+    private:
+
+        /** The result of STRIDE for one frame */
+        struct Frame {
+            bool valid;
+            std::vector<protein_calls::MolecularDataCall::SecStructure> secStructs;
+            std::vector<unsigned int> molSecStructs;
+            std::vector<unsigned int> hydrogenBonds;
+        };
+
+        /**
+         * Computes 'frame' with STRIDE from the atom positions 'pos' and the
+         * stored topology. 'molecules' are the molecules of the calling
+         * thread, whose secondary structure ranges are overwritten.
+         */
+        void compute(const float *pos, std::vector<protein_calls::MolecularDataCall::Molecule>& molecules,
+            Frame& frame) const;
+
+        /** Stores 'frame' at 'idx' unless it was computed meanwhile */
+        void store(unsigned int idx, Frame& frame);
+
+        /** The worker thread loop */
+        void work(void);
+
+        /** Reads the cache file, answers 'false' if it does not match */
+        bool load(void);
+
+        /** Writes the cache file */
+        void save(void) const;
+
+        /** The topology, referencing the arrays of the loader */
+        protein_calls::MolecularDataCall topology;
+
+        /** The molecules of the topology, copied by each worker */
+        std::vector<protein_calls::MolecularDataCall::Molecule> molecules;
+
+        /** Provides the atom positions */
+        PositionSource source;
+
+        /** The results of all frames */
+        std::vector<Frame> frames;
+
+        /** Whether the frame at the same index is computed */
+        std::vector<char> ready;
+
+        /** Guards 'frames' and 'ready' */
+        mutable std::mutex lock;
+
+        /** The next frame a worker computes */
+        std::atomic<unsigned int> next;
+
+        /** The number of computed frames */
+        std::atomic<unsigned int> done;
+
+        /** Tells the workers to finish */
+        std::atomic<bool> cancel;
+
+        /** The worker threads */
+        std::vector<std::thread> workers;
+
+        /** The begin of the computation */
+        std::chrono::steady_clock::time_point started;
+
+        /** The cache file */
+        vislib::TString cacheFile;
+
+        /** Identifies the trajectory in the cache file */
+        std::string key;
+
+    };
+
+} /* end namespace protein */
+} /* end namespace megamol */
+
+#endif /* MMPROTEINPLUGIN_STRIDECACHE_H_INCLUDED */
@@ -0,0 +1,314 @@
+/*
+ * main.cpp
+ *
+ * Copyright (C) 2020 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else /* _WIN32 */
+#include <sys/resource.h>
+#endif /* _WIN32 */
+
+#include "mmcore/AbstractGetData3DCall.h"
+#include "mmcore/CoreInstance.h"
+#include "mmcore/misc/VolumetricDataCall.h"
+#include "mmcore/moldyn/MultiParticleDataCall.h"
+#include "mmcore/profiler/Tracer.h"
+#include "mmcore/special/StubModule.h"
+#include "vislib/Exception.h"
+#include "vislib/sys/Log.h"
+
+using namespace megamol;
+using megamol::core::moldyn::SimpleSphericalParticles;
+
+
+/**
+ * A data call driven by the runner and its results.
+ */
+struct Target {
+    std::string callClass;
+    std::string callee;
+    std::string sink;
+    core::Call *call = nullptr;
+
+    size_t frames = 0;
+    size_t failed = 0;
+    double extentTime = 0.0;
+    double dataTime = 0.0;
+    double minTime = 0.0;
+    double maxTime = 0.0;
+    uint64_t elements = 0;
+    uint64_t bytes = 0;
+};
+
+
+/**
+ * Answer the peak resident memory of the process in MiB.
+ */
+static double peakMemory(void) {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (::GetProcessMemoryInfo(::GetCurrentProcess(), &pmc, sizeof(pmc))) {
+        return static_cast<double>(pmc.PeakWorkingSetSize) / (1024.0 * 1024.0);
+    }
+#else /* _WIN32 */
+    struct rusage usage;
+    if (::getrusage(RUSAGE_SELF, &usage) == 0) {
+        return static_cast<double>(usage.ru_maxrss) / 1024.0; // kilobytes
+    }
+#endif /* _WIN32 */
+    return 0.0;
+}
+
+
+/**
+ * Adds the number of elements and bytes delivered by 'call'. Only the data
+ * calls of the core are measured, all other calls are only timed.
+ */
+static void countPayload(core::Call& call, uint64_t& elements, uint64_t& bytes) {
+    if (auto mpdc = dynamic_cast<core::moldyn::MultiParticleDataCall*>(&call)) {
+        for (unsigned int i = 0; i < mpdc->GetParticleListCount(); ++i) {
+            const auto& parts = mpdc->AccessParticles(i);
+            const uint64_t size = SimpleSphericalParticles::VertexDataSize[parts.GetVertexDataType()] +
+                                  SimpleSphericalParticles::ColorDataSize[parts.GetColourDataType()] +
+                                  SimpleSphericalParticles::DirDataSize[parts.GetDirDataType()] +
+                                  SimpleSphericalParticles::IDDataSize[parts.GetIDDataType()];
+            elements += parts.GetCount();
+            bytes += parts.GetCount() * size;
+        }
+    } else if (auto vdc = dynamic_cast<core::misc::VolumetricDataCall*>(&call)) {
+        if (vdc->GetMetadata() != nullptr) {
+            elements += vdc->GetVoxelsPerFrame();
+            bytes += vdc->GetFrameSize();
+        }
+    }
+}
+
+
+/**
+ * Requests the frames [first, last] of 'target' 'passes' times. Calls which
+ * are not derived from AbstractGetData3DCall have a single frame.
+ */
+static void run(Target& target, unsigned int first, unsigned int last, unsigned int passes, bool record) {
+    typedef std::chrono::high_resolution_clock clock;
+    core::Call& call = *target.call;
+    auto getData = dynamic_cast<core::AbstractGetDataCall*>(&call);
+    auto getData3D = dynamic_cast<core::AbstractGetData3DCall*>(&call);
+    auto volume = dynamic_cast<core::misc::VolumetricDataCall*>(&call);
+
+    if (getData3D != nullptr) {
+        getData3D->SetFrameID(0);
+        if (!call(1)) {
+            std::fprintf(stderr, "%s: failed to get the extent\n", target.callee.c_str());
+            ++target.failed;
+            return;
+        }
+        if (getData3D->FrameCount() == 0) return;
+        last = (std::min)(last, getData3D->FrameCount() - 1);
+    } else {
+        first = last = 0;
+    }
+
+    for (unsigned int pass = 0; pass < passes; ++pass) {
+        for (unsigned int frame = first; frame <= last; ++frame) {
+            const auto start = clock::now();
+            bool ok = true;
+            if (getData3D != nullptr) getData3D->SetFrameID(frame, true);
+            if (getData != nullptr) ok = call(1);
+            if (ok && (volume != nullptr)) ok = call(core::misc::VolumetricDataCall::IDX_GET_METADATA);
+            const auto extent = clock::now();
+            ok = ok && call(0);
+            const auto end = clock::now();
+
+            if (record) {
+                const std::chrono::duration<double, std::milli> tExtent = extent - start;
+                const std::chrono::duration<double, std::milli> tData = end - extent;
+                const double t = tExtent.count() + tData.count();
+                target.minTime = (target.frames == 0) ? t : (std::min)(target.minTime, t);
+                target.maxTime = (std::max)(target.maxTime, t);
+                target.extentTime += tExtent.count();
+                target.dataTime += tData.count();
+                ++target.frames;
+                if (ok) {
+                    countPayload(call, target.elements, target.bytes);
+                } else {
+                    ++target.failed;
+                }
+            }
+            if (getData != nullptr) getData->Unlock();
+        }
+    }
+}
+
+
+/**
+ * Prints the results of 'target'.
+ */
+static void report(const Target& target) {
+    std::printf("%s (%s): %zu frames, %zu failed\n", target.callee.c_str(), target.callClass.c_str(), target.frames,
+        target.failed);
+    if (target.frames == 0) return;
+
+    const double total = target.extentTime + target.dataTime;
+    std::printf("  per frame  min %10.3f ms  avg %10.3f ms  max %10.3f ms  (extent %.3f ms, data %.3f ms)\n",
+        target.minTime, total / target.frames, target.maxTime, target.extentTime / target.frames,
+        target.dataTime / target.frames);
+    if ((target.elements > 0) && (total > 0.0)) {
+        std::printf("  payload    %.0f elements/frame  %.3f M elements/s  %.1f MiB/s\n",
+            static_cast<double>(target.elements) / target.frames, target.elements / total * 1e-3,
+            target.bytes / total * 1000.0 / (1024.0 * 1024.0));
+    } else {
+        std::printf("  payload    not measured for this call\n");
+    }
+}
+
+
+/**
+ * Prints the command line options.
+ */
+static void usage(const char *name) {
+    std::fprintf(stderr,
+        "Usage: %s [options] <project.lua>... -t <call class> <callee slot> [-t ...]\n"
+        "Loads the projects without instantiating views and times the given data calls.\n"
+        "  -c <file>          configuration file\n"
+        "  -o <name> <value>  overrides a configuration value\n"
+        "  -t <class> <slot>  data call to drive, e.g. -t MultiParticleDataCall ::data::getdata\n"
+        "  -f <first> <last>  frame range (default: all frames)\n"
+        "  -r <passes>        timed passes over the frame range (default: 1)\n"
+        "  -w <passes>        untimed warm-up passes (default: 0)\n"
+        "  --trace <file>     writes the spans of all calls as Chrome trace\n"
+        "  -v                 echoes the core log\n",
+        name);
+}
+
+
+/*
+ * main
+ */
+int main(int argc, char **argv) {
+    std::string configFile, overrides, traceFile;
+    std::vector<std::string> projects;
+    std::vector<Target> targets;
+    unsigned int first = 0, last = UINT_MAX, passes = 1, warmUp = 0;
+    bool verbose = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg(argv[i]);
+        const int remaining = argc - i - 1;
+        if ((arg == "-c") && (remaining >= 1)) {
+            configFile = argv[++i];
+        } else if ((arg == "-o") && (remaining >= 2)) {
+            if (!overrides.empty()) overrides.append("\b");
+            overrides.append(argv[i + 1]).append("\a").append(argv[i + 2]);
+            i += 2;
+        } else if ((arg == "-t") && (remaining >= 2)) {
+            Target t;
+            t.callClass = argv[i + 1];
+            t.callee = argv[i + 2];
+            t.sink = "::headless::sink" + std::to_string(targets.size());
+            targets.push_back(t);
+            i += 2;
+        } else if ((arg == "-f") && (remaining >= 2)) {
+            first = static_cast<unsigned int>(std::strtoul(argv[i + 1], nullptr, 10));
+            last = static_cast<unsigned int>(std::strtoul(argv[i + 2], nullptr, 10));
+            i += 2;
+        } else if ((arg == "-r") && (remaining >= 1)) {
+            passes = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        } else if ((arg == "-w") && (remaining >= 1)) {
+            warmUp = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        } else if ((arg == "--trace") && (remaining >= 1)) {
+            traceFile = argv[++i];
+        } else if (arg == "-v") {
+            verbose = true;
+        } else if ((arg.size() > 0) && (arg[0] != '-')) {
+            projects.push_back(arg);
+        } else {
+            usage(argv[0]);
+            return -1;
+        }
+    }
+    if (projects.empty() || targets.empty() || (passes < 1) || (first > last)) {
+        usage(argv[0]);
+        return -1;
+    }
+
+    try {
+        std::unique_ptr<core::CoreInstance> core(new core::CoreInstance());
+        const unsigned int echoLevel = verbose ? vislib::sys::Log::LEVEL_ALL : vislib::sys::Log::LEVEL_WARN;
+        core->SetInitValue(MMC_INITVAL_LOGECHOLEVEL, MMC_TYPE_UINT32, &echoLevel);
+        if (!configFile.empty()) {
+            core->SetInitValue(MMC_INITVAL_CFGFILE, MMC_TYPE_CSTR, configFile.c_str());
+        }
+        if (!overrides.empty()) {
+            core->SetInitValue(MMC_INITVAL_CFGOVERRIDE, MMC_TYPE_CSTR, overrides.c_str());
+        }
+        core->Initialise();
+
+        // Views and jobs are never instantiated, so the projects should
+        // only create data modules.
+        for (const auto& p : projects) {
+            core->LoadProject(vislib::StringA(p.c_str()));
+        }
+        for (const auto& t : targets) {
+            core->RequestModuleInstantiation(core::special::StubModule::ClassName(), t.sink.c_str());
+            core->RequestCallInstantiation(
+                t.callClass.c_str(), (t.sink + "::inSlot").c_str(), t.callee.c_str());
+        }
+        core->PerformGraphUpdates();
+
+        for (auto& t : targets) {
+            core->EnumerateCallerSlotsNoLock<core::special::StubModule, core::Call>(
+                t.sink, [&t](core::Call& c) { t.call = &c; });
+            if (t.call == nullptr) {
+                std::fprintf(stderr, "Unable to connect %s to %s\n", t.callClass.c_str(), t.callee.c_str());
+                return -1;
+            }
+        }
+
+        std::printf("Peak memory after loading: %.1f MiB\n", peakMemory());
+        if (warmUp > 0) {
+            for (auto& t : targets) {
+                run(t, first, last, warmUp, false);
+            }
+        }
+
+        auto& tracer = core::profiler::Tracer::Instance();
+        tracer.Start();
+        for (auto& t : targets) {
+            run(t, first, last, passes, true);
+        }
+        tracer.Stop();
+
+        bool failed = false;
+        for (const auto& t : targets) {
+            report(t);
+            failed = failed || (t.failed > 0);
+        }
+        std::printf("\nTime per module:\n%s", tracer.Summary().c_str());
+        std::printf("\nPeak memory: %.1f MiB\n", peakMemory());
+        if (!traceFile.empty() && !tracer.WriteTrace(traceFile)) {
+            failed = true;
+        }
+        return failed ? 1 : 0;
+
+    } catch (vislib::Exception& ex) {
+        std::fprintf(stderr, "%s (%s; %i)\n", ex.GetMsgA(), ex.GetFile(), ex.GetLine());
+    } catch (std::exception& ex) {
+        std::fprintf(stderr, "%s\n", ex.what());
+    }
+    return -1;
+}
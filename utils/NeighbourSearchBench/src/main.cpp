@@ -0,0 +1,198 @@
+/*
+ * main.cpp
+ *
+ * Copyright (C) 2020 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <omp.h>
+#include <random>
+#include <vector>
+
+#include "CellList.h"
+#include "GridNeighbourFinder.h"
+
+using megamol::protein::CellList;
+using megamol::protein::GridNeighbourFinder;
+
+
+/**
+ * Measures the time 'f' takes in milliseconds (best of three runs).
+ */
+template<class F> static double measure(F&& f) {
+    double best = 0.0;
+    for (int r = 0; r < 3; ++r) {
+        const auto start = std::chrono::high_resolution_clock::now();
+        f();
+        const std::chrono::duration<double, std::milli> d = std::chrono::high_resolution_clock::now() - start;
+        best = (r == 0) ? d.count() : (std::min)(best, d.count());
+    }
+    return best;
+}
+
+
+/**
+ * Prints a result line.
+ */
+static void report(const char* what, const double grid, const double cells) {
+    std::printf("  %-16s GridNeighbourFinder %10.3f ms  CellList %10.3f ms  speedup %6.2fx\n", what, grid, cells,
+        grid / cells);
+}
+
+
+/**
+ * Checks the neighbours of every point found through 'cells' against
+ * 'grid'. Points whose distance is within rounding of the radius may be
+ * missing on either side, as GridNeighbourFinder compares distances and
+ * CellList squared distances.
+ *
+ * @return The number of points with differing neighbour sets.
+ */
+static unsigned int compareNeighbours(const std::vector<float>& positions, unsigned int cnt, float radius,
+        const GridNeighbourFinder<float>& grid, const CellList<float>& cells) {
+    const int points = static_cast<int>(cnt);
+    unsigned int mismatches = 0;
+#pragma omp parallel reduction(+ : mismatches)
+    {
+        vislib::Array<unsigned int> gridRes, cellRes;
+        std::vector<unsigned int> a, b, onlyOne;
+#pragma omp for schedule(dynamic, 1024)
+        for (int i = 0; i < points; ++i) {
+            gridRes.Clear();
+            cellRes.Clear();
+            grid.FindNeighboursInRange(&positions[3 * i], radius, gridRes);
+            cells.FindNeighboursInRange(&positions[3 * i], radius, cellRes);
+            a.assign(gridRes.PeekElements(), gridRes.PeekElements() + gridRes.Count());
+            b.assign(cellRes.PeekElements(), cellRes.PeekElements() + cellRes.Count());
+            std::sort(a.begin(), a.end());
+            std::sort(b.begin(), b.end());
+            onlyOne.clear();
+            std::set_symmetric_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(onlyOne));
+            for (unsigned int j : onlyOne) {
+                float d2 = 0.0f;
+                for (int k = 0; k < 3; ++k) {
+                    const float diff = positions[3 * i + k] - positions[3 * j + k];
+                    d2 += diff * diff;
+                }
+                if (std::abs(std::sqrt(d2) - radius) > 1e-4f * radius) {
+                    ++mismatches;
+                    break;
+                }
+            }
+        }
+    }
+    return mismatches;
+}
+
+
+/*
+ * main
+ */
+int main(int argc, char** argv) {
+    const size_t atoms = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const float radius = (argc > 2) ? static_cast<float>(std::atof(argv[2])) : 3.0f;
+
+    if ((atoms < 1) || (radius <= 0.0f)) {
+        std::fprintf(stderr, "Usage: %s [atoms >= 1] [radius > 0]\n", argv[0]);
+        return -1;
+    }
+
+    // Uniformly distributed atoms at about the density of water.
+    const float edge = std::cbrt(static_cast<float>(atoms) / 0.1f);
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> posDist(0.0f, edge);
+    std::vector<float> positions(3 * atoms);
+    for (auto& p : positions) {
+        p = posDist(rng);
+    }
+    const vislib::math::Cuboid<float> bbox(0.0f, 0.0f, 0.0f, edge, edge, edge);
+    const unsigned int cnt = static_cast<unsigned int>(atoms);
+    std::printf("%u atoms in a box of %.1f A, radius %.2f A\n", cnt, edge, radius);
+
+    GridNeighbourFinder<float> grid;
+    CellList<float> cells;
+
+    // GridNeighbourFinder only allocates its cells if the bounding box
+    // grows, so the first build and the rebuilds are measured separately.
+    const double tGridNew = measure([&]() {
+        GridNeighbourFinder<float> g;
+        g.SetPointData(positions.data(), cnt, bbox, radius);
+    });
+    const double tCellNew = measure([&]() {
+        CellList<float> c;
+        c.Build(positions.data(), cnt, bbox, radius);
+    });
+    report("build", tGridNew, tCellNew);
+    const double tGridBuild = measure([&]() { grid.SetPointData(positions.data(), cnt, bbox, radius); });
+    const double tCellBuild = measure([&]() { cells.Build(positions.data(), cnt, bbox, radius); });
+    report("rebuild", tGridBuild, tCellBuild);
+
+    uint64_t gridFound = 0, cellFound = 0;
+    const double tGridQuery = measure([&]() {
+        vislib::Array<unsigned int> res;
+        gridFound = 0;
+        for (unsigned int i = 0; i < cnt; ++i) {
+            res.Clear();
+            grid.FindNeighboursInRange(&positions[3 * i], radius, res);
+            gridFound += res.Count();
+        }
+    });
+    const double tCellQuery = measure([&]() {
+        vislib::Array<unsigned int> res;
+        cellFound = 0;
+        for (unsigned int i = 0; i < cnt; ++i) {
+            res.Clear();
+            cells.FindNeighboursInRange(&positions[3 * i], radius, res);
+            cellFound += res.Count();
+        }
+    });
+    report("query", tGridQuery, tCellQuery);
+
+    std::vector<unsigned int> offsets, indices;
+    const double tCellBatch = measure([&]() {
+        cells.FindNeighboursInRange(positions.data(), cnt, radius, offsets, indices);
+    });
+    report("batched query", tGridQuery, tCellBatch);
+
+    std::printf("  neighbours found: GridNeighbourFinder %llu  CellList %llu  batched %llu\n",
+        static_cast<unsigned long long>(gridFound), static_cast<unsigned long long>(cellFound),
+        static_cast<unsigned long long>(indices.size()));
+
+    // GridNeighbourFinder compares distances, CellList squared distances,
+    // so pairs right at the radius may differ by rounding.
+    const uint64_t diff = (gridFound > cellFound) ? (gridFound - cellFound) : (cellFound - gridFound);
+    bool match = (diff <= gridFound / 100000) && (cellFound == indices.size());
+
+    // The parallel build must neither lose nor misplace points, and its
+    // result must not depend on the thread schedule, so it has to equal
+    // the serial build exactly, over several runs.
+    const int threads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    CellList<float> serial;
+    serial.Build(positions.data(), cnt, bbox, radius);
+    std::vector<unsigned int> serialOffsets, serialIndices;
+    serial.FindNeighboursInRange(positions.data(), cnt, radius, serialOffsets, serialIndices);
+    omp_set_num_threads(threads);
+    unsigned int differingBuilds = 0;
+    for (int r = 0; r < 10; ++r) {
+        cells.Build(positions.data(), cnt, bbox, radius);
+        cells.FindNeighboursInRange(positions.data(), cnt, radius, offsets, indices);
+        if ((cells.Count() != serial.Count()) || (offsets != serialOffsets) || (indices != serialIndices)) {
+            ++differingBuilds;
+        }
+    }
+    const unsigned int mismatches = compareNeighbours(positions, cnt, radius, grid, cells);
+    std::printf("  %d threads: %u of 10 builds differ from the serial build, %u points with other neighbours "
+                "than GridNeighbourFinder\n",
+        threads, differingBuilds, mismatches);
+    match = match && (differingBuilds == 0) && (mismatches == 0);
+
+    return match ? 0 : 1;
+}
@@ -0,0 +1,135 @@
+/*
+ * main.cpp
+ *
+ * Copyright (C) 2020 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "StreamingPCA.h"
+
+using megamol::infovis::StreamingPCA;
+using namespace Eigen;
+
+
+/** The size of the input table */
+static const size_t ROWS = 100000;
+static const size_t COLUMNS = 12;
+
+/** The number of components kept */
+static const unsigned int COMPONENTS = 3;
+
+/** The rows per chunk, which does not divide ROWS to get a partial last chunk */
+static const size_t CHUNK_ROWS = 8192;
+
+/** Bound of the relative error of the projection, about 5e-8 when written (float output) */
+static const double ERROR_BOUND = 1e-6;
+
+
+/**
+ * Generates correlated rows with well separated variances and column means
+ * far from the origin.
+ */
+static void generate(std::vector<float>& data) {
+    std::mt19937 rng(42);
+    std::normal_distribution<double> normal;
+    MatrixXd mixing(COLUMNS, COLUMNS);
+    for (size_t i = 0; i < COLUMNS; ++i) {
+        for (size_t j = 0; j < COLUMNS; ++j) {
+            mixing(i, j) = normal(rng);
+        }
+    }
+    const MatrixXd rotation = HouseholderQR<MatrixXd>(mixing).householderQ();
+    VectorXd mean(COLUMNS);
+    for (size_t j = 0; j < COLUMNS; ++j) {
+        mean(j) = 50.0 + 10.0 * j;
+    }
+
+    data.resize(ROWS * COLUMNS);
+    VectorXd x(COLUMNS);
+    for (size_t row = 0; row < ROWS; ++row) {
+        for (size_t j = 0; j < COLUMNS; ++j) {
+            x(j) = normal(rng) * std::pow(0.6, static_cast<double>(j)) * 10.0;
+        }
+        const VectorXd y = rotation * x + mean;
+        for (size_t j = 0; j < COLUMNS; ++j) {
+            data[row * COLUMNS + j] = static_cast<float>(y(j));
+        }
+    }
+}
+
+
+/**
+ * Answers the projection by a dense PCA in double precision of the whole
+ * table, with the semantics of the exact mode of PCAProjection.
+ */
+static MatrixXd reference(const std::vector<float>& data, bool center, bool scale) {
+    MatrixXd x = Map<const Matrix<float, Dynamic, Dynamic, RowMajor>>(data.data(), ROWS, COLUMNS).cast<double>();
+    if (center) {
+        x.rowwise() -= x.colwise().mean();
+    }
+    if (scale) {
+        const VectorXd stdDev = (x.colwise().squaredNorm() / static_cast<double>(ROWS - 1)).cwiseSqrt();
+        x = x * stdDev.cwiseInverse().asDiagonal();
+    }
+    const MatrixXd covarianceMatrix = (x.transpose() * x) / static_cast<double>(ROWS - 1);
+    SelfAdjointEigenSolver<MatrixXd> eigSolver(covarianceMatrix);
+    return x * eigSolver.eigenvectors().rowwise().reverse().leftCols(COMPONENTS);
+}
+
+
+/**
+ * Fits and projects the table with the streaming PCA and compares the
+ * result with the reference up to the sign of each component.
+ */
+static bool compare(const std::vector<float>& data, bool center, bool scale) {
+    StreamingPCA pca;
+    pca.Fit(data.data(), ROWS, COLUMNS, COMPONENTS, center, scale, CHUNK_ROWS);
+    std::vector<float> result(ROWS * COMPONENTS), minimum(COMPONENTS), maximum(COMPONENTS);
+    pca.Project(data.data(), ROWS, CHUNK_ROWS, result.data(), minimum.data(), maximum.data());
+    const MatrixXd expected = reference(data, center, scale);
+
+    bool ok = (pca.Columns() == COLUMNS) && (pca.Components() == COMPONENTS);
+    double error = 0.0;
+    for (size_t col = 0; col < COMPONENTS; ++col) {
+        const VectorXd actual =
+            Map<const Matrix<float, Dynamic, Dynamic, RowMajor>>(result.data(), ROWS, COMPONENTS)
+                .col(col)
+                .cast<double>();
+        const double sign = (actual.dot(expected.col(col)) < 0.0) ? -1.0 : 1.0;
+        const double magnitude = expected.col(col).cwiseAbs().maxCoeff();
+        error = (std::max)(error, (sign * actual - expected.col(col)).cwiseAbs().maxCoeff() / magnitude);
+        ok = ok && (minimum[col] == actual.minCoeff()) && (maximum[col] == actual.maxCoeff());
+    }
+    ok = ok && (error <= ERROR_BOUND);
+    std::printf("  center %d, scale %d: relative error %.2g %s\n", center ? 1 : 0, scale ? 1 : 0, error,
+        ok ? "ok" : "FAILED");
+    return ok;
+}
+
+
+/**
+ * Checks the streaming PCA of PCAProjection against a dense PCA in double
+ * precision for all combinations of centring and scaling.
+ */
+int main(void) {
+    std::vector<float> data;
+    generate(data);
+
+    bool ok = true;
+    for (int center = 0; center < 2; ++center) {
+        for (int scale = 0; scale < 2; ++scale) {
+            ok = compare(data, center != 0, scale != 0) && ok;
+        }
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
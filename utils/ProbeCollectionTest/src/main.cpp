@@ -0,0 +1,188 @@
+/*
+ * main.cpp
+ *
+ * Copyright (C) 2020 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ProbeCollection.h"
+
+using namespace megamol::probe;
+
+
+/**
+ * Fills the geometry of a probe from 'seed'.
+ */
+template<class P> static P makeProbe(size_t seed, const std::string& valueName) {
+    P probe;
+    const float f = static_cast<float>(seed);
+    probe.m_timestamp = seed;
+    probe.m_value_name = valueName;
+    probe.m_position = {f, f + 0.5f, f + 0.25f};
+    probe.m_direction = {0.0f, -1.0f, f};
+    probe.m_begin = -f;
+    probe.m_end = 2.0f * f;
+    return probe;
+}
+
+
+/**
+ * Answers a float probe with 'cnt' samples and statistics.
+ */
+static FloatProbe makeFloatProbe(size_t seed, const std::string& valueName, size_t cnt) {
+    auto probe = makeProbe<FloatProbe>(seed, valueName);
+    auto result = probe.getSamplingResult();
+    for (size_t i = 0; i < cnt; ++i) {
+        result->samples.push_back(static_cast<float>(seed * 100 + i));
+    }
+    result->min_value = static_cast<float>(seed);
+    result->max_value = static_cast<float>(seed + cnt);
+    result->average_value = static_cast<float>(seed) + 0.5f;
+    return probe;
+}
+
+
+/**
+ * Answers a vec4 probe with 'cnt' samples.
+ */
+static Vec4Probe makeVec4Probe(size_t seed, const std::string& valueName, size_t cnt) {
+    auto probe = makeProbe<Vec4Probe>(seed, valueName);
+    for (size_t i = 0; i < cnt; ++i) {
+        const float f = static_cast<float>(seed * 100 + i);
+        probe.getSamplingResult()->samples.push_back({f, -f, 0.5f * f, 1.0f});
+    }
+    return probe;
+}
+
+
+/**
+ * Answers whether the geometry of two probes is equal.
+ */
+static bool equalBase(const BaseProbe& lhs, const BaseProbe& rhs) {
+    return (lhs.m_timestamp == rhs.m_timestamp) && (lhs.m_value_name == rhs.m_value_name) &&
+           (lhs.m_position == rhs.m_position) && (lhs.m_direction == rhs.m_direction) &&
+           (lhs.m_begin == rhs.m_begin) && (lhs.m_end == rhs.m_end);
+}
+
+
+/**
+ * Answers whether the probes at 'idx' of two collections are equal,
+ * including their type, samples and statistics.
+ */
+static bool equalProbe(const ProbeCollection& lhs, const ProbeCollection& rhs, size_t idx) {
+    if (lhs.getProbeTypeIdx(idx) != rhs.getProbeTypeIdx(idx)) return false;
+    switch (lhs.getProbeTypeIdx(idx)) {
+    case ProbeCollection::FLOAT_PROBE: {
+        const auto l = lhs.getProbe<FloatProbe>(idx);
+        const auto r = rhs.getProbe<FloatProbe>(idx);
+        const auto lr = l.getSamplingResult();
+        const auto rr = r.getSamplingResult();
+        return equalBase(l, r) && (lr->samples == rr->samples) && (lr->min_value == rr->min_value) &&
+               (lr->max_value == rr->max_value) && (lr->average_value == rr->average_value);
+    }
+    case ProbeCollection::INT_PROBE:
+        return equalBase(lhs.getProbe<IntProbe>(idx), rhs.getProbe<IntProbe>(idx));
+    case ProbeCollection::VEC4_PROBE: {
+        const auto l = lhs.getProbe<Vec4Probe>(idx);
+        const auto r = rhs.getProbe<Vec4Probe>(idx);
+        return equalBase(l, r) && (l.getSamplingResult()->samples == r.getSamplingResult()->samples);
+    }
+    default:
+        return equalBase(lhs.getProbe<BaseProbe>(idx), rhs.getProbe<BaseProbe>(idx));
+    }
+}
+
+
+/**
+ * Answers whether two collections hold equal probes.
+ */
+static bool equal(const ProbeCollection& lhs, const ProbeCollection& rhs) {
+    if (lhs.getProbeCount() != rhs.getProbeCount()) return false;
+    for (size_t idx = 0; idx < lhs.getProbeCount(); ++idx) {
+        if (!equalProbe(lhs, rhs, idx)) return false;
+    }
+    return true;
+}
+
+
+/**
+ * Answers whether 'data' is rejected and leaves the collection empty.
+ */
+static bool rejects(const std::string& data) {
+    ProbeCollection loaded;
+    loaded.addProbe(makeFloatProbe(1, "stale", 2));
+    std::istringstream stream(data);
+    return !loaded.deserialize(stream) && (loaded.getProbeCount() == 0);
+}
+
+
+/**
+ * Prints the result of a check and answers it.
+ */
+static bool check(const char* what, bool ok) {
+    std::printf("  %-52s %s\n", what, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+
+/**
+ * Saves a ProbeCollection with every probe type and reloads it, and checks
+ * that damaged data is rejected.
+ */
+int main(void) {
+    ProbeCollection probes;
+    probes.addProbe(makeFloatProbe(1, "pressure", 5));
+    probes.addProbe(makeProbe<IntProbe>(2, "id"));
+    probes.addProbe(makeVec4Probe(3, "velocity", 4));
+    probes.addProbe(makeProbe<BaseProbe>(4, "pressure"));
+    probes.addProbe(makeFloatProbe(5, "temperature", 0));
+    probes.addProbe(makeFloatProbe(6, "pressure", 7));
+    // leave unused ranges in both sample arrays
+    probes.setProbe(0, makeFloatProbe(7, "pressure", 3));
+    probes.setProbe(2, makeVec4Probe(8, "velocity", 2));
+
+    bool ok = true;
+    std::stringstream saved;
+    ok = check("save", probes.serialize(saved)) && ok;
+    const std::string data = saved.str();
+
+    ProbeCollection loaded;
+    loaded.addProbe(makeVec4Probe(9, "stale", 3));
+    ok = check("load", loaded.deserialize(saved)) && ok;
+    ok = check("loaded probes equal the saved ones", equal(probes, loaded)) && ok;
+
+    // the loaded collection must stay usable: replace and grow probes
+    probes.setProbe(5, makeFloatProbe(10, "density", 12));
+    loaded.setProbe(5, makeFloatProbe(10, "density", 12));
+    probes.setProbe(1, makeVec4Probe(11, "velocity", 6));
+    loaded.setProbe(1, makeVec4Probe(11, "velocity", 6));
+    ok = check("loaded probes can be modified", equal(probes, loaded)) && ok;
+
+    std::stringstream empty;
+    ProbeCollection loadedEmpty;
+    ok = check("empty collection round trip",
+             ProbeCollection().serialize(empty) && loadedEmpty.deserialize(empty) &&
+                 (loadedEmpty.getProbeCount() == 0)) &&
+         ok;
+
+    ok = check("empty data is rejected", rejects(std::string())) && ok;
+    bool truncated = true;
+    for (size_t length = 1; length < data.size(); length += 7) {
+        truncated = rejects(data.substr(0, length)) && truncated;
+    }
+    ok = check("truncated data is rejected", truncated) && ok;
+    std::string badMagic = data;
+    badMagic[0] ^= 0x01;
+    ok = check("wrong magic number is rejected", rejects(badMagic)) && ok;
+    std::string badVersion = data;
+    badVersion[8] ^= 0x02;
+    ok = check("unknown version is rejected", rejects(badVersion)) && ok;
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,223 @@
+/*
+ * main.cpp
+ *
+ * Copyright (C) 2020 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "BarnesHutTSNE.h"
+
+using megamol::infovis::BarnesHutTSNE;
+
+
+/** The perplexity used for all runs */
+static const double PERPLEXITY = 30.0;
+
+/** The seed of the input data and of the embeddings */
+static const int SEED = 42;
+
+/** Bound of the divergence of the exact embedding, about 1.02 when written */
+static const double KL_BOUND_EXACT = 1.10;
+
+/** Bound of the divergence of the Barnes-Hut embedding (theta = 0.5), about 1.09 when written */
+static const double KL_BOUND_BARNES_HUT = 1.20;
+
+
+/**
+ * Generates 'clusters' Gaussian clusters of 'perCluster' rows in 'columns' dimensions.
+ */
+static void generate(size_t clusters, size_t perCluster, size_t columns, std::vector<double>& data,
+    std::vector<int>& labels) {
+    std::mt19937 rng(SEED);
+    std::uniform_real_distribution<double> centre(-10.0, 10.0);
+    std::normal_distribution<double> spread(0.0, 1.0);
+    data.resize(clusters * perCluster * columns);
+    labels.resize(clusters * perCluster);
+    for (size_t c = 0; c < clusters; ++c) {
+        std::vector<double> mid(columns);
+        for (double& v : mid) v = centre(rng);
+        for (size_t r = 0; r < perCluster; ++r) {
+            const size_t row = c * perCluster + r;
+            for (size_t d = 0; d < columns; ++d) data[row * columns + d] = mid[d] + spread(rng);
+            labels[row] = static_cast<int>(c);
+        }
+    }
+}
+
+
+/**
+ * Computes the exact joint input similarities of t-SNE, independently of
+ * BarnesHutTSNE, with the same normalisation of the input.
+ */
+static std::vector<double> inputSimilarities(const std::vector<double>& data, size_t rows, size_t columns) {
+    std::vector<double> x(data);
+    double maxAbs = 0.0;
+    for (size_t c = 0; c < columns; ++c) {
+        double mean = 0.0;
+        for (size_t r = 0; r < rows; ++r) mean += x[r * columns + c];
+        mean /= static_cast<double>(rows);
+        for (size_t r = 0; r < rows; ++r) {
+            x[r * columns + c] -= mean;
+            maxAbs = (std::max)(maxAbs, std::abs(x[r * columns + c]));
+        }
+    }
+    for (double& v : x) v /= maxAbs;
+
+    std::vector<double> p(rows * rows, 0.0);
+    std::vector<double> d2(rows);
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < rows; ++j) {
+            double d = 0.0;
+            for (size_t c = 0; c < columns; ++c) {
+                d += (x[i * columns + c] - x[j * columns + c]) * (x[i * columns + c] - x[j * columns + c]);
+            }
+            d2[j] = d;
+        }
+        double lo = 0.0, hi = std::numeric_limits<double>::max(), beta = 1.0;
+        for (int step = 0; step < 200; ++step) {
+            double sum = 0.0, weighted = 0.0;
+            for (size_t j = 0; j < rows; ++j) {
+                p[i * rows + j] = (j == i) ? 0.0 : std::exp(-beta * d2[j]);
+                sum += p[i * rows + j];
+                weighted += d2[j] * p[i * rows + j];
+            }
+            const double entropy = std::log(sum) + beta * weighted / sum;
+            if (std::abs(entropy - std::log(PERPLEXITY)) < 1e-5) break;
+            if (entropy > std::log(PERPLEXITY)) {
+                lo = beta;
+                beta = (hi == std::numeric_limits<double>::max()) ? beta * 2.0 : 0.5 * (beta + hi);
+            } else {
+                hi = beta;
+                beta = 0.5 * (beta + lo);
+            }
+        }
+        double sum = 0.0;
+        for (size_t j = 0; j < rows; ++j) sum += p[i * rows + j];
+        for (size_t j = 0; j < rows; ++j) p[i * rows + j] /= sum;
+    }
+
+    std::vector<double> joint(rows * rows);
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < rows; ++j) {
+            joint[i * rows + j] = (p[i * rows + j] + p[j * rows + i]) / (2.0 * static_cast<double>(rows));
+        }
+    }
+    return joint;
+}
+
+
+/**
+ * Answers the Kullback-Leibler divergence of the embedding 'y' from the
+ * input similarities 'p'.
+ */
+static double divergence(const std::vector<double>& p, const std::vector<double>& y, size_t rows, size_t dims) {
+    std::vector<double> q(rows * rows, 0.0);
+    double sumQ = 0.0;
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < rows; ++j) {
+            if (j == i) continue;
+            double d = 0.0;
+            for (size_t k = 0; k < dims; ++k) {
+                d += (y[i * dims + k] - y[j * dims + k]) * (y[i * dims + k] - y[j * dims + k]);
+            }
+            q[i * rows + j] = 1.0 / (1.0 + d);
+            sumQ += q[i * rows + j];
+        }
+    }
+    double kl = 0.0;
+    for (size_t e = 0; e < rows * rows; ++e) {
+        if (p[e] > 0.0) kl += p[e] * std::log(p[e] / (q[e] / sumQ));
+    }
+    return kl;
+}
+
+
+/**
+ * Answers the fraction of rows whose nearest neighbour in the embedding 'y'
+ * has the same label.
+ */
+static double neighbourAgreement(const std::vector<double>& y, const std::vector<int>& labels, size_t dims) {
+    const size_t rows = labels.size();
+    size_t agree = 0;
+    for (size_t i = 0; i < rows; ++i) {
+        size_t best = i;
+        double bestD = std::numeric_limits<double>::max();
+        for (size_t j = 0; j < rows; ++j) {
+            if (j == i) continue;
+            double d = 0.0;
+            for (size_t k = 0; k < dims; ++k) {
+                d += (y[i * dims + k] - y[j * dims + k]) * (y[i * dims + k] - y[j * dims + k]);
+            }
+            if (d < bestD) {
+                bestD = d;
+                best = j;
+            }
+        }
+        if (labels[best] == labels[i]) ++agree;
+    }
+    return static_cast<double>(agree) / static_cast<double>(rows);
+}
+
+
+/**
+ * Embeds Gaussian clusters with a fixed seed, exactly (theta = 0) and with
+ * the Barnes-Hut approximation, and checks that the Kullback-Leibler
+ * divergence of the results from the exact input similarities stays below
+ * the bounds above.
+ */
+int main(void) {
+    const size_t clusters = 5, perCluster = 200, columns = 10, dims = 2;
+    const int maxIter = 1000;
+
+    std::vector<double> data;
+    std::vector<int> labels;
+    generate(clusters, perCluster, columns, data, labels);
+    const size_t rows = labels.size();
+    const std::vector<double> p = inputSimilarities(data, rows, columns);
+
+    struct Case {
+        double theta;
+        double maxDivergence;
+    };
+    const Case cases[] = {{0.0, KL_BOUND_EXACT}, {0.5, KL_BOUND_BARNES_HUT}};
+
+    bool ok = true;
+    for (const Case& c : cases) {
+        std::vector<double> y;
+        std::atomic<bool> cancel(false);
+        BarnesHutTSNE tsne(static_cast<int>(dims), PERPLEXITY, c.theta, SEED);
+        const bool finished = tsne.Run(data, rows, columns, maxIter, 0, cancel,
+            [&y](const std::vector<double>& embedding, int) { y = embedding; });
+        if (!finished || (y.size() != rows * dims)) {
+            std::printf("theta %.1f: optimisation failed\n", c.theta);
+            ok = false;
+            continue;
+        }
+        const double kl = divergence(p, y, rows, dims);
+        const double agreement = neighbourAgreement(y, labels, dims);
+        const bool pass = (kl <= c.maxDivergence) && (agreement >= 0.99);
+        std::printf("theta %.1f: KL %.4f (bound %.4f), nearest neighbour labels %.1f %% %s\n", c.theta, kl,
+            c.maxDivergence, 100.0 * agreement, pass ? "ok" : "FAILED");
+        ok = ok && pass;
+    }
+
+    // cancellation before the first iteration
+    {
+        std::atomic<bool> cancel(true);
+        BarnesHutTSNE tsne(static_cast<int>(dims), PERPLEXITY, 0.5, SEED);
+        const bool finished = tsne.Run(data, rows, columns, maxIter, 0, cancel, BarnesHutTSNE::progress_callback());
+        std::printf("cancelled run %s\n", finished ? "FAILED" : "ok");
+        ok = ok && !finished;
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,132 @@
+/*
+ * main.cpp
+ *
+ * Copyright (C) 2020 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include "json.hpp"
+#include "mmcore/Call.h"
+#include "mmcore/profiler/Tracer.h"
+
+using megamol::core::Call;
+using megamol::core::profiler::Tracer;
+
+
+/**
+ * A call without slots, which is traced under empty names.
+ */
+class TestCall : public Call {};
+
+
+/**
+ * Prints the result of a check and answers it.
+ */
+static bool check(const char* what, bool ok) {
+    std::printf("  %-48s %s\n", what, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+
+/**
+ * Records nested spans, overflows the span buffer and checks the nesting
+ * and self times in the exported trace, its syntax and the reported
+ * overflow. Timings are only compared with each other, never with the
+ * sleeps, which may take arbitrarily longer on a loaded machine.
+ * Finally, the cost of recording a span is measured.
+ *
+ * usage: tracertest [trace file]
+ */
+int main(int argc, char** argv) {
+    const std::string path = (argc > 1) ? argv[1] : "tracertest.json";
+    Tracer& tracer = Tracer::Instance();
+    TestCall call;
+    bool ok = true;
+
+    // an outer span with an inner one, both sleeping, then more spans than
+    // fit into the buffer of 4 spans
+    tracer.Start(4);
+    {
+        Tracer::Span outer(call, 0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        {
+            Tracer::Span inner(call, 1);
+            std::this_thread::sleep_for(std::chrono::milliseconds(40));
+        }
+    }
+    for (int i = 0; i < 8; ++i) {
+        Tracer::Span span(call, 2);
+    }
+    tracer.Stop();
+
+    ok = check("trace written", tracer.WriteTrace(path)) && ok;
+    nlohmann::json trace;
+    try {
+        std::ifstream in(path);
+        in >> trace;
+        ok = check("trace is valid JSON", true) && ok;
+    } catch (const std::exception& ex) {
+        std::printf("  %s\n", ex.what());
+        return check("trace is valid JSON", false) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // spans are exported as complete events ("X") in microseconds; the two
+    // longest ones are the outer and the inner span, as only they sleep
+    long long outerTs = -1, outerDur = -1, outerSelf = -1, innerTs = -1, innerDur = -1, innerSelf = -1;
+    int spans = 0;
+    for (const auto& e : trace["traceEvents"]) {
+        if (e["ph"] != "X") continue;
+        ++spans;
+        const long long ts = e["ts"].get<long long>();
+        const long long dur = e["dur"].get<long long>();
+        const long long self = e["args"]["self"].get<long long>();
+        if (dur > outerDur) {
+            innerTs = outerTs;
+            innerDur = outerDur;
+            innerSelf = outerSelf;
+            outerTs = ts;
+            outerDur = dur;
+            outerSelf = self;
+        } else if (dur > innerDur) {
+            innerTs = ts;
+            innerDur = dur;
+            innerSelf = self;
+        }
+    }
+    ok = check("only the spans fitting the buffer are exported", spans == 4) && ok;
+    ok = check("inner span has no children", innerSelf == innerDur) && ok;
+    ok = check("outer self time excludes the inner span", outerSelf == outerDur - innerDur) && ok;
+    ok = check("inner span lies within the outer one",
+             (innerTs >= outerTs) && (innerTs + innerDur <= outerTs + outerDur)) &&
+         ok;
+    ok = check("outer span has time of its own", outerSelf > 0) && ok;
+    const std::string summary = tracer.Summary();
+    ok = check("dropped spans are reported", summary.find("6 spans dropped") != std::string::npos) && ok;
+
+    // the cost of one span while recording and of the disabled check
+    const int reps = 1000000;
+    tracer.Start(reps);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < reps; ++i) {
+        Tracer::Span span(call, 0);
+    }
+    const std::chrono::duration<double, std::nano> recording = std::chrono::steady_clock::now() - start;
+    tracer.Stop();
+    volatile int enabled = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < reps; ++i) {
+        enabled += Tracer::IsEnabled() ? 1 : 0;
+    }
+    const std::chrono::duration<double, std::nano> disabled = std::chrono::steady_clock::now() - start;
+    std::printf("  recording: %.1f ns per span, disabled: %.2f ns per call\n", recording.count() / reps,
+        disabled.count() / reps);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,154 @@
+/*
+ * main.cpp
+ *
+ * Copyright (C) 2020 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "mpi.h"
+
+#include "VolumeBrickExchange.h"
+
+using megamol::stdplugin::datatools::VolumeBrickExchange;
+
+
+/**
+ * A reduction operator and the background the exchange is run with.
+ */
+struct Operator {
+    const char *name;
+    MPI_Op op;
+    float background;
+    float low;
+    float high;
+};
+
+
+/**
+ * Fills 'volume' with 'background' and a few spheres of random values in
+ * [low, high), which differ between the ranks.
+ */
+static void makeVolume(std::vector<float>& volume, const size_t res[3], size_t components, const Operator& op,
+        int rank) {
+    std::mt19937 rng(1234u + static_cast<unsigned int>(rank));
+    std::uniform_real_distribution<float> value(op.low, op.high);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    volume.assign(res[0] * res[1] * res[2] * components, op.background);
+    for (int s = 0; s < 3; ++s) {
+        const float centre[3] = {unit(rng) * res[0], unit(rng) * res[1], unit(rng) * res[2]};
+        const float radius = 0.1f * static_cast<float>((std::min)(res[0], (std::min)(res[1], res[2])));
+        for (size_t z = 0; z < res[2]; ++z) {
+            for (size_t y = 0; y < res[1]; ++y) {
+                for (size_t x = 0; x < res[0]; ++x) {
+                    const float d[3] = {x - centre[0], y - centre[1], z - centre[2]};
+                    if (d[0] * d[0] + d[1] * d[1] + d[2] * d[2] <= radius * radius) {
+                        float *voxel = volume.data() + ((z * res[1] + y) * res[0] + x) * components;
+                        for (size_t c = 0; c < components; ++c) {
+                            voxel[c] = value(rng);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+/**
+ * Answer the number of floats in [0, cnt) differing by more than a relative
+ * 1e-5, the reduction order of the brick-based paths may differ.
+ */
+static size_t countDifferences(const float *expected, const float *actual, size_t cnt) {
+    size_t diff = 0;
+    for (size_t i = 0; i < cnt; ++i) {
+        const float tolerance = 1e-5f * (std::max)(1.0f, std::fabs(expected[i]));
+        if (!(std::fabs(expected[i] - actual[i]) <= tolerance)) {
+            ++diff;
+        }
+    }
+    return diff;
+}
+
+
+/*
+ * main
+ */
+int main(int argc, char **argv) {
+    ::MPI_Init(&argc, &argv);
+    int rank = 0, size = 1;
+    ::MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    ::MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    // the defaults are no multiples of the brick size, so partial bricks
+    // at the upper borders are covered.
+    const size_t res[3] = {(argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 70,
+        (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 45, (argc > 3) ? std::strtoul(argv[3], nullptr, 10) : 38};
+    const size_t brickSize = (argc > 4) ? std::strtoul(argv[4], nullptr, 10) : 16;
+
+    const Operator ops[] = {
+        {"Max", MPI_MAX, 0.0f, -1.0f, 10.0f},
+        {"Min", MPI_MIN, 0.0f, -10.0f, 1.0f},
+        {"Sum", MPI_SUM, 0.0f, -1.0f, 10.0f},
+        {"Product", MPI_PROD, 1.0f, 0.5f, 1.5f},
+    };
+
+    if (rank == 0) {
+        std::printf("%d ranks, %zu x %zu x %zu voxels, bricks of %zu^3\n", size, res[0], res[1], res[2], brickSize);
+    }
+
+    bool failed = false;
+    std::vector<float> volume, expected, actual, slab, gathered;
+    for (size_t components = 1; components <= 2; ++components) {
+        for (const auto& op : ops) {
+            makeVolume(volume, res, components, op, rank);
+            const size_t cnt = volume.size();
+
+            expected.resize(cnt);
+            ::MPI_Allreduce(volume.data(), expected.data(), static_cast<int>(cnt), MPI_FLOAT, op.op, MPI_COMM_WORLD);
+
+            VolumeBrickExchange exchange(MPI_COMM_WORLD, res, components, brickSize, op.op, op.background);
+            const size_t occupied = exchange.FindOccupiedBricks(volume.data());
+
+            // sparse bricks, full result on every rank
+            actual.assign(cnt, -1.0f);
+            bool ok = exchange.Allreduce(volume.data(), actual.data());
+            size_t diffAllreduce = ok ? countDifferences(expected.data(), actual.data(), cnt) : cnt;
+
+            // reduce-scatter, each rank checks its slab
+            slab.assign(exchange.SlabSize(rank), -1.0f);
+            ok = exchange.ReduceScatter(volume.data(), slab.data());
+            const size_t slabOffset = exchange.SlabBegin(rank) * res[0] * res[1] * components;
+            size_t diffScatter = ok ? countDifferences(expected.data() + slabOffset, slab.data(), slab.size()) : cnt;
+
+            // and the slabs gathered on rank 0
+            gathered.assign((rank == 0) ? cnt : 0, -1.0f);
+            ok = ok && exchange.GatherSlabs(slab.data(), gathered.data(), 0);
+            size_t diffGather = !ok ? cnt : (rank == 0) ? countDifferences(expected.data(), gathered.data(), cnt) : 0;
+
+            unsigned long long diff[3] = {diffAllreduce, diffScatter, diffGather};
+            ::MPI_Allreduce(MPI_IN_PLACE, diff, 3, MPI_UNSIGNED_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+            const bool passed = (diff[0] == 0) && (diff[1] == 0) && (diff[2] == 0);
+            failed = failed || !passed;
+
+            if (rank == 0) {
+                std::printf("  %-7s %zu component(s): %zu bricks occupied, %zu of %zu floats sent, %s",
+                    op.name, components, occupied, exchange.TransferSize(), cnt, passed ? "ok\n" : "FAILED");
+                if (!passed) {
+                    std::printf(" (wrong floats: allreduce %llu, reduce-scatter %llu, gather %llu)\n", diff[0],
+                        diff[1], diff[2]);
+                }
+            }
+        }
+    }
+
+    ::MPI_Finalize();
+    return failed ? 1 : 0;
+}
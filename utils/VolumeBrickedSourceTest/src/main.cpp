@@ -0,0 +1,184 @@
+/*
+ * main.cpp
+ *
+ * Copyright (C) 2020 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "VolumetricDataSource.h"
+#include "mmcore/misc/VolumetricDataCall.h"
+#include "mmcore/param/BoolParam.h"
+#include "mmcore/param/FilePathParam.h"
+#include "mmcore/param/IntParam.h"
+#include "mmcore/param/ParamSlot.h"
+
+using megamol::core::misc::VolumetricDataCall;
+using megamol::core::param::ParamSlot;
+using megamol::stdplugin::volume::VolumetricDataSource;
+
+
+/** The resolution of the test volume, which is not a multiple of the brick size */
+static const size_t RESOLUTION[3] = {40, 36, 33};
+
+/** The edge length of a brick */
+static const int BRICK_SIZE = 16;
+
+
+/**
+ * Exposes the callbacks of the data source, so it can be driven without a
+ * core instance.
+ */
+class TestSource : public VolumetricDataSource {
+public:
+    using VolumetricDataSource::create;
+    using VolumetricDataSource::onGetData;
+    using VolumetricDataSource::release;
+
+    /** Sets the value of the parameter 'name' */
+    template<class P, class V> void Set(const char* name, const V& value) {
+        dynamic_cast<ParamSlot*>(this->FindSlot(name))->Param<P>()->SetValue(value);
+    }
+};
+
+
+/**
+ * Answers the value of the voxel (x, y, z) of the test volume.
+ */
+static uint8_t voxel(size_t x, size_t y, size_t z) { return static_cast<uint8_t>(x + 3 * y + 7 * z); }
+
+
+/**
+ * Writes the test volume as unsigned bytes and its dat file.
+ */
+static bool writeVolume(const std::string& dat, const std::string& raw) {
+    std::vector<uint8_t> data;
+    data.reserve(RESOLUTION[0] * RESOLUTION[1] * RESOLUTION[2]);
+    for (size_t z = 0; z < RESOLUTION[2]; ++z) {
+        for (size_t y = 0; y < RESOLUTION[1]; ++y) {
+            for (size_t x = 0; x < RESOLUTION[0]; ++x) {
+                data.push_back(voxel(x, y, z));
+            }
+        }
+    }
+    std::ofstream rawFile(raw, std::ios::binary);
+    rawFile.write(reinterpret_cast<const char*>(data.data()), data.size());
+
+    const auto sep = raw.find_last_of("/\\");
+    std::ofstream datFile(dat);
+    datFile << "OBJECTFILENAME: " << ((sep == std::string::npos) ? raw : raw.substr(sep + 1)) << "\n"
+            << "FORMAT: UCHAR\n"
+            << "GRIDTYPE: EQUIDISTANT\n"
+            << "COMPONENTS: 1\n"
+            << "DIMENSIONS: 3\n"
+            << "TIMESTEPS: 1\n"
+            << "BYTEORDER: LITTLE_ENDIAN\n"
+            << "RESOLUTION: " << RESOLUTION[0] << " " << RESOLUTION[1] << " " << RESOLUTION[2] << "\n"
+            << "SLICETHICKNESS: 1.0 1.0 1.0\n";
+    return static_cast<bool>(rawFile) && static_cast<bool>(datFile);
+}
+
+
+/**
+ * Requests the region [min, max[ of level 0 (the whole volume if 'min' is
+ * nullptr) through 'call' and compares the delivered voxels with the test
+ * volume.
+ */
+static bool read(TestSource& source, VolumetricDataCall& call, const size_t* min, const size_t* max) {
+    call.SetFrameID(0);
+    call.SetRequestedLevel(0);
+    if (min != nullptr) {
+        call.SetRequestedRegion(min, max);
+    } else {
+        call.ResetRequestedRegion();
+    }
+    if (!source.onGetData(call) || (call.GetMetadata() == nullptr) || (call.GetDataLevel() != 0)) {
+        return false;
+    }
+
+    size_t offset[3], ext[3];
+    for (int d = 0; d < 3; ++d) {
+        offset[d] = call.GetDataOffset(d);
+        ext[d] = call.GetMetadata()->Resolution[d];
+        const size_t expected = (min != nullptr) ? (max[d] - min[d]) : RESOLUTION[d];
+        if ((offset[d] != ((min != nullptr) ? min[d] : 0)) || (ext[d] != expected)) return false;
+    }
+    auto data = static_cast<const uint8_t*>(call.GetData());
+    for (size_t z = 0; z < ext[2]; ++z) {
+        for (size_t y = 0; y < ext[1]; ++y) {
+            for (size_t x = 0; x < ext[0]; ++x) {
+                if (data[(z * ext[1] + y) * ext[0] + x] != voxel(x + offset[0], y + offset[1], z + offset[2])) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+
+/**
+ * Prints the result of a check and answers it.
+ */
+static bool check(const char* what, bool ok) {
+    std::printf("  %-52s %s\n", what, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+
+/**
+ * Reads a small volume repeatedly through the bricked mode of
+ * VolumetricDataSource, reusing the same call like a renderer does.
+ *
+ * usage: volumebrickedsourcetest [directory for the test files]
+ */
+int main(int argc, char** argv) {
+    std::string dir = (argc > 1) ? argv[1] : ".";
+    if ((dir.back() != '/') && (dir.back() != '\\')) dir += '/';
+    const std::string dat = dir + "volumebrickedsourcetest.dat";
+    const std::string raw = dir + "volumebrickedsourcetest.raw";
+    const std::string cache = dat + ".f0.b" + std::to_string(BRICK_SIZE) + ".mmbvc";
+    std::remove(cache.c_str());
+    if (!writeVolume(dat, raw)) {
+        std::fprintf(stderr, "Unable to write the test volume to %s\n", dir.c_str());
+        return EXIT_FAILURE;
+    }
+
+    const size_t min[3] = {8, 4, 2}, max[3] = {24, 20, 18};
+    bool ok = true;
+    for (int run = 0; run < 2; ++run) {
+        // the second source opens the cache file written by the first one
+        TestSource source;
+        source.Set<megamol::core::param::FilePathParam>("FileName", dat.c_str());
+        source.Set<megamol::core::param::BoolParam>("Bricked", true);
+        source.Set<megamol::core::param::IntParam>("BrickSize", BRICK_SIZE);
+        source.create();
+
+        VolumetricDataCall call;
+        ok = check((run == 0) ? "first read builds the cache" : "first read opens the cache",
+                 read(source, call, nullptr, nullptr)) && ok;
+        const void* data = call.GetData();
+        const size_t hash = call.DataHash();
+        ok = check("same call reads the volume again", read(source, call, nullptr, nullptr)) && ok;
+        ok = check("unchanged request keeps buffer and hash", (call.GetData() == data) && (call.DataHash() == hash)) &&
+             ok;
+        ok = check("same call reads a region", read(source, call, min, max)) && ok;
+        ok = check("same call reads the region again", read(source, call, min, max)) && ok;
+
+        VolumetricDataCall other;
+        ok = check("another call reads the volume", read(source, other, nullptr, nullptr)) && ok;
+
+        source.release();
+    }
+
+    std::remove(cache.c_str());
+    std::remove(dat.c_str());
+    std::remove(raw.c_str());
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
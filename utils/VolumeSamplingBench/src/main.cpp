@@ -0,0 +1,204 @@
+/*
+ * main.cpp
+ *
+ * Copyright (C) 2020 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "mmcore/misc/VolumetricDataCall.h"
+
+using megamol::core::misc::VolumetricDataCall;
+
+
+/**
+ * Measures the time 'f' takes in milliseconds (best of three runs).
+ */
+template<class F> static double measure(F&& f) {
+    double best = 0.0;
+    for (int r = 0; r < 3; ++r) {
+        const auto start = std::chrono::high_resolution_clock::now();
+        f();
+        const std::chrono::duration<double, std::milli> d = std::chrono::high_resolution_clock::now() - start;
+        best = (r == 0) ? d.count() : (std::min)(best, d.count());
+    }
+    return best;
+}
+
+
+/**
+ * Answer the largest absolute difference between 'lhs' and 'rhs'.
+ */
+static float maxDifference(const std::vector<float>& lhs, const std::vector<float>& rhs) {
+    float retval = 0.0f;
+    for (size_t i = 0; i < lhs.size(); ++i) {
+        retval = (std::max)(retval, std::abs(lhs[i] - rhs[i]));
+    }
+    return retval;
+}
+
+
+/**
+ * Prints a result line.
+ */
+static void report(const char* what, const double perVoxel, const double bulk, const float diff) {
+    if (perVoxel > 0.0) {
+        std::printf("  %-10s per-voxel %9.3f ms  bulk %9.3f ms  speedup %6.2fx  max. diff %g\n", what, perVoxel, bulk,
+            perVoxel / bulk, diff);
+    } else {
+        std::printf("  %-10s per-voxel       n/a     bulk %9.3f ms\n", what, bulk);
+    }
+}
+
+
+/**
+ * Runs all benchmarks on a volume of type T. The per-voxel path only
+ * supports four-byte scalars, so it is skipped for all other types.
+ */
+template<class T>
+static void run(const char* name, const VolumetricDataCall::ScalarType type, const size_t res, const size_t samples) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> valueDist(0, 255);
+
+    std::vector<T> volume(res * res * res);
+    for (auto& v : volume) {
+        v = static_cast<T>(valueDist(rng));
+    }
+
+    double minValue = 0.0, maxValue = 255.0;
+    float sliceDist = 1.0f;
+    VolumetricDataCall::Metadata md;
+    md.GridType = VolumetricDataCall::GridType::CARTESIAN;
+    md.ScalarType = type;
+    md.ScalarLength = sizeof(T);
+    md.Components = 1;
+    md.NumberOfFrames = 1;
+    for (int i = 0; i < 3; ++i) {
+        md.Resolution[i] = res;
+        md.SliceDists[i] = &sliceDist;
+        md.IsUniform[i] = true;
+        md.Extents[i] = static_cast<float>(res);
+    }
+    md.MinValues = &minValue;
+    md.MaxValues = &maxValue;
+
+    VolumetricDataCall call;
+    call.SetMetadata(&md);
+    call.SetData(volume.data());
+
+    const bool perVoxel = (sizeof(T) == 4);
+    const auto res32 = static_cast<uint32_t>(res);
+    std::printf("%s, %zu^3 voxels, %zu samples\n", name, res, samples);
+
+    // Whole-volume conversion.
+    {
+        std::vector<float> ref(volume.size()), bulk(volume.size());
+        double tRef = 0.0;
+        if (perVoxel) {
+            tRef = measure([&]() {
+                size_t i = 0;
+                for (uint32_t z = 0; z < res32; ++z) {
+                    for (uint32_t y = 0; y < res32; ++y) {
+                        for (uint32_t x = 0; x < res32; ++x) {
+                            ref[i++] = call.GetRelativeVoxelValue(x, y, z);
+                        }
+                    }
+                }
+            });
+        }
+        const auto tBulk = measure([&]() { call.ConvertSlab(0, res, bulk.data(), 0, true); });
+        report("slab", tRef, tBulk, perVoxel ? maxDifference(ref, bulk) : 0.0f);
+    }
+
+    // Gathering random voxels.
+    {
+        std::uniform_int_distribution<uint32_t> coordDist(0, res32 - 1);
+        std::vector<uint32_t> coords(3 * samples);
+        std::vector<uint64_t> indices(samples);
+        for (size_t i = 0; i < samples; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                coords[3 * i + j] = coordDist(rng);
+            }
+            indices[i] = (coords[3 * i + 2] * res + coords[3 * i + 1]) * res + coords[3 * i];
+        }
+
+        std::vector<float> ref(samples), bulk(samples);
+        double tRef = 0.0;
+        if (perVoxel) {
+            tRef = measure([&]() {
+                for (size_t i = 0; i < samples; ++i) {
+                    ref[i] = call.GetAbsoluteVoxelValue(coords[3 * i], coords[3 * i + 1], coords[3 * i + 2]);
+                }
+            });
+        }
+        const auto tBulk = measure([&]() { call.GatherVoxelValues(indices.data(), samples, bulk.data()); });
+        report("gather", tRef, tBulk, perVoxel ? maxDifference(ref, bulk) : 0.0f);
+    }
+
+    // Trilinear sampling of random positions.
+    {
+        std::uniform_real_distribution<float> posDist(0.0f, static_cast<float>(res - 1));
+        std::vector<float> positions(3 * samples);
+        for (auto& p : positions) {
+            p = posDist(rng);
+        }
+
+        std::vector<float> ref(samples), bulk(samples);
+        double tRef = 0.0;
+        if (perVoxel) {
+            tRef = measure([&]() {
+                for (size_t i = 0; i < samples; ++i) {
+                    const float* p = positions.data() + 3 * i;
+                    const auto x0 = static_cast<uint32_t>(p[0]);
+                    const auto y0 = static_cast<uint32_t>(p[1]);
+                    const auto z0 = static_cast<uint32_t>(p[2]);
+                    const auto x1 = (std::min)(x0 + 1, res32 - 1);
+                    const auto y1 = (std::min)(y0 + 1, res32 - 1);
+                    const auto z1 = (std::min)(z0 + 1, res32 - 1);
+                    const float fx = p[0] - x0, fy = p[1] - y0, fz = p[2] - z0;
+
+                    const float c00 = call.GetAbsoluteVoxelValue(x0, y0, z0) * (1.0f - fx) +
+                                      call.GetAbsoluteVoxelValue(x1, y0, z0) * fx;
+                    const float c10 = call.GetAbsoluteVoxelValue(x0, y1, z0) * (1.0f - fx) +
+                                      call.GetAbsoluteVoxelValue(x1, y1, z0) * fx;
+                    const float c01 = call.GetAbsoluteVoxelValue(x0, y0, z1) * (1.0f - fx) +
+                                      call.GetAbsoluteVoxelValue(x1, y0, z1) * fx;
+                    const float c11 = call.GetAbsoluteVoxelValue(x0, y1, z1) * (1.0f - fx) +
+                                      call.GetAbsoluteVoxelValue(x1, y1, z1) * fx;
+                    ref[i] = (c00 * (1.0f - fy) + c10 * fy) * (1.0f - fz) + (c01 * (1.0f - fy) + c11 * fy) * fz;
+                }
+            });
+        }
+        const auto tBulk = measure([&]() { call.SampleTrilinear(positions.data(), samples, bulk.data()); });
+        report("trilinear", tRef, tBulk, perVoxel ? maxDifference(ref, bulk) : 0.0f);
+    }
+}
+
+
+/*
+ * main
+ */
+int main(int argc, char** argv) {
+    const size_t res = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 256;
+    const size_t samples = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 4000000;
+
+    if ((res < 2) || (samples < 1)) {
+        std::fprintf(stderr, "Usage: %s [resolution >= 2] [samples >= 1]\n", argv[0]);
+        return -1;
+    }
+
+    run<float>("float32", VolumetricDataCall::ScalarType::FLOATING_POINT, res, samples);
+    run<int32_t>("int32", VolumetricDataCall::ScalarType::SIGNED_INTEGER, res, samples);
+    run<uint16_t>("uint16", VolumetricDataCall::ScalarType::UNSIGNED_INTEGER, res, samples);
+    run<uint8_t>("uint8", VolumetricDataCall::ScalarType::UNSIGNED_INTEGER, res, samples);
+
+    return 0;
+}